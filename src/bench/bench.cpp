@@ -0,0 +1,81 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <bench/bench.hpp>
+#include <GL/glew.h>
+#include <stdexcept>
+#include <iostream>
+#include <cstdlib>
+#include <sys/resource.h>
+
+namespace x11hw {
+    namespace bench {
+
+        // Initialized before main, close enough to the process start
+        static const auto PROCESS_START = std::chrono::steady_clock::now();
+
+        BenchWindow CreateBenchWindow(const std::string &title, glm::uvec2 size, const HwContextConfig &contextConfig) {
+            BenchWindow result;
+            result.manager = std::make_shared<HwWindowManager>(contextConfig);
+            result.window = result.manager->CreateWindow("BENCH_WINDOW", title, size);
+            result.window->MakeContextCurrent();
+            result.window->SetSwapInterval(0);
+
+            glewExperimental = GL_TRUE;
+
+            if (glewInit() != GLEW_OK) {
+                throw std::runtime_error("Failed to init GLEW");
+            }
+
+            return result;
+        }
+
+        void ReportMetric(const std::string &bench, const std::string &metric, double value, const char *unit) {
+            std::cout << bench << "." << metric << " " << value << " " << unit << std::endl;
+        }
+
+        double GetProcessSeconds() {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - PROCESS_START).count();
+        }
+
+        void ReportPeakMemory(const std::string &bench) {
+            rusage usage{};
+            getrusage(RUSAGE_SELF, &usage);
+
+            // ru_maxrss is in kilobytes on Linux
+            ReportMetric(bench, "peak_rss_mib", (double) usage.ru_maxrss / 1024.0, "MiB");
+        }
+
+        double GetArgument(const std::vector<std::string> &args, const std::string &name, double defaultValue) {
+            for (auto& arg: args) {
+                if (arg.size() > name.size() && arg.compare(0, name.size(), name) == 0 && arg[name.size()] == '=') {
+                    return std::atof(arg.c_str() + name.size() + 1);
+                }
+            }
+
+            return defaultValue;
+        }
+
+    }
+}
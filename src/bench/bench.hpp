@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_BENCH_HPP
+#define X11HELLOWORLD_BENCH_HPP
+
+#include <x11hw/window.hpp>
+#include <x11hw/window_manager.hpp>
+#include <x11hw/context_config.hpp>
+#include <glm/vec2.hpp>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace x11hw {
+    namespace bench {
+
+        /** Benchmark entry: receives key=value arguments, returns process exit code */
+        typedef int (*BenchFunction)(const std::vector<std::string> &args);
+
+        struct BenchWindow {
+            std::shared_ptr<HwWindowManager> manager;
+            HwWindow *window = nullptr;
+        };
+
+        /** Measures elapsed wall time */
+        class HwStopwatch {
+        public:
+            HwStopwatch() { Restart(); }
+            void Restart() { mStart = std::chrono::steady_clock::now(); }
+            double GetSeconds() const { return std::chrono::duration<double>(std::chrono::steady_clock::now() - mStart).count(); }
+
+        private:
+            std::chrono::steady_clock::time_point mStart;
+        };
+
+        /**
+         * Create window with current GL context and initialized GLEW (vsync is disabled)
+         * @param title Window title
+         * @param size Window size
+         * @param contextConfig Config of the window context
+         * @return Window and its manager
+         */
+        BenchWindow CreateBenchWindow(const std::string &title, glm::uvec2 size,
+                                      const HwContextConfig &contextConfig = HwContextConfig());
+
+        /**
+         * Print metric in "<bench>.<metric> <value> <unit>" form (parsed by perf regression suite)
+         * @param bench Benchmark name
+         * @param metric Metric name
+         * @param value Metric value
+         * @param unit Metric unit
+         */
+        void ReportMetric(const std::string &bench, const std::string &metric, double value, const char *unit);
+
+        /** @return Seconds since the process start (for startup time) */
+        double GetProcessSeconds();
+
+        /**
+         * Print peak resident set size of the process as "<bench>.peak_rss_mib" metric
+         * @param bench Benchmark name
+         */
+        void ReportPeakMemory(const std::string &bench);
+
+        /**
+         * Find "name=value" argument
+         * @param args Benchmark arguments
+         * @param name Argument name
+         * @param defaultValue Value if argument is not specified
+         * @return Argument value
+         */
+        double GetArgument(const std::vector<std::string> &args, const std::string &name, double defaultValue);
+
+        int RunVertexPacking(const std::vector<std::string> &args);
+        int RunTextureStreaming(const std::vector<std::string> &args);
+        int RunJobSystem(const std::vector<std::string> &args);
+        int RunFramePipeline(const std::vector<std::string> &args);
+        int RunContextModes(const std::vector<std::string> &args);
+        int RunSrgbFill(const std::vector<std::string> &args);
+        int RunMsaaCost(const std::vector<std::string> &args);
+        int RunPresentLatency(const std::vector<std::string> &args);
+        int RunFramePacing(const std::vector<std::string> &args);
+        int RunEventDispatch(const std::vector<std::string> &args);
+        int RunFrameArena(const std::vector<std::string> &args);
+        int RunHudOverlay(const std::vector<std::string> &args);
+        int RunMeshLoading(const std::vector<std::string> &args);
+        int RunSceneEventStorm(const std::vector<std::string> &args);
+
+    }
+}
+
+#endif //X11HELLOWORLD_BENCH_HPP
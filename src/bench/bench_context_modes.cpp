@@ -0,0 +1,148 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <bench/bench.hpp>
+#include <x11hw/geometry.hpp>
+#include <x11hw/shader.hpp>
+#include <x11hw/debug_output.hpp>
+#include <GL/glew.h>
+#include <algorithm>
+#include <iostream>
+
+namespace x11hw {
+    namespace bench {
+
+        static const char *BENCH = "context-modes";
+
+        static const char *GetVertexCode() {
+            return R"(
+                #version 330 core
+                layout (location = 0) in vec2 position;
+
+                uniform vec2 offset;
+
+                void main() {
+                    gl_Position = vec4(position * 0.01f + offset, 0.0f, 1.0f);
+                }
+            )";
+        }
+
+        static const char *GetFragmentCode() {
+            return R"(
+                #version 330 core
+                layout (location = 0) out vec4 outColor;
+
+                uniform vec2 offset;
+
+                void main() {
+                    outColor = vec4(abs(offset), 1.0f, 1.0f);
+                }
+            )";
+        }
+
+        static const char *GetModeName(HwContextMode mode) {
+            switch (mode) {
+                case HwContextMode::NoError:
+                    return "no_error";
+                case HwContextMode::Debug:
+                    return "debug";
+                default:
+                    return "default";
+            }
+        }
+
+        // CPU cost of small draws (uniform update + draw call), which is dominated by driver validation
+        static void RunMode(HwContextMode mode, int draws, int repeats) {
+            HwContextConfig config;
+            config.mode = mode;
+
+            auto benchWindow = CreateBenchWindow("Context modes benchmark", {640, 480}, config);
+            auto actualMode = benchWindow.manager->GetContextMode();
+
+            if (actualMode != mode) {
+                std::cout << BENCH << ": " << GetModeName(mode) << " is not supported, skipped" << std::endl;
+                return;
+            }
+
+            float triangle[] = { -1.0f, -1.0f, 1.0f, -1.0f, 0.0f, 1.0f };
+
+            HwGeometry::InitParams params;
+            params.topology = GL_TRIANGLES;
+            params.stride = sizeof(float) * 2;
+            params.verticesCount = 3;
+            params.attributes = {{0, 2, GL_FLOAT, false}};
+
+            HwShader shader(GetVertexCode(), GetFragmentCode());
+            HwGeometry geometry(params);
+            geometry.Update(0, sizeof(triangle), triangle);
+
+            static const std::string OFFSET = "offset";
+
+            glViewport(0, 0, 640, 480);
+            shader.Bind();
+
+            double submitSeconds = 1e9;
+            double totalSeconds = 1e9;
+
+            for (int r = 0; r < repeats; r++) {
+                glFinish();
+                HwStopwatch stopwatch;
+
+                for (int i = 0; i < draws; i++) {
+                    float t = (float) i / (float) draws;
+                    shader.SetVec2(OFFSET, glm::vec2(t * 2.0f - 1.0f, 1.0f - t * 2.0f));
+                    geometry.Draw();
+                }
+
+                submitSeconds = std::min(submitSeconds, stopwatch.GetSeconds());
+                glFinish();
+                totalSeconds = std::min(totalSeconds, stopwatch.GetSeconds());
+
+                benchWindow.window->SwapBuffers();
+            }
+
+            shader.Unbind();
+
+            std::string prefix = GetModeName(mode);
+            ReportMetric(BENCH, prefix + "_submit_ns_per_draw", submitSeconds / draws * 1e9, "ns");
+            ReportMetric(BENCH, prefix + "_total_ns_per_draw", totalSeconds / draws * 1e9, "ns");
+
+            if (auto debugOutput = benchWindow.manager->GetDebugOutput()) {
+                debugOutput->Report(std::cout);
+            }
+        }
+
+        int RunContextModes(const std::vector<std::string> &args) {
+            auto draws = (int) GetArgument(args, "draws", 20000);
+            auto repeats = (int) GetArgument(args, "repeats", 10);
+
+            RunMode(HwContextMode::Default, draws, repeats);
+            RunMode(HwContextMode::NoError, draws, repeats);
+            RunMode(HwContextMode::Debug, draws, repeats);
+
+            return 0;
+        }
+
+    }
+}
@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <bench/bench.hpp>
+#include <x11hw/event_dispatcher.hpp>
+#include <functional>
+#include <iostream>
+
+namespace x11hw {
+    namespace bench {
+
+        static const char *BENCH = "event-dispatch";
+
+        typedef HwWindow::EventData EventData;
+        typedef HwWindow::EventType EventType;
+
+        static const size_t EVENT_TYPES_COUNT = (size_t) EventType::Unknown;
+
+        static EventType GetEventType(size_t i) {
+            // Motion dominates real input streams
+            return i % 8 == 0 ? EventType::MouseButtonPressed : i % 8 == 1 ? EventType::MouseButtonReleased : EventType::MouseMoved;
+        }
+
+        int RunEventDispatch(const std::vector<std::string> &args) {
+            auto events = (size_t) GetArgument(args, "events", 5000000);
+            auto listeners = (size_t) GetArgument(args, "listeners", 8);
+
+            // Each listener is interested in single event type, as the previous path it gets all of them
+            uint64_t checksum[2] = {};
+
+            std::vector<std::function<void(const EventData &)>> functions;
+            HwWindow::InputEvents dispatcher{HwEventToken::NewOwner(), 1};
+
+            for (size_t i = 0; i < listeners; i++) {
+                auto type = (EventType) (i % EVENT_TYPES_COUNT);
+                auto sum = &checksum[0];
+
+                functions.emplace_back([type, sum](const EventData &event) {
+                    if (event.type == type) {
+                        *sum += (uint64_t) event.mousePosition.x;
+                    }
+                });
+
+                sum = &checksum[1];
+                dispatcher.Subscribe(type, [sum](const EventData &event) {
+                    *sum += (uint64_t) event.mousePosition.x;
+                });
+            }
+
+            HwStopwatch stopwatch;
+
+            for (size_t i = 0; i < events; i++) {
+                EventData event;
+                event.type = GetEventType(i);
+                event.mousePosition = {(int) (i & 1023), 0};
+
+                for (auto& function: functions) {
+                    function(event);
+                }
+            }
+
+            double functionSeconds = stopwatch.GetSeconds();
+            stopwatch.Restart();
+
+            for (size_t i = 0; i < events; i++) {
+                auto type = GetEventType(i);
+
+                if (!dispatcher.HasListeners(type)) {
+                    continue;
+                }
+
+                EventData event;
+                event.type = type;
+                event.mousePosition = {(int) (i & 1023), 0};
+                dispatcher.Dispatch(type, event);
+            }
+
+            double dispatcherSeconds = stopwatch.GetSeconds();
+
+            if (checksum[0] != checksum[1]) {
+                std::cerr << BENCH << ": listeners results do not match" << std::endl;
+                return 1;
+            }
+
+            ReportMetric(BENCH, "std_function_ns", functionSeconds * 1e9 / (double) events, "ns/event");
+            ReportMetric(BENCH, "typed_dispatch_ns", dispatcherSeconds * 1e9 / (double) events, "ns/event");
+            ReportMetric(BENCH, "speedup", functionSeconds / dispatcherSeconds, "x");
+
+            return 0;
+        }
+
+    }
+}
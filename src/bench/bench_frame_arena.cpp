@@ -0,0 +1,131 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <bench/bench.hpp>
+#include <x11hw/frame_arena.hpp>
+#include <x11hw/alloc_counter.hpp>
+#include <iostream>
+
+namespace x11hw {
+    namespace bench {
+
+        static const char *BENCH = "frame-arena";
+
+        struct DrawItem {
+            float transform[16];
+            uint32_t mesh;
+            uint32_t material;
+        };
+
+        // Transient per-frame lists (as draw lists of batching), built and thrown away every frame
+        template<typename MakeVector>
+        static uint64_t BuildFrame(int lists, int items, bool reserve, MakeVector &&makeVector) {
+            uint64_t checksum = 0;
+
+            for (int l = 0; l < lists; l++) {
+                auto drawItems = makeVector();
+
+                // Without reserve arena keeps every grown-out buffer until reset (more memory touched per frame)
+                if (reserve) {
+                    drawItems.reserve(items);
+                }
+
+                for (int i = 0; i < items; i++) {
+                    DrawItem item{};
+                    item.mesh = (uint32_t) i;
+                    item.material = (uint32_t) l;
+                    drawItems.push_back(item);
+                }
+
+                checksum += drawItems.size() + drawItems.back().mesh;
+            }
+
+            return checksum;
+        }
+
+        int RunFrameArena(const std::vector<std::string> &args) {
+            auto frames = (int) GetArgument(args, "frames", 1000);
+            auto lists = (int) GetArgument(args, "lists", 64);
+            auto items = (int) GetArgument(args, "items", 256);
+            auto reserve = GetArgument(args, "reserve", 1) != 0;
+            auto warmupFrames = 10;
+
+            if (!HwAllocationCounter::IsEnabled()) {
+                std::cout << BENCH << ": configure with -DX11HW_COUNT_ALLOCATIONS=ON to count heap allocations" << std::endl;
+            }
+
+            uint64_t heapChecksum = 0;
+            uint64_t heapAllocations = 0;
+            HwStopwatch stopwatch;
+
+            for (int f = 0; f < frames; f++) {
+                auto allocations = HwAllocationCounter::GetThreadAllocations();
+                heapChecksum += BuildFrame(lists, items, reserve, []() { return std::vector<DrawItem>(); });
+                heapAllocations += HwAllocationCounter::GetThreadAllocations() - allocations;
+            }
+
+            double heapSeconds = stopwatch.GetSeconds();
+
+            HwFrameArena frameArena;
+            uint64_t arenaChecksum = 0;
+            uint64_t arenaAllocations = 0;
+
+            // Warmup grows arenas to the frame working set
+            for (int f = 0; f < warmupFrames; f++) {
+                frameArena.BeginFrame();
+                BuildFrame(lists, items, reserve, [&]() { return HwArenaVector<DrawItem>(HwArenaAllocator<DrawItem>(frameArena.Get())); });
+            }
+
+            stopwatch.Restart();
+
+            for (int f = 0; f < frames; f++) {
+                auto allocations = HwAllocationCounter::GetThreadAllocations();
+                frameArena.BeginFrame();
+                arenaChecksum += BuildFrame(lists, items, reserve, [&]() { return HwArenaVector<DrawItem>(HwArenaAllocator<DrawItem>(frameArena.Get())); });
+                arenaAllocations += HwAllocationCounter::GetThreadAllocations() - allocations;
+            }
+
+            double arenaSeconds = stopwatch.GetSeconds();
+
+            if (heapChecksum != arenaChecksum) {
+                std::cerr << BENCH << ": results do not match" << std::endl;
+                return 1;
+            }
+
+            ReportMetric(BENCH, "heap_frame_us", heapSeconds * 1e6 / frames, "us");
+            ReportMetric(BENCH, "arena_frame_us", arenaSeconds * 1e6 / frames, "us");
+            ReportMetric(BENCH, "speedup", heapSeconds / arenaSeconds, "x");
+
+            if (HwAllocationCounter::IsEnabled()) {
+                ReportMetric(BENCH, "heap_allocations_per_frame", (double) heapAllocations / frames, "allocs");
+                ReportMetric(BENCH, "arena_allocations_per_frame", (double) arenaAllocations / frames, "allocs");
+            }
+
+            ReportMetric(BENCH, "arena_chunks", (double) frameArena.GetHeapAllocations(), "allocs");
+
+            return 0;
+        }
+
+    }
+}
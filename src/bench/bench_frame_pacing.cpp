@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <bench/bench.hpp>
+#include <x11hw/frame_pacer.hpp>
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <thread>
+
+namespace x11hw {
+    namespace bench {
+
+        static const char *BENCH = "frame-pacing";
+
+        struct PacingResult {
+            double jitterMs = 0.0;
+            double maxDeviationMs = 0.0;
+            double cpuPercent = 0.0;
+        };
+
+        template<typename WaitFunction>
+        static PacingResult MeasurePacing(std::chrono::nanoseconds period, int frames, WaitFunction &&wait) {
+            typedef std::chrono::steady_clock clock;
+
+            double periodMs = std::chrono::duration<double, std::milli>(period).count();
+            double sum = 0.0;
+            double sumSquares = 0.0;
+            PacingResult result;
+
+            auto cpuStart = std::clock();
+            HwStopwatch stopwatch;
+            auto prev = wait();
+
+            for (int i = 0; i < frames; i++) {
+                clock::time_point now = wait();
+                double intervalMs = std::chrono::duration<double, std::milli>(now - prev).count();
+                prev = now;
+
+                sum += intervalMs;
+                sumSquares += intervalMs * intervalMs;
+                result.maxDeviationMs = std::max(result.maxDeviationMs, std::abs(intervalMs - periodMs));
+            }
+
+            double mean = sum / frames;
+            result.jitterMs = std::sqrt(std::max(0.0, sumSquares / frames - mean * mean));
+            result.cpuPercent = 100.0 * (double) (std::clock() - cpuStart) / CLOCKS_PER_SEC / stopwatch.GetSeconds();
+
+            return result;
+        }
+
+        int RunFramePacing(const std::vector<std::string> &args) {
+            auto periodUs = GetArgument(args, "period_us", 16666);
+            auto frames = (int) GetArgument(args, "frames", 300);
+            auto maxSpinUs = GetArgument(args, "max_spin_us", 2000);
+
+            typedef std::chrono::steady_clock clock;
+            auto period = std::chrono::nanoseconds{(int64_t) (periodUs * 1e3)};
+
+            // Baseline: limiter, which was used by the application before
+            auto deadline = clock::now();
+            auto sleepResult = MeasurePacing(period, frames, [&]() {
+                deadline += period;
+                std::this_thread::sleep_until(deadline);
+                return clock::now();
+            });
+
+            HwFramePacer::InitParams params;
+            params.period = period;
+            params.maxSpin = std::chrono::nanoseconds{(int64_t) (maxSpinUs * 1e3)};
+
+            HwFramePacer pacer(params);
+            auto pacerResult = MeasurePacing(period, frames, [&]() {
+                return pacer.Wait();
+            });
+
+            ReportMetric(BENCH, "sleep_until_jitter_ms", sleepResult.jitterMs, "ms");
+            ReportMetric(BENCH, "sleep_until_max_deviation_ms", sleepResult.maxDeviationMs, "ms");
+            ReportMetric(BENCH, "sleep_until_cpu", sleepResult.cpuPercent, "%");
+            ReportMetric(BENCH, "pacer_jitter_ms", pacerResult.jitterMs, "ms");
+            ReportMetric(BENCH, "pacer_max_deviation_ms", pacerResult.maxDeviationMs, "ms");
+            ReportMetric(BENCH, "pacer_cpu", pacerResult.cpuPercent, "%");
+            ReportMetric(BENCH, "pacer_margin_us", pacer.GetStats().marginUs, "us");
+
+            return 0;
+        }
+
+    }
+}
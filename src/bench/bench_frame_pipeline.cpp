@@ -0,0 +1,163 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <bench/bench.hpp>
+#include <x11hw/frame_pipeline.hpp>
+#include <GL/glew.h>
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+namespace x11hw {
+    namespace bench {
+
+        static const char *BENCH = "frame-pipeline";
+
+        struct BenchSnapshot {
+            std::chrono::steady_clock::time_point simulated;
+        };
+
+        struct PipelineSetting {
+            const char *name;
+            size_t depth;
+            HwFramePipeline<BenchSnapshot>::Mode mode;
+        };
+
+        // Burn CPU for given time, models simulation or draw submission cost
+        static void Work(double milliseconds) {
+            HwStopwatch stopwatch;
+            while (stopwatch.GetSeconds() * 1e3 < milliseconds) {
+            }
+        }
+
+        struct PipelineResult {
+            double fps = 0.0;
+            double latencyMs = 0.0;
+            size_t dropped = 0;
+        };
+
+        static void Present(BenchWindow &benchWindow, double renderMs) {
+            benchWindow.manager->PollEvents();
+            glClear(GL_COLOR_BUFFER_BIT);
+            Work(renderMs);
+            benchWindow.window->SwapBuffers();
+        }
+
+        static PipelineResult RunSetting(BenchWindow &benchWindow, const PipelineSetting &setting,
+                                         int frames, double simulationMs, double renderMs) {
+            typedef HwFramePipeline<BenchSnapshot> Pipeline;
+            using timer = std::chrono::steady_clock;
+
+            PipelineResult result;
+            double latencySum = 0.0;
+            size_t latencyCount = 0;
+            HwStopwatch stopwatch;
+
+            if (setting.depth < 2) {
+                for (int i = 0; i < frames; i++) {
+                    auto simulated = timer::now();
+                    Work(simulationMs);
+                    Present(benchWindow, renderMs);
+                    latencySum += std::chrono::duration<double, std::milli>(timer::now() - simulated).count();
+                    latencyCount += 1;
+                }
+            }
+            else {
+                Pipeline::InitParams params;
+                params.depth = setting.depth;
+                params.mode = setting.mode;
+                Pipeline pipeline(params);
+                std::atomic<bool> stop{false};
+
+                std::thread simulation([&]() {
+                    while (!stop.load()) {
+                        auto snapshot = pipeline.BeginWrite();
+
+                        if (!snapshot) {
+                            break;
+                        }
+
+                        snapshot->simulated = timer::now();
+                        Work(simulationMs);
+                        pipeline.EndWrite();
+                    }
+                });
+
+                for (int i = 0; i < frames; i++) {
+                    bool isNew = false;
+                    auto snapshot = pipeline.Acquire(&isNew);
+                    Present(benchWindow, renderMs);
+
+                    if (snapshot && isNew) {
+                        latencySum += std::chrono::duration<double, std::milli>(timer::now() - snapshot->simulated).count();
+                        latencyCount += 1;
+                    }
+                }
+
+                stop.store(true);
+                pipeline.Close();
+                simulation.join();
+                result.dropped = pipeline.GetStats().dropped;
+            }
+
+            result.fps = frames / stopwatch.GetSeconds();
+            result.latencyMs = latencyCount ? latencySum / latencyCount : 0.0;
+            return result;
+        }
+
+        int RunFramePipeline(const std::vector<std::string> &args) {
+            auto frames = (int) GetArgument(args, "frames", 300);
+            auto simulationMs = GetArgument(args, "simulation_ms", 4.0);
+            auto renderMs = GetArgument(args, "render_ms", 4.0);
+
+            typedef HwFramePipeline<BenchSnapshot>::Mode Mode;
+
+            static const PipelineSetting SETTINGS[] = {
+                { "sync", 1, Mode::Latest },
+                { "latest2", 2, Mode::Latest },
+                { "latest3", 3, Mode::Latest },
+                { "fifo2", 2, Mode::Fifo },
+                { "fifo3", 3, Mode::Fifo },
+                { "fifo4", 4, Mode::Fifo },
+            };
+
+            auto benchWindow = CreateBenchWindow("Frame pipeline benchmark", {640, 480});
+
+            std::cout << BENCH << ": simulation " << simulationMs << " ms, render " << renderMs << " ms per frame" << std::endl;
+
+            for (auto& setting: SETTINGS) {
+                auto result = RunSetting(benchWindow, setting, frames, simulationMs, renderMs);
+                std::string prefix = setting.name;
+
+                ReportMetric(BENCH, prefix + "_fps", result.fps, "fps");
+                ReportMetric(BENCH, prefix + "_latency_ms", result.latencyMs, "ms");
+                ReportMetric(BENCH, prefix + "_dropped", (double) result.dropped, "frames");
+            }
+
+            return 0;
+        }
+
+    }
+}
@@ -0,0 +1,99 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <bench/bench.hpp>
+#include <x11hw/hud.hpp>
+#include <GL/glew.h>
+#include <algorithm>
+#include <iostream>
+
+namespace x11hw {
+    namespace bench {
+
+        static const char *BENCH = "hud-overlay";
+
+        // Frame time with and without overlay, so its total cost includes GL driver work of the draw
+        static double RunFrames(BenchWindow &benchWindow, HwHud *hud, int frames, int lines) {
+            auto framebufferSize = benchWindow.window->GetFramebufferSize();
+            glViewport(0, 0, framebufferSize.x, framebufferSize.y);
+            glFinish();
+
+            HwStopwatch stopwatch;
+
+            for (int f = 0; f < frames; f++) {
+                glClear(GL_COLOR_BUFFER_BIT);
+
+                if (hud) {
+                    hud->AddFrameTime((float) (f % 40));
+
+                    for (int l = 0; l < lines; l++) {
+                        hud->Print(HwHud::COLOR_TEXT, "line %d frame %d  %.2f ms", l, f, (double) (f % 40));
+                    }
+
+                    hud->Draw(framebufferSize);
+                }
+
+                benchWindow.window->SwapBuffers();
+                benchWindow.manager->PollEvents();
+            }
+
+            glFinish();
+            return stopwatch.GetSeconds() / frames;
+        }
+
+        int RunHudOverlay(const std::vector<std::string> &args) {
+            glm::uvec2 size;
+            size.x = (uint32_t) GetArgument(args, "width", 1280);
+            size.y = (uint32_t) GetArgument(args, "height", 720);
+            auto frames = (int) GetArgument(args, "frames", 2000);
+            auto lines = (int) GetArgument(args, "lines", 4);
+
+            // Every line changes every frame (worst case of line cache), panel is the largest blended area
+            HwHud::InitParams params;
+            params.panel = GetArgument(args, "panel", 1) != 0;
+            params.cachedLines = (unsigned) GetArgument(args, "cached_lines", 8);
+
+            auto benchWindow = CreateBenchWindow("HUD overlay benchmark", size);
+            HwHud hud(params);
+
+            // Warmup: shader compile, buffer storage
+            RunFrames(benchWindow, &hud, 50, lines);
+
+            double baseSeconds = RunFrames(benchWindow, nullptr, frames, lines);
+            double hudSeconds = RunFrames(benchWindow, &hud, frames, lines);
+            auto stats = hud.GetStats();
+
+            hud.Report(std::cout, BENCH);
+
+            ReportMetric(BENCH, "frame_delta_us", std::max(0.0, hudSeconds - baseSeconds) * 1e6, "us");
+            ReportMetric(BENCH, "cpu_us", stats.averageCpuUs, "us");
+            ReportMetric(BENCH, "gpu_us", stats.averageGpuUs, "us");
+            ReportMetric(BENCH, "quads", (double) stats.quads, "quads");
+            ReportMetric(BENCH, "uploaded_lines", (double) stats.uploadedLines, "lines");
+
+            return 0;
+        }
+
+    }
+}
@@ -0,0 +1,135 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <bench/bench.hpp>
+#include <x11hw/job_system.hpp>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+namespace x11hw {
+    namespace bench {
+
+        static const char *BENCH = "job-system";
+
+        struct Vertex {
+            glm::vec4 position;
+        };
+
+        // Transform vertices and count ones inside of clip volume (culling and transform work of the frame)
+        static size_t TransformRange(const std::vector<Vertex> &source, std::vector<Vertex> &target,
+                                     const glm::mat4 &transform, size_t begin, size_t end) {
+            size_t visible = 0;
+
+            for (size_t i = begin; i < end; i++) {
+                glm::vec4 p = transform * source[i].position;
+                target[i].position = p;
+                visible += (std::abs(p.x) <= p.w && std::abs(p.y) <= p.w && std::abs(p.z) <= p.w) ? 1 : 0;
+            }
+
+            return visible;
+        }
+
+        int RunJobSystem(const std::vector<std::string> &args) {
+            auto verticesCount = (size_t) GetArgument(args, "vertices", 1000000);
+            auto grain = (size_t) GetArgument(args, "grain", 16384);
+            auto repeats = (int) GetArgument(args, "repeats", 20);
+            auto emptyJobs = (size_t) GetArgument(args, "jobs", 100000);
+
+            HwJobSystem::InitParams params;
+            params.workersCount = (size_t) GetArgument(args, "workers", 0);
+            HwJobSystem jobSystem(params);
+
+            std::vector<Vertex> source(verticesCount);
+            std::vector<Vertex> target(verticesCount);
+
+            std::mt19937 random(42);
+            std::uniform_real_distribution<float> unit(-100.0f, 100.0f);
+
+            for (auto& vertex: source) {
+                vertex.position = glm::vec4(unit(random), unit(random), unit(random), 1.0f);
+            }
+
+            auto transform = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 200.0f) *
+                             glm::lookAt(glm::vec3(0.0f, 0.0f, 150.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+            double serialSeconds = 1e9;
+            double parallelSeconds = 1e9;
+            size_t serialVisible = 0;
+            size_t parallelVisible = 0;
+
+            for (int i = 0; i < repeats; i++) {
+                HwStopwatch stopwatch;
+                serialVisible = TransformRange(source, target, transform, 0, verticesCount);
+                serialSeconds = std::min(serialSeconds, stopwatch.GetSeconds());
+            }
+
+            for (int i = 0; i < repeats; i++) {
+                std::atomic<size_t> visible{0};
+                HwJobCounter counter;
+
+                HwStopwatch stopwatch;
+                jobSystem.ParallelFor(counter, verticesCount, grain, [&](size_t begin, size_t end) {
+                    visible.fetch_add(TransformRange(source, target, transform, begin, end), std::memory_order_relaxed);
+                });
+                jobSystem.Wait(counter);
+                parallelSeconds = std::min(parallelSeconds, stopwatch.GetSeconds());
+
+                parallelVisible = visible.load();
+            }
+
+            if (serialVisible != parallelVisible) {
+                std::cerr << BENCH << ": parallel result mismatch" << std::endl;
+                return 1;
+            }
+
+            // Scheduling overhead: empty jobs per second
+            HwJobCounter counter;
+            HwStopwatch stopwatch;
+
+            for (size_t i = 0; i < emptyJobs; i++) {
+                jobSystem.Submit(counter, []() {});
+            }
+
+            jobSystem.Wait(counter);
+            double emptySeconds = stopwatch.GetSeconds();
+
+            auto stats = jobSystem.GetStats();
+            std::cout << BENCH << ": " << stats.workersCount << " workers, " << verticesCount << " vertices, "
+                      << serialVisible << " visible, stolen " << stats.stolen << " of " << stats.executed << " jobs" << std::endl;
+
+            ReportMetric(BENCH, "serial_ms", serialSeconds * 1e3, "ms");
+            ReportMetric(BENCH, "parallel_ms", parallelSeconds * 1e3, "ms");
+            ReportMetric(BENCH, "speedup", serialSeconds / parallelSeconds, "x");
+            ReportMetric(BENCH, "empty_jobs_rate", emptyJobs / emptySeconds / 1e6, "Mjobs/s");
+
+            return 0;
+        }
+
+    }
+}
@@ -0,0 +1,185 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <bench/bench.hpp>
+#include <x11hw/obj_mesh.hpp>
+#include <x11hw/mesh_file.hpp>
+#include <GL/glew.h>
+#include <iostream>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace x11hw {
+    namespace bench {
+
+        static const char *BENCH = "mesh-loading";
+
+        // Grid of quads in OBJ text (quads are triangulated by the parser)
+        static void WriteGridObj(const std::string &path, int grid) {
+            std::FILE *file = std::fopen(path.c_str(), "w");
+
+            if (!file) {
+                throw std::runtime_error("Failed to create " + path);
+            }
+
+            for (int y = 0; y <= grid; y++) {
+                for (int x = 0; x <= grid; x++) {
+                    float fx = (float) x / (float) grid;
+                    float fy = (float) y / (float) grid;
+                    std::fprintf(file, "v %f %f %f\nvn 0 0 1\n", fx, fy, 0.1f * fx * fy);
+                }
+            }
+
+            for (int y = 0; y < grid; y++) {
+                for (int x = 0; x < grid; x++) {
+                    int a = y * (grid + 1) + x + 1;
+                    int b = a + 1;
+                    int c = a + grid + 1;
+                    int d = c + 1;
+                    std::fprintf(file, "f %d//%d %d//%d %d//%d %d//%d\n", a, a, b, b, d, d, c, c);
+                }
+            }
+
+            std::fclose(file);
+        }
+
+        // Drop file pages from page cache, so the next load reads from disk
+        static void EvictFile(const std::string &path) {
+            int file = open(path.c_str(), O_RDONLY);
+
+            if (file >= 0) {
+                fdatasync(file);
+                posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED);
+                close(file);
+            }
+        }
+
+        static size_t GetFileSize(const std::string &path) {
+            std::FILE *file = std::fopen(path.c_str(), "rb");
+            std::fseek(file, 0, SEEK_END);
+            auto size = (size_t) std::ftell(file);
+            std::fclose(file);
+            return size;
+        }
+
+        struct Buffers {
+            std::vector<GLuint> handles;
+
+            void Upload(GLenum target, size_t size, const void *data) {
+                GLuint handle;
+                glGenBuffers(1, &handle);
+                glBindBuffer(target, handle);
+                glBufferData(target, size, data, GL_STATIC_DRAW);
+                glBindBuffer(target, 0);
+                handles.push_back(handle);
+            }
+
+            ~Buffers() {
+                glDeleteBuffers((GLsizei) handles.size(), handles.data());
+            }
+        };
+
+        static double LoadObj(const std::string &path) {
+            HwStopwatch stopwatch;
+            Buffers buffers;
+
+            HwObjMesh mesh(path);
+            buffers.Upload(GL_ARRAY_BUFFER, mesh.GetVertices().size() * sizeof(float), mesh.GetVertices().data());
+            buffers.Upload(GL_ELEMENT_ARRAY_BUFFER, mesh.GetIndices().size() * sizeof(uint32_t), mesh.GetIndices().data());
+            glFinish();
+
+            return stopwatch.GetSeconds();
+        }
+
+        // Chunks are uploaded straight from the mapping, only first chunk is needed to start drawing
+        static double LoadMeshFile(const std::string &path, bool firstChunkOnly) {
+            HwStopwatch stopwatch;
+            Buffers buffers;
+
+            HwMeshFile file(path);
+            size_t chunks = firstChunkOnly ? 1 : file.GetChunksCount();
+
+            for (size_t c = 0; c < chunks; c++) {
+                if (c + 1 < chunks) {
+                    file.Prefetch(c + 1);
+                }
+
+                auto chunk = file.GetChunk(c);
+                buffers.Upload(GL_ARRAY_BUFFER, chunk.verticesCount * file.GetStride(), chunk.vertices);
+                buffers.Upload(GL_ELEMENT_ARRAY_BUFFER, chunk.indicesCount * sizeof(uint32_t), chunk.indices);
+                file.Evict(c);
+            }
+
+            glFinish();
+
+            return stopwatch.GetSeconds();
+        }
+
+        int RunMeshLoading(const std::vector<std::string> &args) {
+            auto grid = (int) GetArgument(args, "grid", 1000);
+            auto chunkVertices = (size_t) GetArgument(args, "chunk_vertices", 65536);
+            auto cold = GetArgument(args, "cold", 1) != 0;
+
+            std::string objPath = "/tmp/x11hwbench-mesh.obj";
+            std::string meshPath = "/tmp/x11hwbench-mesh.x11mesh";
+
+            WriteGridObj(objPath, grid);
+            HwMeshFile::Write(meshPath, HwObjMesh(objPath).GetSource(), chunkVertices);
+
+            auto benchWindow = CreateBenchWindow("Mesh loading benchmark", glm::uvec2(640, 480));
+
+            if (cold) {
+                EvictFile(objPath);
+            }
+            double objSeconds = LoadObj(objPath);
+
+            if (cold) {
+                EvictFile(meshPath);
+            }
+            double meshSeconds = LoadMeshFile(meshPath, false);
+
+            if (cold) {
+                EvictFile(meshPath);
+            }
+            double firstChunkSeconds = LoadMeshFile(meshPath, true);
+
+            auto meshSize = (double) GetFileSize(meshPath);
+
+            ReportMetric(BENCH, "obj_file_mib", (double) GetFileSize(objPath) / (1024.0 * 1024.0), "MiB");
+            ReportMetric(BENCH, "mesh_file_mib", meshSize / (1024.0 * 1024.0), "MiB");
+            ReportMetric(BENCH, "obj_load_ms", objSeconds * 1e3, "ms");
+            ReportMetric(BENCH, "mesh_load_ms", meshSeconds * 1e3, "ms");
+            ReportMetric(BENCH, "mesh_first_chunk_ms", firstChunkSeconds * 1e3, "ms");
+            ReportMetric(BENCH, "mesh_load_mbps", meshSize / meshSeconds / 1e6, "MB/s");
+            ReportMetric(BENCH, "speedup", objSeconds / meshSeconds, "x");
+
+            std::remove(objPath.c_str());
+            std::remove(meshPath.c_str());
+
+            return 0;
+        }
+
+    }
+}
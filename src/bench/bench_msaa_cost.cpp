@@ -0,0 +1,148 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <bench/bench.hpp>
+#include <x11hw/geometry.hpp>
+#include <x11hw/shader.hpp>
+#include <GL/glew.h>
+#include <algorithm>
+#include <iostream>
+
+namespace x11hw {
+    namespace bench {
+
+        static const char *BENCH = "msaa-cost";
+
+        static const char *GetVertexCode() {
+            return R"(
+                #version 330 core
+                layout (location = 0) in vec2 position;
+
+                out vec3 fsColor;
+
+                void main() {
+                    fsColor = vec3(position * 0.5f + 0.5f, 0.5f);
+                    gl_Position = vec4(position, 0.0f, 1.0f);
+                }
+            )";
+        }
+
+        static const char *GetFragmentCode() {
+            return R"(
+                #version 330 core
+                layout (location = 0) out vec4 outColor;
+
+                in vec3 fsColor;
+
+                void main() {
+                    outColor = vec4(fsColor, 0.5f);
+                }
+            )";
+        }
+
+        // Fill rate and framebuffer memory of the config selected for preferred samples count
+        static void RunSamples(glm::uvec2 size, int samples, bool depthStencil, int layers, int repeats) {
+            HwContextConfig config;
+            config.framebuffer.preferredSamples = samples;
+            config.framebuffer.depthBits = depthStencil ? 24 : 0;
+            config.framebuffer.stencilBits = depthStencil ? 8 : 0;
+
+            auto benchWindow = CreateBenchWindow("MSAA cost benchmark", size, config);
+            auto& info = benchWindow.manager->GetFramebufferInfo();
+
+            if (info.samples != samples) {
+                std::cout << BENCH << ": no config with " << samples << " samples, skipped" << std::endl;
+                return;
+            }
+
+            info.Report(std::cout, size.x, size.y);
+
+            float quad[] = {
+                -1.0f, -1.0f,  1.0f, -1.0f,  1.0f,  1.0f,
+                -1.0f, -1.0f,  1.0f,  1.0f, -1.0f,  1.0f
+            };
+
+            HwGeometry::InitParams params;
+            params.topology = GL_TRIANGLES;
+            params.stride = sizeof(float) * 2;
+            params.verticesCount = 6;
+            params.attributes = {{0, 2, GL_FLOAT, false}};
+
+            HwGeometry geometry(params);
+            geometry.Update(0, sizeof(quad), quad);
+            HwShader shader(GetVertexCode(), GetFragmentCode());
+
+            auto framebufferSize = benchWindow.window->GetFramebufferSize();
+            double pixels = (double) framebufferSize.x * framebufferSize.y * layers;
+            double best = 1e9;
+
+            glViewport(0, 0, framebufferSize.x, framebufferSize.y);
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+            shader.Bind();
+
+            // Swap is included, since multisampled buffer is resolved on it
+            for (int r = 0; r < repeats; r++) {
+                glFinish();
+                HwStopwatch stopwatch;
+
+                glClear(GL_COLOR_BUFFER_BIT | (depthStencil ? GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT : 0));
+
+                for (int i = 0; i < layers; i++) {
+                    geometry.Draw();
+                }
+
+                benchWindow.window->SwapBuffers();
+                glFinish();
+                best = std::min(best, stopwatch.GetSeconds());
+
+                benchWindow.manager->PollEvents();
+            }
+
+            shader.Unbind();
+            glDisable(GL_BLEND);
+
+            auto prefix = "samples_" + std::to_string(samples);
+            ReportMetric(BENCH, prefix + "_fill_mpix", pixels / best / 1e6, "Mpix/s");
+            ReportMetric(BENCH, prefix + "_memory_mib", (double) info.EstimateMemory(framebufferSize.x, framebufferSize.y) / (1024.0 * 1024.0), "MiB");
+        }
+
+        int RunMsaaCost(const std::vector<std::string> &args) {
+            glm::uvec2 size;
+            size.x = (uint32_t) GetArgument(args, "width", 1920);
+            size.y = (uint32_t) GetArgument(args, "height", 1080);
+            auto maxSamples = (int) GetArgument(args, "max_samples", 8);
+            auto depthStencil = GetArgument(args, "depth_stencil", 1) != 0;
+            auto layers = (int) GetArgument(args, "layers", 20);
+            auto repeats = (int) GetArgument(args, "repeats", 10);
+
+            for (int samples = 0; samples <= maxSamples; samples = samples ? samples * 2 : 2) {
+                RunSamples(size, samples, depthStencil, layers, repeats);
+            }
+
+            return 0;
+        }
+
+    }
+}
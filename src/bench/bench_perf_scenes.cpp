@@ -0,0 +1,234 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <bench/bench.hpp>
+#include <x11hw/geometry.hpp>
+#include <x11hw/shader.hpp>
+#include <GL/glew.h>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+#include <cstring>
+
+namespace x11hw {
+    namespace bench {
+
+        // Scenes of the perf regression suite (tests/perf), each one process run under Xvfb.
+        // Rendering scenes run x11helloworld itself (replay and stress modes), only the input
+        // side needs a second X client and lives here
+
+        static const char *GetVertexCode() {
+            return R"(
+                #version 330 core
+                layout (location = 0) in vec2 position;
+                layout (location = 1) in vec3 color;
+
+                out vec3 fsColor;
+
+                uniform vec2 offset;
+                uniform float scale;
+
+                void main() {
+                    fsColor = color;
+                    gl_Position = vec4(position * scale + offset, 0.0f, 1.0f);
+                }
+            )";
+        }
+
+        static const char *GetFragmentCode() {
+            return R"(
+                #version 330 core
+                layout (location = 0) out vec4 outColor;
+
+                in vec3 fsColor;
+
+                void main() {
+                    outColor = vec4(fsColor, 1.0f);
+                }
+            )";
+        }
+
+        static const std::string OFFSET = "offset";
+        static const std::string SCALE = "scale";
+
+        // Triangle of the demo (as pointer cursor): positions and per vertex colors
+        struct SceneTriangle {
+            HwShader shader;
+            HwGeometry geometry;
+
+            static HwGeometry::InitParams GetParams() {
+                HwGeometry::InitParams params;
+                params.topology = GL_TRIANGLES;
+                params.stride = sizeof(float) * 5;
+                params.verticesCount = 3;
+                params.attributes = {{0, 2, GL_FLOAT, false}, {sizeof(float) * 2, 3, GL_FLOAT, false}};
+                return params;
+            }
+
+            SceneTriangle() : shader(GetVertexCode(), GetFragmentCode()), geometry(GetParams()) {
+                float vertices[] = {
+                     0.0f, -1.0f, 1.0f, 0.0f, 0.0f,
+                    -1.0f,  1.0f, 0.0f, 1.0f, 0.0f,
+                     1.0f,  1.0f, 0.0f, 0.0f, 1.0f
+                };
+
+                geometry.Update(0, sizeof(vertices), vertices);
+            }
+        };
+
+        static void ReportStartup(const char *bench) {
+            glFinish();
+            ReportMetric(bench, "startup_ms", GetProcessSeconds() * 1e3, "ms");
+        }
+
+        static Window FindWindow(Display *display, Window parent, const char *title) {
+            Window root, parentOut;
+            Window *children = nullptr;
+            unsigned int count = 0;
+            Window found = None;
+
+            if (!XQueryTree(display, parent, &root, &parentOut, &children, &count)) {
+                return None;
+            }
+
+            for (unsigned int i = 0; i < count && found == None; i++) {
+                char *name = nullptr;
+
+                if (XFetchName(display, children[i], &name) && name) {
+                    if (std::strcmp(name, title) == 0) {
+                        found = children[i];
+                    }
+                    XFree(name);
+                }
+
+                if (found == None) {
+                    found = FindWindow(display, children[i], title);
+                }
+            }
+
+            if (children) {
+                XFree(children);
+            }
+
+            return found;
+        }
+
+        // Motion events go through X server: sent by the other client, read and dispatched by PollEvents
+        int RunSceneEventStorm(const std::vector<std::string> &args) {
+            static const char *BENCH = "scene-event-storm";
+            static const char *TITLE = "Event storm scene";
+            auto events = (size_t) GetArgument(args, "events", 200000);
+            auto batch = (size_t) GetArgument(args, "batch", 1000);
+
+            if (events == 0 || batch == 0) {
+                throw std::runtime_error("Event storm needs events > 0 and batch > 0");
+            }
+
+            auto benchWindow = CreateBenchWindow(TITLE, {640, 480});
+            SceneTriangle triangle;
+
+            size_t received = 0;
+            glm::ivec2 lastPosition{};
+            benchWindow.window->SubscribeOnInput(HwWindow::EventType::MouseMoved, [&](const HwWindow::EventData &event) {
+                received += 1;
+                lastPosition = event.mousePosition;
+            });
+
+            benchWindow.manager->PollEvents();
+            benchWindow.window->SwapBuffers();
+            ReportStartup(BENCH);
+
+            Display *display = XOpenDisplay(nullptr);
+
+            if (!display) {
+                throw std::runtime_error("Failed to open second display connection");
+            }
+
+            auto target = FindWindow(display, XDefaultRootWindow(display), TITLE);
+
+            if (target == None) {
+                XCloseDisplay(display);
+                throw std::runtime_error("Failed to find scene window");
+            }
+
+            XEvent event{};
+            event.xmotion.type = MotionNotify;
+            event.xmotion.display = display;
+            event.xmotion.window = target;
+            event.xmotion.same_screen = True;
+
+            HwStopwatch stopwatch;
+            size_t sent = 0;
+            size_t frames = 0;
+
+            while (sent < events) {
+                auto count = std::min(batch, events - sent);
+
+                for (size_t e = 0; e < count; e++, sent++) {
+                    event.xmotion.x = (int) (sent % 640);
+                    event.xmotion.y = (int) (sent / 640 % 480);
+                    XSendEvent(display, target, False, ButtonMotionMask, &event);
+                }
+
+                XSync(display, False);
+                benchWindow.manager->PollEvents();
+
+                glClear(GL_COLOR_BUFFER_BIT);
+                triangle.shader.Bind();
+                triangle.shader.SetVec2(OFFSET, glm::vec2((float) lastPosition.x / 320.0f - 1.0f, 1.0f - (float) lastPosition.y / 240.0f));
+                triangle.shader.SetFloat(SCALE, 0.1f);
+                triangle.geometry.Draw();
+                triangle.shader.Unbind();
+                benchWindow.window->SwapBuffers();
+                frames += 1;
+            }
+
+            // Events sent after the last poll may still be on the way to this connection
+            HwStopwatch drainStopwatch;
+            while (received < events && drainStopwatch.GetSeconds() < 1.0) {
+                benchWindow.manager->PollEvents();
+            }
+
+            auto seconds = stopwatch.GetSeconds();
+
+            XCloseDisplay(display);
+
+            // Rate is measured on received events, lost ones are reported but are not an error
+            if (received == 0) {
+                std::cerr << BENCH << ": no events received" << std::endl;
+                return 1;
+            }
+            if (received < events) {
+                std::cerr << BENCH << ": received " << received << " of " << events << " events" << std::endl;
+            }
+
+            ReportMetric(BENCH, "events_per_sec", (double) received / seconds, "events/s");
+            ReportMetric(BENCH, "frame_time_ms", seconds / (double) frames * 1e3, "ms");
+            ReportPeakMemory(BENCH);
+
+            return 0;
+        }
+
+    }
+}
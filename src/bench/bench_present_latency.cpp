@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <bench/bench.hpp>
+#include <x11hw/present_latency.hpp>
+#include <GL/glew.h>
+#include <iostream>
+
+namespace x11hw {
+    namespace bench {
+
+        static const char *BENCH = "present-latency";
+
+        struct PresentMode {
+            const char *name;
+            bool fullscreen;
+            int swapInterval;
+        };
+
+        // Input-to-present latency of the clear-only frame loop in one presentation mode
+        static void RunMode(const PresentMode &mode, glm::uvec2 size, int frames, int warmupFrames) {
+            auto benchWindow = CreateBenchWindow("Present latency benchmark", size);
+            auto window = benchWindow.window;
+
+            if (mode.swapInterval < 0 && !benchWindow.manager->IsSwapTearSupported()) {
+                std::cout << BENCH << ": " << mode.name << " requires GLX_EXT_swap_control_tear, skipped" << std::endl;
+                return;
+            }
+
+            if (mode.fullscreen) {
+                window->SetFullscreen(true);
+                window->SetBypassCompositor(true);
+            }
+
+            window->SetSwapInterval(mode.swapInterval);
+
+            HwPresentLatency::InitParams latencyParams;
+            latencyParams.window = window;
+            HwPresentLatency latency(latencyParams);
+
+            // Warmup frames let window manager apply fullscreen state, they are not measured
+            for (int i = 0; i < warmupFrames + frames; i++) {
+                auto inputTime = HwPresentLatency::clock::now();
+                benchWindow.manager->PollEvents();
+
+                auto framebufferSize = window->GetFramebufferSize();
+                glViewport(0, 0, framebufferSize.x, framebufferSize.y);
+                glClearColor((float) (i % 2), 0.0f, 0.0f, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT);
+
+                window->SwapBuffers();
+
+                if (i >= warmupFrames) {
+                    latency.EndFrame(inputTime);
+                }
+            }
+
+            glFinish();
+            latency.Poll();
+
+            auto stats = latency.GetStats();
+            ReportMetric(BENCH, std::string(mode.name) + "_avg_ms", stats.averageMs, "ms");
+            ReportMetric(BENCH, std::string(mode.name) + "_p99_ms", stats.p99Ms, "ms");
+            std::cout << BENCH << ": " << mode.name << " measured to "
+                      << (stats.presentTime ? "present time" : "GPU completion") << std::endl;
+        }
+
+        int RunPresentLatency(const std::vector<std::string> &args) {
+            glm::uvec2 size;
+            size.x = (uint32_t) GetArgument(args, "width", 1280);
+            size.y = (uint32_t) GetArgument(args, "height", 720);
+            auto frames = (int) GetArgument(args, "frames", 300);
+            auto warmupFrames = (int) GetArgument(args, "warmup", 30);
+
+            PresentMode modes[] = {
+                { "windowed_vsync", false, 1 },
+                { "fullscreen_vsync", true, 1 },
+                { "fullscreen_tear", true, -1 }
+            };
+
+            for (auto& mode: modes) {
+                RunMode(mode, size, frames, warmupFrames);
+            }
+
+            return 0;
+        }
+
+    }
+}
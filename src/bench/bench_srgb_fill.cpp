@@ -0,0 +1,160 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <bench/bench.hpp>
+#include <x11hw/geometry.hpp>
+#include <x11hw/shader.hpp>
+#include <GL/glew.h>
+#include <algorithm>
+#include <iostream>
+
+namespace x11hw {
+    namespace bench {
+
+        static const char *BENCH = "srgb-fill";
+
+        static const char *GetVertexCode() {
+            return R"(
+                #version 330 core
+                layout (location = 0) in vec2 position;
+
+                out vec3 fsColor;
+
+                void main() {
+                    fsColor = vec3(position * 0.5f + 0.5f, 0.5f);
+                    gl_Position = vec4(position, 0.0f, 1.0f);
+                }
+            )";
+        }
+
+        static const char *GetGammaFragmentCode() {
+            return R"(
+                #version 330 core
+                layout (location = 0) out vec4 outColor;
+
+                in vec3 fsColor;
+                uniform float basicGamma;
+
+                void main() {
+                    outColor = vec4(pow(fsColor, vec3(1.0f / basicGamma)), 0.5f);
+                }
+            )";
+        }
+
+        static const char *GetLinearFragmentCode() {
+            return R"(
+                #version 330 core
+                layout (location = 0) out vec4 outColor;
+
+                in vec3 fsColor;
+
+                void main() {
+                    outColor = vec4(fsColor, 0.5f);
+                }
+            )";
+        }
+
+        static double MeasureFill(BenchWindow &benchWindow, const HwGeometry &geometry, int layers, int repeats) {
+            double best = 1e9;
+
+            for (int r = 0; r < repeats; r++) {
+                glFinish();
+                HwStopwatch stopwatch;
+
+                for (int i = 0; i < layers; i++) {
+                    geometry.Draw();
+                }
+
+                glFinish();
+                best = std::min(best, stopwatch.GetSeconds());
+
+                benchWindow.manager->PollEvents();
+                benchWindow.window->SwapBuffers();
+            }
+
+            return best;
+        }
+
+        int RunSrgbFill(const std::vector<std::string> &args) {
+            glm::uvec2 size;
+            size.x = (uint32_t) GetArgument(args, "width", 1920);
+            size.y = (uint32_t) GetArgument(args, "height", 1080);
+            auto layers = (int) GetArgument(args, "layers", 50);
+            auto repeats = (int) GetArgument(args, "repeats", 10);
+
+            auto benchWindow = CreateBenchWindow("sRGB fill benchmark", size);
+
+            if (!benchWindow.manager->IsFramebufferSrgb()) {
+                std::cout << BENCH << ": no sRGB capable framebuffer config, only manual gamma is measured" << std::endl;
+            }
+
+            float quad[] = {
+                -1.0f, -1.0f,  1.0f, -1.0f,  1.0f,  1.0f,
+                -1.0f, -1.0f,  1.0f,  1.0f, -1.0f,  1.0f
+            };
+
+            HwGeometry::InitParams params;
+            params.topology = GL_TRIANGLES;
+            params.stride = sizeof(float) * 2;
+            params.verticesCount = 6;
+            params.attributes = {{0, 2, GL_FLOAT, false}};
+
+            HwGeometry geometry(params);
+            geometry.Update(0, sizeof(quad), quad);
+
+            HwShader gammaShader(GetVertexCode(), GetGammaFragmentCode());
+            HwShader linearShader(GetVertexCode(), GetLinearFragmentCode());
+
+            auto framebufferSize = benchWindow.window->GetFramebufferSize();
+            double pixels = (double) framebufferSize.x * framebufferSize.y * layers;
+
+            // Blending makes every layer read and write the framebuffer, as in overlays and UI
+            glViewport(0, 0, framebufferSize.x, framebufferSize.y);
+            glEnable(GL_BLEND);
+            glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+            glDisable(GL_FRAMEBUFFER_SRGB);
+            gammaShader.Bind();
+            gammaShader.SetFloat("basicGamma", 2.2f);
+            double gammaSeconds = MeasureFill(benchWindow, geometry, layers, repeats);
+            gammaShader.Unbind();
+
+            ReportMetric(BENCH, "manual_gamma_mpix", pixels / gammaSeconds / 1e6, "Mpix/s");
+
+            if (benchWindow.manager->IsFramebufferSrgb()) {
+                glEnable(GL_FRAMEBUFFER_SRGB);
+                linearShader.Bind();
+                double srgbSeconds = MeasureFill(benchWindow, geometry, layers, repeats);
+                linearShader.Unbind();
+
+                ReportMetric(BENCH, "srgb_framebuffer_mpix", pixels / srgbSeconds / 1e6, "Mpix/s");
+                ReportMetric(BENCH, "speedup", gammaSeconds / srgbSeconds, "x");
+            }
+
+            glDisable(GL_BLEND);
+            return 0;
+        }
+
+    }
+}
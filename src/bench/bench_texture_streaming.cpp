@@ -0,0 +1,157 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <bench/bench.hpp>
+#include <x11hw/texture.hpp>
+#include <x11hw/texture_streamer.hpp>
+#include <x11hw/geometry.hpp>
+#include <x11hw/shader.hpp>
+#include <GL/glew.h>
+#include <iostream>
+#include <vector>
+
+namespace x11hw {
+    namespace bench {
+
+        static const char *BENCH = "texture-streaming";
+
+        static const char *GetVertexCode() {
+            return R"(
+                #version 330 core
+                layout (location = 0) in vec2 position;
+
+                out vec2 fsTexCoord;
+
+                void main() {
+                    fsTexCoord = position * 0.5f + 0.5f;
+                    gl_Position = vec4(position, 0.0f, 1.0f);
+                }
+            )";
+        }
+
+        static const char *GetFragmentCode() {
+            return R"(
+                #version 330 core
+                layout (location = 0) out vec4 outColor;
+
+                in vec2 fsTexCoord;
+                uniform sampler2D frame;
+
+                void main() {
+                    outColor = texture(frame, fsTexCoord);
+                }
+            )";
+        }
+
+        static void FillFrame(std::vector<uint8_t> &pixels, glm::uvec2 size, uint32_t frame) {
+            for (uint32_t y = 0; y < size.y; y++) {
+                uint8_t *row = pixels.data() + 4 * size.x * y;
+
+                for (uint32_t x = 0; x < size.x; x++) {
+                    row[4 * x + 0] = (uint8_t) (x + frame);
+                    row[4 * x + 1] = (uint8_t) (y + frame);
+                    row[4 * x + 2] = (uint8_t) frame;
+                    row[4 * x + 3] = 255;
+                }
+            }
+        }
+
+        int RunTextureStreaming(const std::vector<std::string> &args) {
+            glm::uvec2 size;
+            size.x = (uint32_t) GetArgument(args, "width", 1920);
+            size.y = (uint32_t) GetArgument(args, "height", 1080);
+            auto frames = (int) GetArgument(args, "frames", 300);
+            auto slots = (size_t) GetArgument(args, "slots", 3);
+
+            auto benchWindow = CreateBenchWindow("Texture streaming benchmark", {640, 480});
+
+            float quad[] = {
+                -1.0f, -1.0f,  1.0f, -1.0f,  1.0f,  1.0f,
+                -1.0f, -1.0f,  1.0f,  1.0f, -1.0f,  1.0f
+            };
+
+            HwGeometry::InitParams geometryParams;
+            geometryParams.topology = GL_TRIANGLES;
+            geometryParams.stride = sizeof(float) * 2;
+            geometryParams.verticesCount = 6;
+            geometryParams.attributes = {{0, 2, GL_FLOAT, false}};
+
+            HwShader shader(GetVertexCode(), GetFragmentCode());
+            HwGeometry geometry(geometryParams);
+            geometry.Update(0, sizeof(quad), quad);
+
+            HwTexture::InitParams textureParams;
+            textureParams.size = size;
+            HwTexture texture(textureParams);
+
+            HwTextureStreamer::InitParams streamerParams;
+            streamerParams.slotSize = 4 * size.x * size.y;
+            streamerParams.slotsCount = slots;
+            HwTextureStreamer streamer(streamerParams);
+
+            std::vector<uint8_t> pixels(streamerParams.slotSize);
+            auto window = benchWindow.window;
+
+            HwStopwatch stopwatch;
+            double fillSeconds = 0.0;
+
+            for (int i = 0; i < frames; i++) {
+                benchWindow.manager->PollEvents();
+
+                HwStopwatch fill;
+                FillFrame(pixels, size, (uint32_t) i);
+                fillSeconds += fill.GetSeconds();
+
+                streamer.Upload(texture, {0, 0}, size, GL_RGBA, GL_UNSIGNED_BYTE, 4, pixels.data());
+
+                auto framebufferSize = window->GetFramebufferSize();
+                glViewport(0, 0, framebufferSize.x, framebufferSize.y);
+
+                shader.Bind();
+                shader.SetTexture("frame", texture, 0);
+                geometry.Draw();
+                shader.Unbind();
+
+                window->SwapBuffers();
+            }
+
+            glFinish();
+            double seconds = stopwatch.GetSeconds();
+            auto stats = streamer.GetStats();
+
+            std::cout << BENCH << ": " << size.x << "x" << size.y << ", "
+                      << (stats.persistent ? "persistent" : "unsynchronized") << " mapping, "
+                      << slots << " slots" << std::endl;
+
+            ReportMetric(BENCH, "uploaded_frames", (double) stats.uploadedFrames, "frames");
+            ReportMetric(BENCH, "dropped_frames", (double) stats.droppedFrames, "frames");
+            ReportMetric(BENCH, "stream_throughput", stats.GetThroughputMBps(), "MB/s");
+            ReportMetric(BENCH, "cpu_throughput", stats.GetCpuThroughputMBps(), "MB/s");
+            ReportMetric(BENCH, "frame_ms", (seconds - fillSeconds) / frames * 1e3, "ms");
+
+            return 0;
+        }
+
+    }
+}
@@ -0,0 +1,164 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <bench/bench.hpp>
+#include <x11hw/vertex_packing.hpp>
+#include <x11hw/geometry.hpp>
+#include <x11hw/shader.hpp>
+#include <GL/glew.h>
+#include <algorithm>
+#include <iostream>
+#include <random>
+
+namespace x11hw {
+    namespace bench {
+
+        static const char *BENCH = "vertex-packing";
+
+        static const char *GetVertexCode() {
+            return R"(
+                #version 330 core
+                layout (location = 0) in vec3 position;
+                layout (location = 1) in vec3 normal;
+                layout (location = 2) in vec4 color;
+
+                out vec4 fsColor;
+
+                void main() {
+                    fsColor = color * (0.5f + 0.5f * normal.z);
+                    gl_Position = vec4(position * 0.001f, 1.0f);
+                }
+            )";
+        }
+
+        static const char *GetFragmentCode() {
+            return R"(
+                #version 330 core
+                layout (location = 0) out vec4 outColor;
+
+                in vec4 fsColor;
+
+                void main() {
+                    outColor = fsColor;
+                }
+            )";
+        }
+
+        static double MeasureUpload(const HwGeometry &geometry, const std::vector<uint8_t> &data, int repeats) {
+            double best = 1e9;
+
+            for (int i = 0; i < repeats; i++) {
+                glFinish();
+                HwStopwatch stopwatch;
+                geometry.Update(0, data.size(), data.data());
+                glFinish();
+                best = std::min(best, stopwatch.GetSeconds());
+            }
+
+            return best;
+        }
+
+        static double MeasureDraw(const HwGeometry &geometry, int repeats) {
+            glFinish();
+            HwStopwatch stopwatch;
+
+            for (int i = 0; i < repeats; i++) {
+                geometry.Draw();
+            }
+
+            glFinish();
+            return stopwatch.GetSeconds() / repeats;
+        }
+
+        int RunVertexPacking(const std::vector<std::string> &args) {
+            auto verticesCount = (size_t) GetArgument(args, "vertices", 3 * 400000);
+            auto repeats = (int) GetArgument(args, "repeats", 10);
+
+            std::vector<float> positions(verticesCount * 3);
+            std::vector<float> normals(verticesCount * 3);
+            std::vector<float> colors(verticesCount * 4);
+
+            std::mt19937 random(42);
+            std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+            std::generate(positions.begin(), positions.end(), [&]() { return unit(random) * 100.0f; });
+            std::generate(normals.begin(), normals.end(), [&]() { return unit(random); });
+            std::generate(colors.begin(), colors.end(), [&]() { return 0.5f + 0.5f * unit(random); });
+
+            HwVertexPacker full({
+                {positions.data(), 3, HwPackedFormat::Float},
+                {normals.data(), 3, HwPackedFormat::Float},
+                {colors.data(), 4, HwPackedFormat::Float}
+            });
+
+            HwVertexPacker packed({
+                {positions.data(), 3, HwPackedFormat::Half},
+                {normals.data(), 3, HwPackedFormat::Snorm10_10_10_2},
+                {colors.data(), 4, HwPackedFormat::Unorm8}
+            });
+
+            std::vector<uint8_t> fullData;
+            std::vector<uint8_t> packedData;
+            full.Pack(verticesCount, fullData);
+
+            HwVertexPacker::Report report;
+            double packSeconds = 1e9;
+
+            for (int i = 0; i < repeats; i++) {
+                report = packed.Pack(verticesCount, packedData);
+                packSeconds = std::min(packSeconds, report.seconds);
+            }
+
+            std::cout << BENCH << ": isa " << report.isa << ", stride " << report.sourceStride
+                      << " -> " << report.packedStride << " bytes" << std::endl;
+
+            ReportMetric(BENCH, "source_bytes", (double) report.sourceBytes, "B");
+            ReportMetric(BENCH, "packed_bytes", (double) report.packedBytes, "B");
+            ReportMetric(BENCH, "saved_bytes", (double) report.GetSavedBytes(), "B");
+            ReportMetric(BENCH, "pack_throughput", report.sourceBytes / packSeconds / 1e6, "MB/s");
+
+            auto benchWindow = CreateBenchWindow("Vertex packing benchmark", {640, 480});
+            HwShader shader(GetVertexCode(), GetFragmentCode());
+            HwGeometry fullGeometry(full.GetParams(verticesCount));
+            HwGeometry packedGeometry(packed.GetParams(verticesCount));
+
+            double fullUpload = MeasureUpload(fullGeometry, fullData, repeats);
+            double packedUpload = MeasureUpload(packedGeometry, packedData, repeats);
+
+            ReportMetric(BENCH, "upload_full_ms", fullUpload * 1e3, "ms");
+            ReportMetric(BENCH, "upload_packed_ms", packedUpload * 1e3, "ms");
+
+            glViewport(0, 0, 640, 480);
+            shader.Bind();
+            double fullDraw = MeasureDraw(fullGeometry, repeats);
+            double packedDraw = MeasureDraw(packedGeometry, repeats);
+            shader.Unbind();
+
+            ReportMetric(BENCH, "draw_full_mverts", verticesCount / fullDraw / 1e6, "Mvert/s");
+            ReportMetric(BENCH, "draw_packed_mverts", verticesCount / packedDraw / 1e6, "Mvert/s");
+
+            return 0;
+        }
+
+    }
+}
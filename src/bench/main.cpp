@@ -0,0 +1,80 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <bench/bench.hpp>
+#include <stdexcept>
+#include <iostream>
+#include <cstring>
+
+struct BenchEntry {
+    const char *name;
+    x11hw::bench::BenchFunction function;
+};
+
+static const BenchEntry BENCHMARKS[] = {
+    { "vertex-packing", x11hw::bench::RunVertexPacking },
+    { "texture-streaming", x11hw::bench::RunTextureStreaming },
+    { "job-system", x11hw::bench::RunJobSystem },
+    { "frame-pipeline", x11hw::bench::RunFramePipeline },
+    { "context-modes", x11hw::bench::RunContextModes },
+    { "srgb-fill", x11hw::bench::RunSrgbFill },
+    { "msaa-cost", x11hw::bench::RunMsaaCost },
+    { "present-latency", x11hw::bench::RunPresentLatency },
+    { "frame-pacing", x11hw::bench::RunFramePacing },
+    { "event-dispatch", x11hw::bench::RunEventDispatch },
+    { "frame-arena", x11hw::bench::RunFrameArena },
+    { "hud-overlay", x11hw::bench::RunHudOverlay },
+    { "mesh-loading", x11hw::bench::RunMeshLoading },
+    { "scene-event-storm", x11hw::bench::RunSceneEventStorm },
+};
+
+int main(int argc, const char *const *argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: x11hwbench <benchmark> [name=value ...]" << std::endl;
+        std::cerr << "Benchmarks:" << std::endl;
+
+        for (auto& entry: BENCHMARKS) {
+            std::cerr << "  " << entry.name << std::endl;
+        }
+
+        return 1;
+    }
+
+    std::vector<std::string> args(argv + 2, argv + argc);
+
+    for (auto& entry: BENCHMARKS) {
+        if (std::strcmp(entry.name, argv[1]) == 0) {
+            try {
+                return entry.function(args);
+            }
+            catch (const std::exception &e) {
+                std::cerr << "Benchmark " << entry.name << " failed: " << e.what() << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    std::cerr << "Unknown benchmark " << argv[1] << std::endl;
+    return 1;
+}
@@ -0,0 +1,84 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/obj_mesh.hpp>
+#include <x11hw/mesh_file.hpp>
+#include <stdexcept>
+#include <iostream>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+
+static void PrintUsage() {
+    std::cerr << "Usage: x11hwmeshconv <input.obj> <output.x11mesh> [options]" << std::endl
+              << "  --chunk-vertices <n>     Max vertices per chunk (default 65536)" << std::endl;
+}
+
+int main(int argc, const char *const *argv) {
+    if (argc < 3) {
+        PrintUsage();
+        return 1;
+    }
+
+    std::string input = argv[1];
+    std::string output = argv[2];
+    size_t chunkVertices = 1 << 16;
+
+    for (int i = 3; i < argc; i++) {
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (std::strcmp(argv[i], "--chunk-vertices") == 0 && value && std::atol(value) >= 3) {
+            chunkVertices = (size_t) std::atol(value);
+            i += 1;
+        }
+        else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    try {
+        auto start = std::chrono::steady_clock::now();
+        x11hw::HwObjMesh mesh(input);
+        auto parsed = std::chrono::steady_clock::now();
+
+        x11hw::HwMeshFile::Write(output, mesh.GetSource(), chunkVertices);
+        auto written = std::chrono::steady_clock::now();
+
+        // Validate written file
+        x11hw::HwMeshFile file(output);
+
+        std::cout << "Converted " << input << ": " << mesh.GetVerticesCount() << " vertices, "
+                  << mesh.GetIndices().size() / 3 << " triangles, "
+                  << file.GetChunksCount() << " chunks, " << file.GetFileSize() << " bytes "
+                  << "(parse " << std::chrono::duration<double, std::milli>(parsed - start).count() << " ms, "
+                  << "write " << std::chrono::duration<double, std::milli>(written - parsed).count() << " ms)" << std::endl;
+    }
+    catch (const std::exception &e) {
+        std::cerr << "Failed to convert mesh: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,129 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/alloc_counter.hpp>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef X11HW_COUNT_ALLOCATIONS
+
+static std::atomic<uint64_t> gAllocations{0};
+static std::atomic<uint64_t> gAllocatedBytes{0};
+
+// Constant initialized, so usable from operator new at any point of the thread life
+static thread_local uint64_t tAllocations = 0;
+static thread_local uint64_t tAllocatedBytes = 0;
+
+static void *CountedAllocate(std::size_t size) {
+    gAllocations.fetch_add(1, std::memory_order_relaxed);
+    gAllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    tAllocations += 1;
+    tAllocatedBytes += size;
+    return std::malloc(size ? size : 1);
+}
+
+void *operator new(std::size_t size) {
+    void *memory = CountedAllocate(size);
+
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+
+    return memory;
+}
+
+void *operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+    return CountedAllocate(size);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+    return CountedAllocate(size);
+}
+
+void operator delete(void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void *memory, const std::nothrow_t &) noexcept {
+    std::free(memory);
+}
+
+void operator delete[](void *memory, const std::nothrow_t &) noexcept {
+    std::free(memory);
+}
+
+#endif
+
+namespace x11hw {
+
+    bool HwAllocationCounter::IsEnabled() {
+#ifdef X11HW_COUNT_ALLOCATIONS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    uint64_t HwAllocationCounter::GetAllocations() {
+#ifdef X11HW_COUNT_ALLOCATIONS
+        return gAllocations.load(std::memory_order_relaxed);
+#else
+        return 0;
+#endif
+    }
+
+    uint64_t HwAllocationCounter::GetAllocatedBytes() {
+#ifdef X11HW_COUNT_ALLOCATIONS
+        return gAllocatedBytes.load(std::memory_order_relaxed);
+#else
+        return 0;
+#endif
+    }
+
+    uint64_t HwAllocationCounter::GetThreadAllocations() {
+#ifdef X11HW_COUNT_ALLOCATIONS
+        return tAllocations;
+#else
+        return 0;
+#endif
+    }
+
+    uint64_t HwAllocationCounter::GetThreadAllocatedBytes() {
+#ifdef X11HW_COUNT_ALLOCATIONS
+        return tAllocatedBytes;
+#else
+        return 0;
+#endif
+    }
+
+}
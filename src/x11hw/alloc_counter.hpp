@@ -0,0 +1,59 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_ALLOC_COUNTER_HPP
+#define X11HELLOWORLD_ALLOC_COUNTER_HPP
+
+#include <cstdint>
+
+namespace x11hw {
+
+    /**
+     * Counters of C++ heap allocations (global operator new, what STL containers use).
+     * Counting replaces global operator new/delete, so it is compiled only
+     * with X11HW_COUNT_ALLOCATIONS option, counters are zero otherwise.
+     * Process counters include allocations of all threads (X event thread, workers, driver threads),
+     * thread counters only allocations of the calling thread, what proves a single loop allocation free.
+     */
+    class HwAllocationCounter {
+    public:
+        /** @return True if allocations are counted in this build */
+        static bool IsEnabled();
+
+        /** @return Number of allocations since process start */
+        static uint64_t GetAllocations();
+
+        /** @return Number of allocated bytes since process start */
+        static uint64_t GetAllocatedBytes();
+
+        /** @return Number of allocations made by the calling thread */
+        static uint64_t GetThreadAllocations();
+
+        /** @return Number of bytes allocated by the calling thread */
+        static uint64_t GetThreadAllocatedBytes();
+    };
+
+}
+
+#endif //X11HELLOWORLD_ALLOC_COUNTER_HPP
@@ -0,0 +1,314 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/buffer_pool.hpp>
+#include <x11hw/deletion_queue.hpp>
+#include <x11hw/error.hpp>
+#include <stdexcept>
+#include <algorithm>
+#include <cassert>
+
+namespace x11hw {
+
+    static bool IsSameAttribute(const HwGeometry::Attribute &a, const HwGeometry::Attribute &b) {
+        return a.offset == b.offset &&
+               a.components == b.components &&
+               a.baseType == b.baseType &&
+               a.normalize == b.normalize;
+    }
+
+    HwBufferPool::HwBufferPool() : HwBufferPool(InitParams()) {
+
+    }
+
+    HwBufferPool::HwBufferPool(const InitParams &params) {
+        assert(params.pageSize > 0);
+        mPageSize = params.pageSize;
+        mUsage = params.usage;
+    }
+
+    HwBufferPool::~HwBufferPool() {
+        for (auto& format: mFormats) {
+            for (auto& page: format.pages) {
+                assert(page->allocations.empty());
+                ReleasePage(format, *page);
+            }
+        }
+
+        mFormats.clear();
+    }
+
+    HwBufferAllocation *HwBufferPool::Allocate(size_t stride, const std::vector<HwGeometry::Attribute> &attributes, size_t verticesCount) {
+        assert(stride > 0);
+        assert(verticesCount > 0);
+        assert(!attributes.empty());
+
+        size_t formatId = FindFormat(stride, attributes);
+        auto& format = mFormats[formatId];
+
+        uint32_t offset = 0;
+        uint32_t node = HwRangeAllocator::INVALID;
+        size_t pageId = 0;
+
+        for (; pageId < format.pages.size(); pageId++) {
+            node = format.pages[pageId]->allocator->Allocate((uint32_t) verticesCount, offset);
+            if (node != HwRangeAllocator::INVALID) {
+                break;
+            }
+        }
+
+        if (node == HwRangeAllocator::INVALID) {
+            auto page = CreatePage(format, verticesCount);
+            pageId = format.pages.size() - 1;
+            node = page->allocator->Allocate((uint32_t) verticesCount, offset);
+            CHECK_MSG(node != HwRangeAllocator::INVALID, "Failed to allocate from new page");
+        }
+
+        auto allocation = new HwBufferAllocation();
+        allocation->format = formatId;
+        allocation->page = pageId;
+        allocation->node = node;
+        allocation->first = offset;
+        allocation->count = verticesCount;
+
+        format.pages[pageId]->allocations.emplace(allocation->first, allocation);
+        return allocation;
+    }
+
+    void HwBufferPool::Release(HwBufferAllocation *allocation) {
+        assert(allocation);
+        auto& page = *mFormats[allocation->format].pages[allocation->page];
+
+        auto found = page.allocations.find(allocation->first);
+        assert(found != page.allocations.end() && found->second == allocation);
+
+        page.allocator->Release(allocation->node);
+        page.allocations.erase(found);
+        delete allocation;
+    }
+
+    void HwBufferPool::Defragment() {
+        for (auto& format: mFormats) {
+            std::vector<std::unique_ptr<Page>> pages;
+
+            for (auto& page: format.pages) {
+                if (page->allocations.empty()) {
+                    ReleasePage(format, *page);
+                    continue;
+                }
+
+                auto stats = page->allocator->GetStats();
+                auto last = page->allocations.rbegin()->second;
+
+                // Page is packed only if live ranges end where their total size ends (no holes before, even single one)
+                if (last->first + last->count != stats.used) {
+                    std::map<size_t, HwBufferAllocation*> allocations;
+
+                    GLuint vbo = CreateBuffer(format.stride * page->allocator->GetCapacity());
+                    glBindBuffer(GL_COPY_WRITE_BUFFER, vbo);
+                    glBindBuffer(GL_COPY_READ_BUFFER, page->vbo);
+
+                    page->allocator->Reset();
+
+                    // Ranges are moved in offset order, so they keep their relative order
+                    for (auto& entry: page->allocations) {
+                        auto allocation = entry.second;
+                        uint32_t offset;
+                        uint32_t node = page->allocator->Allocate((uint32_t) allocation->count, offset);
+                        assert(node != HwRangeAllocator::INVALID);
+
+                        glCopyBufferSubData(
+                            GL_COPY_READ_BUFFER,
+                            GL_COPY_WRITE_BUFFER,
+                            format.stride * allocation->first,
+                            format.stride * offset,
+                            format.stride * allocation->count
+                        );
+
+                        allocation->node = node;
+                        allocation->first = offset;
+                        allocations.emplace(offset, allocation);
+                    }
+
+                    page->allocations = std::move(allocations);
+
+                    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+                    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+                    ReleaseBuffer(page->vbo, format.stride * page->allocator->GetCapacity());
+
+                    page->vbo = vbo;
+                    SetupVAO(format, *page);
+                }
+
+                for (auto& entry: page->allocations) {
+                    entry.second->page = pages.size();
+                }
+
+                pages.push_back(std::move(page));
+            }
+
+            format.pages = std::move(pages);
+        }
+    }
+
+    HwBufferPool::Stats HwBufferPool::GetStats() const {
+        Stats stats;
+        stats.formatsCount = mFormats.size();
+
+        float fragmentation = 0.0f;
+
+        for (auto& format: mFormats) {
+            for (auto& page: format.pages) {
+                auto pageStats = page->allocator->GetStats();
+
+                stats.pagesCount += 1;
+                stats.allocationsCount += pageStats.allocationsCount;
+                stats.freeBlocksCount += pageStats.freeBlocksCount;
+                stats.capacity += format.stride * pageStats.capacity;
+                stats.used += format.stride * pageStats.used;
+                stats.largestFree = std::max(stats.largestFree, format.stride * pageStats.largestFree);
+
+                if (pageStats.free > 0) {
+                    fragmentation += 1.0f - (float) pageStats.largestFree / (float) pageStats.free;
+                }
+            }
+        }
+
+        if (stats.capacity > 0) {
+            stats.utilization = (float) stats.used / (float) stats.capacity;
+        }
+        if (stats.pagesCount > 0) {
+            stats.fragmentation = fragmentation / (float) stats.pagesCount;
+        }
+
+        return stats;
+    }
+
+    GLuint HwBufferPool::GetVAO(const HwBufferAllocation *allocation) const {
+        return mFormats[allocation->format].pages[allocation->page]->vao;
+    }
+
+    GLuint HwBufferPool::GetBuffer(const HwBufferAllocation *allocation) const {
+        return mFormats[allocation->format].pages[allocation->page]->vbo;
+    }
+
+    size_t HwBufferPool::GetStride(const HwBufferAllocation *allocation) const {
+        return mFormats[allocation->format].stride;
+    }
+
+    size_t HwBufferPool::FindFormat(size_t stride, const std::vector<HwGeometry::Attribute> &attributes) {
+        for (size_t i = 0; i < mFormats.size(); i++) {
+            auto& format = mFormats[i];
+
+            if (format.stride == stride && format.attributes.size() == attributes.size() &&
+                std::equal(attributes.begin(), attributes.end(), format.attributes.begin(), IsSameAttribute)) {
+                return i;
+            }
+        }
+
+        Format format;
+        format.stride = stride;
+        format.attributes = attributes;
+        mFormats.push_back(std::move(format));
+
+        return mFormats.size() - 1;
+    }
+
+    HwBufferPool::Page *HwBufferPool::CreatePage(Format &format, size_t verticesCount) {
+        // Geometry larger than page gets its own dedicated page
+        size_t capacity = std::max(mPageSize / format.stride, verticesCount);
+        CHECK_MSG(capacity < HwRangeAllocator::INVALID, "Too large buffer pool page");
+
+        std::unique_ptr<Page> page{new Page()};
+        page->allocator.reset(new HwRangeAllocator((uint32_t) capacity));
+
+        page->vbo = CreateBuffer(format.stride * capacity);
+
+        glGenVertexArrays(1, &page->vao);
+        SetupVAO(format, *page);
+
+        format.pages.push_back(std::move(page));
+        return format.pages.back().get();
+    }
+
+    void HwBufferPool::SetupVAO(const Format &format, const Page &page) {
+        glBindVertexArray(page.vao);
+        glBindBuffer(GL_ARRAY_BUFFER, page.vbo);
+
+        for (size_t i = 0; i < format.attributes.size(); i++) {
+            auto& attrib = format.attributes[i];
+
+            glEnableVertexAttribArray(i);
+            glVertexAttribDivisor(i, 0);
+            glVertexAttribPointer(
+                i,
+                attrib.components,
+                attrib.baseType,
+                attrib.normalize ? GL_TRUE : GL_FALSE,
+                format.stride,
+                (void *) attrib.offset
+            );
+        }
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    void HwBufferPool::ReleasePage(const Format &format, Page &page) {
+        if (auto deletionQueue = HwDeletionQueue::GetCurrent()) {
+            deletionQueue->RetireVertexArray(page.vao);
+        }
+        else {
+            glDeleteVertexArrays(1, &page.vao);
+        }
+
+        ReleaseBuffer(page.vbo, format.stride * page.allocator->GetCapacity());
+        page.vao = 0;
+        page.vbo = 0;
+    }
+
+    GLuint HwBufferPool::CreateBuffer(size_t size) {
+        auto deletionQueue = HwDeletionQueue::GetCurrent();
+        GLuint buffer = deletionQueue ? deletionQueue->AcquireBuffer(size, mUsage) : 0;
+
+        if (!buffer) {
+            glGenBuffers(1, &buffer);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, mUsage);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        }
+
+        return buffer;
+    }
+
+    void HwBufferPool::ReleaseBuffer(GLuint buffer, size_t size) {
+        if (auto deletionQueue = HwDeletionQueue::GetCurrent()) {
+            deletionQueue->RetireBuffer(buffer, size, mUsage);
+        }
+        else {
+            glDeleteBuffers(1, &buffer);
+        }
+    }
+
+}
@@ -0,0 +1,132 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_BUFFER_POOL_HPP
+#define X11HELLOWORLD_BUFFER_POOL_HPP
+
+#include <GL/glew.h>
+#include <x11hw/geometry.hpp>
+#include <x11hw/range_allocator.hpp>
+#include <map>
+#include <memory>
+#include <vector>
+
+namespace x11hw {
+
+    /** Vertex range of the buffer pool (first vertex may change on defragmentation) */
+    struct HwBufferAllocation {
+        size_t format = 0;
+        size_t page = 0;
+        uint32_t node = HwRangeAllocator::INVALID;
+        size_t first = 0;
+        size_t count = 0;
+    };
+
+    /**
+     * Owns few large vertex buffers and sub-allocates vertex ranges from them.
+     * Buffers are grouped by vertex format, each buffer (page) has single VAO,
+     * shared by all geometries allocated from it.
+     *
+     * Pool must outlive all geometries created from it.
+     */
+    class HwBufferPool {
+    public:
+        struct InitParams {
+            size_t pageSize = 16 * 1024 * 1024;
+            GLenum usage = GL_STATIC_DRAW;
+        };
+
+        struct Stats {
+            size_t formatsCount = 0;
+            size_t pagesCount = 0;
+            size_t allocationsCount = 0;
+            size_t freeBlocksCount = 0;
+            size_t capacity = 0;        // Bytes
+            size_t used = 0;            // Bytes
+            size_t largestFree = 0;     // Bytes of largest free block among pages
+            float utilization = 0.0f;   // used / capacity
+            float fragmentation = 0.0f; // 1 - largest free block / total free (per page, averaged)
+        };
+
+        HwBufferPool();
+        explicit HwBufferPool(const InitParams &params);
+        HwBufferPool(const HwBufferPool&) = delete;
+        HwBufferPool(HwBufferPool&&) = delete;
+        ~HwBufferPool();
+
+        /**
+         * Allocate vertex range
+         * @param stride Vertex stride in bytes
+         * @param attributes Vertex attributes layout
+         * @param verticesCount Number of vertices to allocate
+         * @return Allocation, stays valid (but may move inside pool) until released
+         */
+        HwBufferAllocation *Allocate(size_t stride, const std::vector<HwGeometry::Attribute> &attributes, size_t verticesCount);
+
+        /** Release allocation */
+        void Release(HwBufferAllocation *allocation);
+
+        /**
+         * Compact allocations of each page to the beginning of the page and release empty pages.
+         * Allocations data is copied on GPU; allocations first vertex is updated.
+         */
+        void Defragment();
+
+        /** @return Pool usage statistics */
+        Stats GetStats() const;
+
+        GLuint GetVAO(const HwBufferAllocation *allocation) const;
+        GLuint GetBuffer(const HwBufferAllocation *allocation) const;
+        size_t GetStride(const HwBufferAllocation *allocation) const;
+
+    private:
+        struct Page {
+            GLuint vao = 0;
+            GLuint vbo = 0;
+            std::unique_ptr<HwRangeAllocator> allocator;
+            // Indexed by first vertex (ranges of a page do not overlap)
+            std::map<size_t, HwBufferAllocation*> allocations;
+        };
+
+        struct Format {
+            size_t stride = 0;
+            std::vector<HwGeometry::Attribute> attributes;
+            std::vector<std::unique_ptr<Page>> pages;
+        };
+
+        size_t FindFormat(size_t stride, const std::vector<HwGeometry::Attribute> &attributes);
+        Page *CreatePage(Format &format, size_t verticesCount);
+        void SetupVAO(const Format &format, const Page &page);
+        void ReleasePage(const Format &format, Page &page);
+        GLuint CreateBuffer(size_t size);
+        void ReleaseBuffer(GLuint buffer, size_t size);
+
+        std::vector<Format> mFormats;
+        size_t mPageSize = 0;
+        GLenum mUsage = 0;
+    };
+
+}
+
+#endif //X11HELLOWORLD_BUFFER_POOL_HPP
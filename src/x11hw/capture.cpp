@@ -0,0 +1,291 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/capture.hpp>
+#include <x11hw/error.hpp>
+#include <stdexcept>
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cassert>
+#include <sys/stat.h>
+
+namespace x11hw {
+
+    static const size_t BYTES_PER_PIXEL = 4;
+
+    HwFrameCapture::HwFrameCapture(const InitParams &params) {
+        assert(params.ringSize >= 2);
+
+        mDirectory = params.directory;
+        mFormat = params.format;
+
+        // Directory may already exist
+        mkdir(mDirectory.c_str(), 0755);
+
+        if (mFormat == Format::Stream) {
+            std::string path = mDirectory + "/capture.rgba";
+            mStream = std::fopen(path.c_str(), "wb");
+            CHECK_MSG(mStream, "Failed to open capture stream file");
+        }
+
+        for (size_t i = 0; i < params.ringSize; i++) {
+            std::unique_ptr<Slot> slot{new Slot()};
+            glGenBuffers(1, &slot->pbo);
+            mSlots.push_back(std::move(slot));
+        }
+
+        mThread = std::thread([this]() { ThreadMain(); });
+    }
+
+    HwFrameCapture::~HwFrameCapture() {
+        // Frames in flight are still written
+        ProcessReadSlots(true);
+
+        {
+            std::lock_guard<std::mutex> guard(mMutex);
+            mStop = true;
+        }
+
+        mCondition.notify_all();
+        mThread.join();
+
+        ReleaseWrittenSlots();
+
+        for (auto& slot: mSlots) {
+            glDeleteBuffers(1, &slot->pbo);
+        }
+
+        if (mStream) {
+            std::fclose(mStream);
+        }
+    }
+
+    void HwFrameCapture::Capture(glm::uvec2 size) {
+        auto start = std::chrono::steady_clock::now();
+
+        ReleaseWrittenSlots();
+        ProcessReadSlots(false);
+
+        mFrameIndex += 1;
+
+        if (size.x == 0 || size.y == 0) {
+            return;
+        }
+
+        auto& slot = *mSlots[mNextSlot];
+
+        if (slot.state.load() != SlotState::Free) {
+            // GPU or disk is too slow: do not stall render thread
+            mDroppedFrames += 1;
+        }
+        else {
+            size_t required = size.x * size.y * BYTES_PER_PIXEL;
+
+            // Grow during resize, shrink only to the settled size (once frames fit into it)
+            if (slot.capacity < required) {
+                AllocateSlot(slot, std::max(required, mSettledBytes));
+            }
+            else if (slot.capacity > mSettledBytes && mSettledBytes >= required) {
+                AllocateSlot(slot, mSettledBytes);
+            }
+
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+            glReadBuffer(GL_BACK);
+            glReadPixels(0, 0, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+            slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            slot.size = size;
+            slot.bytes = required;
+            slot.frame = mFrameIndex;
+            slot.state.store(SlotState::Reading);
+
+            mNextSlot = (mNextSlot + 1) % mSlots.size();
+            mCapturedFrames += 1;
+        }
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        mTotalSeconds += seconds;
+        mMaxSeconds = std::max(mMaxSeconds, seconds);
+    }
+
+    void HwFrameCapture::Resize(glm::uvec2 size) {
+        mSettledBytes = size.x * size.y * BYTES_PER_PIXEL;
+
+        // Slots in flight are reallocated, when they are used next time
+        for (auto& slot: mSlots) {
+            if (slot->state.load() == SlotState::Free && slot->capacity != 0 && slot->capacity != mSettledBytes) {
+                AllocateSlot(*slot, mSettledBytes);
+            }
+        }
+    }
+
+    HwFrameCapture::Stats HwFrameCapture::GetStats() const {
+        Stats stats;
+        stats.capturedFrames = mCapturedFrames;
+        stats.writtenFrames = mWrittenFrames.load();
+        stats.droppedFrames = mDroppedFrames;
+        stats.reallocations = mReallocations;
+        stats.averageRenderThreadMs = mFrameIndex > 0 ? mTotalSeconds * 1e3 / (double) mFrameIndex : 0.0;
+        stats.maxRenderThreadMs = mMaxSeconds * 1e3;
+        return stats;
+    }
+
+    void HwFrameCapture::AllocateSlot(Slot &slot, size_t capacity) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+        glBufferData(GL_PIXEL_PACK_BUFFER, capacity, nullptr, GL_STREAM_READ);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+        slot.capacity = capacity;
+        mReallocations += 1;
+    }
+
+    void HwFrameCapture::ProcessReadSlots(bool wait) {
+        // Slots are filled in ring order, so process from the oldest one
+        for (size_t i = 0; i < mSlots.size(); i++) {
+            auto& slot = *mSlots[(mNextSlot + i) % mSlots.size()];
+
+            if (slot.state.load() != SlotState::Reading) {
+                continue;
+            }
+
+            GLuint64 timeout = wait ? GL_TIMEOUT_IGNORED : 0;
+            GLenum status = glClientWaitSync(slot.fence, wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0, timeout);
+
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+                break;
+            }
+
+            glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+
+            // Worker reads mapped memory directly, buffer is unmapped once it is written
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+            slot.mapped = (const uint8_t *) glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, slot.bytes, GL_MAP_READ_BIT);
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+            if (!slot.mapped) {
+                slot.state.store(SlotState::Free);
+                mDroppedFrames += 1;
+                continue;
+            }
+
+            slot.state.store(SlotState::Writing);
+
+            {
+                std::lock_guard<std::mutex> guard(mMutex);
+                mQueue.push_back(&slot);
+            }
+
+            mCondition.notify_one();
+        }
+    }
+
+    void HwFrameCapture::ReleaseWrittenSlots() {
+        for (auto& slot: mSlots) {
+            if (slot->state.load() == SlotState::Written) {
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, slot->pbo);
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+                slot->mapped = nullptr;
+                slot->state.store(SlotState::Free);
+            }
+        }
+    }
+
+    void HwFrameCapture::ThreadMain() {
+        std::vector<uint8_t> row;
+
+        while (true) {
+            Slot *slot;
+
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mCondition.wait(lock, [this]() { return mStop || !mQueue.empty(); });
+
+                if (mQueue.empty()) {
+                    break;
+                }
+
+                slot = mQueue.front();
+                mQueue.pop_front();
+            }
+
+            WriteFrame(*slot, row);
+            mWrittenFrames.fetch_add(1);
+            slot->state.store(SlotState::Written);
+        }
+    }
+
+    void HwFrameCapture::WriteFrame(const Slot &slot, std::vector<uint8_t> &row) {
+        size_t width = slot.size.x;
+        size_t height = slot.size.y;
+        size_t pitch = width * BYTES_PER_PIXEL;
+
+        FILE *file = mStream;
+
+        if (!file) {
+            char name[64];
+            std::snprintf(name, sizeof(name), "/frame_%06zu.%s", slot.frame, mFormat == Format::Ppm ? "ppm" : "rgba");
+
+            std::string path = mDirectory + name;
+            file = std::fopen(path.c_str(), "wb");
+
+            if (!file) {
+                std::cerr << "Failed to open capture file " << path << std::endl;
+                return;
+            }
+        }
+
+        if (mFormat == Format::Ppm) {
+            std::fprintf(file, "P6\n%zu %zu\n255\n", width, height);
+            row.resize(width * 3);
+        }
+
+        // GL rows are bottom-up
+        for (size_t y = 0; y < height; y++) {
+            const uint8_t *source = slot.mapped + (height - 1 - y) * pitch;
+
+            if (mFormat == Format::Ppm) {
+                for (size_t x = 0; x < width; x++) {
+                    row[x * 3 + 0] = source[x * 4 + 0];
+                    row[x * 3 + 1] = source[x * 4 + 1];
+                    row[x * 3 + 2] = source[x * 4 + 2];
+                }
+
+                std::fwrite(row.data(), 1, row.size(), file);
+            }
+            else {
+                std::fwrite(source, 1, pitch, file);
+            }
+        }
+
+        if (file != mStream) {
+            std::fclose(file);
+        }
+    }
+
+}
@@ -0,0 +1,148 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_CAPTURE_HPP
+#define X11HELLOWORLD_CAPTURE_HPP
+
+#include <GL/glew.h>
+#include <glm/vec2.hpp>
+#include <condition_variable>
+#include <atomic>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace x11hw {
+
+    /**
+     * Asynchronous capture of rendered frames.
+     * Back buffer is read into a ring of pixel buffer objects, which are mapped
+     * few frames later, once their fences are signalled. Mapped memory is encoded
+     * and written to disk by worker thread, so render thread never waits for the GPU or IO.
+     * If all ring slots are busy, frame is dropped.
+     * Pixel buffers only grow while window is resized, they are reallocated to the exact
+     * frame size by Resize (on settled window resize).
+     */
+    class HwFrameCapture {
+    public:
+        enum class Format {
+            /** File per frame with RGBA pixels, top row first */
+            Raw,
+            /** File per frame in binary PPM (P6) format */
+            Ppm,
+            /** Single file with RGBA frames one after another (ffmpeg -f rawvideo -pix_fmt rgba) */
+            Stream
+        };
+
+        struct InitParams {
+            std::string directory = ".";
+            Format format = Format::Ppm;
+            size_t ringSize = 4;
+        };
+
+        struct Stats {
+            size_t capturedFrames = 0;
+            size_t writtenFrames = 0;
+            size_t droppedFrames = 0;
+            /** Pixel buffer (re)allocations */
+            size_t reallocations = 0;
+            double averageRenderThreadMs = 0.0;
+            double maxRenderThreadMs = 0.0;
+        };
+
+        explicit HwFrameCapture(const InitParams &params);
+        HwFrameCapture(const HwFrameCapture&) = delete;
+        HwFrameCapture(HwFrameCapture&&) = delete;
+        ~HwFrameCapture();
+
+        /**
+         * Capture back buffer of current frame (call right before swap buffers)
+         * @param size Framebuffer size in pixels
+         */
+        void Capture(glm::uvec2 size);
+
+        /**
+         * Reallocate pixel buffers to the frame size (call on settled resize, see HwWindow::SubscribeOnResize)
+         * @param size Settled framebuffer size in pixels
+         */
+        void Resize(glm::uvec2 size);
+
+        /** @return Capture statistics */
+        Stats GetStats() const;
+
+    private:
+        enum class SlotState {
+            Free,
+            Reading,
+            Writing,
+            Written
+        };
+
+        struct Slot {
+            GLuint pbo = 0;
+            GLsync fence = nullptr;
+            size_t capacity = 0;
+            size_t bytes = 0;
+            size_t frame = 0;
+            glm::uvec2 size{};
+            const uint8_t *mapped = nullptr;
+            std::atomic<SlotState> state{SlotState::Free};
+        };
+
+        void AllocateSlot(Slot &slot, size_t capacity);
+        void ProcessReadSlots(bool wait);
+        void ReleaseWrittenSlots();
+        void ThreadMain();
+        void WriteFrame(const Slot &slot, std::vector<uint8_t> &row);
+
+        std::string mDirectory;
+        Format mFormat;
+        std::vector<std::unique_ptr<Slot>> mSlots;
+        size_t mNextSlot = 0;
+        size_t mFrameIndex = 0;
+        // Size of the settled frame (0 - not known yet, buffers only grow)
+        size_t mSettledBytes = 0;
+        size_t mReallocations = 0;
+        FILE *mStream = nullptr;
+
+        std::thread mThread;
+        std::mutex mMutex;
+        std::condition_variable mCondition;
+        std::deque<Slot*> mQueue;
+        bool mStop = false;
+
+        size_t mCapturedFrames = 0;
+        size_t mDroppedFrames = 0;
+        std::atomic<size_t> mWrittenFrames{0};
+        double mTotalSeconds = 0.0;
+        double mMaxSeconds = 0.0;
+    };
+
+}
+
+#endif //X11HELLOWORLD_CAPTURE_HPP
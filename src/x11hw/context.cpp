@@ -23,10 +23,14 @@
 ////////////////////////////////////////////////////////////////////////////////////
 
 #include <x11hw/context.hpp>
+#include <x11hw/deletion_queue.hpp>
+#include <x11hw/debug_output.hpp>
 #include <x11hw/error.hpp>
 #include <stdexcept>
+#include <vector>
 #include <cstring>
 #include <cassert>
+#include <chrono>
 
 namespace x11hw {
 
@@ -34,11 +38,12 @@ namespace x11hw {
         return std::strstr(extensions, extension) != nullptr;
     }
 
-    HwContext::HwContext(Display *display, int screen) {
+    HwContext::HwContext(Display *display, int screen, const HwContextConfig &config) {
         assert(display);
 
         mDisplay = display;
         mScreen = screen;
+        mConfig = config;
 
         ValidateGlxVersion();
         SelectFBConfig();
@@ -47,6 +52,12 @@ namespace x11hw {
 
     HwContext::~HwContext() {
         if (IsCreated()) {
+            DestroySharedContext();
+
+            // Remaining objects must be deleted while context is still alive
+            mDeletionQueue = nullptr;
+            HwDeletionQueue::SetCurrent(nullptr);
+
             glXDestroyContext(mDisplay, mContext);
             XFree(mVisualInfo);
             XFreeColormap(mDisplay, mColorMap);
@@ -68,6 +79,9 @@ namespace x11hw {
     }
 
     void HwContext::SelectFBConfig() {
+        auto& policy = mConfig.framebuffer;
+
+        // Only hard requirements here, the rest is up to the policy scoring
         GLint glxAttributes[] = {
                 GLX_X_RENDERABLE, True,
                 GLX_DRAWABLE_TYPE, GLX_WINDOW_BIT,
@@ -76,9 +90,9 @@ namespace x11hw {
                 GLX_RED_SIZE, 8,
                 GLX_GREEN_SIZE, 8,
                 GLX_BLUE_SIZE, 8,
-                GLX_ALPHA_SIZE, 8,
-                GLX_DEPTH_SIZE, 24,
-                GLX_STENCIL_SIZE, 8,
+                GLX_ALPHA_SIZE, policy.alphaBits,
+                GLX_DEPTH_SIZE, policy.depthBits,
+                GLX_STENCIL_SIZE, policy.stencilBits,
                 GLX_DOUBLEBUFFER, True,
                 None
         };
@@ -87,32 +101,71 @@ namespace x11hw {
         GLXFBConfig* fbConfigs = glXChooseFBConfig(mDisplay, mScreen, glxAttributes, &fbConfigsCount);
         CHECK_MSG(fbConfigs && fbConfigsCount > 0, "Failed to retrieve framebuffer configs");
 
+        // sRGB capable config lets fixed-function hardware encode linear shader output
+        const char *glxExtensions = glXQueryExtensionsString(mDisplay, mScreen);
+        bool srgbSupported = IsExtensionSupported(glxExtensions, "GLX_ARB_framebuffer_sRGB") ||
+                             IsExtensionSupported(glxExtensions, "GLX_EXT_framebuffer_sRGB");
+
         int selectedConfigId = -1;
-        int bestSamples = -1;
+        int64_t bestScore = -1;
 
         for (int i = 0; i < fbConfigsCount; i++) {
             XVisualInfo *visualInfo = glXGetVisualFromFBConfig(mDisplay, fbConfigs[i]);
 
             if (visualInfo) {
-                int sampleBuffers;
-                int samples;
-
-                glXGetFBConfigAttrib(mDisplay, fbConfigs[i], GLX_SAMPLE_BUFFERS, &sampleBuffers);
-                glXGetFBConfigAttrib(mDisplay, fbConfigs[i], GLX_SAMPLES, &samples);
+                auto info = QueryFramebufferInfo(fbConfigs[i], srgbSupported);
+                auto score = HwFramebufferInfo::Score(policy, info);
 
-                if (selectedConfigId < 0 || (sampleBuffers && samples > bestSamples) ) {
+                if (score > bestScore) {
                     selectedConfigId = i;
-                    bestSamples = samples;
+                    bestScore = score;
+                    mFramebufferInfo = info;
                 }
 
                 XFree(visualInfo);
             }
         }
 
+        if (selectedConfigId < 0) {
+            XFree(fbConfigs);
+            throw std::runtime_error("No framebuffer config satisfies required samples count");
+        }
+
+        mFramebufferInfo.postProcessAntialiasing = policy.antialiasing == HwAntialiasing::PostProcess;
+        mFramebufferSrgb = mFramebufferInfo.srgb;
         mFbConfig = fbConfigs[selectedConfigId];
         XFree(fbConfigs);
     }
 
+    HwFramebufferInfo HwContext::QueryFramebufferInfo(GLXFBConfig fbConfig, bool srgbSupported) const {
+        HwFramebufferInfo info;
+
+        int sampleBuffers = 0;
+        int doubleBuffer = 0;
+        int srgbCapable = 0;
+
+        glXGetFBConfigAttrib(mDisplay, fbConfig, GLX_FBCONFIG_ID, &info.fbConfigId);
+        glXGetFBConfigAttrib(mDisplay, fbConfig, GLX_RED_SIZE, &info.redBits);
+        glXGetFBConfigAttrib(mDisplay, fbConfig, GLX_GREEN_SIZE, &info.greenBits);
+        glXGetFBConfigAttrib(mDisplay, fbConfig, GLX_BLUE_SIZE, &info.blueBits);
+        glXGetFBConfigAttrib(mDisplay, fbConfig, GLX_ALPHA_SIZE, &info.alphaBits);
+        glXGetFBConfigAttrib(mDisplay, fbConfig, GLX_DEPTH_SIZE, &info.depthBits);
+        glXGetFBConfigAttrib(mDisplay, fbConfig, GLX_STENCIL_SIZE, &info.stencilBits);
+        glXGetFBConfigAttrib(mDisplay, fbConfig, GLX_SAMPLE_BUFFERS, &sampleBuffers);
+        glXGetFBConfigAttrib(mDisplay, fbConfig, GLX_SAMPLES, &info.samples);
+        glXGetFBConfigAttrib(mDisplay, fbConfig, GLX_DOUBLEBUFFER, &doubleBuffer);
+
+        if (srgbSupported) {
+            glXGetFBConfigAttrib(mDisplay, fbConfig, GLX_FRAMEBUFFER_SRGB_CAPABLE_ARB, &srgbCapable);
+        }
+
+        info.samples = sampleBuffers ? info.samples : 0;
+        info.doubleBuffer = doubleBuffer != 0;
+        info.srgb = srgbCapable != 0;
+
+        return info;
+    }
+
     void HwContext::CreateVisualInfo() {
         mVisualInfo = glXGetVisualFromFBConfig(mDisplay, mFbConfig);
         CHECK_MSG(mVisualInfo, "Failed to create VisualInfo");
@@ -129,6 +182,10 @@ namespace x11hw {
             mglXSwapIntervalEXTSupport = mglXSwapIntervalEXT != nullptr;
         }
 
+        // Negative intervals are accepted only by glXSwapIntervalEXT
+        mglXSwapControlTearSupport = mglXSwapIntervalEXTSupport &&
+                                     IsExtensionSupported(glxExtensions, "GLX_EXT_swap_control_tear");
+
         if (IsExtensionSupported(glxExtensions, "GLX_MESA_swap_control")) {
             mglXSwapIntervalMESA = (glXSwapIntervalMESA) glXGetProcAddressARB((const GLubyte *) "glXSwapIntervalMESA");
             mglXSwapIntervalMESASupport = mglXSwapIntervalMESA != nullptr;
@@ -139,14 +196,57 @@ namespace x11hw {
             mglXSwapIntervalSGISupport = mglXSwapIntervalSGI != nullptr;
         }
 
-        if (IsExtensionSupported(glxExtensions, "GLX_ARB_create_context")) {
-            int contextAttributes[] = {
-                    GLX_CONTEXT_MAJOR_VERSION_ARB, 3,
-                    GLX_CONTEXT_MINOR_VERSION_ARB, 2,
-                    GLX_CONTEXT_FLAGS_ARB, GLX_CONTEXT_FORWARD_COMPATIBLE_BIT_ARB,
-                    None
+        if (IsExtensionSupported(glxExtensions, "GLX_OML_sync_control")) {
+            mglXGetSyncValuesOML = (glXGetSyncValuesOML) glXGetProcAddressARB((const GLubyte *) "glXGetSyncValuesOML");
+            mglXWaitForSbcOML = (glXWaitForSbcOML) glXGetProcAddressARB((const GLubyte *) "glXWaitForSbcOML");
+            mglXSyncControlOMLSupport = mglXGetSyncValuesOML != nullptr && mglXWaitForSbcOML != nullptr;
+        }
+
+        mglXCreateContextAttribsARBSupport = IsExtensionSupported(glxExtensions, "GLX_ARB_create_context");
+        mglXCreateContextNoErrorARBSupport = IsExtensionSupported(glxExtensions, "GLX_ARB_create_context_no_error");
+
+        // Without attributes context flags cannot be requested
+        mMode = mglXCreateContextAttribsARBSupport ? mConfig.mode : HwContextMode::Default;
+
+        if (mMode == HwContextMode::NoError && !mglXCreateContextNoErrorARBSupport) {
+            mMode = HwContextMode::Default;
+        }
+
+        mContext = CreateContextInternal(nullptr);
+
+        CHECK_MSG(mContext, "Failed to create GL context");
+
+        if (mMode == HwContextMode::Debug) {
+            mDebugOutput = std::unique_ptr<HwDebugOutput>{new HwDebugOutput(mConfig.debugMessagesPerSecond, mConfig.debugNotifications)};
+        }
+
+        mDeletionQueue = std::unique_ptr<HwDeletionQueue>{new HwDeletionQueue()};
+    }
+
+    GLXContext HwContext::CreateContextInternal(GLXContext shareContext) {
+        GLXContext context;
+
+        if (mglXCreateContextAttribsARBSupport) {
+            int flags = mConfig.forwardCompatible ? GLX_CONTEXT_FORWARD_COMPATIBLE_BIT_ARB : 0;
+
+            if (mMode == HwContextMode::Debug) {
+                flags |= GLX_CONTEXT_DEBUG_BIT_ARB;
+            }
+
+            std::vector<int> contextAttributes = {
+                    GLX_CONTEXT_MAJOR_VERSION_ARB, mConfig.majorVersion,
+                    GLX_CONTEXT_MINOR_VERSION_ARB, mConfig.minorVersion,
+                    GLX_CONTEXT_FLAGS_ARB, flags
             };
 
+            // Shared context gets the same attribute, contexts of one share group must match in it
+            if (mMode == HwContextMode::NoError) {
+                contextAttributes.push_back(GLX_CONTEXT_OPENGL_NO_ERROR_ARB);
+                contextAttributes.push_back(True);
+            }
+
+            contextAttributes.push_back(None);
+
             typedef GLXContext (*glXCreateContextAttribsARBFunction)(
                     Display*,
                     GLXFBConfig,
@@ -159,14 +259,94 @@ namespace x11hw {
                     glXGetProcAddressARB((const GLubyte *) "glXCreateContextAttribsARB");
             CHECK_MSG(glXCreateContextAttribsARB, "Failed to get glXCreateContextAttribsARB function");
 
-            mContext = glXCreateContextAttribsARB(mDisplay, mFbConfig, nullptr, true, contextAttributes);
+            context = glXCreateContextAttribsARB(mDisplay, mFbConfig, shareContext, true, contextAttributes.data());
         }
         else {
             // Fallback to simple setup
-            mContext = glXCreateNewContext(mDisplay, mFbConfig, GLX_RGBA_TYPE, nullptr, True);
+            context = glXCreateNewContext(mDisplay, mFbConfig, GLX_RGBA_TYPE, shareContext, True);
         }
 
-        CHECK_MSG(mContext, "Failed to create GL context");
+        return context;
+    }
+
+    void HwContext::CreateSharedContext() {
+        assert(IsCreated());
+
+        if (mSharedContext) {
+            return;
+        }
+
+        mSharedContext = CreateContextInternal(mContext);
+        CHECK_MSG(mSharedContext, "Failed to create shared GL context");
+
+        int drawableType = 0;
+        glXGetFBConfigAttrib(mDisplay, mFbConfig, GLX_DRAWABLE_TYPE, &drawableType);
+
+        // Prefer pbuffer, fallback to never mapped window of the same visual
+        if (drawableType & GLX_PBUFFER_BIT) {
+            int pbufferAttributes[] = {
+                    GLX_PBUFFER_WIDTH, 1,
+                    GLX_PBUFFER_HEIGHT, 1,
+                    None
+            };
+
+            mSharedPbuffer = glXCreatePbuffer(mDisplay, mFbConfig, pbufferAttributes);
+        }
+
+        if (!mSharedPbuffer) {
+            XSetWindowAttributes windowAttributes;
+            windowAttributes.colormap = mColorMap;
+            windowAttributes.border_pixel = 0;
+
+            mSharedWindow = XCreateWindow(
+                mDisplay,
+                XRootWindow(mDisplay, mScreen),
+                0, 0,
+                1, 1,
+                0,
+                mVisualInfo->depth,
+                InputOutput,
+                mVisualInfo->visual,
+                CWColormap | CWBorderPixel,
+                &windowAttributes
+            );
+
+            CHECK_MSG(mSharedWindow, "Failed to create hidden window for shared context");
+        }
+    }
+
+    void HwContext::DestroySharedContext() {
+        if (!mSharedContext) {
+            return;
+        }
+
+        glXDestroyContext(mDisplay, mSharedContext);
+        mSharedDebugOutputInstalled = false;
+
+        if (mSharedPbuffer) {
+            glXDestroyPbuffer(mDisplay, mSharedPbuffer);
+        }
+        if (mSharedWindow) {
+            XDestroyWindow(mDisplay, mSharedWindow);
+        }
+
+        mSharedContext = nullptr;
+        mSharedPbuffer = 0;
+        mSharedWindow = 0;
+    }
+
+    void HwContext::MakeSharedContextCurrent() {
+        assert(mSharedContext);
+        GLXDrawable drawable = mSharedPbuffer ? mSharedPbuffer : mSharedWindow;
+        CHECK(glXMakeContextCurrent(mDisplay, drawable, drawable, mSharedContext));
+
+        if (mDebugOutput && !mSharedDebugOutputInstalled) {
+            mSharedDebugOutputInstalled = mDebugOutput->Install();
+        }
+    }
+
+    void HwContext::ReleaseSharedContextCurrent() {
+        glXMakeContextCurrent(mDisplay, None, None, nullptr);
     }
 
     bool HwContext::IsCreated() {
@@ -176,16 +356,45 @@ namespace x11hw {
     void HwContext::MakeContextCurrent(Window window) {
         assert(IsCreated());
         CHECK(glXMakeCurrent(mDisplay, window, mContext));
+        HwDeletionQueue::SetCurrent(mDeletionQueue.get());
+
+        if (mDebugOutput && !mDebugOutputInstalled) {
+            mDebugOutputInstalled = mDebugOutput->Install();
+        }
+
+        // Enable state is per context, set it once the context is current for the first time
+        if (mFramebufferSrgb && !mFramebufferSrgbEnabled) {
+            glEnable(GL_FRAMEBUFFER_SRGB);
+            mFramebufferSrgbEnabled = true;
+        }
     }
 
     void HwContext::SwapBuffers(Window window) {
         assert(IsCreated());
         glXSwapBuffers(mDisplay, window);
+
+        // Objects released during this frame are deleted once GPU is done with it
+        mDeletionQueue->EndFrame();
+        mDeletionQueue->Drain(std::chrono::microseconds{DELETION_BUDGET_US});
     }
 
-    void HwContext::SetSwapInterval(Window window, int interval) {
+    glm::uvec2 HwContext::QueryDrawableSize(Window window) const {
+        unsigned int width = 0;
+        unsigned int height = 0;
+
+        glXQueryDrawable(mDisplay, window, GLX_WIDTH, &width);
+        glXQueryDrawable(mDisplay, window, GLX_HEIGHT, &height);
+
+        return {width, height};
+    }
+
+    int HwContext::SetSwapInterval(Window window, int interval) {
         assert(IsCreated());
-        assert(interval >= 0);
+
+        // Negative interval: sync to vblank, but tear instead of waiting for the next one, if frame is late
+        if (interval < 0 && !mglXSwapControlTearSupport) {
+            interval = -interval;
+        }
 
         if (mglXSwapIntervalEXTSupport) {
             mglXSwapIntervalEXT(mDisplay, window, interval);
@@ -196,6 +405,31 @@ namespace x11hw {
         else if (mglXSwapIntervalSGISupport) {
             mglXSwapIntervalSGI(interval);
         }
+        else {
+            return 0;
+        }
+
+        return interval;
+    }
+
+    bool HwContext::GetSyncValues(Window window, int64_t &ust, int64_t &msc, int64_t &sbc) {
+        assert(IsCreated());
+
+        if (!mglXSyncControlOMLSupport) {
+            return false;
+        }
+
+        return mglXGetSyncValuesOML(mDisplay, window, &ust, &msc, &sbc) == True;
+    }
+
+    bool HwContext::WaitForSwap(Window window, int64_t targetSbc, int64_t &ust, int64_t &msc, int64_t &sbc) {
+        assert(IsCreated());
+
+        if (!mglXSyncControlOMLSupport) {
+            return false;
+        }
+
+        return mglXWaitForSbcOML(mDisplay, window, targetSbc, &ust, &msc, &sbc) == True;
     }
 
     XVisualInfo * HwContext::GetVisualInfo() const {
@@ -210,4 +444,24 @@ namespace x11hw {
         return mColorMap;
     }
 
+    const HwFramebufferInfo &HwContext::GetFramebufferInfo() const {
+        return mFramebufferInfo;
+    }
+
+    bool HwContext::IsSwapTearSupported() const {
+        return mglXSwapControlTearSupport;
+    }
+
+    bool HwContext::IsFramebufferSrgb() const {
+        return mFramebufferSrgb;
+    }
+
+    HwContextMode HwContext::GetMode() const {
+        return mMode;
+    }
+
+    const HwDebugOutput *HwContext::GetDebugOutput() const {
+        return mDebugOutput.get();
+    }
+
 }
\ No newline at end of file
@@ -25,9 +25,13 @@
 #ifndef X11HELLOWORLD_CONTEXT_HPP
 #define X11HELLOWORLD_CONTEXT_HPP
 
+#include <GL/glew.h>
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 #include <GL/glx.h>
+#include <x11hw/context_config.hpp>
+#include <glm/vec2.hpp>
+#include <memory>
 
 namespace x11hw {
 
@@ -36,6 +40,9 @@ namespace x11hw {
         static const int GLX_MAJOR_MIN = 1;
         static const int GLX_MINOR_MIN = 2;
 
+        /** Max time per frame spent on deleting retired GL objects */
+        static const int DELETION_BUDGET_US = 500;
+
         HwContext(const HwContext &) = delete;
         HwContext(HwContext &&) = delete;
         ~HwContext();
@@ -43,27 +50,45 @@ namespace x11hw {
     private:
         friend class HwWindowManager;
         friend class HwWindow;
+        friend class HwUploader;
 
-        HwContext(Display *display, int screen);
+        HwContext(Display *display, int screen, const HwContextConfig &config);
 
         void CreateContext();
         bool IsCreated();
         void MakeContextCurrent(Window window);
         void SwapBuffers(Window window);
-        void SetSwapInterval(Window window, int interval);
+        int SetSwapInterval(Window window, int interval);
+        bool GetSyncValues(Window window, int64_t &ust, int64_t &msc, int64_t &sbc);
+        bool WaitForSwap(Window window, int64_t targetSbc, int64_t &ust, int64_t &msc, int64_t &sbc);
+        glm::uvec2 QueryDrawableSize(Window window) const;
+
+        void CreateSharedContext();
+        void DestroySharedContext();
+        void MakeSharedContextCurrent();
+        void ReleaseSharedContextCurrent();
 
         XVisualInfo *GetVisualInfo() const;
         GLXFBConfig GetFBConfig() const;
         Colormap GetColorMap() const;
+        const HwFramebufferInfo &GetFramebufferInfo() const;
+        bool IsFramebufferSrgb() const;
+        bool IsSwapTearSupported() const;
+        HwContextMode GetMode() const;
+        const class HwDebugOutput *GetDebugOutput() const;
 
     private:
         typedef void (*glXSwapIntervalEXT)(Display*,GLXDrawable,int);
         typedef int (*glXSwapIntervalSGI)(int);
         typedef int (*glXSwapIntervalMESA)(int);
+        typedef Bool (*glXGetSyncValuesOML)(Display*,GLXDrawable,int64_t*,int64_t*,int64_t*);
+        typedef Bool (*glXWaitForSbcOML)(Display*,GLXDrawable,int64_t,int64_t*,int64_t*,int64_t*);
 
         void ValidateGlxVersion();
         void SelectFBConfig();
+        HwFramebufferInfo QueryFramebufferInfo(GLXFBConfig fbConfig, bool srgbSupported) const;
         void CreateVisualInfo();
+        GLXContext CreateContextInternal(GLXContext shareContext);
 
         int mScreen = -1;
         Display *mDisplay = nullptr;
@@ -71,14 +96,40 @@ namespace x11hw {
         GLXFBConfig mFbConfig = nullptr;
         Colormap mColorMap{};
         XVisualInfo *mVisualInfo = nullptr;
+        std::unique_ptr<class HwDeletionQueue> mDeletionQueue;
+
+        // Requested config and mode of created context (may fall back to Default)
+        HwContextConfig mConfig;
+        HwContextMode mMode = HwContextMode::Default;
+        std::unique_ptr<class HwDebugOutput> mDebugOutput;
+        bool mDebugOutputInstalled = false;
+        bool mSharedDebugOutputInstalled = false;
+
+        // Attributes of the config selected by mConfig.framebuffer policy
+        HwFramebufferInfo mFramebufferInfo;
+
+        // Default framebuffer encodes linear color into sRGB (GL_FRAMEBUFFER_SRGB is enabled)
+        bool mFramebufferSrgb = false;
+        bool mFramebufferSrgbEnabled = false;
+
+        // Context of the same share group for background work (bound to hidden drawable)
+        GLXContext mSharedContext = nullptr;
+        GLXPbuffer mSharedPbuffer = 0;
+        Window mSharedWindow = 0;
 
         glXSwapIntervalEXT mglXSwapIntervalEXT = nullptr;
         glXSwapIntervalMESA mglXSwapIntervalMESA = nullptr;
         glXSwapIntervalSGI mglXSwapIntervalSGI = nullptr;
+        glXGetSyncValuesOML mglXGetSyncValuesOML = nullptr;
+        glXWaitForSbcOML mglXWaitForSbcOML = nullptr;
 
         bool mglXSwapIntervalEXTSupport = false;
         bool mglXSwapIntervalMESASupport = false;
         bool mglXSwapIntervalSGISupport = false;
+        bool mglXSwapControlTearSupport = false;
+        bool mglXSyncControlOMLSupport = false;
+        bool mglXCreateContextAttribsARBSupport = false;
+        bool mglXCreateContextNoErrorARBSupport = false;
     };
 
 }
@@ -0,0 +1,60 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_CONTEXT_CONFIG_HPP
+#define X11HELLOWORLD_CONTEXT_CONFIG_HPP
+
+#include <x11hw/framebuffer_config.hpp>
+#include <cstddef>
+
+namespace x11hw {
+
+    enum class HwContextMode {
+        /** Regular context: errors are generated, but not reported */
+        Default,
+        /** GLX_ARB_create_context_no_error context: no error checks in the driver (production) */
+        NoError,
+        /** Debug context: driver messages are collected by HwDebugOutput (development) */
+        Debug
+    };
+
+    /** Parameters of GL context of the windows (passed to HwWindowManager) */
+    struct HwContextConfig {
+        int majorVersion = 3;
+        int minorVersion = 2;
+        bool forwardCompatible = true;
+        HwContextMode mode = HwContextMode::Default;
+
+        /** Debug mode: max number of messages printed per second (others are counted only) */
+        size_t debugMessagesPerSecond = 20;
+        /** Debug mode: print notification messages (performance hints of some drivers) */
+        bool debugNotifications = false;
+
+        /** Default framebuffer config selection policy */
+        HwFramebufferConfig framebuffer;
+    };
+
+}
+
+#endif //X11HELLOWORLD_CONTEXT_CONFIG_HPP
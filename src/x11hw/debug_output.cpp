@@ -0,0 +1,220 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/debug_output.hpp>
+#include <GL/glx.h>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+namespace x11hw {
+
+    static void APIENTRY DebugMessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity,
+                                              GLsizei length, const GLchar *message, const void *userParam) {
+        auto output = (HwDebugOutput *) userParam;
+        // Length excludes the terminator, some drivers pass negative value for null-terminated messages
+        output->OnMessage(source, type, id, severity, length >= 0 ? std::string(message, (size_t) length) : std::string(message));
+    }
+
+    HwDebugOutput::HwDebugOutput(size_t messagesPerSecond, bool notifications) {
+        mMessagesPerSecond = messagesPerSecond;
+        mNotifications = notifications;
+        mWindowStart = std::chrono::steady_clock::now();
+    }
+
+    bool HwDebugOutput::Install() {
+        // Called right after context is made current, before GLEW is initialized, so load entry points here
+        auto debugMessageCallback = (PFNGLDEBUGMESSAGECALLBACKPROC)
+                glXGetProcAddressARB((const GLubyte *) "glDebugMessageCallback");
+        auto debugMessageControl = (PFNGLDEBUGMESSAGECONTROLPROC)
+                glXGetProcAddressARB((const GLubyte *) "glDebugMessageControl");
+
+        if (!debugMessageCallback || !debugMessageControl) {
+            return false;
+        }
+
+        glEnable(GL_DEBUG_OUTPUT);
+        // Message is reported from the call, which caused it (breakpoint in OnMessage shows the caller)
+        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+
+        debugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+        debugMessageCallback((GLDEBUGPROC) DebugMessageCallback, this);
+
+        return true;
+    }
+
+    void HwDebugOutput::OnMessage(GLenum source, GLenum type, GLuint id, GLenum severity, const std::string &message) {
+        // Text is a part of the key: some drivers report every message with id 0, others reuse
+        // one id for messages with different text (e.g. same warning about different objects)
+        uint64_t key = (uint64_t) std::hash<std::string>()(message);
+        key = key * 31 + id;
+        key = key * 31 + source;
+        key = key * 31 + type;
+        key = key * 31 + severity;
+
+        auto category = GetCategory(type);
+        bool print = false;
+
+        {
+            std::lock_guard<std::mutex> guard(mMutex);
+
+            mStats.received += 1;
+            mStats.categories[(size_t) category] += 1;
+
+            auto found = mEntries.find(key);
+
+            if (found != mEntries.end()) {
+                found->second.count += 1;
+                mStats.suppressed += 1;
+                return;
+            }
+
+            mEntries.emplace(key, Entry{message, category, severity, 1});
+            mStats.unique += 1;
+
+            if (severity == GL_DEBUG_SEVERITY_NOTIFICATION && !mNotifications) {
+                mStats.suppressed += 1;
+                return;
+            }
+
+            auto now = std::chrono::steady_clock::now();
+
+            if (now - mWindowStart >= std::chrono::seconds(1)) {
+                mWindowStart = now;
+                mPrintedInWindow = 0;
+            }
+
+            if (mPrintedInWindow < mMessagesPerSecond) {
+                mPrintedInWindow += 1;
+                mStats.printed += 1;
+                print = true;
+            }
+            else {
+                mStats.suppressed += 1;
+            }
+        }
+
+        if (print) {
+            std::cerr << "GL " << GetSeverityName(severity) << " [" << GetCategoryName(category) << ", "
+                      << GetSourceName(source) << ", id " << id << "]: " << message << std::endl;
+        }
+    }
+
+    HwDebugOutput::Stats HwDebugOutput::GetStats() const {
+        std::lock_guard<std::mutex> guard(mMutex);
+        return mStats;
+    }
+
+    void HwDebugOutput::Report(std::ostream &stream) const {
+        static const size_t MAX_REPORTED = 10;
+
+        std::lock_guard<std::mutex> guard(mMutex);
+
+        stream << "GL debug output: " << mStats.received << " messages, " << mStats.unique << " unique, "
+               << mStats.printed << " printed, " << mStats.suppressed << " suppressed" << std::endl;
+
+        for (size_t i = 0; i < (size_t) Category::Count; i++) {
+            if (mStats.categories[i] > 0) {
+                stream << "  " << GetCategoryName((Category) i) << ": " << mStats.categories[i] << std::endl;
+            }
+        }
+
+        std::vector<const Entry *> entries;
+        for (auto& entry: mEntries) {
+            entries.push_back(&entry.second);
+        }
+
+        std::sort(entries.begin(), entries.end(), [](const Entry *a, const Entry *b) { return a->count > b->count; });
+
+        for (size_t i = 0; i < entries.size() && i < MAX_REPORTED; i++) {
+            stream << "  " << entries[i]->count << "x " << GetSeverityName(entries[i]->severity) << " "
+                   << GetCategoryName(entries[i]->category) << ": " << entries[i]->message << std::endl;
+        }
+    }
+
+    const char *HwDebugOutput::GetCategoryName(Category category) {
+        switch (category) {
+            case Category::Error:
+                return "error";
+            case Category::Deprecated:
+                return "deprecated";
+            case Category::UndefinedBehavior:
+                return "undefined behavior";
+            case Category::Portability:
+                return "portability";
+            case Category::Performance:
+                return "performance";
+            default:
+                return "other";
+        }
+    }
+
+    HwDebugOutput::Category HwDebugOutput::GetCategory(GLenum type) {
+        switch (type) {
+            case GL_DEBUG_TYPE_ERROR:
+                return Category::Error;
+            case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
+                return Category::Deprecated;
+            case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
+                return Category::UndefinedBehavior;
+            case GL_DEBUG_TYPE_PORTABILITY:
+                return Category::Portability;
+            case GL_DEBUG_TYPE_PERFORMANCE:
+                return Category::Performance;
+            default:
+                return Category::Other;
+        }
+    }
+
+    const char *HwDebugOutput::GetSourceName(GLenum source) {
+        switch (source) {
+            case GL_DEBUG_SOURCE_API:
+                return "api";
+            case GL_DEBUG_SOURCE_WINDOW_SYSTEM:
+                return "window system";
+            case GL_DEBUG_SOURCE_SHADER_COMPILER:
+                return "shader compiler";
+            case GL_DEBUG_SOURCE_THIRD_PARTY:
+                return "third party";
+            case GL_DEBUG_SOURCE_APPLICATION:
+                return "application";
+            default:
+                return "other";
+        }
+    }
+
+    const char *HwDebugOutput::GetSeverityName(GLenum severity) {
+        switch (severity) {
+            case GL_DEBUG_SEVERITY_HIGH:
+                return "high";
+            case GL_DEBUG_SEVERITY_MEDIUM:
+                return "medium";
+            case GL_DEBUG_SEVERITY_LOW:
+                return "low";
+            default:
+                return "notification";
+        }
+    }
+
+}
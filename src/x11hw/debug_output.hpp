@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_DEBUG_OUTPUT_HPP
+#define X11HELLOWORLD_DEBUG_OUTPUT_HPP
+
+#include <GL/glew.h>
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+
+namespace x11hw {
+
+    /**
+     * Sink for KHR_debug messages of debug context.
+     * Repeated messages (same source, type, id, severity and text) are printed once and then only counted,
+     * printing is limited by messages per second, so a message in the draw loop does not flood the output.
+     * Thread-safe: callback is also installed for the shared context of the uploader.
+     */
+    class HwDebugOutput {
+    public:
+        enum class Category {
+            Error,
+            Deprecated,
+            UndefinedBehavior,
+            Portability,
+            Performance,
+            Other,
+            Count
+        };
+
+        struct Stats {
+            size_t received = 0;
+            size_t unique = 0;
+            size_t printed = 0;
+            size_t suppressed = 0;
+            size_t categories[(size_t) Category::Count] = {};
+        };
+
+        HwDebugOutput(size_t messagesPerSecond, bool notifications);
+        HwDebugOutput(const HwDebugOutput&) = delete;
+        HwDebugOutput(HwDebugOutput&&) = delete;
+
+        /**
+         * Enable debug output in the current context and set this sink as its callback
+         * @return True if KHR_debug (or GL 4.3) callback is available
+         */
+        bool Install();
+
+        /** Process message (called by the driver) */
+        void OnMessage(GLenum source, GLenum type, GLuint id, GLenum severity, const std::string &message);
+
+        /** @return Accumulated statistics */
+        Stats GetStats() const;
+
+        /** Print statistics and the most frequent messages */
+        void Report(std::ostream &stream) const;
+
+        /** @return Category name */
+        static const char *GetCategoryName(Category category);
+
+    private:
+        struct Entry {
+            std::string message;
+            Category category;
+            GLenum severity;
+            size_t count;
+        };
+
+        static Category GetCategory(GLenum type);
+        static const char *GetSourceName(GLenum source);
+        static const char *GetSeverityName(GLenum severity);
+
+        mutable std::mutex mMutex;
+        std::unordered_map<uint64_t, Entry> mEntries;
+        Stats mStats;
+
+        size_t mMessagesPerSecond;
+        size_t mPrintedInWindow = 0;
+        std::chrono::steady_clock::time_point mWindowStart;
+        bool mNotifications;
+    };
+
+}
+
+#endif //X11HELLOWORLD_DEBUG_OUTPUT_HPP
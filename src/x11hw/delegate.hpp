@@ -0,0 +1,167 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_DELEGATE_HPP
+#define X11HELLOWORLD_DELEGATE_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace x11hw {
+
+    /** Default inline storage of the delegate: enough for lambda with four captured references */
+    static const size_t HW_DELEGATE_CAPACITY = 4 * sizeof(void *);
+
+    template<typename Signature, size_t Capacity = HW_DELEGATE_CAPACITY>
+    class HwDelegate;
+
+    /**
+     * Callable wrapper with inline storage (never allocates, unlike std::function).
+     * Callable must fit into Capacity bytes, what is checked at compile time.
+     *
+     * @tparam R Return type
+     * @tparam Args Arguments types
+     * @tparam Capacity Size of inline storage
+     */
+    template<typename R, typename... Args, size_t Capacity>
+    class HwDelegate<R(Args...), Capacity> {
+    public:
+        HwDelegate() = default;
+
+        template<typename Callable, typename = typename std::enable_if<
+                !std::is_same<typename std::decay<Callable>::type, HwDelegate>::value>::type>
+        HwDelegate(Callable &&callable) {
+            typedef typename std::decay<Callable>::type Stored;
+
+            static_assert(sizeof(Stored) <= Capacity, "Callable does not fit into delegate storage");
+            static_assert(alignof(Stored) <= alignof(Storage), "Callable alignment is not supported by delegate storage");
+
+            new (&mStorage) Stored(std::forward<Callable>(callable));
+            mInvoke = &Invoke<Stored>;
+            mManage = &Manage<Stored>;
+        }
+
+        HwDelegate(const HwDelegate &other) {
+            if (other.mManage) {
+                other.mManage(Operation::Copy, &mStorage, const_cast<Storage *>(&other.mStorage));
+                mInvoke = other.mInvoke;
+                mManage = other.mManage;
+            }
+        }
+
+        HwDelegate(HwDelegate &&other) noexcept {
+            if (other.mManage) {
+                other.mManage(Operation::Move, &mStorage, &other.mStorage);
+                mInvoke = other.mInvoke;
+                mManage = other.mManage;
+                other.Reset();
+            }
+        }
+
+        ~HwDelegate() {
+            Reset();
+        }
+
+        HwDelegate &operator=(const HwDelegate &other) {
+            if (this != &other) {
+                HwDelegate copy(other);
+                *this = std::move(copy);
+            }
+
+            return *this;
+        }
+
+        HwDelegate &operator=(HwDelegate &&other) noexcept {
+            if (this != &other) {
+                Reset();
+
+                if (other.mManage) {
+                    other.mManage(Operation::Move, &mStorage, &other.mStorage);
+                    mInvoke = other.mInvoke;
+                    mManage = other.mManage;
+                    other.Reset();
+                }
+            }
+
+            return *this;
+        }
+
+        R operator()(Args... args) const {
+            return mInvoke(const_cast<Storage *>(&mStorage), std::forward<Args>(args)...);
+        }
+
+        explicit operator bool() const { return mInvoke != nullptr; }
+
+        /** Destroy stored callable */
+        void Reset() {
+            if (mManage) {
+                mManage(Operation::Destroy, &mStorage, nullptr);
+            }
+
+            mInvoke = nullptr;
+            mManage = nullptr;
+        }
+
+    private:
+        typedef typename std::aligned_storage<Capacity, alignof(std::max_align_t)>::type Storage;
+
+        enum class Operation {
+            Copy,
+            Move,
+            Destroy
+        };
+
+        typedef R (*InvokeFunction)(void *storage, Args&&... args);
+        typedef void (*ManageFunction)(Operation operation, void *storage, void *other);
+
+        template<typename Stored>
+        static R Invoke(void *storage, Args&&... args) {
+            return (*reinterpret_cast<Stored *>(storage))(std::forward<Args>(args)...);
+        }
+
+        template<typename Stored>
+        static void Manage(Operation operation, void *storage, void *other) {
+            switch (operation) {
+                case Operation::Copy:
+                    new (storage) Stored(*reinterpret_cast<const Stored *>(other));
+                    break;
+                case Operation::Move:
+                    new (storage) Stored(std::move(*reinterpret_cast<Stored *>(other)));
+                    break;
+                case Operation::Destroy:
+                    reinterpret_cast<Stored *>(storage)->~Stored();
+                    break;
+            }
+        }
+
+        Storage mStorage;
+        InvokeFunction mInvoke = nullptr;
+        ManageFunction mManage = nullptr;
+    };
+
+}
+
+#endif //X11HELLOWORLD_DELEGATE_HPP
@@ -0,0 +1,205 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/deletion_queue.hpp>
+#include <cassert>
+
+namespace x11hw {
+
+    static thread_local HwDeletionQueue *gCurrentQueue = nullptr;
+
+    HwDeletionQueue::~HwDeletionQueue() {
+        Flush();
+    }
+
+    HwDeletionQueue *HwDeletionQueue::GetCurrent() {
+        return gCurrentQueue;
+    }
+
+    void HwDeletionQueue::SetCurrent(HwDeletionQueue *queue) {
+        gCurrentQueue = queue;
+    }
+
+    void HwDeletionQueue::RetireBuffer(GLuint buffer, size_t size, GLenum usage) {
+        Retire({ObjectType::Buffer, buffer, size, usage});
+    }
+
+    void HwDeletionQueue::RetireVertexArray(GLuint vertexArray) {
+        Retire({ObjectType::VertexArray, vertexArray, 0, 0});
+    }
+
+    void HwDeletionQueue::RetireProgram(GLuint program) {
+        Retire({ObjectType::Program, program, 0, 0});
+    }
+
+    void HwDeletionQueue::RetireShader(GLuint shader) {
+        Retire({ObjectType::Shader, shader, 0, 0});
+    }
+
+    void HwDeletionQueue::RetireTexture(GLuint texture) {
+        Retire({ObjectType::Texture, texture, 0, 0});
+    }
+
+    GLuint HwDeletionQueue::AcquireBuffer(size_t size, GLenum usage) {
+        auto found = mRecycled.find({size, usage});
+
+        if (found == mRecycled.end() || found->second.empty()) {
+            return 0;
+        }
+
+        GLuint buffer = found->second.back();
+        found->second.pop_back();
+        mRecycledBytes -= size;
+        mReusedBuffers += 1;
+
+        return buffer;
+    }
+
+    void HwDeletionQueue::EndFrame() {
+        if (mCurrent.objects.empty()) {
+            return;
+        }
+
+        mCurrent.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        mPending.push_back(std::move(mCurrent));
+        mCurrent = Batch();
+    }
+
+    void HwDeletionQueue::Drain(std::chrono::microseconds budget) {
+        auto start = std::chrono::steady_clock::now();
+
+        while (!mPending.empty()) {
+            auto& batch = mPending.front();
+
+            if (batch.fence) {
+                // Fences are signalled in order, so stop on first not signalled
+                GLenum status = glClientWaitSync(batch.fence, 0, 0);
+                if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+                    return;
+                }
+
+                glDeleteSync(batch.fence);
+                batch.fence = nullptr;
+            }
+
+            while (!batch.objects.empty()) {
+                Release(batch.objects.back());
+                batch.objects.pop_back();
+
+                if (std::chrono::steady_clock::now() - start >= budget) {
+                    if (batch.objects.empty()) {
+                        mPending.pop_front();
+                    }
+                    return;
+                }
+            }
+
+            mPending.pop_front();
+        }
+    }
+
+    void HwDeletionQueue::Flush() {
+        EndFrame();
+
+        for (auto& batch: mPending) {
+            if (batch.fence) {
+                glClientWaitSync(batch.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+                glDeleteSync(batch.fence);
+            }
+
+            for (auto& object: batch.objects) {
+                Delete(object);
+            }
+        }
+
+        for (auto& entry: mRecycled) {
+            for (auto buffer: entry.second) {
+                Delete({ObjectType::Buffer, buffer, entry.first.first, entry.first.second});
+            }
+        }
+
+        mPending.clear();
+        mRecycled.clear();
+        mRecycledBytes = 0;
+    }
+
+    HwDeletionQueue::Stats HwDeletionQueue::GetStats() const {
+        Stats stats;
+        stats.pendingObjects = mCurrent.objects.size();
+        stats.pendingFences = mPending.size();
+        stats.recycledBytes = mRecycledBytes;
+        stats.deletedObjects = mDeletedObjects;
+        stats.reusedBuffers = mReusedBuffers;
+
+        for (auto& batch: mPending) {
+            stats.pendingObjects += batch.objects.size();
+        }
+        for (auto& entry: mRecycled) {
+            stats.recycledBuffers += entry.second.size();
+        }
+
+        return stats;
+    }
+
+    void HwDeletionQueue::Retire(const Object &object) {
+        assert(object.handle);
+        mCurrent.objects.push_back(object);
+    }
+
+    void HwDeletionQueue::Release(const Object &object) {
+        // Buffers of unknown size (0) are not recycled
+        bool recyclable = object.type == ObjectType::Buffer && object.size > 0;
+
+        if (recyclable && mRecycledBytes + object.size <= MAX_RECYCLED_BYTES) {
+            mRecycled[{object.size, object.usage}].push_back(object.handle);
+            mRecycledBytes += object.size;
+            return;
+        }
+
+        Delete(object);
+    }
+
+    void HwDeletionQueue::Delete(const Object &object) {
+        switch (object.type) {
+            case ObjectType::Buffer:
+                glDeleteBuffers(1, &object.handle);
+                break;
+            case ObjectType::VertexArray:
+                glDeleteVertexArrays(1, &object.handle);
+                break;
+            case ObjectType::Program:
+                glDeleteProgram(object.handle);
+                break;
+            case ObjectType::Shader:
+                glDeleteShader(object.handle);
+                break;
+            case ObjectType::Texture:
+                glDeleteTextures(1, &object.handle);
+                break;
+        }
+
+        mDeletedObjects += 1;
+    }
+
+}
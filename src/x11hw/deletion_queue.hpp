@@ -0,0 +1,131 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_DELETION_QUEUE_HPP
+#define X11HELLOWORLD_DELETION_QUEUE_HPP
+
+#include <GL/glew.h>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace x11hw {
+
+    /**
+     * Per-context queue of GL objects, which are released but may still be used by the GPU.
+     * Objects retired during frame are guarded by single fence, inserted at the end of the frame,
+     * and physically deleted once the fence is signalled. Retired buffers are kept for reuse
+     * by allocations of the same size and usage.
+     */
+    class HwDeletionQueue {
+    public:
+        struct Stats {
+            size_t pendingObjects = 0;
+            size_t pendingFences = 0;
+            size_t recycledBuffers = 0;
+            size_t recycledBytes = 0;
+            size_t deletedObjects = 0;
+            size_t reusedBuffers = 0;
+        };
+
+        static const size_t MAX_RECYCLED_BYTES = 64 * 1024 * 1024;
+
+        HwDeletionQueue() = default;
+        HwDeletionQueue(const HwDeletionQueue&) = delete;
+        HwDeletionQueue(HwDeletionQueue&&) = delete;
+        ~HwDeletionQueue();
+
+        /** @return Queue of the context current on this thread (may be null) */
+        static HwDeletionQueue *GetCurrent();
+
+        /** Set queue of the context current on this thread */
+        static void SetCurrent(HwDeletionQueue *queue);
+
+        void RetireBuffer(GLuint buffer, size_t size, GLenum usage);
+        void RetireVertexArray(GLuint vertexArray);
+        void RetireProgram(GLuint program);
+        void RetireShader(GLuint shader);
+        void RetireTexture(GLuint texture);
+
+        /**
+         * Take buffer with already allocated storage of exactly this size and usage
+         * @param size Buffer size in bytes
+         * @param usage Buffer usage
+         * @return Buffer or 0 if there is no buffer to reuse
+         */
+        GLuint AcquireBuffer(size_t size, GLenum usage);
+
+        /** Guard objects retired since previous call with fence (call after frame submission) */
+        void EndFrame();
+
+        /**
+         * Delete objects, which fences are signalled
+         * @param budget Max time to spend (checked after each object)
+         */
+        void Drain(std::chrono::microseconds budget);
+
+        /** Wait for all fences and delete all objects, including buffers kept for reuse */
+        void Flush();
+
+        /** @return Queue statistics */
+        Stats GetStats() const;
+
+    private:
+        enum class ObjectType {
+            Buffer,
+            VertexArray,
+            Program,
+            Shader,
+            Texture
+        };
+
+        struct Object {
+            ObjectType type;
+            GLuint handle;
+            size_t size;
+            GLenum usage;
+        };
+
+        struct Batch {
+            GLsync fence = nullptr;
+            std::vector<Object> objects;
+        };
+
+        void Retire(const Object &object);
+        void Release(const Object &object);
+        void Delete(const Object &object);
+
+        Batch mCurrent;
+        std::deque<Batch> mPending;
+        std::map<std::pair<size_t, GLenum>, std::vector<GLuint>> mRecycled;
+        size_t mRecycledBytes = 0;
+        size_t mDeletedObjects = 0;
+        size_t mReusedBuffers = 0;
+    };
+
+}
+
+#endif //X11HELLOWORLD_DELETION_QUEUE_HPP
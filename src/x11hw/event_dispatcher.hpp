@@ -0,0 +1,265 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_EVENT_DISPATCHER_HPP
+#define X11HELLOWORLD_EVENT_DISPATCHER_HPP
+
+#include <x11hw/delegate.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace x11hw {
+
+    /** Subscription token, used to unsubscribe the listener */
+    struct HwEventToken {
+        /** Owner of the events (e.g. window), ids of different owners overlap */
+        uint32_t owner = 0;
+        /** Source of the subscription (defined by the owner of the event) */
+        uint32_t channel = 0;
+        /** Listener id, 0 for invalid token */
+        uint32_t id = 0;
+
+        bool IsValid() const { return id != 0; }
+
+        /** @return New owner id, unique within the process (thread-safe) */
+        static uint32_t NewOwner() {
+            static std::atomic<uint32_t> next{0};
+            return ++next;
+        }
+    };
+
+    /**
+     * List of listeners of single event type.
+     * Dispatch does not allocate: listeners are delegates with inline storage.
+     * Listeners may subscribe and unsubscribe (themselves or others) while the event is dispatched,
+     * such changes are applied after dispatch (new listeners are not called for the current event).
+     *
+     * @tparam Args Arguments of the event
+     */
+    template<typename... Args>
+    class HwEventList {
+    public:
+        typedef HwDelegate<void(Args...)> Delegate;
+
+        /** Add listener with specified id (ids are managed by the owner) */
+        void Add(uint32_t id, Delegate delegate) {
+            assert(id != 0);
+
+            if (mDispatching) {
+                mAdded.push_back({id, std::move(delegate)});
+            }
+            else {
+                mListeners.push_back({id, std::move(delegate)});
+            }
+        }
+
+        /**
+         * Remove listener
+         * @param id Listener id
+         * @return True if listener was found
+         */
+        bool Remove(uint32_t id) {
+            bool found = false;
+
+            for (auto& listener: mListeners) {
+                if (listener.id == id) {
+                    // Removed entries are compacted once dispatch is finished
+                    listener.id = 0;
+                    mRemoved = true;
+                    found = true;
+                }
+            }
+
+            auto added = std::remove_if(mAdded.begin(), mAdded.end(), [id](const Listener &listener) { return listener.id == id; });
+            found = found || added != mAdded.end();
+            mAdded.erase(added, mAdded.end());
+
+            if (!mDispatching) {
+                Compact();
+            }
+
+            return found;
+        }
+
+        /** Call all listeners */
+        void Dispatch(Args... args) {
+            mDispatching += 1;
+
+            // Indexed access: listeners vector is not modified while dispatching
+            for (size_t i = 0; i < mListeners.size(); i++) {
+                if (mListeners[i].id != 0) {
+                    mListeners[i].delegate(args...);
+                }
+            }
+
+            mDispatching -= 1;
+
+            if (!mDispatching) {
+                Compact();
+            }
+        }
+
+        /** @return True if there are no listeners */
+        bool IsEmpty() const { return mListeners.empty() && mAdded.empty(); }
+
+    private:
+        struct Listener {
+            uint32_t id;
+            Delegate delegate;
+        };
+
+        void Compact() {
+            if (mRemoved) {
+                mListeners.erase(std::remove_if(mListeners.begin(), mListeners.end(), [](const Listener &listener) { return listener.id == 0; }), mListeners.end());
+                mRemoved = false;
+            }
+
+            for (auto& listener: mAdded) {
+                mListeners.push_back(std::move(listener));
+            }
+
+            mAdded.clear();
+        }
+
+        std::vector<Listener> mListeners;
+        std::vector<Listener> mAdded;
+        uint32_t mDispatching = 0;
+        bool mRemoved = false;
+    };
+
+    /**
+     * Single event type with its own listeners
+     * @tparam Args Arguments of the event
+     */
+    template<typename... Args>
+    class HwEvent {
+    public:
+        typedef typename HwEventList<Args...>::Delegate Delegate;
+
+        HwEvent(uint32_t owner, uint32_t channel) : mOwner(owner), mChannel(channel) {}
+
+        HwEventToken Subscribe(Delegate delegate) {
+            HwEventToken token;
+            token.owner = mOwner;
+            token.channel = mChannel;
+            token.id = ++mNextId;
+            mListeners.Add(token.id, std::move(delegate));
+            return token;
+        }
+
+        /** @return True if listener was found (tokens of other owners and channels are rejected) */
+        bool Unsubscribe(HwEventToken token) {
+            return token.owner == mOwner && token.channel == mChannel && token.IsValid() && mListeners.Remove(token.id);
+        }
+
+        void Dispatch(Args... args) { mListeners.Dispatch(args...); }
+
+        bool HasListeners() const { return !mListeners.IsEmpty(); }
+
+    private:
+        HwEventList<Args...> mListeners;
+        uint32_t mOwner;
+        uint32_t mChannel;
+        uint32_t mNextId = 0;
+    };
+
+    /**
+     * Events of several types with the same arguments: listeners subscribe to the types they need
+     * and are not called for others, so dispatch cost is proportional to the number of interested listeners.
+     *
+     * @tparam Type Enum of event types (values 0..TypesCount-1)
+     * @tparam TypesCount Number of event types
+     * @tparam Args Arguments of the event
+     */
+    template<typename Type, size_t TypesCount, typename... Args>
+    class HwEventDispatcher {
+    public:
+        typedef typename HwEventList<Args...>::Delegate Delegate;
+
+        HwEventDispatcher(uint32_t owner, uint32_t channel) : mOwner(owner), mChannel(channel) {}
+
+        /** Subscribe to single event type */
+        HwEventToken Subscribe(Type type, Delegate delegate) {
+            assert((size_t) type < TypesCount);
+
+            HwEventToken token;
+            token.owner = mOwner;
+            token.channel = mChannel;
+            token.id = ++mNextId;
+            mLists[(size_t) type].Add(token.id, std::move(delegate));
+            return token;
+        }
+
+        /** Subscribe to all event types with single token */
+        HwEventToken SubscribeAll(const Delegate &delegate) {
+            HwEventToken token;
+            token.owner = mOwner;
+            token.channel = mChannel;
+            token.id = ++mNextId;
+
+            for (auto& list: mLists) {
+                list.Add(token.id, delegate);
+            }
+
+            return token;
+        }
+
+        /** @return True if listener was found (tokens of other owners and channels are rejected) */
+        bool Unsubscribe(HwEventToken token) {
+            if (token.owner != mOwner || token.channel != mChannel || !token.IsValid()) {
+                return false;
+            }
+
+            bool found = false;
+
+            for (auto& list: mLists) {
+                found = list.Remove(token.id) || found;
+            }
+
+            return found;
+        }
+
+        void Dispatch(Type type, Args... args) {
+            assert((size_t) type < TypesCount);
+            mLists[(size_t) type].Dispatch(args...);
+        }
+
+        /** @return True if somebody listens to this type (event data may be not built otherwise) */
+        bool HasListeners(Type type) const {
+            return (size_t) type < TypesCount && !mLists[(size_t) type].IsEmpty();
+        }
+
+    private:
+        HwEventList<Args...> mLists[TypesCount];
+        uint32_t mOwner;
+        uint32_t mChannel;
+        uint32_t mNextId = 0;
+    };
+
+}
+
+#endif //X11HELLOWORLD_EVENT_DISPATCHER_HPP
@@ -0,0 +1,157 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/frame_arena.hpp>
+#include <algorithm>
+#include <cassert>
+
+namespace x11hw {
+
+    HwLinearArena::HwLinearArena() : HwLinearArena(InitParams()) {
+
+    }
+
+    HwLinearArena::HwLinearArena(const InitParams &params) {
+        assert(params.chunkSize > 0);
+        mChunkSize = params.chunkSize;
+    }
+
+    void *HwLinearArena::Allocate(size_t size, size_t alignment) {
+        assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+        while (true) {
+            if (mChunk < mChunks.size()) {
+                auto& chunk = mChunks[mChunk];
+                auto base = (uintptr_t) chunk.memory.get();
+                auto aligned = (base + mOffset + alignment - 1) & ~(uintptr_t) (alignment - 1);
+                auto offset = (size_t) (aligned - base);
+
+                if (offset + size <= chunk.size) {
+                    mOffset = offset + size;
+                    mAllocations += 1;
+                    mAllocatedBytes += size;
+                    mPeakBytes = std::max(mPeakBytes, mAllocatedBytes);
+                    return chunk.memory.get() + offset;
+                }
+
+                // Rest of the chunk is wasted until reset
+                mChunk += 1;
+                mOffset = 0;
+                continue;
+            }
+
+            AddChunk(size + alignment);
+        }
+    }
+
+    void HwLinearArena::Reset() {
+        // Frame working set did not fit into single chunk: merge, so next frames use one chunk
+        if (mChunks.size() > 1) {
+            size_t total = 0;
+            for (auto& chunk: mChunks) {
+                total += chunk.size;
+            }
+
+            mChunks.clear();
+            AddChunk(total);
+        }
+
+        mChunk = 0;
+        mOffset = 0;
+        mAllocations = 0;
+        mAllocatedBytes = 0;
+    }
+
+    HwLinearArena::Marker HwLinearArena::GetMarker() const {
+        Marker marker;
+        marker.chunk = mChunk;
+        marker.offset = mOffset;
+        marker.allocatedBytes = mAllocatedBytes;
+        return marker;
+    }
+
+    void HwLinearArena::Rewind(const Marker &marker) {
+        assert(marker.chunk < mChunk || (marker.chunk == mChunk && marker.offset <= mOffset));
+
+        mChunk = marker.chunk;
+        mOffset = marker.offset;
+        mAllocatedBytes = marker.allocatedBytes;
+    }
+
+    HwLinearArena::Stats HwLinearArena::GetStats() const {
+        Stats stats;
+        stats.allocations = mAllocations;
+        stats.allocatedBytes = mAllocatedBytes;
+        stats.peakBytes = mPeakBytes;
+        stats.heapAllocations = mHeapAllocations;
+
+        for (auto& chunk: mChunks) {
+            stats.capacity += chunk.size;
+        }
+
+        return stats;
+    }
+
+    HwLinearArena &HwLinearArena::GetThreadLocal() {
+        static thread_local HwLinearArena arena;
+        return arena;
+    }
+
+    void HwLinearArena::AddChunk(size_t minSize) {
+        Chunk chunk;
+        chunk.size = std::max(minSize, mChunkSize);
+        chunk.memory = std::unique_ptr<uint8_t[]>{new uint8_t[chunk.size]};
+
+        mChunks.push_back(std::move(chunk));
+        mHeapAllocations += 1;
+    }
+
+    HwFrameArena::HwFrameArena() : HwFrameArena(InitParams()) {
+
+    }
+
+    HwFrameArena::HwFrameArena(const InitParams &params) {
+        assert(params.framesInFlight > 0);
+
+        for (size_t i = 0; i < params.framesInFlight; i++) {
+            mArenas.emplace_back(new HwLinearArena(params.arena));
+        }
+    }
+
+    void HwFrameArena::BeginFrame() {
+        mCurrent = (mCurrent + 1) % mArenas.size();
+        mArenas[mCurrent]->Reset();
+    }
+
+    size_t HwFrameArena::GetHeapAllocations() const {
+        size_t allocations = 0;
+
+        for (auto& arena: mArenas) {
+            allocations += arena->GetStats().heapAllocations;
+        }
+
+        return allocations;
+    }
+
+}
@@ -0,0 +1,192 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_FRAME_ARENA_HPP
+#define X11HELLOWORLD_FRAME_ARENA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace x11hw {
+
+    /**
+     * Bump allocator for transient data: allocation is a pointer increment, memory is released
+     * all at once by Reset (or Rewind to marker), destructors are not called.
+     * Memory is kept in chunks, which are retained on reset, so once the arena is grown to
+     * the frame working set, it makes no heap allocations anymore.
+     * Not thread-safe: use thread-local arena (GetThreadLocal) from worker threads.
+     */
+    class HwLinearArena {
+    public:
+        struct InitParams {
+            size_t chunkSize = 1024 * 1024;
+        };
+
+        struct Stats {
+            size_t allocations = 0;
+            size_t allocatedBytes = 0;
+            size_t peakBytes = 0;
+            size_t capacity = 0;
+            /** Heap allocations made by the arena itself (chunks) */
+            size_t heapAllocations = 0;
+        };
+
+        /** Position in the arena to rewind to */
+        struct Marker {
+            size_t chunk = 0;
+            size_t offset = 0;
+            size_t allocatedBytes = 0;
+        };
+
+        HwLinearArena();
+        explicit HwLinearArena(const InitParams &params);
+        HwLinearArena(const HwLinearArena&) = delete;
+        HwLinearArena(HwLinearArena&&) = delete;
+        ~HwLinearArena() = default;
+
+        /**
+         * Allocate memory
+         * @param size Size in bytes
+         * @param alignment Alignment (power of two)
+         * @return Pointer, valid until Reset or Rewind behind it
+         */
+        void *Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+        /** Release all allocations. If several chunks were used, they are merged into single one */
+        void Reset();
+
+        /** @return Current position */
+        Marker GetMarker() const;
+
+        /** Release allocations made after marker */
+        void Rewind(const Marker &marker);
+
+        /** @return Arena statistics (allocations are counted since last Reset) */
+        Stats GetStats() const;
+
+        /** @return Arena of the calling thread (created on first call) */
+        static HwLinearArena &GetThreadLocal();
+
+    private:
+        struct Chunk {
+            std::unique_ptr<uint8_t[]> memory;
+            size_t size;
+        };
+
+        void AddChunk(size_t minSize);
+
+        std::vector<Chunk> mChunks;
+        size_t mChunkSize;
+        size_t mChunk = 0;
+        size_t mOffset = 0;
+        size_t mAllocations = 0;
+        size_t mAllocatedBytes = 0;
+        size_t mPeakBytes = 0;
+        size_t mHeapAllocations = 0;
+    };
+
+    /** Rewinds arena to the position at construction on scope exit (for jobs on worker threads) */
+    class HwArenaScope {
+    public:
+        explicit HwArenaScope(HwLinearArena &arena) : mArena(arena), mMarker(arena.GetMarker()) {}
+        HwArenaScope(const HwArenaScope&) = delete;
+        HwArenaScope(HwArenaScope&&) = delete;
+        ~HwArenaScope() { mArena.Rewind(mMarker); }
+
+    private:
+        HwLinearArena &mArena;
+        HwLinearArena::Marker mMarker;
+    };
+
+    /**
+     * Arena per frame in flight: arena of frame N is reset, when frame N + framesInFlight begins,
+     * so data referenced by frames still processed by the pipeline or the GPU stays valid.
+     */
+    class HwFrameArena {
+    public:
+        struct InitParams {
+            size_t framesInFlight = 3;
+            HwLinearArena::InitParams arena;
+        };
+
+        HwFrameArena();
+        explicit HwFrameArena(const InitParams &params);
+        HwFrameArena(const HwFrameArena&) = delete;
+        HwFrameArena(HwFrameArena&&) = delete;
+
+        /** Switch to arena of the next frame and reset it */
+        void BeginFrame();
+
+        /** @return Arena of the current frame */
+        HwLinearArena &Get() { return *mArenas[mCurrent]; }
+
+        /** @return Total heap allocations made by arenas */
+        size_t GetHeapAllocations() const;
+
+    private:
+        std::vector<std::unique_ptr<HwLinearArena>> mArenas;
+        size_t mCurrent = 0;
+    };
+
+    /**
+     * STL allocator adapter: deallocation is no-op, memory is released with the arena
+     * @tparam T Type of the elements
+     */
+    template<typename T>
+    class HwArenaAllocator {
+    public:
+        typedef T value_type;
+
+        explicit HwArenaAllocator(HwLinearArena &arena) : mArena(&arena) {}
+
+        template<typename U>
+        HwArenaAllocator(const HwArenaAllocator<U> &other) : mArena(other.GetArena()) {}
+
+        T *allocate(size_t count) {
+            return static_cast<T *>(mArena->Allocate(sizeof(T) * count, alignof(T)));
+        }
+
+        void deallocate(T *, size_t) {}
+
+        HwLinearArena *GetArena() const { return mArena; }
+
+        template<typename U>
+        bool operator==(const HwArenaAllocator<U> &other) const { return mArena == other.GetArena(); }
+
+        template<typename U>
+        bool operator!=(const HwArenaAllocator<U> &other) const { return mArena != other.GetArena(); }
+
+    private:
+        HwLinearArena *mArena;
+    };
+
+    /** Vector of transient data in arena */
+    template<typename T>
+    using HwArenaVector = std::vector<T, HwArenaAllocator<T>>;
+
+}
+
+#endif //X11HELLOWORLD_FRAME_ARENA_HPP
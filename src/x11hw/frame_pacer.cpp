@@ -0,0 +1,170 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/frame_pacer.hpp>
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <ctime>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace x11hw {
+
+    static inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield");
+#endif
+    }
+
+    HwFramePacer::HwFramePacer() : HwFramePacer(InitParams()) {
+
+    }
+
+    HwFramePacer::HwFramePacer(const InitParams &params) {
+        mParams = params;
+        mMargin = std::min(std::max(params.initialMargin, params.minMargin), params.maxSpin);
+    }
+
+    HwFramePacer::clock::time_point HwFramePacer::Wait() {
+        auto now = clock::now();
+
+        if (!mStarted) {
+            mStarted = true;
+            mDeadline = now + mParams.period;
+            mLastWakeup = now;
+            return now;
+        }
+
+        if (now > mDeadline) {
+            mMissedDeadlines += 1;
+
+            // Too late to catch up: skip deadlines instead of rendering burst of frames
+            if (now - mDeadline > mParams.period) {
+                mDeadline = now;
+            }
+        }
+
+        auto sleepTarget = mDeadline - mMargin;
+
+        if (now < sleepTarget) {
+            SleepUntil(sleepTarget);
+            now = clock::now();
+            TuneMargin(std::chrono::duration_cast<std::chrono::nanoseconds>(now - sleepTarget));
+        }
+
+        // Spin rest of the margin, bounded by CPU budget even if the margin was just increased
+        auto spinStart = now;
+        auto spinEnd = std::min(mDeadline, spinStart + mParams.maxSpin);
+
+        while (now < spinEnd) {
+            CpuRelax();
+            now = clock::now();
+        }
+
+        mSpinTime += now - spinStart;
+
+        AccountInterval(now);
+        mDeadline += mParams.period;
+
+        return now;
+    }
+
+    void HwFramePacer::SetPeriod(std::chrono::nanoseconds period) {
+        mDeadline += period - mParams.period;
+        mParams.period = period;
+    }
+
+    void HwFramePacer::SleepUntil(clock::time_point time) const {
+        // steady_clock is CLOCK_MONOTONIC on Linux, so absolute time is passed as is
+        auto sinceEpoch = std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+
+        timespec target{};
+        target.tv_sec = (time_t) (sinceEpoch / 1000000000);
+        target.tv_nsec = (long) (sinceEpoch % 1000000000);
+
+        // Absolute deadline, so signal interruption does not accumulate error
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &target, nullptr) == EINTR) {
+        }
+    }
+
+    void HwFramePacer::TuneMargin(std::chrono::nanoseconds oversleep) {
+        mSleeps += 1;
+        mOversleepSumUs += (double) oversleep.count() / 1e3;
+
+        if (oversleep + mParams.minMargin > mMargin) {
+            // Late wakeup: grow at once with some headroom
+            mMargin = oversleep + oversleep / 4 + mParams.minMargin;
+        }
+        else {
+            // Decay slowly, single lucky wakeup must not shrink the margin
+            mMargin -= (mMargin - oversleep - mParams.minMargin) / 64;
+        }
+
+        mMargin = std::min(std::max(mMargin, mParams.minMargin), mParams.maxSpin);
+    }
+
+    void HwFramePacer::AccountInterval(clock::time_point wakeup) {
+        double intervalMs = std::chrono::duration<double, std::milli>(wakeup - mLastWakeup).count();
+        double periodMs = std::chrono::duration<double, std::milli>(mParams.period).count();
+        mLastWakeup = wakeup;
+
+        mIntervals += 1;
+        double delta = intervalMs - mIntervalMean;
+        mIntervalMean += delta / (double) mIntervals;
+        mIntervalM2 += delta * (intervalMs - mIntervalMean);
+        mMaxDeviationMs = std::max(mMaxDeviationMs, std::abs(intervalMs - periodMs));
+    }
+
+    HwFramePacer::Stats HwFramePacer::GetStats() const {
+        Stats stats;
+        stats.frames = mIntervals;
+        stats.missedDeadlines = mMissedDeadlines;
+        stats.averageIntervalMs = mIntervalMean;
+        stats.jitterMs = mIntervals > 1 ? std::sqrt(mIntervalM2 / (double) (mIntervals - 1)) : 0.0;
+        stats.maxDeviationMs = mMaxDeviationMs;
+        stats.averageOversleepUs = mSleeps ? mOversleepSumUs / (double) mSleeps : 0.0;
+        stats.marginUs = (double) mMargin.count() / 1e3;
+        stats.spinSeconds = std::chrono::duration<double>(mSpinTime).count();
+        return stats;
+    }
+
+    void HwFramePacer::Report(std::ostream &stream, const char *label) const {
+        auto stats = GetStats();
+
+        stream << "Frame pacing (" << label << "): " << stats.frames << " frames, "
+               << "interval avg " << stats.averageIntervalMs << " ms, "
+               << "jitter " << stats.jitterMs << " ms, "
+               << "max deviation " << stats.maxDeviationMs << " ms, "
+               << "missed " << stats.missedDeadlines << ", "
+               << "oversleep avg " << stats.averageOversleepUs << " us, "
+               << "margin " << stats.marginUs << " us, "
+               << "spin " << stats.spinSeconds << " s" << std::endl;
+    }
+
+}
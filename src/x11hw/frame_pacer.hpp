@@ -0,0 +1,112 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_FRAME_PACER_HPP
+#define X11HELLOWORLD_FRAME_PACER_HPP
+
+#include <chrono>
+#include <ostream>
+
+namespace x11hw {
+
+    /**
+     * Frame limiter with hybrid wait: sleeps with clock_nanosleep(TIMER_ABSTIME) until
+     * margin before the deadline, then spins with pause instructions until the deadline.
+     * Margin is tuned from observed oversleep: grows at once on late wakeup, slowly decays back.
+     * Spin phase is capped by maxSpin, so the limiter never burns more CPU than that per frame.
+     * Not thread-safe: use one pacer per paced thread.
+     */
+    class HwFramePacer {
+    public:
+        typedef std::chrono::steady_clock clock;
+
+        struct InitParams {
+            /** Frame period */
+            std::chrono::nanoseconds period = std::chrono::nanoseconds{16666667};
+            /** Margin before the first oversleep is observed */
+            std::chrono::nanoseconds initialMargin = std::chrono::microseconds{1000};
+            /** Min margin (scheduler wakeup is never exact) */
+            std::chrono::nanoseconds minMargin = std::chrono::microseconds{50};
+            /** Max spin time per frame (CPU budget of the spin phase) */
+            std::chrono::nanoseconds maxSpin = std::chrono::microseconds{2000};
+        };
+
+        struct Stats {
+            size_t frames = 0;
+            size_t missedDeadlines = 0;
+            double averageIntervalMs = 0.0;
+            /** Standard deviation of frame interval */
+            double jitterMs = 0.0;
+            /** Max deviation of frame interval from the period */
+            double maxDeviationMs = 0.0;
+            double averageOversleepUs = 0.0;
+            double marginUs = 0.0;
+            double spinSeconds = 0.0;
+        };
+
+        HwFramePacer();
+        explicit HwFramePacer(const InitParams &params);
+
+        /**
+         * Wait until the next frame deadline.
+         * If the deadline is already missed by more than a period, schedule restarts from now (no burst).
+         * @return Time of the wakeup
+         */
+        clock::time_point Wait();
+
+        /** Change frame period (applied from the next frame) */
+        void SetPeriod(std::chrono::nanoseconds period);
+
+        /** @return Pacing statistics */
+        Stats GetStats() const;
+
+        /** Print statistics */
+        void Report(std::ostream &stream, const char *label) const;
+
+    private:
+        void SleepUntil(clock::time_point time) const;
+        void TuneMargin(std::chrono::nanoseconds oversleep);
+        void AccountInterval(clock::time_point wakeup);
+
+        InitParams mParams;
+        std::chrono::nanoseconds mMargin;
+        clock::time_point mDeadline{};
+        clock::time_point mLastWakeup{};
+        bool mStarted = false;
+
+        // Welford accumulators of the frame interval (ms)
+        size_t mIntervals = 0;
+        double mIntervalMean = 0.0;
+        double mIntervalM2 = 0.0;
+        double mMaxDeviationMs = 0.0;
+
+        size_t mSleeps = 0;
+        double mOversleepSumUs = 0.0;
+        size_t mMissedDeadlines = 0;
+        clock::duration mSpinTime{};
+    };
+
+}
+
+#endif //X11HELLOWORLD_FRAME_PACER_HPP
@@ -0,0 +1,246 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_FRAME_PIPELINE_HPP
+#define X11HELLOWORLD_FRAME_PIPELINE_HPP
+
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+
+namespace x11hw {
+
+    /**
+     * Hands immutable frame snapshots from simulation thread to render thread through
+     * fixed number of slots (pipeline depth), so next frame is simulated while previous one is submitted.
+     *
+     * Latest mode: render thread takes the newest snapshot and drops older ones, simulation thread
+     * overwrites stale snapshots instead of waiting (depth 3 is classic triple buffering, depth 2
+     * makes simulation wait for render thread).
+     * Fifo mode: render thread takes snapshots in order, simulation thread runs up to depth - 1 frames
+     * ahead and waits once all slots are taken (higher throughput, but latency grows with depth).
+     *
+     * @tparam Snapshot Frame state type
+     */
+    template<typename Snapshot>
+    class HwFramePipeline {
+    public:
+        enum class Mode {
+            Latest,
+            Fifo
+        };
+
+        struct InitParams {
+            size_t depth = 3;
+            Mode mode = Mode::Latest;
+        };
+
+        struct Stats {
+            size_t produced = 0;
+            size_t consumed = 0;
+            size_t dropped = 0;
+            size_t producerWaits = 0;
+        };
+
+        explicit HwFramePipeline(const InitParams &params) : mSlots(params.depth), mMode(params.mode) {
+            assert(params.depth >= 2);
+        }
+
+        HwFramePipeline(const HwFramePipeline&) = delete;
+        HwFramePipeline(HwFramePipeline&&) = delete;
+
+        /**
+         * Simulation thread: get slot for the next snapshot (may wait for free slot)
+         * @return Snapshot to fill or null if pipeline is closed
+         */
+        Snapshot *BeginWrite() {
+            std::unique_lock<std::mutex> lock(mMutex);
+            assert(mWriting == INVALID);
+
+            size_t slot = FindWritable();
+
+            if (slot == INVALID) {
+                mStats.producerWaits += 1;
+                mCondition.wait(lock, [&]() { return mClosed || (slot = FindWritable()) != INVALID; });
+            }
+
+            if (mClosed) {
+                return nullptr;
+            }
+
+            if (mSlots[slot].state == State::Ready) {
+                // Stale snapshot is overwritten, render thread will never see it
+                mStats.dropped += 1;
+            }
+
+            mSlots[slot].state = State::Writing;
+            mWriting = slot;
+            return &mSlots[slot].snapshot;
+        }
+
+        /** Simulation thread: publish snapshot returned by BeginWrite */
+        void EndWrite() {
+            {
+                std::lock_guard<std::mutex> guard(mMutex);
+                assert(mWriting != INVALID);
+
+                mSlots[mWriting].state = State::Ready;
+                mSlots[mWriting].sequence = mNextSequence++;
+                mWriting = INVALID;
+                mStats.produced += 1;
+            }
+
+            mCondition.notify_all();
+        }
+
+        /**
+         * Render thread: take next snapshot and release previously taken one (never waits)
+         * @param isNew Set to true if returned snapshot is not seen before
+         * @return Snapshot to render or null if nothing is published yet
+         */
+        const Snapshot *Acquire(bool *isNew = nullptr) {
+            size_t slot = INVALID;
+
+            {
+                std::lock_guard<std::mutex> guard(mMutex);
+
+                for (size_t i = 0; i < mSlots.size(); i++) {
+                    if (mSlots[i].state != State::Ready) {
+                        continue;
+                    }
+
+                    bool better = slot == INVALID ||
+                                  (mMode == Mode::Latest ? mSlots[i].sequence > mSlots[slot].sequence
+                                                         : mSlots[i].sequence < mSlots[slot].sequence);
+                    slot = better ? i : slot;
+                }
+
+                if (slot != INVALID) {
+                    if (mReading != INVALID) {
+                        mSlots[mReading].state = State::Free;
+                    }
+
+                    if (mMode == Mode::Latest) {
+                        // Everything older than the taken snapshot is not needed anymore
+                        for (auto& s: mSlots) {
+                            if (s.state == State::Ready && s.sequence < mSlots[slot].sequence) {
+                                s.state = State::Free;
+                                mStats.dropped += 1;
+                            }
+                        }
+                    }
+
+                    mSlots[slot].state = State::Reading;
+                    mReading = slot;
+                    mStats.consumed += 1;
+                }
+            }
+
+            if (isNew) {
+                *isNew = slot != INVALID;
+            }
+
+            if (slot != INVALID) {
+                mCondition.notify_all();
+            }
+
+            return mReading != INVALID ? &mSlots[mReading].snapshot : nullptr;
+        }
+
+        /** Wake up and stop simulation thread waiting in BeginWrite */
+        void Close() {
+            {
+                std::lock_guard<std::mutex> guard(mMutex);
+                mClosed = true;
+            }
+
+            mCondition.notify_all();
+        }
+
+        /** @return Pipeline depth (number of slots) */
+        size_t GetDepth() const { return mSlots.size(); }
+
+        /** @return Hand-off mode */
+        Mode GetMode() const { return mMode; }
+
+        /** @return Accumulated statistics */
+        Stats GetStats() const {
+            std::lock_guard<std::mutex> guard(mMutex);
+            return mStats;
+        }
+
+    private:
+        enum class State {
+            Free,
+            Writing,
+            Ready,
+            Reading
+        };
+
+        struct Slot {
+            Snapshot snapshot{};
+            State state = State::Free;
+            uint64_t sequence = 0;
+        };
+
+        size_t FindWritable() const {
+            size_t oldestReady = INVALID;
+            size_t readyCount = 0;
+
+            for (size_t i = 0; i < mSlots.size(); i++) {
+                if (mSlots[i].state == State::Free) {
+                    return i;
+                }
+
+                if (mSlots[i].state == State::Ready) {
+                    readyCount += 1;
+                    oldestReady = (oldestReady == INVALID || mSlots[i].sequence < mSlots[oldestReady].sequence) ? i : oldestReady;
+                }
+            }
+
+            // Newest snapshot is always kept for render thread
+            return mMode == Mode::Latest && readyCount > 1 ? oldestReady : INVALID;
+        }
+
+        static const size_t INVALID = ~size_t(0);
+
+        std::vector<Slot> mSlots;
+        mutable std::mutex mMutex;
+        std::condition_variable mCondition;
+        Stats mStats;
+        Mode mMode;
+        uint64_t mNextSequence = 0;
+        size_t mWriting = INVALID;
+        size_t mReading = INVALID;
+        bool mClosed = false;
+    };
+
+    template<typename Snapshot>
+    const size_t HwFramePipeline<Snapshot>::INVALID;
+
+}
+
+#endif //X11HELLOWORLD_FRAME_PIPELINE_HPP
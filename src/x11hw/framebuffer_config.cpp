@@ -0,0 +1,94 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/framebuffer_config.hpp>
+#include <algorithm>
+#include <cstdlib>
+
+namespace x11hw {
+
+    size_t HwFramebufferInfo::GetBytesPerPixel() const {
+        // Drivers pad texels to 32 bits (RGB8 is stored as RGBX8, D24 as D24X8)
+        size_t colorBytes = (size_t) (redBits + greenBits + blueBits + alphaBits + 31) / 32 * 4;
+        size_t depthStencilBytes = (size_t) (depthBits + stencilBits + 31) / 32 * 4;
+        size_t colorBuffers = doubleBuffer ? 2 : 1;
+        size_t samplesCount = (size_t) std::max(samples, 1);
+
+        // Multisampled color is resolved into regular front/back buffers on swap
+        size_t bytes = colorBytes * colorBuffers + depthStencilBytes * samplesCount;
+
+        if (samplesCount > 1) {
+            bytes += colorBytes * samplesCount;
+        }
+
+        return bytes;
+    }
+
+    uint64_t HwFramebufferInfo::EstimateMemory(uint32_t width, uint32_t height) const {
+        return (uint64_t) width * height * GetBytesPerPixel();
+    }
+
+    void HwFramebufferInfo::Report(std::ostream &stream, uint32_t width, uint32_t height) const {
+        double megabytes = (double) EstimateMemory(width, height) / (1024.0 * 1024.0);
+
+        stream << "Framebuffer config 0x" << std::hex << fbConfigId << std::dec << ": "
+               << "RGBA " << redBits << "/" << greenBits << "/" << blueBits << "/" << alphaBits << ", "
+               << "depth " << depthBits << ", stencil " << stencilBits << ", "
+               << "samples " << samples << (postProcessAntialiasing ? " (post process AA)" : "") << ", "
+               << (srgb ? "sRGB" : "linear") << ", "
+               << (doubleBuffer ? "double" : "single") << " buffered, "
+               << "~" << megabytes << " MiB at " << width << "x" << height << std::endl;
+    }
+
+    int64_t HwFramebufferInfo::Score(const HwFramebufferConfig &config, const HwFramebufferInfo &info) {
+        bool postProcess = config.antialiasing == HwAntialiasing::PostProcess;
+        int requiredSamples = postProcess ? 0 : config.requiredSamples;
+        int preferredSamples = postProcess ? 0 : std::max(config.preferredSamples, requiredSamples);
+
+        if (info.samples < requiredSamples ||
+            info.depthBits < config.depthBits ||
+            info.stencilBits < config.stencilBits ||
+            info.alphaBits < config.alphaBits) {
+            return -1;
+        }
+
+        // Missing samples are worse than extra ones of the same count
+        int64_t samplesDistance = info.samples < preferredSamples ?
+                                  2 * (preferredSamples - info.samples) : info.samples - preferredSamples;
+        int64_t unusedBits = (info.depthBits - config.depthBits) +
+                             (info.stencilBits - config.stencilBits) +
+                             (info.alphaBits - config.alphaBits);
+        int64_t bytesPerPixel = (int64_t) info.GetBytesPerPixel();
+
+        // Each component is bounded, so components do not overlap in the sum
+        int64_t score = 0;
+        score += (info.srgb == config.srgb ? 1 : 0) * (int64_t(1) << 48);
+        score += (0xffff - std::min<int64_t>(samplesDistance, 0xffff)) * (int64_t(1) << 32);
+        score += (0xffff - std::min<int64_t>(unusedBits, 0xffff)) * (int64_t(1) << 16);
+        score += (0xffff - std::min<int64_t>(bytesPerPixel, 0xffff));
+
+        return score;
+    }
+
+}
@@ -0,0 +1,103 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_FRAMEBUFFER_CONFIG_HPP
+#define X11HELLOWORLD_FRAMEBUFFER_CONFIG_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+namespace x11hw {
+
+    enum class HwAntialiasing {
+        /** Multisampled default framebuffer with preferred samples count */
+        Multisample,
+        /** Single sample default framebuffer: application applies post process antialiasing (HwFxaa) */
+        PostProcess
+    };
+
+    /**
+     * Policy of the default framebuffer config selection (passed to HwWindowManager within HwContextConfig).
+     * Configs, which do not satisfy requirements, are rejected, others are scored in this priority:
+     * sRGB match, distance to preferred samples, unused depth/stencil/alpha bits, memory per pixel.
+     */
+    struct HwFramebufferConfig {
+        HwAntialiasing antialiasing = HwAntialiasing::Multisample;
+        /** Min samples count of the config (0 - no requirement) */
+        int requiredSamples = 0;
+        /** Samples count to select, both fewer and more samples are penalized (more cost fill rate) */
+        int preferredSamples = 0;
+        /** Depth buffer bits (0 - depth buffer is not needed) */
+        int depthBits = 24;
+        /** Stencil buffer bits (0 - stencil buffer is not needed) */
+        int stencilBits = 8;
+        /** Alpha channel bits of the color buffer (0 - alpha is not needed) */
+        int alphaBits = 8;
+        /** Prefer sRGB capable config (linear shader output is encoded by the hardware) */
+        bool srgb = true;
+    };
+
+    /** Attributes of the selected framebuffer config */
+    struct HwFramebufferInfo {
+        int fbConfigId = 0;
+        int redBits = 0;
+        int greenBits = 0;
+        int blueBits = 0;
+        int alphaBits = 0;
+        int depthBits = 0;
+        int stencilBits = 0;
+        int samples = 0;
+        bool srgb = false;
+        bool doubleBuffer = false;
+        /** Selected with post process antialiasing policy */
+        bool postProcessAntialiasing = false;
+
+        /** @return Bytes per pixel of all buffers of the framebuffer (with samples) */
+        size_t GetBytesPerPixel() const;
+
+        /**
+         * Estimate memory of the window framebuffer.
+         * Multisampled buffers are counted per sample, plus single sample resolve buffers.
+         * @param width Framebuffer width
+         * @param height Framebuffer height
+         * @return Memory in bytes
+         */
+        uint64_t EstimateMemory(uint32_t width, uint32_t height) const;
+
+        /** Print config and estimated memory for framebuffer of specified size */
+        void Report(std::ostream &stream, uint32_t width, uint32_t height) const;
+
+        /**
+         * Score config for selection policy
+         * @param config Selection policy
+         * @param info Candidate config
+         * @return Score (higher is better) or negative if config does not satisfy requirements
+         */
+        static int64_t Score(const HwFramebufferConfig &config, const HwFramebufferInfo &info);
+    };
+
+}
+
+#endif //X11HELLOWORLD_FRAMEBUFFER_CONFIG_HPP
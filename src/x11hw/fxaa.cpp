@@ -0,0 +1,242 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/fxaa.hpp>
+#include <x11hw/shader.hpp>
+#include <x11hw/texture.hpp>
+#include <x11hw/error.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace x11hw {
+
+    static const char *GetFxaaVertexCode() {
+        return R"(
+            #version 330 core
+            out vec2 fsUv;
+
+            // Part of the target covered by the scene
+            uniform vec2 uvScale;
+
+            // Full screen triangle, no vertex buffer
+            void main() {
+                vec2 position = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+                fsUv = position * uvScale;
+                gl_Position = vec4(position * 2.0f - 1.0f, 0.0f, 1.0f);
+            }
+        )";
+    }
+
+    static const char *GetFxaaFragmentCode() {
+        return R"(
+            #version 330 core
+            layout (location = 0) out vec4 outColor;
+
+            in vec2 fsUv;
+
+            uniform sampler2D scene;
+            uniform vec2 texelSize;
+            uniform float lumaExponent;
+            uniform float edgeThreshold;
+            uniform float edgeThresholdMin;
+
+            const float SPAN_MAX = 8.0f;
+            const float REDUCE_MUL = 1.0f / 8.0f;
+            const float REDUCE_MIN = 1.0f / 128.0f;
+
+            float Luma(vec3 color) {
+                return pow(dot(color, vec3(0.299f, 0.587f, 0.114f)), lumaExponent);
+            }
+
+            void main() {
+                vec3 rgbM = texture(scene, fsUv).rgb;
+                float lumaNW = Luma(textureOffset(scene, fsUv, ivec2(-1, -1)).rgb);
+                float lumaNE = Luma(textureOffset(scene, fsUv, ivec2(1, -1)).rgb);
+                float lumaSW = Luma(textureOffset(scene, fsUv, ivec2(-1, 1)).rgb);
+                float lumaSE = Luma(textureOffset(scene, fsUv, ivec2(1, 1)).rgb);
+                float lumaM = Luma(rgbM);
+
+                float lumaMin = min(lumaM, min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)));
+                float lumaMax = max(lumaM, max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)));
+
+                // Flat area: nothing to smooth
+                if (lumaMax - lumaMin < max(edgeThresholdMin, lumaMax * edgeThreshold)) {
+                    outColor = vec4(rgbM, 1.0f);
+                    return;
+                }
+
+                // Direction along the edge (perpendicular to the luma gradient)
+                vec2 dir = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)), (lumaNW + lumaSW) - (lumaNE + lumaSE));
+                float dirReduce = max((lumaNW + lumaNE + lumaSW + lumaSE) * (0.25f * REDUCE_MUL), REDUCE_MIN);
+                float rcpDirMin = 1.0f / (min(abs(dir.x), abs(dir.y)) + dirReduce);
+                dir = clamp(dir * rcpDirMin, vec2(-SPAN_MAX), vec2(SPAN_MAX)) * texelSize;
+
+                vec3 rgbA = 0.5f * (texture(scene, fsUv + dir * (1.0f / 3.0f - 0.5f)).rgb +
+                                    texture(scene, fsUv + dir * (2.0f / 3.0f - 0.5f)).rgb);
+                vec3 rgbB = rgbA * 0.5f + 0.25f * (texture(scene, fsUv - dir * 0.5f).rgb +
+                                                   texture(scene, fsUv + dir * 0.5f).rgb);
+
+                // Wide filter crossed another edge: keep the narrow one
+                float lumaB = Luma(rgbB);
+                outColor = vec4(lumaB < lumaMin || lumaB > lumaMax ? rgbA : rgbB, 1.0f);
+            }
+        )";
+    }
+
+    HwFxaa::HwFxaa(const InitParams &params) {
+        mSrgb = params.srgbFramebuffer;
+        mEdgeThreshold = params.edgeThreshold;
+        mEdgeThresholdMin = params.edgeThresholdMin;
+
+        mShader.reset(new HwShader(GetFxaaVertexCode(), GetFxaaFragmentCode()));
+
+        // Core profile draws need bound VAO, even without attributes
+        glGenVertexArrays(1, &mVAO);
+        glGenFramebuffers(1, &mFramebuffer);
+    }
+
+    HwFxaa::~HwFxaa() {
+        glDeleteFramebuffers(1, &mFramebuffer);
+        glDeleteVertexArrays(1, &mVAO);
+    }
+
+    void HwFxaa::Resize(glm::uvec2 framebufferSize) {
+        if (framebufferSize.x == 0 || framebufferSize.y == 0 || (mColor && mSize == framebufferSize)) {
+            return;
+        }
+
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &mOutputFramebuffer);
+        CreateTarget(framebufferSize);
+    }
+
+    void HwFxaa::BeginScene(glm::uvec2 framebufferSize) {
+        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &mOutputFramebuffer);
+
+        if (!mColor || mSize.x < framebufferSize.x || mSize.y < framebufferSize.y) {
+            // Not settled yet: round up, so next few frames of the drag fit into it
+            auto grow = [](uint32_t current, uint32_t required) {
+                if (current >= required) {
+                    return current;
+                }
+
+                return (required + GROW_GRANULARITY - 1) / GROW_GRANULARITY * GROW_GRANULARITY;
+            };
+
+            glm::uvec2 size = framebufferSize;
+            if (mColor) {
+                size = glm::uvec2(grow(mSize.x, framebufferSize.x), grow(mSize.y, framebufferSize.y));
+            }
+
+            CreateTarget(size);
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, mFramebuffer);
+        mSceneSize = framebufferSize;
+        mScissor = mSceneSize != mSize;
+
+        if (mScissor) {
+            // One texel border is kept too, so edge samples read scene clear color, not stale content
+            glScissor(0, 0, std::min(mSceneSize.x + 1, mSize.x), std::min(mSceneSize.y + 1, mSize.y));
+            glEnable(GL_SCISSOR_TEST);
+            mPartialFrames += 1;
+        }
+    }
+
+    void HwFxaa::Apply() {
+        static const std::string SCENE = "scene";
+        static const std::string TEXEL_SIZE = "texelSize";
+        static const std::string UV_SCALE = "uvScale";
+        static const std::string LUMA_EXPONENT = "lumaExponent";
+        static const std::string EDGE_THRESHOLD = "edgeThreshold";
+        static const std::string EDGE_THRESHOLD_MIN = "edgeThresholdMin";
+
+        if (mScissor) {
+            glDisable(GL_SCISSOR_TEST);
+            mScissor = false;
+        }
+
+        glBindFramebuffer(GL_FRAMEBUFFER, (GLuint) mOutputFramebuffer);
+
+        mShader->Bind();
+        mShader->SetTexture(SCENE, *mColor, 0);
+        mShader->SetVec2(TEXEL_SIZE, glm::vec2(1.0f / (float) mSize.x, 1.0f / (float) mSize.y));
+        mShader->SetVec2(UV_SCALE, glm::vec2((float) mSceneSize.x / (float) mSize.x, (float) mSceneSize.y / (float) mSize.y));
+        // Samples of sRGB texture are decoded to linear, luma is compared as it is seen
+        mShader->SetFloat(LUMA_EXPONENT, mSrgb ? 1.0f / 2.2f : 1.0f);
+        mShader->SetFloat(EDGE_THRESHOLD, mEdgeThreshold);
+        mShader->SetFloat(EDGE_THRESHOLD_MIN, mEdgeThresholdMin);
+
+        glBindVertexArray(mVAO);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        glBindVertexArray(0);
+        mShader->Unbind();
+
+        mFrames += 1;
+    }
+
+    HwFxaa::Stats HwFxaa::GetStats() const {
+        Stats stats;
+        stats.frames = mFrames;
+        stats.targetsCreated = mTargetsCreated;
+        stats.partialFrames = mPartialFrames;
+        stats.targetSize = mSize;
+        return stats;
+    }
+
+    void HwFxaa::Report(std::ostream &stream, const char *label) const {
+        auto stats = GetStats();
+
+        stream << "FXAA (" << label << "): " << stats.frames << " frames, "
+               << "target " << stats.targetSize.x << "x" << stats.targetSize.y << " "
+               << (mSrgb ? "sRGB" : "linear") << ", "
+               << "created " << stats.targetsCreated << " times, "
+               << stats.partialFrames << " frames into larger target" << std::endl;
+    }
+
+    void HwFxaa::CreateTarget(glm::uvec2 size) {
+        CHECK_MSG(size.x > 0 && size.y > 0, "FXAA target must not be empty");
+
+        HwTexture::InitParams textureParams;
+        textureParams.size = size;
+        textureParams.internalFormat = mSrgb ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+        // Edge search samples between texels
+        textureParams.minFilter = GL_LINEAR;
+        textureParams.magFilter = GL_LINEAR;
+        textureParams.wrap = GL_CLAMP_TO_EDGE;
+
+        mColor.reset(new HwTexture(textureParams));
+        mSize = size;
+        mTargetsCreated += 1;
+
+        glBindFramebuffer(GL_FRAMEBUFFER, mFramebuffer);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, mColor->GetHandle(), 0);
+
+        auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        glBindFramebuffer(GL_FRAMEBUFFER, (GLuint) mOutputFramebuffer);
+
+        CHECK_MSG(status == GL_FRAMEBUFFER_COMPLETE, "FXAA target is incomplete");
+    }
+
+}
@@ -0,0 +1,122 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_FXAA_HPP
+#define X11HELLOWORLD_FXAA_HPP
+
+#include <GL/glew.h>
+#include <glm/vec2.hpp>
+#include <memory>
+#include <ostream>
+
+namespace x11hw {
+
+    /**
+     * FXAA post pass for single sample framebuffer (HwAntialiasing::PostProcess).
+     * Scene is rendered into offscreen color texture, then full screen triangle resolves it
+     * into the window framebuffer: edges are found by
+     * local luma contrast, pixel is blended along the edge direction estimated from the
+     * diagonal neighbours (FXAA 3.11 console variant). Overlays drawn after the pass stay sharp.
+     * On sRGB framebuffer the texture is sRGB too, so blending is done in linear space and
+     * luma is taken from gamma encoded values, as it is seen.
+     * Target is reallocated to the exact size only by Resize (on settled window resize). During
+     * resize burst scene is rendered into the lower left corner of the existing target, if it is
+     * large enough (clear and draws are scissored), otherwise the target grows with some headroom.
+     */
+    class HwFxaa {
+    public:
+        struct InitParams {
+            /** Framebuffer encodes linear shader output (GL_FRAMEBUFFER_SRGB) */
+            bool srgbFramebuffer = false;
+            /** Min local contrast relative to the max luma of the neighbourhood to treat pixel as edge */
+            float edgeThreshold = 0.125f;
+            /** Min absolute local contrast (skips noise in dark areas) */
+            float edgeThresholdMin = 0.0312f;
+
+            InitParams() {}
+        };
+
+        struct Stats {
+            size_t frames = 0;
+            size_t targetsCreated = 0;
+            /** Frames rendered into part of a larger target */
+            size_t partialFrames = 0;
+            glm::uvec2 targetSize{};
+        };
+
+        /** Target grows by multiples of this size during resize (fewer reallocations while dragging) */
+        static const uint32_t GROW_GRANULARITY = 128;
+
+        explicit HwFxaa(const InitParams &params = InitParams());
+        HwFxaa(const HwFxaa&) = delete;
+        HwFxaa(HwFxaa&&) = delete;
+        ~HwFxaa();
+
+        /**
+         * Reallocate target to the exact size (call on settled resize, see HwWindow::SubscribeOnResize)
+         * @param framebufferSize Settled size of the framebuffer in pixels
+         */
+        void Resize(glm::uvec2 framebufferSize);
+
+        /**
+         * Bind offscreen target to render the scene into (viewport is left to the caller,
+         * it must cover framebufferSize from the origin)
+         * @param framebufferSize Size of the currently bound framebuffer in pixels
+         */
+        void BeginScene(glm::uvec2 framebufferSize);
+
+        /** Resolve scene with FXAA into the framebuffer, which was bound before BeginScene (it is bound on return) */
+        void Apply();
+
+        /** @return Number of resolved frames and target state */
+        Stats GetStats() const;
+
+        /** Print statistics */
+        void Report(std::ostream &stream, const char *label) const;
+
+    private:
+        void CreateTarget(glm::uvec2 size);
+
+    private:
+        std::unique_ptr<class HwShader> mShader;
+        std::unique_ptr<class HwTexture> mColor;
+        GLuint mFramebuffer = 0;
+        GLuint mVAO = 0;
+        GLint mOutputFramebuffer = 0;
+        glm::uvec2 mSize{};
+        glm::uvec2 mSceneSize{};
+        bool mScissor = false;
+
+        bool mSrgb = false;
+        float mEdgeThreshold = 0.125f;
+        float mEdgeThresholdMin = 0.0312f;
+
+        size_t mFrames = 0;
+        size_t mTargetsCreated = 0;
+        size_t mPartialFrames = 0;
+    };
+
+}
+
+#endif //X11HELLOWORLD_FXAA_HPP
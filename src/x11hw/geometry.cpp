@@ -23,6 +23,8 @@
 ////////////////////////////////////////////////////////////////////////////////////
 
 #include <x11hw/geometry.hpp>
+#include <x11hw/buffer_pool.hpp>
+#include <x11hw/deletion_queue.hpp>
 #include <cassert>
 
 namespace x11hw {
@@ -36,55 +38,117 @@ namespace x11hw {
         mTopology = params.topology;
         mStride = params.stride;
         mVerticesCount = params.verticesCount;
+        mIndicesCount = params.indicesCount;
+        mAttributes = params.attributes;
 
-        glGenVertexArrays(1, &mVAO);
-        glBindVertexArray(mVAO);
+        // Reuse retired buffer of the same size, if any, to avoid storage reallocation
+        auto deletionQueue = HwDeletionQueue::GetCurrent();
+        mVBO = deletionQueue ? deletionQueue->AcquireBuffer(GetBufferSize(), GL_STATIC_DRAW) : 0;
 
-        glGenBuffers(1, &mVBO);
-        glBindBuffer(GL_ARRAY_BUFFER, mVBO);
-        glBufferData(GL_ARRAY_BUFFER, GetBufferSize(), nullptr, GL_STATIC_DRAW);
+        if (!mVBO) {
+            glGenBuffers(1, &mVBO);
+            glBindBuffer(GL_ARRAY_BUFFER, mVBO);
+            glBufferData(GL_ARRAY_BUFFER, GetBufferSize(), nullptr, GL_STATIC_DRAW);
+            glBindBuffer(GL_ARRAY_BUFFER, 0);
+        }
 
-        for (size_t i = 0; i < params.attributes.size(); i++) {
-            auto& attrib = params.attributes[i];
+        if (mIndicesCount) {
+            // Buffer objects have no fixed target, retired vertex buffers are fine for indices
+            mIBO = deletionQueue ? deletionQueue->AcquireBuffer(GetIndexBufferSize(), GL_STATIC_DRAW) : 0;
 
-            glEnableVertexAttribArray(i);
-            glVertexAttribDivisor(i, 0);
-            glVertexAttribPointer(
-                i,
-                attrib.components,
-                attrib.baseType,
-                attrib.normalize ? GL_TRUE : GL_FALSE,
-                mStride,
-                (void *) attrib.offset
-            );
+            if (!mIBO) {
+                glGenBuffers(1, &mIBO);
+                glBindBuffer(GL_ARRAY_BUFFER, mIBO);
+                glBufferData(GL_ARRAY_BUFFER, GetIndexBufferSize(), nullptr, GL_STATIC_DRAW);
+                glBindBuffer(GL_ARRAY_BUFFER, 0);
+            }
         }
+    }
 
-        glBindVertexArray(0);
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    HwGeometry::HwGeometry(HwBufferPool &pool, const InitParams &params) {
+        assert(params.topology == GL_TRIANGLES);
+        assert(params.stride > 0);
+        assert(params.verticesCount > 0);
+        assert(!params.attributes.empty());
+        assert(params.indicesCount == 0);
+
+        mTopology = params.topology;
+        mStride = params.stride;
+        mVerticesCount = params.verticesCount;
+
+        mPool = &pool;
+        mAllocation = pool.Allocate(mStride, params.attributes, mVerticesCount);
     }
 
     HwGeometry::~HwGeometry() {
-        if (mVAO) {
-            glDeleteVertexArrays(1, &mVAO);
-            glDeleteBuffers(1, &mVBO);
+        if (mPool) {
+            mPool->Release(mAllocation);
+
+            mPool = nullptr;
+            mAllocation = nullptr;
+            mStride = 0;
+            mVerticesCount = 0;
+        }
+
+        if (mVBO) {
+            if (auto deletionQueue = HwDeletionQueue::GetCurrent()) {
+                if (mVAO) {
+                    deletionQueue->RetireVertexArray(mVAO);
+                }
+
+                deletionQueue->RetireBuffer(mVBO, GetBufferSize(), GL_STATIC_DRAW);
+
+                if (mIBO) {
+                    deletionQueue->RetireBuffer(mIBO, GetIndexBufferSize(), GL_STATIC_DRAW);
+                }
+            }
+            else {
+                if (mVAO) {
+                    glDeleteVertexArrays(1, &mVAO);
+                }
+
+                if (mIBO) {
+                    glDeleteBuffers(1, &mIBO);
+                }
+
+                glDeleteBuffers(1, &mVBO);
+            }
 
             mVAO = 0;
             mVBO = 0;
+            mIBO = 0;
             mStride = 0;
             mVerticesCount = 0;
+            mIndicesCount = 0;
         }
     }
 
     void HwGeometry::Update(size_t offset, size_t size, const void *vertexData) const {
         assert(offset + size <= GetBufferSize());
-        glBindBuffer(GL_ARRAY_BUFFER, mVBO);
-        glBufferSubData(GL_ARRAY_BUFFER, offset, size, vertexData);
+        glBindBuffer(GL_ARRAY_BUFFER, GetVBO());
+        glBufferSubData(GL_ARRAY_BUFFER, GetFirstVertex() * mStride + offset, size, vertexData);
         glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
 
+    void HwGeometry::UpdateIndices(size_t first, size_t count, const GLuint *indices) const {
+        assert(mIBO);
+        assert(first + count <= mIndicesCount);
+        // Bind to copy target, so VAO element buffer binding is not touched
+        glBindBuffer(GL_COPY_WRITE_BUFFER, mIBO);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(GLuint) * first, sizeof(GLuint) * count, indices);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
     void HwGeometry::Draw() const {
-        glBindVertexArray(mVAO);
-        glDrawArrays(mTopology, 0, mVerticesCount);
+        glBindVertexArray(GetVAO());
+
+        if (mIndicesCount) {
+            glDrawElements(mTopology, mIndicesCount, GL_UNSIGNED_INT, nullptr);
+        }
+        else {
+            glDrawArrays(mTopology, GetFirstVertex(), mVerticesCount);
+        }
+
         glBindVertexArray(0);
     }
 
@@ -92,4 +156,57 @@ namespace x11hw {
         return mStride * mVerticesCount;
     }
 
+    size_t HwGeometry::GetIndexBufferSize() const {
+        return sizeof(GLuint) * mIndicesCount;
+    }
+
+    GLuint HwGeometry::GetVAO() const {
+        if (mPool) {
+            return mPool->GetVAO(mAllocation);
+        }
+
+        if (!mVAO) {
+            CreateVAO();
+        }
+
+        return mVAO;
+    }
+
+    void HwGeometry::CreateVAO() const {
+        glGenVertexArrays(1, &mVAO);
+        glBindVertexArray(mVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, mVBO);
+
+        if (mIBO) {
+            // Element buffer binding is part of the VAO state
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIBO);
+        }
+
+        for (size_t i = 0; i < mAttributes.size(); i++) {
+            auto& attrib = mAttributes[i];
+
+            glEnableVertexAttribArray(i);
+            glVertexAttribDivisor(i, 0);
+            glVertexAttribPointer(
+                i,
+                attrib.components,
+                attrib.baseType,
+                attrib.normalize ? GL_TRUE : GL_FALSE,
+                mStride,
+                (void *) attrib.offset
+            );
+        }
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    GLuint HwGeometry::GetVBO() const {
+        return mPool ? mPool->GetBuffer(mAllocation) : mVBO;
+    }
+
+    size_t HwGeometry::GetFirstVertex() const {
+        return mPool ? mAllocation->first : 0;
+    }
+
 }
\ No newline at end of file
@@ -30,6 +30,9 @@
 
 namespace x11hw {
 
+    class HwBufferPool;
+    struct HwBufferAllocation;
+
     class HwGeometry {
     public:
         struct Attribute {
@@ -44,9 +47,19 @@ namespace x11hw {
             size_t stride = 0;
             GLenum topology = 0;
             std::vector<Attribute> attributes;
+            // Optional u32 index buffer (not supported by pooled geometry)
+            size_t indicesCount = 0;
         };
 
         explicit HwGeometry(const InitParams& params);
+
+        /**
+         * Create geometry as view of vertex range, sub-allocated from the pool
+         * (no own GL objects, VAO is shared by geometries of the same format)
+         * @param pool Pool to allocate from (must outlive geometry)
+         * @param params Geometry params
+         */
+        HwGeometry(HwBufferPool& pool, const InitParams& params);
         ~HwGeometry();
 
         /**
@@ -57,18 +70,48 @@ namespace x11hw {
          */
         void Update(size_t offset, size_t size, const void *vertexData) const;
 
+        /**
+         * Update index data of the indexed geometry
+         * @param first First index to write
+         * @param count Number of indices
+         * @param indices Indices (relative to the geometry vertices)
+         */
+        void UpdateIndices(size_t first, size_t count, const GLuint *indices) const;
+
         /** Issue geometry draw */
         void Draw() const;
 
         /** @return Vertex buffer size in bytes */
         size_t GetBufferSize() const;
 
+        /** @return Index buffer size in bytes (0 if not indexed) */
+        size_t GetIndexBufferSize() const;
+
+        /** @return True if geometry is drawn with index buffer */
+        bool IsIndexed() const { return mIndicesCount > 0; }
+
+        /** @return True if geometry is allocated from buffer pool */
+        bool IsPooled() const { return mPool != nullptr; }
+
+    private:
+        GLuint GetVAO() const;
+        void CreateVAO() const;
+        GLuint GetVBO() const;
+        size_t GetFirstVertex() const;
+
     private:
         size_t mVerticesCount = 0;
+        size_t mIndicesCount = 0;
         size_t mStride = 0;
         GLenum mTopology = 0;
-        GLuint mVAO = 0;
+        std::vector<Attribute> mAttributes;
+        // Created on first draw, since VAO is not shared between contexts
+        mutable GLuint mVAO = 0;
         GLuint mVBO = 0;
+        GLuint mIBO = 0;
+
+        HwBufferPool *mPool = nullptr;
+        HwBufferAllocation *mAllocation = nullptr;
     };
 
 }
@@ -0,0 +1,108 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/gpu_timer.hpp>
+#include <algorithm>
+#include <cassert>
+
+namespace x11hw {
+
+    HwGpuTimer::HwGpuTimer() {
+        glGenQueries(MAX_QUERIES, mQueries);
+    }
+
+    HwGpuTimer::~HwGpuTimer() {
+        glDeleteQueries(MAX_QUERIES, mQueries);
+    }
+
+    void HwGpuTimer::Begin() {
+        assert(!mActive);
+
+        Collect();
+
+        if (mPending[mNext]) {
+            return;
+        }
+
+        glBeginQuery(GL_TIME_ELAPSED, mQueries[mNext]);
+        mActive = true;
+    }
+
+    void HwGpuTimer::End() {
+        if (!mActive) {
+            return;
+        }
+
+        glEndQuery(GL_TIME_ELAPSED);
+        mPending[mNext] = true;
+        mNext = (mNext + 1) % MAX_QUERIES;
+        mActive = false;
+    }
+
+    HwGpuTimer::Stats HwGpuTimer::GetStats() const {
+        Stats stats;
+        stats.samples = mSamples;
+        stats.lastUs = mLastUs;
+        stats.averageUs = mSamples ? mSumUs / (double) mSamples : 0.0;
+        stats.maxUs = mMaxUs;
+        return stats;
+    }
+
+    void HwGpuTimer::Report(std::ostream &stream, const char *label) const {
+        auto stats = GetStats();
+
+        stream << "GPU time (" << label << "): " << stats.samples << " samples, "
+               << "avg " << stats.averageUs << " us, "
+               << "max " << stats.maxUs << " us" << std::endl;
+    }
+
+    void HwGpuTimer::Collect() {
+        // Queries finish in order, so collect from the oldest one
+        for (size_t i = 0; i < MAX_QUERIES; i++) {
+            auto index = (mNext + i) % MAX_QUERIES;
+
+            if (!mPending[index]) {
+                continue;
+            }
+
+            GLint available = 0;
+            glGetQueryObjectiv(mQueries[index], GL_QUERY_RESULT_AVAILABLE, &available);
+
+            if (!available) {
+                break;
+            }
+
+            GLuint64 elapsedNs = 0;
+            glGetQueryObjectui64v(mQueries[index], GL_QUERY_RESULT, &elapsedNs);
+
+            mLastUs = (double) elapsedNs / 1e3;
+            mSumUs += mLastUs;
+            mMaxUs = std::max(mMaxUs, mLastUs);
+            mSmoothedUs = mSamples > 0 ? mSmoothedUs * 0.9 + mLastUs * 0.1 : mLastUs;
+            mSamples += 1;
+            mPending[index] = false;
+        }
+    }
+
+}
@@ -0,0 +1,90 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_GPU_TIMER_HPP
+#define X11HELLOWORLD_GPU_TIMER_HPP
+
+#include <GL/glew.h>
+#include <cstddef>
+#include <ostream>
+
+namespace x11hw {
+
+    /**
+     * GPU time of a span of commands (GL_TIME_ELAPSED). Queries are kept in a ring and
+     * their results are collected without waiting, so values lag a few frames behind.
+     * If all queries of the ring are still in flight, the span is not measured.
+     * Time elapsed queries do not nest: spans of different timers must not overlap.
+     */
+    class HwGpuTimer {
+    public:
+        struct Stats {
+            size_t samples = 0;
+            double lastUs = 0.0;
+            double averageUs = 0.0;
+            double maxUs = 0.0;
+        };
+
+        /** Queries in flight (a frame of latency each) */
+        static const size_t MAX_QUERIES = 4;
+
+        HwGpuTimer();
+        HwGpuTimer(const HwGpuTimer&) = delete;
+        HwGpuTimer(HwGpuTimer&&) = delete;
+        ~HwGpuTimer();
+
+        /** Start measured span (collects finished queries first) */
+        void Begin();
+
+        /** End measured span */
+        void End();
+
+        /** @return Exponentially smoothed time of the recent spans (0 if nothing is measured yet) */
+        double GetSmoothedUs() const { return mSmoothedUs; }
+
+        /** @return Collected samples */
+        Stats GetStats() const;
+
+        /** Print statistics */
+        void Report(std::ostream& stream, const char* label) const;
+
+    private:
+        void Collect();
+
+    private:
+        GLuint mQueries[MAX_QUERIES] = {};
+        bool mPending[MAX_QUERIES] = {};
+        size_t mNext = 0;
+        bool mActive = false;
+
+        size_t mSamples = 0;
+        double mLastUs = 0.0;
+        double mSumUs = 0.0;
+        double mMaxUs = 0.0;
+        double mSmoothedUs = 0.0;
+    };
+
+}
+
+#endif //X11HELLOWORLD_GPU_TIMER_HPP
@@ -0,0 +1,598 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/hud.hpp>
+#include <x11hw/shader.hpp>
+#include <x11hw/texture.hpp>
+#include <x11hw/geometry.hpp>
+#include <x11hw/gpu_timer.hpp>
+#include <cmath>
+#include <algorithm>
+#include <cassert>
+#include <cstdarg>
+#include <cstdio>
+
+namespace x11hw {
+
+    // 5x7 glyphs of printable ASCII (32..126), row per byte from the top, bit 4 is the leftmost pixel
+    static const uint8_t FONT_5X7[95][7] = {
+            { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 }, // space
+            { 0x04, 0x04, 0x04, 0x04, 0x04, 0x00, 0x04 }, // !
+            { 0x0a, 0x0a, 0x0a, 0x00, 0x00, 0x00, 0x00 }, // "
+            { 0x0a, 0x0a, 0x1f, 0x0a, 0x1f, 0x0a, 0x0a }, // #
+            { 0x04, 0x0f, 0x14, 0x0e, 0x05, 0x1e, 0x04 }, // $
+            { 0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03 }, // %
+            { 0x0c, 0x12, 0x14, 0x08, 0x15, 0x12, 0x0d }, // &
+            { 0x04, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00 }, // quote
+            { 0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02 }, // (
+            { 0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08 }, // )
+            { 0x00, 0x04, 0x15, 0x0e, 0x15, 0x04, 0x00 }, // *
+            { 0x00, 0x04, 0x04, 0x1f, 0x04, 0x04, 0x00 }, // +
+            { 0x00, 0x00, 0x00, 0x00, 0x0c, 0x04, 0x08 }, // ,
+            { 0x00, 0x00, 0x00, 0x1f, 0x00, 0x00, 0x00 }, // -
+            { 0x00, 0x00, 0x00, 0x00, 0x00, 0x0c, 0x0c }, // .
+            { 0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00 }, // /
+            { 0x0e, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0e }, // 0
+            { 0x04, 0x0c, 0x04, 0x04, 0x04, 0x04, 0x0e }, // 1
+            { 0x0e, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1f }, // 2
+            { 0x1f, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0e }, // 3
+            { 0x02, 0x06, 0x0a, 0x12, 0x1f, 0x02, 0x02 }, // 4
+            { 0x1f, 0x10, 0x1e, 0x01, 0x01, 0x11, 0x0e }, // 5
+            { 0x06, 0x08, 0x10, 0x1e, 0x11, 0x11, 0x0e }, // 6
+            { 0x1f, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08 }, // 7
+            { 0x0e, 0x11, 0x11, 0x0e, 0x11, 0x11, 0x0e }, // 8
+            { 0x0e, 0x11, 0x11, 0x0f, 0x01, 0x02, 0x0c }, // 9
+            { 0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x0c, 0x00 }, // :
+            { 0x00, 0x0c, 0x0c, 0x00, 0x0c, 0x04, 0x08 }, // ;
+            { 0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02 }, // <
+            { 0x00, 0x00, 0x1f, 0x00, 0x1f, 0x00, 0x00 }, // =
+            { 0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08 }, // >
+            { 0x0e, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04 }, // ?
+            { 0x0e, 0x11, 0x01, 0x0d, 0x15, 0x15, 0x0e }, // @
+            { 0x0e, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11 }, // A
+            { 0x1e, 0x11, 0x11, 0x1e, 0x11, 0x11, 0x1e }, // B
+            { 0x0e, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0e }, // C
+            { 0x1c, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1c }, // D
+            { 0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x1f }, // E
+            { 0x1f, 0x10, 0x10, 0x1e, 0x10, 0x10, 0x10 }, // F
+            { 0x0e, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0f }, // G
+            { 0x11, 0x11, 0x11, 0x1f, 0x11, 0x11, 0x11 }, // H
+            { 0x0e, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e }, // I
+            { 0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0c }, // J
+            { 0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11 }, // K
+            { 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1f }, // L
+            { 0x11, 0x1b, 0x15, 0x15, 0x11, 0x11, 0x11 }, // M
+            { 0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11 }, // N
+            { 0x0e, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e }, // O
+            { 0x1e, 0x11, 0x11, 0x1e, 0x10, 0x10, 0x10 }, // P
+            { 0x0e, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0d }, // Q
+            { 0x1e, 0x11, 0x11, 0x1e, 0x14, 0x12, 0x11 }, // R
+            { 0x0f, 0x10, 0x10, 0x0e, 0x01, 0x01, 0x1e }, // S
+            { 0x1f, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }, // T
+            { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0e }, // U
+            { 0x11, 0x11, 0x11, 0x11, 0x11, 0x0a, 0x04 }, // V
+            { 0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0a }, // W
+            { 0x11, 0x11, 0x0a, 0x04, 0x0a, 0x11, 0x11 }, // X
+            { 0x11, 0x11, 0x11, 0x0a, 0x04, 0x04, 0x04 }, // Y
+            { 0x1f, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1f }, // Z
+            { 0x0e, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0e }, // [
+            { 0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00 }, // backslash
+            { 0x0e, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0e }, // ]
+            { 0x04, 0x0a, 0x11, 0x00, 0x00, 0x00, 0x00 }, // ^
+            { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1f }, // _
+            { 0x08, 0x04, 0x02, 0x00, 0x00, 0x00, 0x00 }, // `
+            { 0x00, 0x00, 0x0e, 0x01, 0x0f, 0x11, 0x0f }, // a
+            { 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x1e }, // b
+            { 0x00, 0x00, 0x0e, 0x10, 0x10, 0x11, 0x0e }, // c
+            { 0x01, 0x01, 0x0d, 0x13, 0x11, 0x11, 0x0f }, // d
+            { 0x00, 0x00, 0x0e, 0x11, 0x1f, 0x10, 0x0e }, // e
+            { 0x06, 0x09, 0x08, 0x1c, 0x08, 0x08, 0x08 }, // f
+            { 0x00, 0x0f, 0x11, 0x11, 0x0f, 0x01, 0x0e }, // g
+            { 0x10, 0x10, 0x16, 0x19, 0x11, 0x11, 0x11 }, // h
+            { 0x04, 0x00, 0x0c, 0x04, 0x04, 0x04, 0x0e }, // i
+            { 0x02, 0x00, 0x06, 0x02, 0x02, 0x12, 0x0c }, // j
+            { 0x10, 0x10, 0x12, 0x14, 0x18, 0x14, 0x12 }, // k
+            { 0x0c, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0e }, // l
+            { 0x00, 0x00, 0x1a, 0x15, 0x15, 0x11, 0x11 }, // m
+            { 0x00, 0x00, 0x16, 0x19, 0x11, 0x11, 0x11 }, // n
+            { 0x00, 0x00, 0x0e, 0x11, 0x11, 0x11, 0x0e }, // o
+            { 0x00, 0x00, 0x1e, 0x11, 0x1e, 0x10, 0x10 }, // p
+            { 0x00, 0x00, 0x0d, 0x13, 0x0f, 0x01, 0x01 }, // q
+            { 0x00, 0x00, 0x16, 0x19, 0x10, 0x10, 0x10 }, // r
+            { 0x00, 0x00, 0x0e, 0x10, 0x0e, 0x01, 0x1e }, // s
+            { 0x08, 0x08, 0x1c, 0x08, 0x08, 0x09, 0x06 }, // t
+            { 0x00, 0x00, 0x11, 0x11, 0x11, 0x13, 0x0d }, // u
+            { 0x00, 0x00, 0x11, 0x11, 0x11, 0x0a, 0x04 }, // v
+            { 0x00, 0x00, 0x11, 0x11, 0x15, 0x15, 0x0a }, // w
+            { 0x00, 0x00, 0x11, 0x0a, 0x04, 0x0a, 0x11 }, // x
+            { 0x00, 0x00, 0x11, 0x11, 0x0f, 0x01, 0x0e }, // y
+            { 0x00, 0x00, 0x1f, 0x02, 0x04, 0x08, 0x1f }, // z
+            { 0x02, 0x04, 0x04, 0x08, 0x04, 0x04, 0x02 }, // {
+            { 0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04 }, // |
+            { 0x08, 0x04, 0x04, 0x02, 0x04, 0x04, 0x08 }, // }
+            { 0x00, 0x00, 0x08, 0x15, 0x02, 0x00, 0x00 }, // ~
+    };
+
+    static const char *GetHudVertexCode() {
+        return R"(
+            #version 330 core
+            layout (location = 0) in vec2 position;
+            layout (location = 1) in vec2 uv;
+            layout (location = 2) in vec4 color;
+
+            out vec2 fsUv;
+            out vec4 fsColor;
+
+            uniform vec2 viewportSize;
+            uniform float colorExponent;
+
+            void main() {
+                fsUv = uv;
+                fsColor = vec4(pow(color.rgb, vec3(colorExponent)), color.a);
+                gl_Position = vec4(position / viewportSize * vec2(2.0f, -2.0f) + vec2(-1.0f, 1.0f), 0.0f, 1.0f);
+            }
+        )";
+    }
+
+    static const char *GetHudFragmentCode() {
+        return R"(
+            #version 330 core
+            layout (location = 0) out vec4 outColor;
+
+            in vec2 fsUv;
+            in vec4 fsColor;
+
+            uniform sampler2D atlas;
+
+            // Glyphs are white with coverage in alpha, graph texels carry their own color
+            void main() {
+                outColor = fsColor * texture(atlas, fsUv);
+            }
+        )";
+    }
+
+    HwHud::HwHud(const InitParams &params) {
+        assert(params.scale > 0);
+        assert(params.maxQuads > 0 && params.maxQuads <= MAX_QUADS);
+        assert(params.graphSamples > 0);
+
+        mScale = (float) params.scale;
+        mMaxQuads = params.maxQuads;
+        mGraphHeight = params.graphHeight;
+        mGraphMaxMs = params.graphMaxMs;
+        mGraphTargetMs = params.graphTargetMs;
+        mColorExponent = params.srgbFramebuffer ? 2.2f : 1.0f;
+        mPanel = params.panel;
+
+        mVertices.reserve(mMaxQuads * 4);
+        mFrameTimes.resize(params.graphSamples, 0.0f);
+        mGraphColumns.resize(params.graphSamples * mGraphHeight * 4, 0);
+        mCachedLines.resize(params.cachedLines);
+        mDirtyLinesBegin = params.cachedLines;
+        mLinePixels.resize(params.cachedLines * MAX_LINE_LENGTH * CELL_WIDTH * CELL_HEIGHT * 4, 0);
+
+        for (auto& line: mCachedLines) {
+            line.reserve(MAX_LINE_LENGTH);
+        }
+
+        mShader.reset(new HwShader(GetHudVertexCode(), GetHudFragmentCode()));
+        mGpuTimer.reset(new HwGpuTimer());
+        CreateAtlas();
+
+        const HwGeometry::Attribute attributes[] = {
+            {offsetof(Vertex, position), 2, GL_FLOAT, false},
+            {offsetof(Vertex, uv), 2, GL_UNSIGNED_SHORT, true},
+            {offsetof(Vertex, color), 4, GL_UNSIGNED_BYTE, true}
+        };
+
+        // Index pattern of quads is the same every frame
+        std::vector<uint16_t> indices;
+        indices.reserve(mMaxQuads * 6);
+
+        for (size_t i = 0; i < mMaxQuads; i++) {
+            auto first = (uint16_t) (i * 4);
+            uint16_t quad[] = {first, (uint16_t) (first + 1), (uint16_t) (first + 2),
+                               (uint16_t) (first + 2), (uint16_t) (first + 1), (uint16_t) (first + 3)};
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+
+        glGenVertexArrays(1, &mVAO);
+        glBindVertexArray(mVAO);
+
+        glGenBuffers(1, &mVertexBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * 4 * mMaxQuads, nullptr, GL_STREAM_DRAW);
+
+        // Element array binding is stored in the VAO
+        glGenBuffers(1, &mIndexBuffer);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIndexBuffer);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint16_t) * indices.size(), indices.data(), GL_STATIC_DRAW);
+
+        for (GLuint i = 0; i < sizeof(attributes) / sizeof(attributes[0]); i++) {
+            auto& attrib = attributes[i];
+
+            glEnableVertexAttribArray(i);
+            glVertexAttribPointer(
+                i,
+                attrib.components,
+                attrib.baseType,
+                attrib.normalize ? GL_TRUE : GL_FALSE,
+                sizeof(Vertex),
+                (void *) attrib.offset
+            );
+        }
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    }
+
+    HwHud::~HwHud() {
+        glDeleteBuffers(1, &mVertexBuffer);
+        glDeleteBuffers(1, &mIndexBuffer);
+        glDeleteVertexArrays(1, &mVAO);
+    }
+
+    void HwHud::AddFrameTime(float ms) {
+        mFrameTimes[mNextFrameTime] = ms;
+        mNextFrameTime = (mNextFrameTime + 1) % mFrameTimes.size();
+        mDirtyColumns = std::min(mDirtyColumns + 1, mFrameTimes.size());
+    }
+
+    void HwHud::Print(uint32_t color, const char *format, ...) {
+        auto start = std::chrono::steady_clock::now();
+
+        char line[128];
+        va_list args;
+        va_start(args, format);
+        int length = std::vsnprintf(line, sizeof(line), format, args);
+        va_end(args);
+
+        length = std::min(std::max(length, 0), (int) sizeof(line) - 1);
+
+        if (mVertices.empty()) {
+            AddCellQuad(0.0f, 0.0f, 0.0f, 0.0f, SOLID_CELL, COLOR_PANEL);
+        }
+
+        float cell = mScale;
+        float x = cell * CELL_WIDTH;
+        float y = cell * CELL_HEIGHT * (float) (mLines + 1);
+
+        if (mLines < mCachedLines.size()) {
+            if (mCachedLines[mLines].compare(0, std::string::npos, line, length) != 0) {
+                UpdateLine(mLines, line, length);
+            }
+
+            if (length > 0) {
+                auto top = (float) (ATLAS_ROWS * CELL_HEIGHT + mGraphHeight + mLines * CELL_HEIGHT);
+                auto width = (float) (length * CELL_WIDTH);
+                AddQuad(x, y, cell * width, cell * CELL_HEIGHT, glm::vec2(0.0f, top), glm::vec2(width, top + CELL_HEIGHT), color);
+            }
+        }
+        else {
+            for (int i = 0; i < length; i++) {
+                auto c = (unsigned char) line[i];
+
+                if (c > FIRST_CHAR && c < FIRST_CHAR + CHARS_COUNT) {
+                    AddCellQuad(x + cell * CELL_WIDTH * (float) i, y, cell * GLYPH_WIDTH, cell * GLYPH_HEIGHT, c - FIRST_CHAR, color);
+                }
+            }
+        }
+
+        mLines += 1;
+        mMaxColumns = std::max(mMaxColumns, (unsigned) length);
+        mFrameCpuTime += std::chrono::steady_clock::now() - start;
+    }
+
+    void HwHud::Draw(glm::uvec2 framebufferSize) {
+        auto start = std::chrono::steady_clock::now();
+
+        if (mVertices.empty()) {
+            AddCellQuad(0.0f, 0.0f, 0.0f, 0.0f, SOLID_CELL, COLOR_PANEL);
+        }
+
+        UploadLines();
+        UpdateGraph();
+
+        // Graph: ring of columns from the oldest to the newest (two quads), budget line over it
+        float cell = mScale;
+        float graphLeft = cell * CELL_WIDTH;
+        float graphTop = cell * CELL_HEIGHT * (float) (mLines + 1) + (mLines > 0 ? cell * CELL_HEIGHT * 0.5f : 0.0f);
+        float graphHeight = cell * (float) mGraphHeight;
+        float graphWidth = cell * (float) mFrameTimes.size();
+        float graphBottom = graphTop + graphHeight;
+
+        auto samples = (float) mFrameTimes.size();
+        auto oldest = (float) mNextFrameTime;
+        float graphV0 = (float) (ATLAS_ROWS * CELL_HEIGHT);
+        float graphV1 = graphV0 + (float) mGraphHeight;
+
+        AddQuad(graphLeft, graphTop, cell * (samples - oldest), graphHeight,
+                glm::vec2(oldest, graphV0), glm::vec2(samples, graphV1), COLOR_TEXT);
+
+        if (mNextFrameTime > 0) {
+            AddQuad(graphLeft + cell * (samples - oldest), graphTop, cell * oldest, graphHeight,
+                    glm::vec2(0.0f, graphV0), glm::vec2(oldest, graphV1), COLOR_TEXT);
+        }
+
+        float targetHeight = graphHeight * std::min(mGraphTargetMs / mGraphMaxMs, 1.0f);
+        AddCellQuad(graphLeft, graphBottom - targetHeight, graphWidth, std::max(1.0f, cell * 0.5f), SOLID_CELL, COLOR_TEXT);
+
+        // Panel around text and graph (empty quad, if disabled)
+        if (mPanel) {
+            float textWidth = cell * CELL_WIDTH * (float) mMaxColumns;
+            float panelWidth = std::max(textWidth, graphWidth) + 2.0f * graphLeft;
+            float panelHeight = graphBottom + cell * CELL_HEIGHT;
+            mVertices[1].position[0] = panelWidth;
+            mVertices[2].position[1] = panelHeight;
+            mVertices[3].position[0] = panelWidth;
+            mVertices[3].position[1] = panelHeight;
+        }
+
+        size_t quads = mVertices.size() / 4;
+
+        // Orphan previous storage, so we do not wait for the draw of the previous frame
+        glBindBuffer(GL_ARRAY_BUFFER, mVertexBuffer);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * 4 * mMaxQuads, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(Vertex) * mVertices.size(), mVertices.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        static const std::string VIEWPORT_SIZE = "viewportSize";
+        static const std::string COLOR_EXPONENT = "colorExponent";
+        static const std::string ATLAS = "atlas";
+
+        mGpuTimer->Begin();
+
+        glEnable(GL_BLEND);
+        glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+        mShader->Bind();
+        mShader->SetVec2(VIEWPORT_SIZE, glm::vec2(framebufferSize));
+        mShader->SetFloat(COLOR_EXPONENT, mColorExponent);
+        mShader->SetTexture(ATLAS, *mAtlas, 0);
+
+        glBindVertexArray(mVAO);
+        glDrawElements(GL_TRIANGLES, (GLsizei) (quads * 6), GL_UNSIGNED_SHORT, nullptr);
+        glBindVertexArray(0);
+
+        mShader->Unbind();
+        glDisable(GL_BLEND);
+
+        mGpuTimer->End();
+
+        mLastQuads = quads;
+        mVertices.clear();
+        mLines = 0;
+        mMaxColumns = 0;
+
+        mFrameCpuTime += std::chrono::steady_clock::now() - start;
+        auto cpuUs = std::chrono::duration<double, std::micro>(mFrameCpuTime).count();
+        mFrameCpuTime = std::chrono::steady_clock::duration{};
+
+        mFrames += 1;
+        mCpuSumUs += cpuUs;
+        mCpuMaxUs = std::max(mCpuMaxUs, cpuUs);
+    }
+
+    HwHud::Stats HwHud::GetStats() const {
+        Stats stats;
+        stats.frames = mFrames;
+        stats.quads = mLastQuads;
+        stats.droppedQuads = mDroppedQuads;
+        stats.uploadedLines = mUploadedLines;
+        stats.averageCpuUs = mFrames ? mCpuSumUs / (double) mFrames : 0.0;
+        stats.maxCpuUs = mCpuMaxUs;
+        stats.averageGpuUs = mGpuTimer->GetStats().averageUs;
+        return stats;
+    }
+
+    void HwHud::Report(std::ostream &stream, const char *label) const {
+        auto stats = GetStats();
+
+        stream << "HUD (" << label << "): " << stats.frames << " frames, "
+               << stats.quads << " quads per draw, "
+               << "dropped " << stats.droppedQuads << ", "
+               << "uploaded " << stats.uploadedLines << " lines, "
+               << "cpu avg " << stats.averageCpuUs << " us, "
+               << "max " << stats.maxCpuUs << " us, "
+               << "gpu avg " << stats.averageGpuUs << " us" << std::endl;
+    }
+
+    void HwHud::RasterizeCell(uint8_t *pixels, size_t stride, unsigned left, unsigned top, unsigned cell) {
+        for (unsigned y = 0; y < CELL_HEIGHT; y++) {
+            for (unsigned x = 0; x < CELL_WIDTH; x++) {
+                bool set = cell == SOLID_CELL ||
+                           (x < GLYPH_WIDTH && y < GLYPH_HEIGHT && ((FONT_5X7[cell][y] >> (GLYPH_WIDTH - 1 - x)) & 1));
+
+                // White texel with coverage in alpha
+                auto pixel = &pixels[((top + y) * stride + left + x) * 4];
+                pixel[0] = pixel[1] = pixel[2] = 255;
+                pixel[3] = set ? 255 : 0;
+            }
+        }
+    }
+
+    void HwHud::CreateAtlas() {
+        // Font cells on top, graph ring under them, cached lines at the bottom
+        unsigned width = std::max({ATLAS_COLUMNS * CELL_WIDTH, (unsigned) mFrameTimes.size(), MAX_LINE_LENGTH * CELL_WIDTH});
+        unsigned height = ATLAS_ROWS * CELL_HEIGHT + mGraphHeight + (unsigned) mCachedLines.size() * CELL_HEIGHT;
+        glm::uvec2 size{width, height};
+        std::vector<uint8_t> pixels(size.x * size.y * 4, 0);
+
+        // Glyphs and solid cell for panel and budget line (the whole cell is filled, so sampling its glyph rect never bleeds)
+        for (unsigned cell = 0; cell <= SOLID_CELL; cell++) {
+            RasterizeCell(pixels.data(), size.x, (cell % ATLAS_COLUMNS) * CELL_WIDTH, (cell / ATLAS_COLUMNS) * CELL_HEIGHT, cell);
+        }
+
+        HwTexture::InitParams params;
+        params.size = size;
+        params.internalFormat = GL_RGBA8;
+        params.minFilter = GL_NEAREST;
+        params.magFilter = GL_NEAREST;
+        mAtlas.reset(new HwTexture(params));
+        mAtlas->Update(glm::uvec2(0, 0), size, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        mAtlasSize = size;
+    }
+
+    void HwHud::UpdateGraph() {
+        if (mDirtyColumns == 0) {
+            return;
+        }
+
+        // Bar colors are decoded here, shader decodes only vertex colors
+        auto decode = [this](uint32_t color, uint8_t *texel) {
+            for (unsigned c = 0; c < 3; c++) {
+                auto value = (float) ((color >> (24 - 8 * c)) & 0xffu) / 255.0f;
+                texel[c] = (uint8_t) std::lround(std::pow(value, mColorExponent) * 255.0f);
+            }
+
+            texel[3] = (uint8_t) color;
+        };
+
+        size_t samples = mFrameTimes.size();
+        size_t first = (mNextFrameTime + samples - mDirtyColumns) % samples;
+
+        for (size_t i = 0; i < mDirtyColumns; i++) {
+            size_t column = (first + i) % samples;
+            float ms = mFrameTimes[column];
+            auto filled = (unsigned) std::lround((float) mGraphHeight * std::min(ms / mGraphMaxMs, 1.0f));
+            uint32_t color = ms <= mGraphTargetMs ? COLOR_GOOD : ms <= mGraphTargetMs * 2.0f ? COLOR_WARNING : COLOR_BAD;
+
+            uint8_t texel[4];
+            decode(color, texel);
+
+            // Column is stored as one pixel wide image: rows from the top, bar grows from the bottom
+            uint8_t *pixels = &mGraphColumns[column * mGraphHeight * 4];
+            for (unsigned row = 0; row < mGraphHeight; row++) {
+                bool set = row >= mGraphHeight - filled;
+                for (unsigned c = 0; c < 4; c++) {
+                    pixels[row * 4 + c] = set ? texel[c] : 0;
+                }
+            }
+        }
+
+        // Few columns are uploaded one by one, wrapped or long runs as the whole ring
+        glm::uvec2 graphOffset{0, ATLAS_ROWS * CELL_HEIGHT};
+
+        if (mDirtyColumns <= 4) {
+            for (size_t i = 0; i < mDirtyColumns; i++) {
+                size_t column = (first + i) % samples;
+                mAtlas->Update(graphOffset + glm::uvec2(column, 0), glm::uvec2(1, mGraphHeight), GL_RGBA, GL_UNSIGNED_BYTE,
+                               &mGraphColumns[column * mGraphHeight * 4]);
+            }
+        }
+        else {
+            // Columns are stored one after another, image rows are interleaved
+            std::vector<uint8_t> rows(samples * mGraphHeight * 4);
+            for (size_t column = 0; column < samples; column++) {
+                for (unsigned row = 0; row < mGraphHeight; row++) {
+                    std::copy_n(&mGraphColumns[(column * mGraphHeight + row) * 4], 4, &rows[(row * samples + column) * 4]);
+                }
+            }
+
+            mAtlas->Update(graphOffset, glm::uvec2(samples, mGraphHeight), GL_RGBA, GL_UNSIGNED_BYTE, rows.data());
+        }
+
+        mDirtyColumns = 0;
+    }
+
+    void HwHud::UpdateLine(unsigned row, const char *text, size_t length) {
+        size_t stride = MAX_LINE_LENGTH * CELL_WIDTH;
+
+        for (size_t i = 0; i < length; i++) {
+            auto c = (unsigned char) text[i];
+            unsigned cell = c >= FIRST_CHAR && c < FIRST_CHAR + CHARS_COUNT ? c - FIRST_CHAR : 0;
+            RasterizeCell(mLinePixels.data(), stride, (unsigned) i * CELL_WIDTH, row * CELL_HEIGHT, cell);
+        }
+
+        mCachedLines[row].assign(text, length);
+        mDirtyLinesBegin = std::min(mDirtyLinesBegin, row);
+        mDirtyLinesEnd = std::max(mDirtyLinesEnd, row + 1);
+        mDirtyLineColumns = std::max(mDirtyLineColumns, (unsigned) length);
+    }
+
+    void HwHud::UploadLines() {
+        if (mDirtyLinesBegin >= mDirtyLinesEnd || mDirtyLineColumns == 0) {
+            mDirtyLinesBegin = (unsigned) mCachedLines.size();
+            mDirtyLinesEnd = 0;
+            return;
+        }
+
+        // Changed lines go in one upload: rows between them are not changed, so uploading them again is harmless
+        glm::uvec2 offset{0, ATLAS_ROWS * CELL_HEIGHT + mGraphHeight + mDirtyLinesBegin * CELL_HEIGHT};
+        glm::uvec2 size{mDirtyLineColumns * CELL_WIDTH, (mDirtyLinesEnd - mDirtyLinesBegin) * CELL_HEIGHT};
+        auto pixels = &mLinePixels[mDirtyLinesBegin * CELL_HEIGHT * MAX_LINE_LENGTH * CELL_WIDTH * 4];
+
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, MAX_LINE_LENGTH * CELL_WIDTH);
+        mAtlas->Update(offset, size, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+
+        mUploadedLines += mDirtyLinesEnd - mDirtyLinesBegin;
+        mDirtyLinesBegin = (unsigned) mCachedLines.size();
+        mDirtyLinesEnd = 0;
+        mDirtyLineColumns = 0;
+    }
+
+    void HwHud::AddCellQuad(float x, float y, float w, float h, unsigned cell, uint32_t color) {
+        auto left = (float) ((cell % ATLAS_COLUMNS) * CELL_WIDTH);
+        auto top = (float) ((cell / ATLAS_COLUMNS) * CELL_HEIGHT);
+
+        AddQuad(x, y, w, h, glm::vec2(left, top), glm::vec2(left + GLYPH_WIDTH, top + GLYPH_HEIGHT), color);
+    }
+
+    void HwHud::AddQuad(float x, float y, float w, float h, glm::vec2 uv0, glm::vec2 uv1, uint32_t color) {
+        if (mVertices.size() >= mMaxQuads * 4) {
+            mDroppedQuads += 1;
+            return;
+        }
+
+        // Texel coordinates to unorm16
+        float uScale = 65535.0f / (float) mAtlasSize.x;
+        float vScale = 65535.0f / (float) mAtlasSize.y;
+
+        auto u0 = (uint16_t) (uv0.x * uScale);
+        auto v0 = (uint16_t) (uv0.y * vScale);
+        auto u1 = (uint16_t) (uv1.x * uScale);
+        auto v1 = (uint16_t) (uv1.y * vScale);
+
+        Vertex vertex;
+        vertex.color[0] = (uint8_t) (color >> 24);
+        vertex.color[1] = (uint8_t) (color >> 16);
+        vertex.color[2] = (uint8_t) (color >> 8);
+        vertex.color[3] = (uint8_t) color;
+
+        // Corners in Z order: top left, top right, bottom left, bottom right
+        for (unsigned corner = 0; corner < 4; corner++) {
+            bool right = corner & 1;
+            bool bottom = corner >> 1;
+
+            vertex.position[0] = right ? x + w : x;
+            vertex.position[1] = bottom ? y + h : y;
+            vertex.uv[0] = right ? u1 : u0;
+            vertex.uv[1] = bottom ? v1 : v0;
+            mVertices.push_back(vertex);
+        }
+    }
+
+}
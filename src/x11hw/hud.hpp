@@ -0,0 +1,201 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_HUD_HPP
+#define X11HELLOWORLD_HUD_HPP
+
+#include <GL/glew.h>
+#include <glm/vec2.hpp>
+#include <chrono>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace x11hw {
+
+    /**
+     * Performance overlay: text lines and frame time graph in the top left corner.
+     * Glyphs come from the atlas of the embedded 5x7 bitmap font, built once. Frame time
+     * graph is a ring of texel columns in the same texture, one column is uploaded per frame,
+     * so the graph is two quads instead of a quad per bar. Text lines are cached as texture rows
+     * as well: a line is rasterized only when its text changes (changed lines are uploaded at once)
+     * and is drawn as one quad.
+     * Panel, lines and graph are quads of a single stream buffer, drawn with one indexed draw.
+     * Quads are not instanced: software rasterizers (llvmpipe) run vertex pipeline per
+     * instance, what makes a few hundred instances cost more than the whole frame.
+     * Blended panel is the largest area of the overlay, it may be disabled where fill rate is scarce.
+     * Text is formatted into stack buffers, so a frame of the HUD does not allocate.
+     */
+    class HwHud {
+    public:
+        struct InitParams {
+            /** Integer scale of the font pixels */
+            unsigned scale = 2;
+            /** Quads per frame (panel, lines, glyphs of uncached lines and graph), the rest is dropped */
+            size_t maxQuads = 512;
+            /** Lines cached as texture rows, further lines are drawn as quad per glyph */
+            unsigned cachedLines = 8;
+            /** Frame times in the graph ring */
+            size_t graphSamples = 240;
+            /** Graph height in font pixels */
+            unsigned graphHeight = 30;
+            /** Frame time at the top of the graph */
+            float graphMaxMs = 33.3f;
+            /** Frame budget, slower frames are highlighted */
+            float graphTargetMs = 16.7f;
+            /** Colors are given in sRGB, decode them if framebuffer encodes on write */
+            bool srgbFramebuffer = false;
+            /** Draw translucent panel under text and graph */
+            bool panel = true;
+
+            InitParams() {}
+        };
+
+        struct Stats {
+            size_t frames = 0;
+            size_t quads = 0;
+            size_t droppedQuads = 0;
+            size_t uploadedLines = 0;
+            double averageCpuUs = 0.0;
+            double maxCpuUs = 0.0;
+            double averageGpuUs = 0.0;
+        };
+
+        /** Packed 0xRRGGBBAA colors */
+        static const uint32_t COLOR_TEXT = 0xffffffff;
+        static const uint32_t COLOR_WARNING = 0xffd040ff;
+        static const uint32_t COLOR_GOOD = 0x40e060ff;
+        static const uint32_t COLOR_BAD = 0xff4040ff;
+        static const uint32_t COLOR_PANEL = 0x000000a0;
+
+        explicit HwHud(const InitParams &params = InitParams());
+        HwHud(const HwHud&) = delete;
+        HwHud(HwHud&&) = delete;
+        ~HwHud();
+
+        /**
+         * Push frame time into graph ring
+         * @param ms Frame time in milliseconds
+         */
+        void AddFrameTime(float ms);
+
+        /**
+         * Add text line (printf format, at most 127 characters) to the current frame.
+         * Line is uploaded only if it differs from the line printed at the same row in the previous frame.
+         * @param color Packed 0xRRGGBBAA color
+         * @param format Format string
+         */
+        void Print(uint32_t color, const char *format, ...);
+
+        /**
+         * Draw lines added since the previous draw and the graph over the current framebuffer
+         * @param framebufferSize Framebuffer size in pixels
+         */
+        void Draw(glm::uvec2 framebufferSize);
+
+        /** @return Cost of the HUD (CPU time of Print and Draw, GPU time of the draw, lags few frames) */
+        Stats GetStats() const;
+
+        /** Print statistics */
+        void Report(std::ostream &stream, const char *label) const;
+
+    private:
+        // Vertex of quad: pixel position, atlas position (unorm16), color (unorm8)
+        struct Vertex {
+            float position[2];
+            uint16_t uv[2];
+            uint8_t color[4];
+        };
+
+        static const unsigned GLYPH_WIDTH = 5;
+        static const unsigned GLYPH_HEIGHT = 7;
+        static const unsigned CELL_WIDTH = GLYPH_WIDTH + 1;
+        static const unsigned CELL_HEIGHT = GLYPH_HEIGHT + 1;
+        static const unsigned ATLAS_COLUMNS = 16;
+        static const unsigned ATLAS_ROWS = 6;
+        static const unsigned FIRST_CHAR = 32;
+        static const unsigned CHARS_COUNT = 95;
+        static const unsigned SOLID_CELL = CHARS_COUNT;
+        static const size_t MAX_QUADS = 16384; // 16 bit indices
+        static const unsigned MAX_LINE_LENGTH = 127;
+
+        static void RasterizeCell(uint8_t *pixels, size_t stride, unsigned left, unsigned top, unsigned cell);
+
+        void CreateAtlas();
+        void UpdateLine(unsigned row, const char *text, size_t length);
+        void UploadLines();
+        void UpdateGraph();
+        void AddCellQuad(float x, float y, float w, float h, unsigned cell, uint32_t color);
+        void AddQuad(float x, float y, float w, float h, glm::vec2 uv0, glm::vec2 uv1, uint32_t color);
+
+    private:
+        std::unique_ptr<class HwShader> mShader;
+        std::unique_ptr<class HwTexture> mAtlas;
+        std::unique_ptr<class HwGpuTimer> mGpuTimer;
+        glm::uvec2 mAtlasSize{};
+        GLuint mVAO = 0;
+        GLuint mVertexBuffer = 0;
+        GLuint mIndexBuffer = 0;
+
+        // First quad is the panel, its size is known only at draw
+        std::vector<Vertex> mVertices;
+        size_t mMaxQuads = 0;
+        size_t mDroppedQuads = 0;
+        size_t mLastQuads = 0;
+        unsigned mLines = 0;
+        unsigned mMaxColumns = 0;
+
+        // Text of the cached lines (capacity is reserved, so updates do not allocate), their texels
+        // and rows changed since the last upload
+        std::vector<std::string> mCachedLines;
+        std::vector<uint8_t> mLinePixels;
+        unsigned mDirtyLinesBegin = 0;
+        unsigned mDirtyLinesEnd = 0;
+        unsigned mDirtyLineColumns = 0;
+        size_t mUploadedLines = 0;
+
+        // Graph ring: frame times, texel columns (RGBA, top row first) and columns not uploaded yet
+        std::vector<float> mFrameTimes;
+        std::vector<uint8_t> mGraphColumns;
+        size_t mNextFrameTime = 0;
+        size_t mDirtyColumns = 0;
+
+        float mScale = 2.0f;
+        unsigned mGraphHeight = 30;
+        float mGraphMaxMs = 33.3f;
+        float mGraphTargetMs = 16.7f;
+        float mColorExponent = 1.0f;
+        bool mPanel = true;
+
+        std::chrono::steady_clock::duration mFrameCpuTime{};
+        size_t mFrames = 0;
+        double mCpuSumUs = 0.0;
+        double mCpuMaxUs = 0.0;
+    };
+
+}
+
+#endif //X11HELLOWORLD_HUD_HPP
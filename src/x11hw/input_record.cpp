@@ -0,0 +1,260 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/input_record.hpp>
+#include <x11hw/error.hpp>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+
+namespace x11hw {
+
+    static const char INPUT_LOG_MAGIC[8] = {'X', '1', '1', 'H', 'W', 'I', 'N', 'P'};
+    static const uint32_t INPUT_LOG_VERSION = 1;
+
+    HwInputRecorder::HwInputRecorder(const std::string &path) {
+        mFile = std::fopen(path.c_str(), "wb");
+        CHECK_MSG(mFile, "Failed to open input log for writing");
+
+        std::fwrite(INPUT_LOG_MAGIC, sizeof(INPUT_LOG_MAGIC), 1, mFile);
+        Write<uint32_t>(INPUT_LOG_VERSION);
+
+        mStart = std::chrono::steady_clock::now();
+    }
+
+    HwInputRecorder::~HwInputRecorder() {
+        std::fclose(mFile);
+        mFile = nullptr;
+    }
+
+    void HwInputRecorder::RecordInput(uint32_t frame, const std::string &window, const HwWindow::EventData &event) {
+        auto timestamp = GetTimestamp();
+        auto id = GetWindowId(frame, timestamp, window);
+
+        WriteHeader(HwInputRecord::Kind::Input, frame, timestamp, id);
+        Write<uint8_t>((uint8_t) event.type);
+        Write<uint8_t>((uint8_t) event.mouseButton);
+        Write<int32_t>(event.mousePosition.x);
+        Write<int32_t>(event.mousePosition.y);
+
+        mRecordsCount += 1;
+    }
+
+    void HwInputRecorder::RecordClose(uint32_t frame, const std::string &window) {
+        auto timestamp = GetTimestamp();
+        auto id = GetWindowId(frame, timestamp, window);
+
+        WriteHeader(HwInputRecord::Kind::Close, frame, timestamp, id);
+        // Close must survive crash of the application right after the request
+        std::fflush(mFile);
+
+        mRecordsCount += 1;
+    }
+
+    uint16_t HwInputRecorder::GetWindowId(uint32_t frame, uint64_t timestamp, const std::string &window) {
+        auto found = mWindowIds.find(window);
+
+        if (found != mWindowIds.end()) {
+            return found->second;
+        }
+
+        CHECK_MSG(mWindowIds.size() < UINT16_MAX, "Too many windows in input log");
+        CHECK_MSG(window.size() < UINT16_MAX, "Too long window name for input log");
+
+        auto id = (uint16_t) mWindowIds.size();
+        mWindowIds.emplace(window, id);
+
+        WriteHeader(HwInputRecord::Kind::Window, frame, timestamp, id);
+        Write<uint16_t>((uint16_t) window.size());
+        std::fwrite(window.data(), 1, window.size(), mFile);
+
+        return id;
+    }
+
+    uint64_t HwInputRecorder::GetTimestamp() const {
+        auto elapsed = std::chrono::steady_clock::now() - mStart;
+        return (uint64_t) std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    }
+
+    void HwInputRecorder::WriteHeader(HwInputRecord::Kind kind, uint32_t frame, uint64_t timestamp, uint16_t window) {
+        Write<uint8_t>((uint8_t) kind);
+        Write<uint32_t>(frame);
+        Write<uint64_t>(timestamp);
+        Write<uint16_t>(window);
+    }
+
+    class HwInputLogReader {
+    public:
+        explicit HwInputLogReader(std::vector<uint8_t> data) : mData(std::move(data)) {}
+
+        template<typename T>
+        T Read() {
+            CHECK_MSG(mOffset + sizeof(T) <= mData.size(), "Unexpected end of input log");
+            T value;
+            std::memcpy(&value, mData.data() + mOffset, sizeof(T));
+            mOffset += sizeof(T);
+            return value;
+        }
+
+        std::string ReadString(size_t length) {
+            CHECK_MSG(mOffset + length <= mData.size(), "Unexpected end of input log");
+            std::string value((const char *) mData.data() + mOffset, length);
+            mOffset += length;
+            return value;
+        }
+
+        bool IsEnd() const { return mOffset >= mData.size(); }
+
+    private:
+        std::vector<uint8_t> mData;
+        size_t mOffset = 0;
+    };
+
+    HwInputReplay::HwInputReplay(const std::string &path, bool realtime) {
+        mRealtime = realtime;
+
+        // Log is small, read it at once, so replay does not touch the disk during the run
+        std::FILE *file = std::fopen(path.c_str(), "rb");
+        CHECK_MSG(file, "Failed to open input log for reading");
+
+        std::vector<uint8_t> data;
+        uint8_t chunk[4096];
+        size_t read;
+
+        while ((read = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+            data.insert(data.end(), chunk, chunk + read);
+        }
+
+        std::fclose(file);
+
+        HwInputLogReader reader(std::move(data));
+
+        CHECK_MSG(reader.ReadString(sizeof(INPUT_LOG_MAGIC)) == std::string(INPUT_LOG_MAGIC, sizeof(INPUT_LOG_MAGIC)), "Not an input log file");
+        CHECK_MSG(reader.Read<uint32_t>() == INPUT_LOG_VERSION, "Unsupported input log version");
+
+        while (!reader.IsEnd()) {
+            HwInputRecord record;
+            record.kind = (HwInputRecord::Kind) reader.Read<uint8_t>();
+            record.frame = reader.Read<uint32_t>();
+            record.timestamp = reader.Read<uint64_t>();
+            record.window = reader.Read<uint16_t>();
+
+            // Due records and frame time lookup rely on the order
+            CHECK_MSG(mRecords.empty() || mRecords.back().frame <= record.frame, "Input log records are not in frame order");
+
+            switch (record.kind) {
+                case HwInputRecord::Kind::Window: {
+                    CHECK_MSG(record.window == mWindowNames.size(), "Invalid window id in input log");
+                    auto length = reader.Read<uint16_t>();
+                    mWindowNames.push_back(reader.ReadString(length));
+                    break;
+                }
+                case HwInputRecord::Kind::Input: {
+                    auto type = reader.Read<uint8_t>();
+                    auto button = reader.Read<uint8_t>();
+                    CHECK_MSG(type <= (uint8_t) HwWindow::EventType::Unknown, "Invalid event type in input log");
+                    CHECK_MSG(button <= (uint8_t) HwWindow::MouseButton::Unknown, "Invalid mouse button in input log");
+
+                    record.event.type = (HwWindow::EventType) type;
+                    record.event.mouseButton = (HwWindow::MouseButton) button;
+                    record.event.mousePosition.x = reader.Read<int32_t>();
+                    record.event.mousePosition.y = reader.Read<int32_t>();
+                    CHECK_MSG(record.window < mWindowNames.size(), "Undeclared window id in input log");
+                    mRecords.push_back(record);
+                    break;
+                }
+                case HwInputRecord::Kind::Close: {
+                    CHECK_MSG(record.window < mWindowNames.size(), "Undeclared window id in input log");
+                    mRecords.push_back(record);
+                    break;
+                }
+                default:
+                    throw std::runtime_error("Invalid record kind in input log");
+            }
+        }
+    }
+
+    bool HwInputReplay::Next(uint32_t frame, HwInputRecord &record) {
+        if (IsFinished()) {
+            return false;
+        }
+
+        if (!mStarted) {
+            mStart = std::chrono::steady_clock::now();
+            mStarted = true;
+        }
+
+        auto& next = mRecords[mNext];
+
+        if (mRealtime) {
+            auto elapsed = std::chrono::steady_clock::now() - mStart;
+            auto elapsedUs = (uint64_t) std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+
+            if (next.timestamp > elapsedUs) {
+                return false;
+            }
+        }
+        else if (next.frame > frame) {
+            return false;
+        }
+
+        record = next;
+        mNext += 1;
+
+        // Recorded timeline, so motion keeps its speed (matches wall time only in realtime mode)
+        record.event.time = mStart + std::chrono::microseconds(next.timestamp);
+
+        return true;
+    }
+
+    std::chrono::steady_clock::time_point HwInputReplay::GetFrameTime(uint32_t frame) const {
+        // Records are in frame order
+        auto after = std::upper_bound(mRecords.begin(), mRecords.end(), frame, [](uint32_t f, const HwInputRecord &record) {
+            return f < record.frame;
+        });
+
+        double timestamp = 0.0;
+
+        if (mRecords.empty()) {
+            timestamp = 0.0;
+        }
+        else if (after == mRecords.begin()) {
+            // Before the first record: timeline starts at frame 0
+            timestamp = after->frame > 0 ? (double) after->timestamp * frame / after->frame : 0.0;
+        }
+        else if (after == mRecords.end()) {
+            auto& last = mRecords.back();
+            double frameUs = last.frame > 0 ? (double) last.timestamp / last.frame : 0.0;
+            timestamp = (double) last.timestamp + frameUs * (frame - last.frame);
+        }
+        else {
+            auto& before = *(after - 1);
+            double t = (double) (frame - before.frame) / (double) (after->frame - before.frame);
+            timestamp = (double) before.timestamp + t * ((double) after->timestamp - (double) before.timestamp);
+        }
+
+        return mStart + std::chrono::microseconds((int64_t) timestamp);
+    }
+
+}
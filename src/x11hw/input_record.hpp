@@ -0,0 +1,141 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_INPUT_RECORD_HPP
+#define X11HELLOWORLD_INPUT_RECORD_HPP
+
+#include <x11hw/window.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace x11hw {
+
+    /**
+     * Binary input log layout (little-endian, no padding):
+     *
+     *  header: magic "X11HWINP" (8), version (u32)
+     *  record: kind (u8), frame (u32), timestamp in microseconds (u64), window id (u16), payload
+     *
+     *  payload of Window record: name length (u16), name bytes
+     *  payload of Input record:  event type (u8), mouse button (u8), x (i32), y (i32)
+     *  payload of Close record:  empty
+     *
+     * Window record declares id of the window name before first its use.
+     */
+    struct HwInputRecord {
+        enum class Kind : uint8_t {
+            Window = 0,
+            Input = 1,
+            Close = 2
+        };
+
+        Kind kind = Kind::Input;
+        uint32_t frame = 0;
+        uint64_t timestamp = 0;
+        uint16_t window = 0;
+        HwWindow::EventData event;
+    };
+
+    /** Writes window events into binary log */
+    class HwInputRecorder {
+    public:
+        explicit HwInputRecorder(const std::string &path);
+        HwInputRecorder(const HwInputRecorder&) = delete;
+        HwInputRecorder(HwInputRecorder&&) = delete;
+        ~HwInputRecorder();
+
+        /** Record input event of the window at specified frame */
+        void RecordInput(uint32_t frame, const std::string &window, const HwWindow::EventData &event);
+
+        /** Record close request of the window at specified frame */
+        void RecordClose(uint32_t frame, const std::string &window);
+
+        /** @return Number of recorded events */
+        size_t GetRecordsCount() const { return mRecordsCount; }
+
+    private:
+        uint16_t GetWindowId(uint32_t frame, uint64_t timestamp, const std::string &window);
+        uint64_t GetTimestamp() const;
+        void WriteHeader(HwInputRecord::Kind kind, uint32_t frame, uint64_t timestamp, uint16_t window);
+
+        template<typename T>
+        void Write(T value) { std::fwrite(&value, sizeof(T), 1, mFile); }
+
+    private:
+        std::unordered_map<std::string, uint16_t> mWindowIds;
+        std::chrono::steady_clock::time_point mStart;
+        std::FILE *mFile = nullptr;
+        size_t mRecordsCount = 0;
+    };
+
+    /** Reads binary log and returns recorded events when they are due */
+    class HwInputReplay {
+    public:
+        /**
+         * @param path Log file path
+         * @param realtime If true, events are due at their timestamps, otherwise at their frame indices
+         */
+        HwInputReplay(const std::string &path, bool realtime);
+
+        /**
+         * Get next due event
+         * @param frame Current frame index
+         * @param record Event record
+         * @return True if there is due event
+         */
+        bool Next(uint32_t frame, HwInputRecord &record);
+
+        /** @return Window name of the record */
+        const std::string &GetWindowName(const HwInputRecord &record) const { return mWindowNames[record.window]; }
+
+        /** @return True if all events are returned */
+        bool IsFinished() const { return mNext >= mRecords.size(); }
+
+        /**
+         * Time of the frame on the recorded timeline: interpolated by frame index between the records
+         * around it (extrapolated with average recorded frame time after the last one)
+         * @param frame Frame index
+         * @return Time on the same clock as times of replayed events
+         */
+        std::chrono::steady_clock::time_point GetFrameTime(uint32_t frame) const;
+
+        /** @return Index of the frame with last recorded event */
+        uint32_t GetLastFrame() const { return mRecords.empty() ? 0 : mRecords.back().frame; }
+
+    private:
+        std::vector<HwInputRecord> mRecords;
+        std::vector<std::string> mWindowNames;
+        std::chrono::steady_clock::time_point mStart;
+        size_t mNext = 0;
+        bool mRealtime = false;
+        bool mStarted = false;
+    };
+
+}
+
+#endif //X11HELLOWORLD_INPUT_RECORD_HPP
@@ -0,0 +1,403 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/job_system.hpp>
+#include <x11hw/error.hpp>
+#include <stdexcept>
+#include <iostream>
+#include <cassert>
+
+namespace x11hw {
+
+    struct HwJob {
+        HwJobSystem::Job function;
+        HwJobCounter *counter = nullptr;
+        std::atomic<bool> free{true};
+        bool heap = false;
+    };
+
+    /** Fixed size Chase-Lev deque (Le, Pop, Cohen, Nardelli "Correct and Efficient Work-Stealing for Weak Memory Models") */
+    class HwJobSystem::Deque {
+    public:
+        explicit Deque(size_t capacity)
+            : mBuffer(new std::atomic<HwJob*>[capacity]), mMask(capacity - 1) {
+        }
+
+        /** Owner only */
+        bool Push(HwJob *job) {
+            int64_t bottom = mBottom.load(std::memory_order_relaxed);
+            int64_t top = mTop.load(std::memory_order_acquire);
+
+            if (bottom - top > (int64_t) mMask) {
+                return false;
+            }
+
+            mBuffer[bottom & mMask].store(job, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            mBottom.store(bottom + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        /** Owner only */
+        HwJob *Pop() {
+            int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+            mBottom.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t top = mTop.load(std::memory_order_relaxed);
+
+            if (top > bottom) {
+                mBottom.store(bottom + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            HwJob *job = mBuffer[bottom & mMask].load(std::memory_order_relaxed);
+
+            if (top == bottom) {
+                // Last job: race with thieves for it
+                if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    job = nullptr;
+                }
+
+                mBottom.store(bottom + 1, std::memory_order_relaxed);
+            }
+
+            return job;
+        }
+
+        /** Any thread */
+        HwJob *Steal() {
+            int64_t top = mTop.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t bottom = mBottom.load(std::memory_order_acquire);
+
+            if (top >= bottom) {
+                return nullptr;
+            }
+
+            HwJob *job = mBuffer[top & mMask].load(std::memory_order_relaxed);
+
+            if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                return nullptr;
+            }
+
+            return job;
+        }
+
+    private:
+        std::unique_ptr<std::atomic<HwJob*>[]> mBuffer;
+        size_t mMask;
+        // Keep top (touched by thieves) and bottom (touched by owner) in different cache lines
+        std::atomic<int64_t> mTop{0};
+        char mPadding[64];
+        std::atomic<int64_t> mBottom{0};
+    };
+
+    struct HwJobSystem::ThreadData {
+        explicit ThreadData(size_t capacity) : deque(capacity), jobs(capacity) {}
+
+        Deque deque;
+        // Ring of job storage, slot is reused once its job is finished
+        std::vector<HwJob> jobs;
+        size_t nextJob = 0;
+        uint32_t random = 0;
+
+        std::atomic<size_t> executed{0};
+        std::atomic<size_t> stolen{0};
+        std::atomic<size_t> inlined{0};
+        std::atomic<size_t> allocated{0};
+    };
+
+    // Index of the thread data of the calling thread in the system, which owns it
+    static thread_local const HwJobSystem *tJobSystem = nullptr;
+    static thread_local size_t tThreadIndex = 0;
+
+    HwJobSystem::HwJobSystem() : HwJobSystem(InitParams()) {
+
+    }
+
+    HwJobSystem::HwJobSystem(const InitParams &params) {
+        CHECK_MSG(params.queueCapacity > 0 && (params.queueCapacity & (params.queueCapacity - 1)) == 0,
+                  "Job queue capacity must be power of two");
+
+        size_t workersCount = params.workersCount;
+
+        if (workersCount == 0) {
+            auto cores = (size_t) std::thread::hardware_concurrency();
+            workersCount = cores > 1 ? cores - 1 : 0;
+        }
+
+        // Thread data 0 belongs to the creating thread
+        for (size_t i = 0; i < workersCount + 1; i++) {
+            mThreads.emplace_back(new ThreadData(params.queueCapacity));
+            mThreads.back()->random = (uint32_t) (i * 2654435761u + 1);
+        }
+
+        tJobSystem = this;
+        tThreadIndex = 0;
+
+        for (size_t i = 0; i < workersCount; i++) {
+            mWorkers.emplace_back([this, i]() { WorkerMain(i + 1); });
+        }
+    }
+
+    HwJobSystem::~HwJobSystem() {
+        {
+            std::lock_guard<std::mutex> guard(mSleepMutex);
+            mStop.store(true);
+        }
+
+        mSleepCondition.notify_all();
+
+        for (auto& worker: mWorkers) {
+            worker.join();
+        }
+
+        if (tJobSystem == this) {
+            tJobSystem = nullptr;
+        }
+    }
+
+    void HwJobSystem::Submit(HwJobCounter &counter, Job job) {
+        assert(job);
+
+        counter.mCount.fetch_add(1, std::memory_order_relaxed);
+        Enqueue(AllocateJob(counter, std::move(job)));
+    }
+
+    void HwJobSystem::SubmitAfter(HwJobCounter &dependency, HwJobCounter &counter, Job job) {
+        assert(job);
+
+        counter.mCount.fetch_add(1, std::memory_order_relaxed);
+        HwJob *allocated = AllocateJob(counter, std::move(job));
+
+        {
+            std::lock_guard<std::mutex> guard(dependency.mMutex);
+
+            if (dependency.mCount.load(std::memory_order_acquire) > 0) {
+                dependency.mContinuations.push_back(allocated);
+                return;
+            }
+        }
+
+        Enqueue(allocated);
+    }
+
+    void HwJobSystem::Wait(HwJobCounter &counter) {
+        auto& thread = GetThreadData();
+
+        while (!counter.IsDone()) {
+            HwJob *job = FindJob(thread);
+
+            if (job) {
+                Execute(job);
+            }
+            else {
+                std::this_thread::yield();
+            }
+        }
+
+        // Finishing thread may still hold the lock, after that it does not touch the counter
+        std::lock_guard<std::mutex> guard(counter.mMutex);
+    }
+
+    HwJobSystem::Stats HwJobSystem::GetStats() const {
+        Stats stats;
+        stats.workersCount = mWorkers.size();
+
+        for (auto& thread: mThreads) {
+            stats.executed += thread->executed.load(std::memory_order_relaxed);
+            stats.stolen += thread->stolen.load(std::memory_order_relaxed);
+            stats.inlined += thread->inlined.load(std::memory_order_relaxed);
+            stats.allocated += thread->allocated.load(std::memory_order_relaxed);
+        }
+
+        return stats;
+    }
+
+    void HwJobSystem::Enqueue(HwJob *job) {
+        auto& thread = GetThreadData();
+
+        if (!thread.deque.Push(job)) {
+            // Queue is full: do the work now instead of waiting for free space
+            thread.inlined.fetch_add(1, std::memory_order_relaxed);
+            Execute(job);
+            return;
+        }
+
+        // Sleeping thread either sees new epoch before it waits or is counted here (both are seq_cst)
+        mWorkEpoch.fetch_add(1, std::memory_order_seq_cst);
+
+        if (mSleeping.load(std::memory_order_seq_cst) > 0) {
+            std::lock_guard<std::mutex> guard(mSleepMutex);
+            mSleepCondition.notify_one();
+        }
+    }
+
+    void HwJobSystem::Execute(HwJob *job) {
+        try {
+            job->function();
+        }
+        catch (const std::exception &e) {
+            std::cerr << "Failed job: " << e.what() << std::endl;
+        }
+
+        HwJobCounter &counter = *job->counter;
+
+        if (job->heap) {
+            delete job;
+        }
+        else {
+            job->function = nullptr;
+            job->counter = nullptr;
+            job->free.store(true, std::memory_order_release);
+        }
+
+        GetThreadData().executed.fetch_add(1, std::memory_order_relaxed);
+        Finish(counter);
+    }
+
+    void HwJobSystem::Finish(HwJobCounter &counter) {
+        std::vector<HwJob *> continuations;
+
+        {
+            std::lock_guard<std::mutex> guard(counter.mMutex);
+
+            if (counter.mCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                continuations.swap(counter.mContinuations);
+            }
+        }
+
+        for (auto job: continuations) {
+            Enqueue(job);
+        }
+    }
+
+    HwJob *HwJobSystem::AllocateJob(HwJobCounter &counter, Job &&function) {
+        auto& thread = GetThreadData();
+        auto& job = thread.jobs[thread.nextJob];
+
+        if (!job.free.load(std::memory_order_acquire)) {
+            // Ring wrapped around unfinished job: fall back to heap storage
+            auto allocated = new HwJob();
+            allocated->function = std::move(function);
+            allocated->counter = &counter;
+            allocated->heap = true;
+            allocated->free.store(false, std::memory_order_relaxed);
+
+            thread.allocated.fetch_add(1, std::memory_order_relaxed);
+            return allocated;
+        }
+
+        thread.nextJob = (thread.nextJob + 1) % thread.jobs.size();
+
+        job.free.store(false, std::memory_order_relaxed);
+        job.function = std::move(function);
+        job.counter = &counter;
+
+        return &job;
+    }
+
+    HwJob *HwJobSystem::FindJob(ThreadData &thread) {
+        HwJob *job = thread.deque.Pop();
+
+        if (job || mThreads.size() < 2) {
+            return job;
+        }
+
+        // Xorshift to pick random victim, so thieves do not contend for the same deque
+        thread.random ^= thread.random << 13u;
+        thread.random ^= thread.random >> 17u;
+        thread.random ^= thread.random << 5u;
+
+        size_t start = thread.random % mThreads.size();
+
+        for (size_t i = 0; i < mThreads.size(); i++) {
+            auto& victim = *mThreads[(start + i) % mThreads.size()];
+
+            if (&victim == &thread) {
+                continue;
+            }
+
+            job = victim.deque.Steal();
+
+            if (job) {
+                thread.stolen.fetch_add(1, std::memory_order_relaxed);
+                return job;
+            }
+        }
+
+        return nullptr;
+    }
+
+    HwJobSystem::ThreadData &HwJobSystem::GetThreadData() {
+        CHECK_MSG(tJobSystem == this, "Jobs may be submitted and waited only from threads of the job system");
+        return *mThreads[tThreadIndex];
+    }
+
+    void HwJobSystem::WorkerMain(size_t index) {
+        tJobSystem = this;
+        tThreadIndex = index;
+
+        auto& thread = *mThreads[index];
+        size_t idleSpins = 0;
+
+        // Spin a bit before sleep, jobs of the frame usually come in bursts
+        static const size_t MAX_IDLE_SPINS = 64;
+
+        while (!mStop.load(std::memory_order_acquire)) {
+            HwJob *job = FindJob(thread);
+
+            if (job) {
+                Execute(job);
+                idleSpins = 0;
+                continue;
+            }
+
+            if (idleSpins < MAX_IDLE_SPINS) {
+                idleSpins += 1;
+                std::this_thread::yield();
+                continue;
+            }
+
+            // Job pushed after the last look into the queues changes the epoch, so it is not missed
+            auto epoch = mWorkEpoch.load(std::memory_order_seq_cst);
+            job = FindJob(thread);
+
+            if (job) {
+                Execute(job);
+                idleSpins = 0;
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(mSleepMutex);
+            mSleeping.fetch_add(1, std::memory_order_seq_cst);
+            mSleepCondition.wait(lock, [this, epoch]() {
+                return mStop.load(std::memory_order_acquire) || mWorkEpoch.load(std::memory_order_seq_cst) != epoch;
+            });
+            mSleeping.fetch_sub(1, std::memory_order_seq_cst);
+            idleSpins = 0;
+        }
+    }
+
+}
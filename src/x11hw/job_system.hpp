@@ -0,0 +1,164 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_JOB_SYSTEM_HPP
+#define X11HELLOWORLD_JOB_SYSTEM_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+namespace x11hw {
+
+    struct HwJob;
+
+    /**
+     * Counts unfinished jobs of the group. Jobs may be submitted to run once
+     * the counter of other group reaches zero (see HwJobSystem::SubmitAfter).
+     * Counter must outlive its jobs: wait for it before destruction.
+     */
+    class HwJobCounter {
+    public:
+        HwJobCounter() = default;
+        HwJobCounter(const HwJobCounter&) = delete;
+        HwJobCounter(HwJobCounter&&) = delete;
+
+        /** @return True if all jobs of the group are finished */
+        bool IsDone() const { return mCount.load(std::memory_order_acquire) == 0; }
+
+    private:
+        friend class HwJobSystem;
+
+        std::atomic<uint32_t> mCount{0};
+        std::mutex mMutex;
+        std::vector<HwJob *> mContinuations;
+    };
+
+    /**
+     * Work-stealing job scheduler with fixed pool of worker threads.
+     *
+     * Each thread (workers and the thread, which created the system) owns Chase-Lev deque:
+     * owner pushes and pops jobs at the bottom, idle threads steal from the top of others.
+     * Jobs may be submitted only from the owner threads. Waiting thread executes jobs
+     * instead of blocking, so waiting inside of a job is allowed.
+     */
+    class HwJobSystem {
+    public:
+        typedef std::function<void()> Job;
+
+        struct InitParams {
+            /** Number of worker threads (0 - number of cores minus one for the calling thread) */
+            size_t workersCount = 0;
+            /** Max number of queued jobs per thread (power of two) */
+            size_t queueCapacity = 4096;
+        };
+
+        struct Stats {
+            size_t workersCount = 0;
+            size_t executed = 0;
+            size_t stolen = 0;
+            size_t inlined = 0;
+            size_t allocated = 0;
+        };
+
+        HwJobSystem();
+        explicit HwJobSystem(const InitParams &params);
+        HwJobSystem(const HwJobSystem&) = delete;
+        HwJobSystem(HwJobSystem&&) = delete;
+        ~HwJobSystem();
+
+        /**
+         * Queue job for execution
+         * @param counter Counter of the job group
+         * @param job Function to run
+         */
+        void Submit(HwJobCounter &counter, Job job);
+
+        /**
+         * Queue job, which starts once all jobs of dependency group are finished
+         * @param dependency Counter of the group to wait for
+         * @param counter Counter of the job group
+         * @param job Function to run
+         */
+        void SubmitAfter(HwJobCounter &dependency, HwJobCounter &counter, Job job);
+
+        /**
+         * Split range [0, count) into chunks of at most grain elements and process them in parallel
+         * @param counter Counter of the job group
+         * @param count Number of elements
+         * @param grain Max number of elements per job
+         * @param function Function called as function(begin, end) for each chunk
+         */
+        template<typename Function>
+        void ParallelFor(HwJobCounter &counter, size_t count, size_t grain, Function function) {
+            grain = grain > 0 ? grain : 1;
+
+            for (size_t begin = 0; begin < count; begin += grain) {
+                size_t end = begin + grain < count ? begin + grain : count;
+                Submit(counter, [function, begin, end]() { function(begin, end); });
+            }
+        }
+
+        /**
+         * Execute jobs on the calling thread until all jobs of the group are finished
+         * @param counter Counter of the group
+         */
+        void Wait(HwJobCounter &counter);
+
+        /** @return Number of worker threads (without calling thread) */
+        size_t GetWorkersCount() const { return mWorkers.size(); }
+
+        /** @return Accumulated statistics */
+        Stats GetStats() const;
+
+    private:
+        class Deque;
+        struct ThreadData;
+
+        void Enqueue(HwJob *job);
+        void Execute(HwJob *job);
+        void Finish(HwJobCounter &counter);
+        HwJob *AllocateJob(HwJobCounter &counter, Job &&function);
+        HwJob *FindJob(ThreadData &thread);
+        ThreadData &GetThreadData();
+        void WorkerMain(size_t index);
+
+        std::vector<std::unique_ptr<ThreadData>> mThreads;
+        std::vector<std::thread> mWorkers;
+        std::mutex mSleepMutex;
+        std::condition_variable mSleepCondition;
+        std::atomic<size_t> mSleeping{0};
+        // Incremented on every queued job, sleeping workers wake up once it changes
+        std::atomic<uint64_t> mWorkEpoch{0};
+        std::atomic<bool> mStop{false};
+    };
+
+}
+
+#endif //X11HELLOWORLD_JOB_SYSTEM_HPP
@@ -28,12 +28,36 @@
 #include <x11hw/window.hpp>
 #include <x11hw/window_manager.hpp>
 #include <x11hw/shader.hpp>
+#include <x11hw/shader_variants.hpp>
 #include <x11hw/geometry.hpp>
+#include <x11hw/vertex_packing.hpp>
+#include <x11hw/uploader.hpp>
+#include <x11hw/capture.hpp>
+#include <x11hw/job_system.hpp>
+#include <x11hw/frame_pipeline.hpp>
+#include <x11hw/debug_output.hpp>
+#include <x11hw/present_latency.hpp>
+#include <x11hw/frame_pacer.hpp>
+#include <x11hw/alloc_counter.hpp>
+#include <x11hw/frame_arena.hpp>
+#include <x11hw/metrics.hpp>
+#include <x11hw/hud.hpp>
+#include <x11hw/gpu_timer.hpp>
+#include <x11hw/stress_scene.hpp>
+#include <x11hw/pointer_predictor.hpp>
+#include <x11hw/fxaa.hpp>
 
 #include <stdexcept>
+#include <algorithm>
 #include <iostream>
 #include <chrono>
 #include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <sys/resource.h>
 
 const char *GetVertexStageCode() {
     return R"(
@@ -55,44 +79,450 @@ const char *GetVertexStageCode() {
     )";
 }
 
+// Manual gamma is only a fallback variant: on sRGB framebuffer color is written as linear,
+// encoding is done by the hardware on write
 const char *GetFragmentStageCode() {
     return R"(
         #version 330 core
+        #pragma feature MANUAL_GAMMA
         layout (location = 0) out vec4 outColor;
 
         in vec3 fsColor;
 
+        #ifdef MANUAL_GAMMA
         uniform float basicGamma;
+        #endif
 
         void main() {
+        #ifdef MANUAL_GAMMA
             outColor = vec4(pow(fsColor, vec3(1.0f / basicGamma)), 1.0f);
+        #else
+            outColor = vec4(fsColor, 1.0f);
+        #endif
         }
     )";
 }
 
-x11hw::HwGeometry::InitParams GetTriangleParams() {
-    x11hw::HwGeometry::InitParams params;
-    params.verticesCount = 3;
-    params.stride = (2 + 3) * sizeof(float);
-    params.topology = GL_TRIANGLES;
-    params.attributes.push_back({(0) * sizeof(float), 2, GL_FLOAT, false});
-    params.attributes.push_back({(2) * sizeof(float), 3, GL_FLOAT, false});
+// Features of the triangle shader in the declaration order
+enum class TriangleFeature {
+    ManualGamma
+};
 
-    return params;
+typedef x11hw::HwShaderFeatures<TriangleFeature> TriangleFeatures;
+
+float SrgbToLinear(float value) {
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+const size_t TRIANGLE_VERTICES_COUNT = 3;
+
+x11hw::HwVertexPacker GetTrianglePacker() {
+    static const float positions[] = {
+         0.0f,  0.0f,
+        -0.5f,  1.0f,
+         0.5f,  1.0f
+    };
+
+    static const float colors[] = {
+        1.0f, 0.0f, 0.0f,
+        0.0f, 1.0f, 0.0f,
+        0.0f, 0.0f, 1.0f
+    };
+
+    // vec2 half position (4 bytes) and unorm8 color (4 bytes) instead of 5 floats (20 bytes)
+    return x11hw::HwVertexPacker({
+        {positions, 2, x11hw::HwPackedFormat::Half},
+        {colors, 3, x11hw::HwPackedFormat::Unorm8}
+    });
+}
+
+// Immutable state of the frame, produced by simulation and consumed by rendering
+struct FrameSnapshot {
+    bool showTriangle = false;
+    glm::ivec2 mousePosition{};
+    std::chrono::steady_clock::time_point simulated;
+};
+
+// Input events are handed from the event thread to simulation
+struct InputInbox {
+    std::mutex mutex;
+    std::vector<x11hw::HwWindow::EventData> events;
+};
+
+struct SimulationState {
+    bool showTriangle = false;
+    glm::ivec2 mousePosition{};
+    // Set if triangle follows predicted pointer position
+    std::unique_ptr<x11hw::HwPointerPredictor> predictor;
+};
+
+// Events of the simulated frame, kept in the frame arena of the simulating thread
+typedef x11hw::HwArenaVector<x11hw::HwWindow::EventData> FrameEvents;
+
+// Triangle to draw in the frame, draw list is kept in the frame arena of the render thread
+struct TriangleDraw {
+    glm::vec2 position{};
+    glm::vec2 size{};
+};
+
+void Simulate(SimulationState &state, const FrameEvents &events) {
+    using namespace x11hw;
+
+    for (auto& event: events) {
+        if (event.type == HwWindow::EventType::MouseButtonPressed &&
+            event.mouseButton == HwWindow::MouseButton::Left) {
+            state.showTriangle = true;
+            state.mousePosition = event.mousePosition;
+
+            // Motion history of the previous drag says nothing about this one
+            if (state.predictor) {
+                state.predictor->Reset();
+                state.predictor->AddSample(event.time, glm::vec2(event.mousePosition));
+            }
+        }
+        if (event.type == HwWindow::EventType::MouseMoved) {
+            state.mousePosition = event.mousePosition;
+
+            if (state.predictor) {
+                state.predictor->AddSample(event.time, glm::vec2(event.mousePosition));
+            }
+        }
+        if (event.type == HwWindow::EventType::MouseButtonReleased &&
+            event.mouseButton == HwWindow::MouseButton::Left) {
+            state.showTriangle = false;
+            state.mousePosition = event.mousePosition;
+        }
+    }
+}
+
+typedef x11hw::HwFramePipeline<FrameSnapshot> FramePipeline;
+
+struct Options {
+    std::string recordPath;
+    std::string replayPath;
+    bool replayRealtime = false;
+    std::string captureDirectory;
+    x11hw::HwFrameCapture::Format captureFormat = x11hw::HwFrameCapture::Format::Ppm;
+    std::string metricsSocket;
+    bool hud = false;
+    x11hw::HwContextMode contextMode = x11hw::HwContextMode::Default;
+    int samples = 0;
+    bool postProcessAntialiasing = false;
+    bool fullscreen = false;
+    bool lowLatency = false;
+    size_t pipelineDepth = 3;
+    FramePipeline::Mode pipelineMode = FramePipeline::Mode::Latest;
+    // Stress sweep: every combination of the listed values is a separate scene
+    bool stress = false;
+    std::vector<size_t> stressWindows = {1};
+    std::vector<size_t> stressGeometries = {16};
+    std::vector<size_t> stressDraws = {1000};
+    std::vector<size_t> stressVertices = {3};
+    std::vector<size_t> stressUpdates = {0};
+    std::vector<size_t> stressPool = {0};
+    std::vector<size_t> stressReallocations = {0};
+    std::vector<size_t> stressMultiDraw = {0};
+    size_t stressFrames = 200;
+    // Triangle follows pointer position predicted at the present time of the frame
+    bool predict = false;
+    // Fixed lead of the present time over the simulation (negative - measured present latency)
+    double predictMs = -1.0;
+};
+
+void PrintUsage() {
+    std::cerr << "Usage: x11helloworld [options]" << std::endl
+              << "  --record <file>          Record input events into file" << std::endl
+              << "  --replay <file>          Replay input events from file as fast as possible, exit when done" << std::endl
+              << "  --replay-realtime        Replay input events with recorded timing" << std::endl
+              << "  --context <mode>         GL context mode: default, no-error (production) or debug (validation)" << std::endl
+              << "  --msaa <samples>         Preferred samples of the window framebuffer (default 0)" << std::endl
+              << "  --no-msaa                Single sample framebuffer, antialiased with FXAA post pass" << std::endl
+              << "  --fullscreen             Show window fullscreen" << std::endl
+              << "  --low-latency            Fullscreen, bypass compositor, tear late frames instead of waiting" << std::endl
+              << "  --pipeline-depth <n>     Simulation/render pipeline depth, 1 runs both in one thread (default 3, 1 on replay)" << std::endl
+              << "  --pipeline-mode <mode>   Snapshot hand-off: latest (drop stale) or fifo (render all)" << std::endl
+              << "  --capture <dir>          Capture every frame into directory" << std::endl
+              << "  --capture-format <fmt>   Capture format: ppm, raw or stream" << std::endl
+              << "  --metrics <socket>       Serve runtime metrics on Unix socket (text exposition format)" << std::endl
+              << "  --hud                    Show performance overlay (fps, frame time graph, CPU time, draws)" << std::endl
+              << "  --stress                 Run stress scenes at uncapped frame rate instead of demo, print CSV" << std::endl
+              << "  --stress-windows <list>  Windows of the scene, comma separated values are swept (default 1)" << std::endl
+              << "  --stress-geometries <list> Distinct geometries (default 16)" << std::endl
+              << "  --stress-draws <list>    Draw calls per frame over all windows (default 1000)" << std::endl
+              << "  --stress-vertices <list> Vertices per geometry (default 3)" << std::endl
+              << "  --stress-updates <list>  Geometries updated per frame (default 0)" << std::endl
+              << "  --stress-pool <list>     1 - geometries share buffer pool pages, 0 - own VBO each (default 0)" << std::endl
+              << "  --stress-reallocations <list> Geometries recreated per frame (default 0)" << std::endl
+              << "  --stress-multi-draw <list> 1 - submit draws with multi draw indirect, 0 - draw per geometry (default 0)" << std::endl
+              << "  --stress-frames <n>      Measured frames per scene (default 200)" << std::endl
+              << "  --predict <ms|auto>      Draw triangle at pointer position predicted at present time," << std::endl
+              << "                           auto - measured present latency, <ms> - fixed lead over simulation" << std::endl;
+}
+
+// Comma separated list of positive numbers: "1,2,4,8"
+bool ParseSizeList(const char *value, std::vector<size_t> &list) {
+    list.clear();
+
+    while (*value) {
+        char *end = nullptr;
+        auto number = std::strtol(value, &end, 10);
+
+        if (end == value || number < 0 || (*end != ',' && *end != '\0')) {
+            return false;
+        }
+
+        list.push_back((size_t) number);
+        value = *end == ',' ? end + 1 : end;
+    }
+
+    return !list.empty();
+}
+
+bool ParseOptions(int argc, const char *const *argv, Options &options) {
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (std::strcmp(arg, "--record") == 0 && value) {
+            options.recordPath = value;
+            i += 1;
+        }
+        else if (std::strcmp(arg, "--replay") == 0 && value) {
+            options.replayPath = value;
+            i += 1;
+        }
+        else if (std::strcmp(arg, "--replay-realtime") == 0) {
+            options.replayRealtime = true;
+        }
+        else if (std::strcmp(arg, "--context") == 0 && value) {
+            if (std::strcmp(value, "default") == 0) {
+                options.contextMode = x11hw::HwContextMode::Default;
+            }
+            else if (std::strcmp(value, "no-error") == 0) {
+                options.contextMode = x11hw::HwContextMode::NoError;
+            }
+            else if (std::strcmp(value, "debug") == 0) {
+                options.contextMode = x11hw::HwContextMode::Debug;
+            }
+            else {
+                return false;
+            }
+
+            i += 1;
+        }
+        else if (std::strcmp(arg, "--msaa") == 0 && value) {
+            int samples = std::atoi(value);
+
+            if (samples < 0) {
+                return false;
+            }
+
+            options.samples = samples;
+            i += 1;
+        }
+        else if (std::strcmp(arg, "--no-msaa") == 0) {
+            options.postProcessAntialiasing = true;
+        }
+        else if (std::strcmp(arg, "--fullscreen") == 0) {
+            options.fullscreen = true;
+        }
+        else if (std::strcmp(arg, "--low-latency") == 0) {
+            options.fullscreen = true;
+            options.lowLatency = true;
+        }
+        else if (std::strcmp(arg, "--pipeline-depth") == 0 && value) {
+            int depth = std::atoi(value);
+
+            if (depth < 1) {
+                return false;
+            }
+
+            options.pipelineDepth = (size_t) depth;
+            i += 1;
+        }
+        else if (std::strcmp(arg, "--pipeline-mode") == 0 && value) {
+            if (std::strcmp(value, "latest") == 0) {
+                options.pipelineMode = FramePipeline::Mode::Latest;
+            }
+            else if (std::strcmp(value, "fifo") == 0) {
+                options.pipelineMode = FramePipeline::Mode::Fifo;
+            }
+            else {
+                return false;
+            }
+
+            i += 1;
+        }
+        else if (std::strcmp(arg, "--capture") == 0 && value) {
+            options.captureDirectory = value;
+            i += 1;
+        }
+        else if (std::strcmp(arg, "--capture-format") == 0 && value) {
+            if (std::strcmp(value, "ppm") == 0) {
+                options.captureFormat = x11hw::HwFrameCapture::Format::Ppm;
+            }
+            else if (std::strcmp(value, "raw") == 0) {
+                options.captureFormat = x11hw::HwFrameCapture::Format::Raw;
+            }
+            else if (std::strcmp(value, "stream") == 0) {
+                options.captureFormat = x11hw::HwFrameCapture::Format::Stream;
+            }
+            else {
+                return false;
+            }
+
+            i += 1;
+        }
+        else if (std::strcmp(arg, "--hud") == 0) {
+            options.hud = true;
+        }
+        else if (std::strcmp(arg, "--metrics") == 0 && value) {
+            options.metricsSocket = value;
+            i += 1;
+        }
+        else if (std::strcmp(arg, "--predict") == 0 && value) {
+            if (std::strcmp(value, "auto") == 0) {
+                options.predictMs = -1.0;
+            }
+            else {
+                char *end = nullptr;
+                double lead = std::strtod(value, &end);
+
+                if (end == value || *end != '\0' || lead < 0.0) {
+                    return false;
+                }
+
+                options.predictMs = lead;
+            }
+
+            options.predict = true;
+            i += 1;
+        }
+        else if (std::strcmp(arg, "--stress") == 0) {
+            options.stress = true;
+        }
+        else if (std::strncmp(arg, "--stress-", 9) == 0 && value) {
+            const char *param = arg + 9;
+            bool parsed;
+
+            if (std::strcmp(param, "windows") == 0) {
+                parsed = ParseSizeList(value, options.stressWindows);
+            }
+            else if (std::strcmp(param, "geometries") == 0) {
+                parsed = ParseSizeList(value, options.stressGeometries);
+            }
+            else if (std::strcmp(param, "draws") == 0) {
+                parsed = ParseSizeList(value, options.stressDraws);
+            }
+            else if (std::strcmp(param, "vertices") == 0) {
+                parsed = ParseSizeList(value, options.stressVertices);
+            }
+            else if (std::strcmp(param, "updates") == 0) {
+                parsed = ParseSizeList(value, options.stressUpdates);
+            }
+            else if (std::strcmp(param, "pool") == 0) {
+                parsed = ParseSizeList(value, options.stressPool);
+            }
+            else if (std::strcmp(param, "reallocations") == 0) {
+                parsed = ParseSizeList(value, options.stressReallocations);
+            }
+            else if (std::strcmp(param, "multi-draw") == 0) {
+                parsed = ParseSizeList(value, options.stressMultiDraw);
+            }
+            else if (std::strcmp(param, "frames") == 0) {
+                options.stressFrames = (size_t) std::max(1, std::atoi(value));
+                parsed = true;
+            }
+            else {
+                parsed = false;
+            }
+
+            if (!parsed) {
+                return false;
+            }
+
+            options.stress = true;
+            i += 1;
+        }
+        else {
+            return false;
+        }
+    }
+
+    return options.recordPath.empty() || options.replayPath.empty();
 }
 
-const void *GetTriangleData() {
-    static const float vertices[] = {
-     //  vec2 position      vec3 color
-         0.0f,  0.0f,       1.0f, 0.0f, 0.0f,
-        -0.5f,  1.0f,       0.0f, 1.0f, 0.0f,
-         0.5f,  1.0f,       0.0f, 0.0f, 1.0f
+// Throughput curves: one CSV row per combination, the varied parameter makes the curve
+int RunStress(const Options &options) {
+    // Draw lists of the scenes are prepared on all cores, GL submission stays on this thread
+    x11hw::HwJobSystem jobSystem;
+    x11hw::HwStressScene::WriteHeader(std::cout);
+
+    // Every combination of the listed values, in order of the options (first one is the outer loop)
+    typedef x11hw::HwStressScene::InitParams StressParams;
+    std::vector<StressParams> scenes(1);
+
+    auto sweep = [&scenes](const std::vector<size_t> &values, void (*set)(StressParams &params, size_t value)) {
+        std::vector<StressParams> expanded;
+
+        for (auto& scene: scenes) {
+            for (auto value: values) {
+                expanded.push_back(scene);
+                set(expanded.back(), value);
+            }
+        }
+
+        scenes.swap(expanded);
     };
 
-    return vertices;
+    sweep(options.stressWindows, [](StressParams &params, size_t value) { params.windows = value; });
+    sweep(options.stressGeometries, [](StressParams &params, size_t value) { params.geometries = value; });
+    sweep(options.stressDraws, [](StressParams &params, size_t value) { params.drawsPerFrame = value; });
+    sweep(options.stressVertices, [](StressParams &params, size_t value) { params.verticesPerGeometry = value; });
+    sweep(options.stressUpdates, [](StressParams &params, size_t value) { params.updatesPerFrame = value; });
+    sweep(options.stressPool, [](StressParams &params, size_t value) { params.pooled = value != 0; });
+    sweep(options.stressReallocations, [](StressParams &params, size_t value) { params.reallocationsPerFrame = value; });
+    sweep(options.stressMultiDraw, [](StressParams &params, size_t value) { params.multiDraw = value != 0; });
+
+    for (auto& params: scenes) {
+        params.frames = options.stressFrames;
+        params.contextConfig.mode = options.contextMode;
+        params.jobSystem = &jobSystem;
+
+        x11hw::HwStressScene scene(params);
+        auto result = scene.Run();
+        x11hw::HwStressScene::WriteRow(std::cout, scene.GetParams(), result);
+    }
+
+    return 0;
 }
 
-int main(int, const char *const *) {
+int main(int argc, const char *const *argv) {
+    auto processStartTime = std::chrono::steady_clock::now();
+    Options options;
+
+    if (!ParseOptions(argc, argv, options)) {
+        PrintUsage();
+        return 1;
+    }
+
+    // Replay is deterministic only if events are simulated in the frame they are polled in,
+    // simulation thread would pick them up at its own pace
+    if (!options.replayPath.empty() && options.pipelineDepth > 1) {
+        std::cout << "Replay: pipeline depth " << options.pipelineDepth << " is forced to 1" << std::endl;
+        options.pipelineDepth = 1;
+    }
+
+    if (options.stress) {
+        try {
+            return RunStress(options);
+        }
+        catch (const std::exception &e) {
+            std::cerr << "Stress scene failed: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
     // Window (background color = #25854b) setting
     glm::vec4 clearColor{0.145, 0.522, 0.294, 1.0f};
     glm::uvec2 windowSize{1280, 720};
@@ -102,17 +532,63 @@ int main(int, const char *const *) {
 
     // For triangle drawing
     bool shouldClose = false;
-    bool showTriangle = false;
-    glm::ivec2 mousePosition;
     glm::vec2 triangleSize{120.0f, 120.0f};
 
     // Create window manager and primary window
-    auto windowManager = std::make_shared<x11hw::HwWindowManager>();
+    x11hw::HwContextConfig contextConfig;
+    contextConfig.mode = options.contextMode;
+
+    // Demo is 2D: no depth/stencil, no alpha, samples only on request
+    auto& framebufferConfig = contextConfig.framebuffer;
+    framebufferConfig.depthBits = 0;
+    framebufferConfig.stencilBits = 0;
+    framebufferConfig.alphaBits = 0;
+    framebufferConfig.preferredSamples = options.samples;
+    framebufferConfig.antialiasing = options.postProcessAntialiasing ?
+                                     x11hw::HwAntialiasing::PostProcess : x11hw::HwAntialiasing::Multisample;
+
+    auto windowManager = std::make_shared<x11hw::HwWindowManager>(contextConfig);
     auto window = windowManager->CreateWindow(name, title, windowSize);
 
+    {
+        auto drawableSize = window->QueryDrawableSize();
+        windowManager->GetFramebufferInfo().Report(std::cout, drawableSize.x, drawableSize.y);
+    }
+
+    // Recorded input drives the same loop on replay, so runs are comparable between builds
+    bool replayFast = !options.replayPath.empty() && !options.replayRealtime;
+
+    if (!options.recordPath.empty()) {
+        windowManager->StartRecording(options.recordPath);
+    }
+    if (!options.replayPath.empty()) {
+        windowManager->StartReplay(options.replayPath, options.replayRealtime);
+    }
+
+    // Unredirected fullscreen window is flipped directly, without extra compositor copy and frame of latency
+    if (options.fullscreen) {
+        window->SetFullscreen(true);
+    }
+    if (options.lowLatency) {
+        window->SetBypassCompositor(true);
+    }
+
     // Will draw only into single window
     window->MakeContextCurrent();
-    window->SetSwapInterval(1);
+
+    if (replayFast) {
+        window->SetSwapInterval(0);
+    }
+    else if (options.lowLatency) {
+        // Falls back to regular vsync if tearing is not supported
+        window->SetSwapInterval(-1);
+    }
+    else {
+        window->SetSwapInterval(1);
+    }
+
+    // Core profile: extensions are queried with glGetStringi, which requires experimental mode
+    glewExperimental = GL_TRUE;
 
     if (glewInit() != GLEW_OK) {
         std::cerr << "Failed to init GLEW" << std::endl;
@@ -124,79 +600,494 @@ int main(int, const char *const *) {
         shouldClose = true;
     });
 
-    // Subscribe for input events to move triangle
-    window->SubscribeOnInput([&](const x11hw::HwWindow::EventData &event) {
-        using namespace x11hw;
+    // Input events to move triangle are applied by simulation
+    InputInbox inbox;
 
-        if (event.type == HwWindow::EventType::MouseButtonPressed &&
-            event.mouseButton == HwWindow::MouseButton::Left) {
-            showTriangle = true;
-            mousePosition = event.mousePosition;
-        }
-        if (event.type == HwWindow::EventType::MouseMoved) {
-            mousePosition = event.mousePosition;
-        }
-        if (event.type == HwWindow::EventType::MouseButtonReleased &&
-            event.mouseButton == HwWindow::MouseButton::Left) {
-            showTriangle = false;
-            mousePosition = event.mousePosition;
-        }
+    window->SubscribeOnInput([&](const x11hw::HwWindow::EventData &event) {
+        std::lock_guard<std::mutex> guard(inbox.mutex);
+        inbox.events.push_back(event);
     });
 
-    // Create gl objets for drawing
-    auto shader = std::make_shared<x11hw::HwShader>(GetVertexStageCode(), GetFragmentStageCode());
-    auto geometry = std::make_shared<x11hw::HwGeometry>(GetTriangleParams());
-    geometry->Update(0, geometry->GetBufferSize(), GetTriangleData());
+    SimulationState simulationState;
 
     // Frame rate control
     using microseconds = std::chrono::microseconds;
     using timer = std::chrono::steady_clock;
     auto desiredDelta = microseconds{16666};
-    auto prevTime = timer::now();
 
-    while (!shouldClose) {
-        auto currentTime = timer::now();
-        auto delta = currentTime - prevTime;
+    // Pointer keeps moving while the frame is rendered and presented, so the triangle is
+    // drawn where the pointer is expected to be at present time. Present latency is measured
+    // from the simulation of the snapshot, so it includes the frames spent in the pipeline;
+    // until the first frame is measured, each pipeline slot is assumed to take a frame.
+    const microseconds maxPredictLead{100000};
+    auto fixedPredictLead = std::chrono::duration_cast<microseconds>(
+            std::chrono::duration<double, std::milli>(std::max(options.predictMs, 0.0)));
+    std::atomic<int64_t> measuredLatencyUs{0};
 
-        // Sleep if update is too fast
-        if (delta < desiredDelta) {
-            auto toSleep = desiredDelta - delta;
-            std::this_thread::sleep_until(currentTime + toSleep);
-            currentTime = timer::now();
+    auto getPredictLead = [&]() -> microseconds {
+        if (options.predictMs >= 0.0) {
+            return fixedPredictLead;
         }
 
-        prevTime = currentTime;
+        // Fast replay runs on the recorded timeline, latency measured in wall time does not apply to it
+        auto measured = replayFast ? 0 : measuredLatencyUs.load(std::memory_order_relaxed);
+        auto lead = measured > 0 ? microseconds{measured} : desiredDelta * (int64_t) options.pipelineDepth;
+        return std::min(lead, maxPredictLead);
+    };
 
-        // Query input
+    if (options.predict) {
+        x11hw::HwPointerPredictor::InitParams predictorParams;
+        // Horizon counts from the last sample, which may be up to idle timeout old
+        predictorParams.maxHorizon = std::max(predictorParams.maxHorizon, predictorParams.idleTimeout +
+                                              (options.predictMs >= 0.0 ? fixedPredictLead : maxPredictLead));
+        simulationState.predictor.reset(new x11hw::HwPointerPredictor(predictorParams));
+    }
+
+    auto simulateFrame = [&](FrameSnapshot &snapshot, x11hw::HwLinearArena &arena) {
+        // Inbox keeps its capacity, so neither side allocates in the steady state
+        FrameEvents events{x11hw::HwArenaAllocator<x11hw::HwWindow::EventData>(arena)};
+        {
+            std::lock_guard<std::mutex> guard(inbox.mutex);
+            events.assign(inbox.events.begin(), inbox.events.end());
+            inbox.events.clear();
+        }
+
+        snapshot.simulated = std::chrono::steady_clock::now();
+        Simulate(simulationState, events);
+
+        snapshot.showTriangle = simulationState.showTriangle;
+        snapshot.mousePosition = simulationState.mousePosition;
+
+        if (simulationState.predictor && simulationState.showTriangle) {
+            // Event times of fast replay are on the recorded timeline, so prediction uses its clock too
+            auto now = replayFast ? windowManager->GetReplayTime() : snapshot.simulated;
+            auto predicted = simulationState.predictor->Predict(now, now + getPredictLead());
+            snapshot.mousePosition = glm::ivec2((int) std::lround(predicted.x), (int) std::lround(predicted.y));
+        }
+    };
+
+    // Manual gamma is only a fallback, if there is no sRGB capable framebuffer
+    bool framebufferSrgb = windowManager->IsFramebufferSrgb();
+
+    if (framebufferSrgb) {
+        // Clear color is also encoded by the framebuffer
+        clearColor = glm::vec4(SrgbToLinear(clearColor.x), SrgbToLinear(clearColor.y), SrgbToLinear(clearColor.z), clearColor.w);
+    }
+
+    // Create gl objets for drawing in background, render loop starts right away
+    struct TriangleResources {
+        std::shared_ptr<x11hw::HwShaderVariants> shaders;
+        std::shared_ptr<x11hw::HwGeometry> geometry;
+    };
+
+    std::shared_ptr<x11hw::HwShaderVariants> shaders;
+    x11hw::HwShader *shader = nullptr;
+    std::shared_ptr<x11hw::HwGeometry> geometry;
+
+    // Shared state, so the task is safe even if still running at exit
+    auto loaded = std::make_shared<TriangleResources>();
+    auto uploader = windowManager->GetUploader();
+
+    uploader->Submit([loaded, framebufferSrgb]() {
+        // Only used variant is compiled
+        loaded->shaders = std::make_shared<x11hw::HwShaderVariants>(GetVertexStageCode(), GetFragmentStageCode());
+        loaded->shaders->ValidateFeatures<TriangleFeature>({{TriangleFeature::ManualGamma, "MANUAL_GAMMA"}});
+        loaded->shaders->Get(TriangleFeatures().With(TriangleFeature::ManualGamma, !framebufferSrgb));
+
+        auto trianglePacker = GetTrianglePacker();
+        std::vector<uint8_t> triangleData;
+        trianglePacker.Pack(TRIANGLE_VERTICES_COUNT, triangleData);
+
+        loaded->geometry = std::make_shared<x11hw::HwGeometry>(trianglePacker.GetParams(TRIANGLE_VERTICES_COUNT));
+        loaded->geometry->Update(0, loaded->geometry->GetBufferSize(), triangleData.data());
+    }, [loaded, framebufferSrgb, &shaders, &shader, &geometry]() {
+        shaders = std::move(loaded->shaders);
+        shader = &shaders->Get(TriangleFeatures().With(TriangleFeature::ManualGamma, !framebufferSrgb));
+        geometry = std::move(loaded->geometry);
+    });
+
+    // Optional capture of presented frames
+    std::unique_ptr<x11hw::HwFrameCapture> capture;
+
+    if (!options.captureDirectory.empty()) {
+        x11hw::HwFrameCapture::InitParams captureParams;
+        captureParams.directory = options.captureDirectory;
+        captureParams.format = options.captureFormat;
+        capture.reset(new x11hw::HwFrameCapture(captureParams));
+    }
+
+    // Optional performance overlay, frame GPU time (scene and post process) is measured for it
+    std::unique_ptr<x11hw::HwHud> hud;
+    std::unique_ptr<x11hw::HwGpuTimer> frameGpuTimer;
+
+    if (options.hud) {
+        x11hw::HwHud::InitParams hudParams;
+        hudParams.srgbFramebuffer = framebufferSrgb;
+        hud.reset(new x11hw::HwHud(hudParams));
+        frameGpuTimer.reset(new x11hw::HwGpuTimer());
+    }
+
+    // Post process antialiasing of the single sample framebuffer (overlay is drawn after it)
+    std::unique_ptr<x11hw::HwFxaa> fxaa;
+
+    if (windowManager->GetFramebufferInfo().postProcessAntialiasing) {
+        x11hw::HwFxaa::InitParams fxaaParams;
+        fxaaParams.srgbFramebuffer = framebufferSrgb;
+        fxaa.reset(new x11hw::HwFxaa(fxaaParams));
+    }
+
+    auto startTime = timer::now();
+
+    // Simulation of frame N + 1 runs on its own thread, while frame N is submitted
+    std::unique_ptr<FramePipeline> pipeline;
+    std::thread simulation;
+    std::atomic<bool> stopSimulation{false};
+    std::atomic<size_t> simulatedFrames{0};
+    FrameSnapshot syncSnapshot;
+
+    if (options.pipelineDepth > 1) {
+        FramePipeline::InitParams pipelineParams;
+        pipelineParams.depth = options.pipelineDepth;
+        pipelineParams.mode = options.pipelineMode;
+        pipeline.reset(new FramePipeline(pipelineParams));
+
+        simulation = std::thread([&]() {
+            x11hw::HwFramePacer::InitParams pacerParams;
+            pacerParams.period = desiredDelta;
+            x11hw::HwFramePacer simulationPacer(pacerParams);
+            x11hw::HwFrameArena simulationArena;
+
+            while (!stopSimulation.load()) {
+                if (!replayFast) {
+                    simulationPacer.Wait();
+                }
+
+                auto snapshot = pipeline->BeginWrite();
+
+                if (!snapshot) {
+                    break;
+                }
+
+                simulationArena.BeginFrame();
+                simulateFrame(*snapshot, simulationArena.Get());
+                pipeline->EndWrite();
+                simulatedFrames.fetch_add(1);
+            }
+        });
+    }
+
+    // Latency from simulation of the snapshot to its presentation
+    double latencySumMs = 0.0;
+    double latencyMaxMs = 0.0;
+    size_t presentedSnapshots = 0;
+    size_t renderedFrames = 0;
+
+    // Input sampling to presentation of the frame (GPU completion without GLX_OML_sync_control)
+    x11hw::HwPresentLatency::InitParams presentLatencyParams;
+    presentLatencyParams.window = window;
+    x11hw::HwPresentLatency presentLatency(presentLatencyParams);
+
+    // Transient data of the render thread frame (events of synchronous simulation, draw list)
+    x11hw::HwFrameArena frameArena;
+
+    // Heap allocations of the render thread in the steady state loop (after resources are loaded and arenas are grown)
+    const size_t warmupFrames = 120;
+    uint64_t warmupAllocations = 0;
+
+    // Viewport follows the latest (coalesced) size, settled sizes are reported once
+    glm::uvec2 viewportSize{};
+    size_t settledResizes = 0;
+
+    // Offscreen targets are reallocated to the exact size once resize settles (larger ones are reused while dragging)
+    window->SubscribeOnResize([&settledResizes, &fxaa, &capture](glm::uvec2, glm::uvec2 framebufferSize) {
+        if (fxaa) {
+            fxaa->Resize(framebufferSize);
+        }
+
+        if (capture) {
+            capture->Resize(framebufferSize);
+        }
+
+        settledResizes += 1;
+    });
+
+    // Runtime metrics: render thread only updates atomics, scrapes are served by the server thread
+    x11hw::HwMetricsRegistry metrics;
+    auto& metricFrames = metrics.AddCounter("x11hw_frames_total", "Rendered frames");
+    auto& metricMissedFrames = metrics.AddCounter("x11hw_missed_frames_total", "Frames started after their deadline");
+    auto& metricDrawCalls = metrics.AddCounter("x11hw_draw_calls_total", "Issued draw calls");
+    auto& metricDrawCallsPerFrame = metrics.AddGauge("x11hw_draw_calls_per_frame", "Draw calls of the last frame");
+    auto& metricEventQueueDepth = metrics.AddGauge("x11hw_event_queue_depth", "Events queued by X server at the frame start");
+    auto& metricSwapInterval = metrics.AddGauge("x11hw_swap_interval", "Swap interval in effect (negative - late frames tear)");
+    auto& metricFrameTime = metrics.AddHistogram("x11hw_frame_time_ms", "Interval between frame starts",
+                                                 {1.0, 2.0, 4.0, 8.0, 12.0, 16.7, 20.0, 25.0, 33.3, 50.0, 100.0});
+
+    metricSwapInterval.Set(window->GetSwapInterval());
+
+    std::unique_ptr<x11hw::HwMetricsServer> metricsServer;
+
+    if (!options.metricsSocket.empty()) {
+        x11hw::HwMetricsServer::InitParams metricsParams;
+        metricsParams.socketPath = options.metricsSocket;
+        metricsServer.reset(new x11hw::HwMetricsServer(metrics, metricsParams));
+    }
+
+    // Sleep + spin limiter keeps pacing even, when vsync is off (fast replay is not limited)
+    x11hw::HwFramePacer::InitParams pacerParams;
+    pacerParams.period = desiredDelta;
+    x11hw::HwFramePacer pacer(pacerParams);
+    auto prevFrameTime = timer::now();
+    size_t prevMissedFrames = 0;
+    size_t prevDrawCalls = 0;
+    double smoothedFrameMs = 0.0;
+    double cpuFrameMs = 0.0;
+
+    while (!shouldClose) {
+        // Fences of previous frames are also polled around the wait, so their signal time is bracketed closer
+        presentLatency.Poll();
+        auto currentTime = replayFast ? timer::now() : pacer.Wait();
+        presentLatency.Poll();
+        frameArena.BeginFrame();
+        size_t drawCalls = 0;
+
+        auto frameMs = std::chrono::duration<double, std::milli>(currentTime - prevFrameTime).count();
+        metricFrameTime.Observe(frameMs);
+        smoothedFrameMs = smoothedFrameMs > 0.0 ? smoothedFrameMs * 0.95 + frameMs * 0.05 : frameMs;
+        prevFrameTime = currentTime;
+
+        if (!replayFast) {
+            auto missedFrames = pacer.GetStats().missedDeadlines;
+            metricMissedFrames.Add(missedFrames - prevMissedFrames);
+            prevMissedFrames = missedFrames;
+        }
+
+        // Query input and pick up finished background uploads
         windowManager->PollEvents();
+        uploader->Poll();
+        metricEventQueueDepth.Set(windowManager->GetEventQueueDepth());
+
+        if (windowManager->IsReplayFinished()) {
+            shouldClose = true;
+        }
+
+        // Take snapshot to render
+        const FrameSnapshot *frame = nullptr;
+        bool isNewFrame = true;
+
+        if (pipeline) {
+            frame = pipeline->Acquire(&isNewFrame);
+        }
+        else {
+            simulateFrame(syncSnapshot, frameArena.Get());
+            simulatedFrames.fetch_add(1);
+            frame = &syncSnapshot;
+        }
+
+        // Only if user holds left mouse button
+        x11hw::HwArenaVector<TriangleDraw> drawList{x11hw::HwArenaAllocator<TriangleDraw>(frameArena.Get())};
+
+        if (frame && frame->showTriangle) {
+            TriangleDraw draw;
+            draw.position = glm::vec2(frame->mousePosition);
+            draw.size = triangleSize;
+            drawList.push_back(draw);
+        }
+
+        // Flip Y-axis, so mouse position is correct (triangle vertices also flipped)
+        auto framebufferSize = window->GetFramebufferSize();
+        auto proj = glm::ortho(0.0f, (float) framebufferSize.x, (float) framebufferSize.y, 0.0f, -1.0f, 1.0f);
 
         // Setup drawing area and clear color buffer
-        glViewport(0, 0, window->GetSize().x, window->GetSize().y);
+        if (viewportSize != framebufferSize) {
+            glViewport(0, 0, framebufferSize.x, framebufferSize.y);
+            viewportSize = framebufferSize;
+        }
+
+        if (frameGpuTimer) {
+            frameGpuTimer->Begin();
+        }
+
+        if (fxaa) {
+            fxaa->BeginScene(framebufferSize);
+        }
+
         glClearColor(clearColor.x, clearColor.y, clearColor.z, clearColor.w);
         glClear(GL_COLOR_BUFFER_BIT);
 
-        // Only if user holds left mouse button
-        if (showTriangle) {
+        // Draw list is submitted once resources are loaded
+        if (!drawList.empty() && shader && geometry) {
             static const std::string PROJ_VIEW = "projView";
             static const std::string BASIC_GAMMA = "basicGamma";
             static const std::string TRIANGLE_SIZE = "triangleSize";
             static const std::string MOUSE_POSITION = "mousePosition";
 
-            // Flip Y-axis, so mouse position is correct (triangle vertices also flipped)
-            auto size = window->GetFramebufferSize();
-            auto proj = glm::ortho(0.0f, (float) size.x, (float) size.y, 0.0f, -1.0f, 1.0f);
-
             shader->Bind();
-            shader->SetFloat(BASIC_GAMMA, gamma);
-            shader->SetVec2(TRIANGLE_SIZE, triangleSize);
-            shader->SetVec2(MOUSE_POSITION, mousePosition);
+            if (!framebufferSrgb) {
+                shader->SetFloat(BASIC_GAMMA, gamma);
+            }
+
             shader->SetMatrix4(PROJ_VIEW, proj);
-            geometry->Draw();
+
+            for (auto& draw: drawList) {
+                shader->SetVec2(TRIANGLE_SIZE, draw.size);
+                shader->SetVec2(MOUSE_POSITION, draw.position);
+                geometry->Draw();
+                drawCalls += 1;
+            }
+
             shader->Unbind();
         }
 
+        if (fxaa) {
+            fxaa->Apply();
+            drawCalls += 1;
+        }
+
+        // Timer queries do not nest, overlay measures itself
+        if (frameGpuTimer) {
+            frameGpuTimer->End();
+        }
+
+        // Overlay shows values of the previous frame (current one is not finished yet)
+        if (hud) {
+            auto hudStats = hud->GetStats();
+            auto sceneGpuUs = frameGpuTimer->GetSmoothedUs();
+
+            hud->AddFrameTime((float) frameMs);
+            hud->Print(x11hw::HwHud::COLOR_TEXT, "FPS %.0f  frame %.2f ms", 1e3 / smoothedFrameMs, smoothedFrameMs);
+            hud->Print(x11hw::HwHud::COLOR_TEXT, "CPU %.2f ms  GPU %.2f ms", cpuFrameMs, (sceneGpuUs + hudStats.averageGpuUs) / 1e3);
+            hud->Print(x11hw::HwHud::COLOR_TEXT, "draws %zu  swap %d  events %u",
+                       prevDrawCalls, window->GetSwapInterval(), windowManager->GetEventQueueDepth());
+            hud->Print(x11hw::HwHud::COLOR_WARNING, "HUD cpu %.1f us  gpu %.1f us", hudStats.averageCpuUs, hudStats.averageGpuUs);
+            hud->Draw(framebufferSize);
+            drawCalls += 1;
+        }
+
+        // Read back buffer before it is presented
+        if (capture) {
+            capture->Capture(window->GetFramebufferSize());
+        }
+
         // Present image
+        cpuFrameMs = std::chrono::duration<double, std::milli>(timer::now() - currentTime).count();
+        prevDrawCalls = drawCalls;
         window->SwapBuffers();
+        presentLatency.EndFrame(frame ? frame->simulated : currentTime);
+        measuredLatencyUs.store((int64_t) (presentLatency.GetSmoothedMs() * 1e3), std::memory_order_relaxed);
+        renderedFrames += 1;
+
+        metricFrames.Add();
+        metricDrawCalls.Add(drawCalls);
+        metricDrawCallsPerFrame.Set((double) drawCalls);
+
+        if (renderedFrames == warmupFrames) {
+            warmupAllocations = x11hw::HwAllocationCounter::GetThreadAllocations();
+        }
+
+        if (frame && isNewFrame) {
+            auto latencyMs = std::chrono::duration<double, std::milli>(timer::now() - frame->simulated).count();
+            latencySumMs += latencyMs;
+            latencyMaxMs = std::max(latencyMaxMs, latencyMs);
+            presentedSnapshots += 1;
+        }
+    }
+
+    auto runSeconds = std::chrono::duration<double>(timer::now() - startTime).count();
+
+    if (pipeline) {
+        stopSimulation.store(true);
+        pipeline->Close();
+        simulation.join();
+
+        // Events polled after the last simulated snapshot still belong to the run
+        bool pending;
+        {
+            std::lock_guard<std::mutex> guard(inbox.mutex);
+            pending = !inbox.events.empty();
+        }
+
+        if (pending) {
+            simulateFrame(syncSnapshot, frameArena.Get());
+            simulatedFrames.fetch_add(1);
+        }
+    }
+
+    {
+        size_t dropped = pipeline ? pipeline->GetStats().dropped : 0;
+        const char *mode = !pipeline ? "sync" : options.pipelineMode == FramePipeline::Mode::Latest ? "latest" : "fifo";
+
+        std::cout << "Pipeline depth " << options.pipelineDepth << " (" << mode << "): "
+                  << "rendered " << renderedFrames << " frames (" << renderedFrames / runSeconds << " fps), "
+                  << "simulated " << simulatedFrames.load() << " (" << simulatedFrames.load() / runSeconds << " Hz), "
+                  << "dropped " << dropped << " snapshots, "
+                  << "latency avg " << (presentedSnapshots ? latencySumMs / presentedSnapshots : 0.0) << " ms, "
+                  << "max " << latencyMaxMs << " ms" << std::endl;
+    }
+
+    {
+        const char *mode = options.lowLatency ?
+                           (windowManager->IsSwapTearSupported() ? "low-latency, tear" : "low-latency, vsync") :
+                           (options.fullscreen ? "fullscreen" : "windowed");
+        presentLatency.Report(std::cout, mode);
+
+        if (!replayFast) {
+            pacer.Report(std::cout, "render");
+        }
+
+        if (hud) {
+            hud->Report(std::cout, "overlay");
+            frameGpuTimer->Report(std::cout, "scene and post process");
+        }
+
+        if (fxaa) {
+            fxaa->Report(std::cout, "post process");
+        }
+
+        if (simulationState.predictor) {
+            auto lead = options.predictMs >= 0.0 ? std::to_string(options.predictMs) + " ms lead" :
+                        "measured lead " + std::to_string(measuredLatencyUs.load() / 1000.0) + " ms";
+            simulationState.predictor->Report(std::cout, lead.c_str());
+        }
+    }
+
+    if (x11hw::HwAllocationCounter::IsEnabled() && renderedFrames > warmupFrames) {
+        auto allocations = x11hw::HwAllocationCounter::GetThreadAllocations() - warmupAllocations;
+        std::cout << "Render thread heap allocations after warmup: " << allocations << " in " << renderedFrames - warmupFrames << " frames ("
+                  << (double) allocations / (double) (renderedFrames - warmupFrames) << " per frame), "
+                  << "frame arena chunks " << frameArena.GetHeapAllocations() << std::endl;
+    }
+
+    if (settledResizes > 0) {
+        std::cout << "Window resized " << settledResizes << " times, final size "
+                  << window->GetSize().x << "x" << window->GetSize().y << std::endl;
+    }
+
+    if (windowManager->IsReplaying()) {
+        auto seconds = std::chrono::duration<double>(timer::now() - startTime).count();
+        auto startupMs = std::chrono::duration<double, std::milli>(startTime - processStartTime).count();
+        auto frames = windowManager->GetFrameIndex();
+
+        // ru_maxrss is in kilobytes on Linux
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+
+        // Parsed by perf regression suite (tests/perf/run_perf_scene.sh)
+        std::cout << "Replayed " << frames << " frames in " << seconds << " s, "
+                  << "avg frame " << seconds * 1e3 / frames << " ms, "
+                  << "startup " << startupMs << " ms, "
+                  << "peak RSS " << (double) usage.ru_maxrss / 1024.0 << " MiB" << std::endl;
+    }
+
+    if (auto debugOutput = windowManager->GetDebugOutput()) {
+        debugOutput->Report(std::cout);
+    }
+
+    if (capture) {
+        auto stats = capture->GetStats();
+        std::cout << "Captured " << stats.capturedFrames << " frames (dropped " << stats.droppedFrames << "), "
+                  << "buffers allocated " << stats.reallocations << " times, "
+                  << "render thread cost avg " << stats.averageRenderThreadMs << " ms, "
+                  << "max " << stats.maxRenderThreadMs << " ms" << std::endl;
     }
 
     return 0;
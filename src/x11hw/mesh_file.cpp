@@ -0,0 +1,418 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/mesh_file.hpp>
+#include <x11hw/error.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace x11hw {
+
+    static const char MESH_FILE_MAGIC[8] = {'X', '1', '1', 'H', 'W', 'M', 'S', 'H'};
+
+    struct HwMeshFileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t stride;
+        uint32_t attributesCount;
+        uint32_t chunksCount;
+        uint64_t attributesOffset;
+        uint64_t chunksOffset;
+    };
+
+    struct HwMeshFileAttribute {
+        uint32_t offset;
+        uint32_t components;
+        uint32_t baseType;
+        uint32_t normalize;
+    };
+
+    struct HwMeshFileChunk {
+        uint64_t verticesOffset;
+        uint64_t verticesCount;
+        uint64_t indicesOffset;
+        uint64_t indicesCount;
+    };
+
+    static_assert(sizeof(HwMeshFileHeader) == 40, "Header must have no padding");
+    static_assert(sizeof(HwMeshFileAttribute) == 16, "Attribute must have no padding");
+    static_assert(sizeof(HwMeshFileChunk) == 32, "Chunk must have no padding");
+
+    static size_t AlignUp(size_t offset, size_t alignment) {
+        return (offset + alignment - 1) & ~(alignment - 1);
+    }
+
+    static size_t GetBaseTypeSize(uint32_t baseType) {
+        switch (baseType) {
+            case GL_BYTE:
+            case GL_UNSIGNED_BYTE:
+                return 1;
+            case GL_SHORT:
+            case GL_UNSIGNED_SHORT:
+            case GL_HALF_FLOAT:
+                return 2;
+            case GL_INT:
+            case GL_UNSIGNED_INT:
+            case GL_FLOAT:
+                return 4;
+            default:
+                return 0;
+        }
+    }
+
+    static bool IsValidAttribute(const HwMeshFileAttribute &attribute, size_t stride) {
+        // Packed formats hold all 4 components in one u32
+        if (attribute.baseType == GL_INT_2_10_10_10_REV || attribute.baseType == GL_UNSIGNED_INT_2_10_10_10_REV) {
+            return attribute.components == 4 && attribute.offset <= stride && sizeof(uint32_t) <= stride - attribute.offset;
+        }
+
+        auto baseTypeSize = GetBaseTypeSize(attribute.baseType);
+        return baseTypeSize > 0 &&
+               attribute.components >= 1 && attribute.components <= 4 &&
+               attribute.offset <= stride &&
+               attribute.components * baseTypeSize <= stride - attribute.offset;
+    }
+
+    /** Check that count items of given size starting at offset fit into size bytes (without overflow) */
+    static bool IsRangeInside(uint64_t offset, uint64_t count, uint64_t itemSize, uint64_t size) {
+        return offset <= size && count <= (size - offset) / itemSize;
+    }
+
+    HwMeshFile::HwMeshFile(const std::string &path) {
+        mFile = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+        if (mFile < 0) {
+            throw std::runtime_error("Failed to open mesh file " + path);
+        }
+
+        struct stat info{};
+
+        if (fstat(mFile, &info) != 0) {
+            close(mFile);
+            throw std::runtime_error("Failed to query size of mesh file " + path);
+        }
+
+        mSize = (size_t) info.st_size;
+
+        if (mSize < sizeof(HwMeshFileHeader)) {
+            close(mFile);
+            throw std::runtime_error("Mesh file is too small " + path);
+        }
+
+        // Private read-only mapping: pages come from page cache on first access, never copied
+        void *data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, mFile, 0);
+
+        if (data == MAP_FAILED) {
+            close(mFile);
+            throw std::runtime_error("Failed to map mesh file " + path);
+        }
+
+        mData = (const uint8_t *) data;
+
+        HwMeshFileHeader header;
+        std::memcpy(&header, mData, sizeof(header));
+
+        bool valid = std::memcmp(header.magic, MESH_FILE_MAGIC, sizeof(MESH_FILE_MAGIC)) == 0 &&
+                     header.version == VERSION &&
+                     header.stride > 0 &&
+                     header.attributesCount > 0 &&
+                     IsRangeInside(header.attributesOffset, header.attributesCount, sizeof(HwMeshFileAttribute), mSize) &&
+                     IsRangeInside(header.chunksOffset, header.chunksCount, sizeof(HwMeshFileChunk), mSize) &&
+                     header.chunksOffset % alignof(HwMeshFileChunk) == 0;
+
+        if (valid) {
+            mStride = header.stride;
+            mChunksCount = header.chunksCount;
+            mChunks = (const HwMeshFileChunk *) (mData + header.chunksOffset);
+
+            for (uint32_t i = 0; i < header.attributesCount && valid; i++) {
+                HwMeshFileAttribute attribute;
+                std::memcpy(&attribute, mData + header.attributesOffset + sizeof(attribute) * i, sizeof(attribute));
+                valid = IsValidAttribute(attribute, mStride);
+                mAttributes.push_back({attribute.offset, attribute.components, attribute.baseType, attribute.normalize != 0});
+            }
+
+            for (size_t i = 0; i < mChunksCount && valid; i++) {
+                auto& chunk = mChunks[i];
+                valid = chunk.verticesCount > 0 &&
+                        chunk.indicesCount % 3 == 0 &&
+                        chunk.verticesOffset % BLOCK_ALIGNMENT == 0 &&
+                        chunk.indicesOffset % BLOCK_ALIGNMENT == 0 &&
+                        IsRangeInside(chunk.verticesOffset, chunk.verticesCount, mStride, mSize) &&
+                        IsRangeInside(chunk.indicesOffset, chunk.indicesCount, sizeof(uint32_t), mSize);
+            }
+        }
+
+        if (!valid) {
+            munmap(data, mSize);
+            close(mFile);
+            throw std::runtime_error("Invalid or unsupported mesh file " + path);
+        }
+    }
+
+    HwMeshFile::~HwMeshFile() {
+        munmap((void *) mData, mSize);
+        close(mFile);
+    }
+
+    HwMeshFile::Chunk HwMeshFile::GetChunk(size_t index) const {
+        assert(index < mChunksCount);
+
+        auto& entry = mChunks[index];
+
+        Chunk chunk;
+        chunk.vertices = mData + entry.verticesOffset;
+        chunk.verticesCount = (size_t) entry.verticesCount;
+        chunk.indices = entry.indicesCount ? (const uint32_t *) (mData + entry.indicesOffset) : nullptr;
+        chunk.indicesCount = (size_t) entry.indicesCount;
+        return chunk;
+    }
+
+    HwGeometry::InitParams HwMeshFile::GetGeometryParams(size_t index) const {
+        assert(index < mChunksCount);
+
+        HwGeometry::InitParams params;
+        params.verticesCount = (size_t) mChunks[index].verticesCount;
+        params.stride = mStride;
+        params.topology = GL_TRIANGLES;
+        params.attributes = mAttributes;
+        params.indicesCount = (size_t) mChunks[index].indicesCount;
+        return params;
+    }
+
+    std::unique_ptr<HwGeometry> HwMeshFile::CreateGeometry(size_t index) const {
+        auto chunk = GetChunk(index);
+
+        // Indices are touched only here (not on open), so out of range ones are caught before upload
+        for (size_t i = 0; i < chunk.indicesCount; i++) {
+            CHECK_MSG(chunk.indices[i] < chunk.verticesCount, "Mesh chunk index is out of range");
+        }
+
+        std::unique_ptr<HwGeometry> geometry{new HwGeometry(GetGeometryParams(index))};
+        geometry->Update(0, chunk.verticesCount * mStride, chunk.vertices);
+
+        if (chunk.indicesCount) {
+            geometry->UpdateIndices(0, chunk.indicesCount, chunk.indices);
+        }
+
+        return geometry;
+    }
+
+    void HwMeshFile::Prefetch(size_t index) const {
+        size_t offset, size;
+        GetChunkRange(index, offset, size);
+        madvise((void *) (mData + offset), size, MADV_WILLNEED);
+    }
+
+    void HwMeshFile::Evict(size_t index) const {
+        size_t offset, size;
+        GetChunkRange(index, offset, size);
+        madvise((void *) (mData + offset), size, MADV_DONTNEED);
+    }
+
+    size_t HwMeshFile::GetPageSize() {
+        static const size_t pageSize = (size_t) sysconf(_SC_PAGESIZE);
+        return pageSize;
+    }
+
+    void HwMeshFile::GetChunkRange(size_t index, size_t &offset, size_t &size) const {
+        assert(index < mChunksCount);
+
+        // Index block follows vertex block of the same chunk
+        auto& chunk = mChunks[index];
+        size_t end = chunk.indicesCount ?
+                     (size_t) (chunk.indicesOffset + chunk.indicesCount * sizeof(uint32_t)) :
+                     (size_t) (chunk.verticesOffset + chunk.verticesCount * mStride);
+
+        // madvise takes page aligned ranges, file may be written with smaller pages than ours
+        auto pageSize = GetPageSize();
+        offset = (size_t) chunk.verticesOffset & ~(pageSize - 1);
+        size = AlignUp(end, pageSize) - offset;
+    }
+
+    void HwMeshFile::Write(const std::string &path, const Source &source, size_t maxChunkVertices) {
+        assert(source.stride > 0);
+        assert(maxChunkVertices >= 3);
+
+        bool indexed = source.indices != nullptr;
+        size_t trianglesCount = (indexed ? source.indicesCount : source.verticesCount) / 3;
+
+        // Pass 1: triangle ranges of chunks, so table size is known before blocks are written
+        struct Range {
+            size_t firstTriangle;
+            size_t trianglesCount;
+            size_t verticesCount;
+        };
+
+        std::vector<Range> ranges;
+        std::vector<uint32_t> remap(indexed ? source.verticesCount : 0, UINT32_MAX);
+        std::vector<uint32_t> used;
+
+        auto resetRemap = [&]() {
+            for (auto vertex: used) {
+                remap[vertex] = UINT32_MAX;
+            }
+            used.clear();
+        };
+
+        for (size_t t = 0; t < trianglesCount;) {
+            Range range{t, 0, 0};
+
+            if (indexed) {
+                while (t < trianglesCount) {
+                    size_t added = 0;
+                    for (size_t k = 0; k < 3; k++) {
+                        auto vertex = source.indices[t * 3 + k];
+                        CHECK_MSG(vertex < source.verticesCount, "Mesh index is out of range");
+                        added += remap[vertex] == UINT32_MAX ? 1 : 0;
+                    }
+
+                    if (used.size() + added > maxChunkVertices) {
+                        break;
+                    }
+
+                    for (size_t k = 0; k < 3; k++) {
+                        auto vertex = source.indices[t * 3 + k];
+                        if (remap[vertex] == UINT32_MAX) {
+                            remap[vertex] = (uint32_t) used.size();
+                            used.push_back(vertex);
+                        }
+                    }
+
+                    t += 1;
+                }
+
+                range.verticesCount = used.size();
+                resetRemap();
+            }
+            else {
+                size_t count = std::min(trianglesCount - t, maxChunkVertices / 3);
+                t += count;
+                range.verticesCount = count * 3;
+            }
+
+            range.trianglesCount = t - range.firstTriangle;
+            ranges.push_back(range);
+        }
+
+        std::FILE *file = std::fopen(path.c_str(), "wb");
+
+        if (!file) {
+            throw std::runtime_error("Failed to create mesh file " + path);
+        }
+
+        HwMeshFileHeader header{};
+        std::memcpy(header.magic, MESH_FILE_MAGIC, sizeof(MESH_FILE_MAGIC));
+        header.version = VERSION;
+        header.stride = (uint32_t) source.stride;
+        header.attributesCount = (uint32_t) source.attributes.size();
+        header.chunksCount = (uint32_t) ranges.size();
+        header.attributesOffset = sizeof(HwMeshFileHeader);
+        header.chunksOffset = header.attributesOffset + sizeof(HwMeshFileAttribute) * header.attributesCount;
+
+        std::vector<HwMeshFileAttribute> attributes;
+        for (auto& attribute: source.attributes) {
+            attributes.push_back({(uint32_t) attribute.offset, (uint32_t) attribute.components,
+                                  (uint32_t) attribute.baseType, attribute.normalize ? 1u : 0u});
+        }
+
+        auto alignment = GetPageSize() > BLOCK_ALIGNMENT ? GetPageSize() : BLOCK_ALIGNMENT;
+        auto alignBlock = [alignment](size_t offset) { return AlignUp(offset, alignment); };
+
+        std::vector<HwMeshFileChunk> chunks(ranges.size());
+        size_t offset = alignBlock(header.chunksOffset + sizeof(HwMeshFileChunk) * chunks.size());
+
+        for (size_t c = 0; c < ranges.size(); c++) {
+            chunks[c].verticesOffset = offset;
+            chunks[c].verticesCount = ranges[c].verticesCount;
+            offset = alignBlock(offset + ranges[c].verticesCount * source.stride);
+
+            chunks[c].indicesOffset = indexed ? offset : 0;
+            chunks[c].indicesCount = indexed ? ranges[c].trianglesCount * 3 : 0;
+            offset = indexed ? alignBlock(offset + ranges[c].trianglesCount * 3 * sizeof(uint32_t)) : offset;
+        }
+
+        std::fwrite(&header, sizeof(header), 1, file);
+        std::fwrite(attributes.data(), sizeof(HwMeshFileAttribute), attributes.size(), file);
+        std::fwrite(chunks.data(), sizeof(HwMeshFileChunk), chunks.size(), file);
+
+        // Pass 2: chunk blocks
+        auto vertices = (const uint8_t *) source.vertices;
+        std::vector<uint8_t> vertexBlock;
+        std::vector<uint32_t> indexBlock;
+        std::vector<uint8_t> padding(alignment, 0);
+
+        auto pad = [&](size_t to) {
+            auto position = (size_t) std::ftell(file);
+            std::fwrite(padding.data(), 1, to - position, file);
+        };
+
+        for (size_t c = 0; c < ranges.size(); c++) {
+            auto& range = ranges[c];
+
+            pad(chunks[c].verticesOffset);
+
+            if (indexed) {
+                vertexBlock.resize(range.verticesCount * source.stride);
+                indexBlock.resize(range.trianglesCount * 3);
+
+                for (size_t i = 0; i < indexBlock.size(); i++) {
+                    auto vertex = source.indices[range.firstTriangle * 3 + i];
+
+                    if (remap[vertex] == UINT32_MAX) {
+                        remap[vertex] = (uint32_t) used.size();
+                        std::memcpy(vertexBlock.data() + used.size() * source.stride, vertices + vertex * source.stride, source.stride);
+                        used.push_back(vertex);
+                    }
+
+                    indexBlock[i] = remap[vertex];
+                }
+
+                resetRemap();
+
+                std::fwrite(vertexBlock.data(), 1, vertexBlock.size(), file);
+                pad(chunks[c].indicesOffset);
+                std::fwrite(indexBlock.data(), sizeof(uint32_t), indexBlock.size(), file);
+            }
+            else {
+                std::fwrite(vertices + range.firstTriangle * 3 * source.stride, source.stride, range.verticesCount, file);
+            }
+        }
+
+        bool failed = std::ferror(file) != 0;
+        failed = std::fclose(file) != 0 || failed;
+
+        if (failed) {
+            throw std::runtime_error("Failed to write mesh file " + path);
+        }
+    }
+
+}
@@ -0,0 +1,137 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_MESH_FILE_HPP
+#define X11HELLOWORLD_MESH_FILE_HPP
+
+#include <x11hw/geometry.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace x11hw {
+
+    /**
+     * Binary mesh container layout (little-endian, blocks are ready to be uploaded as is):
+     *
+     *  header:     magic "X11HWMSH" (8), version (u32), stride (u32), attributes count (u32),
+     *              chunks count (u32), attributes offset (u64), chunks offset (u64)
+     *  attribute:  offset (u32), components (u32), base type (u32), normalize (u32)
+     *  chunk:      vertices offset (u64), vertices count (u64), indices offset (u64), indices count (u64)
+     *  blocks:     vertex data in attributes layout, u32 indices relative to the chunk vertices,
+     *              each block starts at page boundary of the writer (at least BLOCK_ALIGNMENT)
+     *
+     * Chunks are independent: a chunk is drawn (and loaded) without touching the others.
+     */
+    class HwMeshFile {
+    public:
+        static const uint32_t VERSION = 1;
+        /** Min alignment of blocks in file (actual alignment is page size of the writer) */
+        static const size_t BLOCK_ALIGNMENT = 4096;
+
+        struct Chunk {
+            const void *vertices = nullptr;
+            size_t verticesCount = 0;
+            const uint32_t *indices = nullptr;
+            size_t indicesCount = 0;
+        };
+
+        /** Mesh to write: vertices with attributes and optional triangle list indices */
+        struct Source {
+            size_t stride = 0;
+            std::vector<HwGeometry::Attribute> attributes;
+            const void *vertices = nullptr;
+            size_t verticesCount = 0;
+            const uint32_t *indices = nullptr;
+            size_t indicesCount = 0;
+        };
+
+        /**
+         * Map mesh file (nothing is read until chunk data is touched)
+         * @param path File path
+         */
+        explicit HwMeshFile(const std::string &path);
+        HwMeshFile(const HwMeshFile&) = delete;
+        HwMeshFile(HwMeshFile&&) = delete;
+        ~HwMeshFile();
+
+        /**
+         * Get chunk data pointing into the mapping. Pages are read on first access, so passing
+         * pointers straight to glBufferData/glBufferSubData streams file into the GL buffer
+         * without intermediate copies.
+         * @param index Chunk index
+         * @return Chunk data
+         */
+        Chunk GetChunk(size_t index) const;
+
+        /** @return Params of geometry for vertices (and indices) of the chunk */
+        HwGeometry::InitParams GetGeometryParams(size_t index) const;
+
+        /**
+         * Create geometry and upload chunk vertices and indices into it
+         * @param index Chunk index
+         * @return Geometry
+         */
+        std::unique_ptr<HwGeometry> CreateGeometry(size_t index) const;
+
+        /** Start read ahead of the chunk pages (call before chunk is needed) */
+        void Prefetch(size_t index) const;
+
+        /** Drop chunk pages from the mapping (call after upload, pages stay in page cache) */
+        void Evict(size_t index) const;
+
+        /** @return Page size of the system, blocks are aligned to it on write */
+        static size_t GetPageSize();
+
+        size_t GetChunksCount() const { return mChunksCount; }
+        size_t GetStride() const { return mStride; }
+        size_t GetFileSize() const { return mSize; }
+        const std::vector<HwGeometry::Attribute> &GetAttributes() const { return mAttributes; }
+
+        /**
+         * Write mesh into file, splitting triangles into chunks with at most maxChunkVertices
+         * vertices (chunk indices are remapped to chunk local vertices)
+         * @param path File path
+         * @param source Mesh to write
+         * @param maxChunkVertices Max vertices in chunk
+         */
+        static void Write(const std::string &path, const Source &source, size_t maxChunkVertices = 1 << 16);
+
+    private:
+        void GetChunkRange(size_t index, size_t &offset, size_t &size) const;
+
+    private:
+        std::vector<HwGeometry::Attribute> mAttributes;
+        const uint8_t *mData = nullptr;
+        const struct HwMeshFileChunk *mChunks = nullptr;
+        size_t mChunksCount = 0;
+        size_t mStride = 0;
+        size_t mSize = 0;
+        int mFile = -1;
+    };
+
+}
+
+#endif //X11HELLOWORLD_MESH_FILE_HPP
@@ -0,0 +1,243 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/metrics.hpp>
+#include <x11hw/error.hpp>
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <cassert>
+#include <cstring>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace x11hw {
+
+    static uint64_t DoubleToBits(double value) {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+
+    static double BitsToDouble(uint64_t bits) {
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    HwMetricCounter::HwMetricCounter(std::string name, std::string help)
+        : mName(std::move(name)), mHelp(std::move(help)) {
+    }
+
+    HwMetricGauge::HwMetricGauge(std::string name, std::string help)
+        : mName(std::move(name)), mHelp(std::move(help)) {
+        Set(0.0);
+    }
+
+    void HwMetricGauge::Set(double value) {
+        mBits.store(DoubleToBits(value), std::memory_order_relaxed);
+    }
+
+    double HwMetricGauge::Get() const {
+        return BitsToDouble(mBits.load(std::memory_order_relaxed));
+    }
+
+    HwMetricHistogram::HwMetricHistogram(std::string name, std::string help, std::vector<double> bounds)
+        : mName(std::move(name)), mHelp(std::move(help)), mBounds(std::move(bounds)) {
+        assert(std::is_sorted(mBounds.begin(), mBounds.end()));
+
+        mBuckets.reset(new std::atomic<uint64_t>[mBounds.size() + 1]);
+
+        for (size_t i = 0; i <= mBounds.size(); i++) {
+            mBuckets[i].store(0, std::memory_order_relaxed);
+        }
+
+        mSumBits.store(DoubleToBits(0.0), std::memory_order_relaxed);
+    }
+
+    void HwMetricHistogram::Observe(double value) {
+        // Bounds are few (tens), so linear search is faster than binary
+        size_t bucket = 0;
+        while (bucket < mBounds.size() && value > mBounds[bucket]) {
+            bucket += 1;
+        }
+
+        mBuckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        mCount.fetch_add(1, std::memory_order_relaxed);
+
+        auto expected = mSumBits.load(std::memory_order_relaxed);
+        while (!mSumBits.compare_exchange_weak(expected, DoubleToBits(BitsToDouble(expected) + value), std::memory_order_relaxed)) {
+        }
+    }
+
+    double HwMetricHistogram::GetSum() const {
+        return BitsToDouble(mSumBits.load(std::memory_order_relaxed));
+    }
+
+    HwMetricCounter &HwMetricsRegistry::AddCounter(std::string name, std::string help) {
+        std::lock_guard<std::mutex> guard(mMutex);
+        mCounters.emplace_back(new HwMetricCounter(std::move(name), std::move(help)));
+        return *mCounters.back();
+    }
+
+    HwMetricGauge &HwMetricsRegistry::AddGauge(std::string name, std::string help) {
+        std::lock_guard<std::mutex> guard(mMutex);
+        mGauges.emplace_back(new HwMetricGauge(std::move(name), std::move(help)));
+        return *mGauges.back();
+    }
+
+    HwMetricHistogram &HwMetricsRegistry::AddHistogram(std::string name, std::string help, std::vector<double> bounds) {
+        std::lock_guard<std::mutex> guard(mMutex);
+        mHistograms.emplace_back(new HwMetricHistogram(std::move(name), std::move(help), std::move(bounds)));
+        return *mHistograms.back();
+    }
+
+    void HwMetricsRegistry::WriteText(std::ostream &stream) const {
+        std::lock_guard<std::mutex> guard(mMutex);
+
+        // Default precision (6 digits) would round large sums
+        auto precision = stream.precision(15);
+
+        for (auto& counter: mCounters) {
+            stream << "# HELP " << counter->GetName() << " " << counter->GetHelp() << "\n"
+                   << "# TYPE " << counter->GetName() << " counter\n"
+                   << counter->GetName() << " " << counter->Get() << "\n";
+        }
+
+        for (auto& gauge: mGauges) {
+            stream << "# HELP " << gauge->GetName() << " " << gauge->GetHelp() << "\n"
+                   << "# TYPE " << gauge->GetName() << " gauge\n"
+                   << gauge->GetName() << " " << gauge->Get() << "\n";
+        }
+
+        for (auto& histogram: mHistograms) {
+            auto& name = histogram->GetName();
+            auto& bounds = histogram->GetBounds();
+
+            stream << "# HELP " << name << " " << histogram->GetHelp() << "\n"
+                   << "# TYPE " << name << " histogram\n";
+
+            // Buckets are read one by one while being updated, so keep cumulative counts monotonic
+            uint64_t cumulative = 0;
+
+            for (size_t i = 0; i < bounds.size(); i++) {
+                cumulative += histogram->GetBucketCount(i);
+                stream << name << "_bucket{le=\"" << bounds[i] << "\"} " << cumulative << "\n";
+            }
+
+            cumulative += histogram->GetBucketCount(bounds.size());
+            stream << name << "_bucket{le=\"+Inf\"} " << cumulative << "\n"
+                   << name << "_sum " << histogram->GetSum() << "\n"
+                   << name << "_count " << cumulative << "\n";
+        }
+
+        stream.precision(precision);
+    }
+
+    HwMetricsServer::HwMetricsServer(const HwMetricsRegistry &registry, const InitParams &params)
+        : mRegistry(registry) {
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+
+        CHECK_MSG(!params.socketPath.empty(), "Metrics socket path is empty");
+        CHECK_MSG(params.socketPath.size() < sizeof(address.sun_path), "Metrics socket path is too long");
+
+        mSocketPath = params.socketPath;
+        mPollTimeoutMs = params.pollTimeoutMs;
+        std::strncpy(address.sun_path, mSocketPath.c_str(), sizeof(address.sun_path) - 1);
+
+        // Socket file of the previous (crashed) run blocks bind, but never remove anything else at that path
+        struct stat existing{};
+        if (lstat(mSocketPath.c_str(), &existing) == 0) {
+            CHECK_MSG(S_ISSOCK(existing.st_mode), "Metrics socket path exists and is not a socket");
+            unlink(mSocketPath.c_str());
+        }
+
+        mSocket = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        CHECK_MSG(mSocket >= 0, "Failed to create metrics socket");
+
+        if (bind(mSocket, (const sockaddr *) &address, sizeof(address)) != 0 || listen(mSocket, 4) != 0) {
+            close(mSocket);
+            mSocket = -1;
+            throw std::runtime_error("Failed to bind metrics socket " + mSocketPath + ": " + std::strerror(errno));
+        }
+
+        mThread = std::thread([this]() { ThreadMain(); });
+    }
+
+    HwMetricsServer::~HwMetricsServer() {
+        mStop.store(true);
+        mThread.join();
+
+        close(mSocket);
+        unlink(mSocketPath.c_str());
+    }
+
+    void HwMetricsServer::ThreadMain() {
+        std::string text;
+
+        while (!mStop.load()) {
+            pollfd fd{};
+            fd.fd = mSocket;
+            fd.events = POLLIN;
+
+            if (poll(&fd, 1, mPollTimeoutMs) <= 0 || !(fd.revents & POLLIN)) {
+                continue;
+            }
+
+            int client = accept4(mSocket, nullptr, nullptr, SOCK_CLOEXEC);
+
+            if (client < 0) {
+                continue;
+            }
+
+            std::ostringstream stream;
+            mRegistry.WriteText(stream);
+            text = stream.str();
+
+            // Scraper may go away at any moment: no SIGPIPE, partial writes are retried
+            size_t written = 0;
+            while (written < text.size()) {
+                auto result = send(client, text.data() + written, text.size() - written, MSG_NOSIGNAL);
+
+                if (result < 0 && errno == EINTR) {
+                    continue;
+                }
+                if (result <= 0) {
+                    break;
+                }
+
+                written += (size_t) result;
+            }
+
+            close(client);
+            mScrapes.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+}
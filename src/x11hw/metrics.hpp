@@ -0,0 +1,179 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_METRICS_HPP
+#define X11HELLOWORLD_METRICS_HPP
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+namespace x11hw {
+
+    /** Monotonic counter, updated with relaxed atomics (safe from any thread, never blocks) */
+    class HwMetricCounter {
+    public:
+        HwMetricCounter(std::string name, std::string help);
+        HwMetricCounter(const HwMetricCounter&) = delete;
+        HwMetricCounter(HwMetricCounter&&) = delete;
+
+        void Add(uint64_t value = 1) { mValue.fetch_add(value, std::memory_order_relaxed); }
+        uint64_t Get() const { return mValue.load(std::memory_order_relaxed); }
+
+        const std::string &GetName() const { return mName; }
+        const std::string &GetHelp() const { return mHelp; }
+
+    private:
+        std::string mName;
+        std::string mHelp;
+        std::atomic<uint64_t> mValue{0};
+    };
+
+    /** Value, which may go up and down (last written value is exported) */
+    class HwMetricGauge {
+    public:
+        HwMetricGauge(std::string name, std::string help);
+        HwMetricGauge(const HwMetricGauge&) = delete;
+        HwMetricGauge(HwMetricGauge&&) = delete;
+
+        void Set(double value);
+        double Get() const;
+
+        const std::string &GetName() const { return mName; }
+        const std::string &GetHelp() const { return mHelp; }
+
+    private:
+        std::string mName;
+        std::string mHelp;
+        std::atomic<uint64_t> mBits{0};
+    };
+
+    /**
+     * Histogram with fixed bucket upper bounds. Observe is wait-free for single writer
+     * and lock-free for many (sum is updated with CAS). Buckets are not cumulative
+     * internally, cumulative counts are computed on export.
+     */
+    class HwMetricHistogram {
+    public:
+        /**
+         * @param name Metric name
+         * @param help Description
+         * @param bounds Ascending upper bounds of buckets (+Inf bucket is implicit)
+         */
+        HwMetricHistogram(std::string name, std::string help, std::vector<double> bounds);
+        HwMetricHistogram(const HwMetricHistogram&) = delete;
+        HwMetricHistogram(HwMetricHistogram&&) = delete;
+
+        void Observe(double value);
+
+        /** @return Count of values in bucket (last bucket is +Inf) */
+        uint64_t GetBucketCount(size_t bucket) const { return mBuckets[bucket].load(std::memory_order_relaxed); }
+        uint64_t GetCount() const { return mCount.load(std::memory_order_relaxed); }
+        double GetSum() const;
+
+        const std::vector<double> &GetBounds() const { return mBounds; }
+        const std::string &GetName() const { return mName; }
+        const std::string &GetHelp() const { return mHelp; }
+
+    private:
+        std::string mName;
+        std::string mHelp;
+        std::vector<double> mBounds;
+        std::unique_ptr<std::atomic<uint64_t>[]> mBuckets;
+        std::atomic<uint64_t> mCount{0};
+        std::atomic<uint64_t> mSumBits{0};
+    };
+
+    /**
+     * Set of named metrics. Metrics are registered at setup (registration locks), returned
+     * references stay valid for the registry lifetime and are updated without locks.
+     */
+    class HwMetricsRegistry {
+    public:
+        HwMetricsRegistry() = default;
+        HwMetricsRegistry(const HwMetricsRegistry&) = delete;
+        HwMetricsRegistry(HwMetricsRegistry&&) = delete;
+
+        HwMetricCounter &AddCounter(std::string name, std::string help);
+        HwMetricGauge &AddGauge(std::string name, std::string help);
+        HwMetricHistogram &AddHistogram(std::string name, std::string help, std::vector<double> bounds);
+
+        /**
+         * Write all metrics in text exposition format (Prometheus 0.0.4):
+         * HELP/TYPE comments, one sample per line, histograms as cumulative _bucket{le=".."}, _sum, _count.
+         * @param stream Output stream
+         */
+        void WriteText(std::ostream &stream) const;
+
+    private:
+        mutable std::mutex mMutex;
+        std::vector<std::unique_ptr<HwMetricCounter>> mCounters;
+        std::vector<std::unique_ptr<HwMetricGauge>> mGauges;
+        std::vector<std::unique_ptr<HwMetricHistogram>> mHistograms;
+    };
+
+    /**
+     * Serves registry text on a Unix domain socket: each accepted connection gets the current
+     * snapshot and is closed. Formatting and IO run on the server thread, the hot path only
+     * updates atomics. Scrape with: socat - UNIX-CONNECT:<path>
+     */
+    class HwMetricsServer {
+    public:
+        struct InitParams {
+            std::string socketPath;
+            /** Period of stop flag checks of the server thread */
+            int pollTimeoutMs = 100;
+
+            InitParams() {}
+        };
+
+        HwMetricsServer(const HwMetricsRegistry &registry, const InitParams &params = InitParams());
+        HwMetricsServer(const HwMetricsServer&) = delete;
+        HwMetricsServer(HwMetricsServer&&) = delete;
+        ~HwMetricsServer();
+
+        /** @return Number of served scrapes */
+        uint64_t GetScrapesCount() const { return mScrapes.load(std::memory_order_relaxed); }
+
+    private:
+        void ThreadMain();
+
+    private:
+        const HwMetricsRegistry &mRegistry;
+        std::string mSocketPath;
+        int mPollTimeoutMs = 100;
+        int mSocket = -1;
+        std::thread mThread;
+        std::atomic<bool> mStop{false};
+        std::atomic<uint64_t> mScrapes{0};
+    };
+
+}
+
+#endif //X11HELLOWORLD_METRICS_HPP
@@ -0,0 +1,309 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/multi_draw.hpp>
+#include <x11hw/deletion_queue.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <cassert>
+#include <cstring>
+
+namespace x11hw {
+
+    HwMultiDraw::HwMultiDraw(const InitParams &params) {
+        assert(params.stride > 0);
+        assert(params.maxVertices > 0);
+        assert(params.maxDraws > 0);
+        assert(!params.attributes.empty());
+
+        mMaxVertices = params.maxVertices;
+        mMaxIndices = params.maxIndices;
+        mMaxDraws = params.maxDraws;
+        mDrawDataSize = params.drawDataSize;
+        mStride = params.stride;
+        mTopology = params.topology;
+        mDrawIdLocation = params.drawIdLocation;
+        mDrawDataBinding = params.drawDataBinding;
+
+        // Without base instance baseInstance of commands is ignored and every draw reads draw id 0
+        mIndirectSupported = (GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect) &&
+                             (GLEW_VERSION_4_2 || GLEW_ARB_base_instance) &&
+                             glMultiDrawArraysIndirect && glMultiDrawElementsIndirect;
+        mStorageSupported = params.storageBuffer && (GLEW_VERSION_4_3 || GLEW_ARB_shader_storage_buffer_object);
+        mDrawsPerBatch = mMaxDraws;
+
+        if (mDrawDataSize > 0 && !mStorageSupported) {
+            // Uniform block may be as small as 16 KiB, draws are split into batches which data fits into it
+            GLint maxBlockSize = 0;
+            glGetIntegerv(GL_MAX_UNIFORM_BLOCK_SIZE, &maxBlockSize);
+            mDrawsPerBatch = std::max<size_t>(1, std::min(mMaxDraws, (size_t) maxBlockSize / mDrawDataSize));
+        }
+
+        glGenVertexArrays(1, &mVAO);
+        glBindVertexArray(mVAO);
+
+        glGenBuffers(1, &mVBO);
+        glBindBuffer(GL_ARRAY_BUFFER, mVBO);
+        glBufferData(GL_ARRAY_BUFFER, mStride * mMaxVertices, nullptr, GL_STATIC_DRAW);
+
+        for (size_t i = 0; i < params.attributes.size(); i++) {
+            auto& attrib = params.attributes[i];
+            assert(i != mDrawIdLocation);
+
+            glEnableVertexAttribArray(i);
+            glVertexAttribDivisor(i, 0);
+            glVertexAttribPointer(
+                i,
+                attrib.components,
+                attrib.baseType,
+                attrib.normalize ? GL_TRUE : GL_FALSE,
+                mStride,
+                (void *) attrib.offset
+            );
+        }
+
+        if (mIndirectSupported) {
+            std::vector<GLuint> drawIds(mMaxDraws);
+            for (size_t i = 0; i < mMaxDraws; i++) {
+                drawIds[i] = (GLuint) i;
+            }
+
+            glGenBuffers(1, &mDrawIdBuffer);
+            glBindBuffer(GL_ARRAY_BUFFER, mDrawIdBuffer);
+            glBufferData(GL_ARRAY_BUFFER, sizeof(GLuint) * mMaxDraws, drawIds.data(), GL_STATIC_DRAW);
+
+            glEnableVertexAttribArray(mDrawIdLocation);
+            glVertexAttribDivisor(mDrawIdLocation, DRAW_ID_DIVISOR);
+            glVertexAttribIPointer(mDrawIdLocation, 1, GL_UNSIGNED_INT, sizeof(GLuint), nullptr);
+
+            glGenBuffers(1, &mCommandBuffer);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mCommandBuffer);
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawElementsIndirectCommand) * mMaxDraws, nullptr, GL_STREAM_DRAW);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        }
+
+        if (IsIndexed()) {
+            // Element array binding is stored in the VAO
+            glGenBuffers(1, &mIBO);
+            glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mIBO);
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * mMaxIndices, nullptr, GL_STATIC_DRAW);
+        }
+
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+        if (mDrawDataSize > 0) {
+            GLenum target = mStorageSupported ? GL_SHADER_STORAGE_BUFFER : GL_UNIFORM_BUFFER;
+
+            glGenBuffers(1, &mDrawDataBuffer);
+            glBindBuffer(target, mDrawDataBuffer);
+            glBufferData(target, mDrawDataSize * mDrawsPerBatch, nullptr, GL_STREAM_DRAW);
+            glBindBuffer(target, 0);
+        }
+
+        mArraysCommands.reserve(mMaxDraws);
+        mElementsCommands.reserve(mMaxDraws);
+        mDrawData.resize(mDrawDataSize * mMaxDraws);
+    }
+
+    HwMultiDraw::~HwMultiDraw() {
+        if (mVAO) {
+            GLuint buffers[] = { mVBO, mIBO, mDrawIdBuffer, mCommandBuffer, mDrawDataBuffer };
+
+            if (auto deletionQueue = HwDeletionQueue::GetCurrent()) {
+                // Sizes are not tracked for these buffers, so they are not recycled
+                deletionQueue->RetireVertexArray(mVAO);
+
+                for (auto buffer: buffers) {
+                    if (buffer) {
+                        deletionQueue->RetireBuffer(buffer, 0, 0);
+                    }
+                }
+            }
+            else {
+                glDeleteVertexArrays(1, &mVAO);
+                glDeleteBuffers(sizeof(buffers) / sizeof(buffers[0]), buffers);
+            }
+
+            mVAO = 0;
+            mVBO = 0;
+            mIBO = 0;
+            mDrawIdBuffer = 0;
+            mCommandBuffer = 0;
+            mDrawDataBuffer = 0;
+        }
+    }
+
+    size_t HwMultiDraw::AddMesh(const void *vertexData, size_t verticesCount, const GLuint *indices, size_t indicesCount) {
+        assert(vertexData);
+        assert(verticesCount > 0);
+        assert(IsIndexed() == (indices != nullptr));
+
+        if (mVerticesCount + verticesCount > mMaxVertices || mIndicesCount + indicesCount > mMaxIndices) {
+            throw std::runtime_error("Not enough space in multi draw buffers");
+        }
+
+        Mesh mesh{};
+        mesh.firstVertex = (GLuint) mVerticesCount;
+        mesh.verticesCount = (GLuint) verticesCount;
+        mesh.firstIndex = (GLuint) mIndicesCount;
+        mesh.indicesCount = (GLuint) indicesCount;
+
+        glBindBuffer(GL_ARRAY_BUFFER, mVBO);
+        glBufferSubData(GL_ARRAY_BUFFER, mStride * mVerticesCount, mStride * verticesCount, vertexData);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+        if (IsIndexed()) {
+            // Bind through VAO, so the element array binding of other VAO is not touched
+            glBindVertexArray(mVAO);
+            glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLuint) * mIndicesCount, sizeof(GLuint) * indicesCount, indices);
+            glBindVertexArray(0);
+        }
+
+        mVerticesCount += verticesCount;
+        mIndicesCount += indicesCount;
+        mMeshes.push_back(mesh);
+
+        return mMeshes.size() - 1;
+    }
+
+    void HwMultiDraw::AddDraw(size_t mesh, GLuint instancesCount, const void *drawData) {
+        assert(mesh < mMeshes.size());
+        assert(instancesCount > 0);
+
+        if (mDrawsCount >= mMaxDraws) {
+            throw std::runtime_error("Too many draws queued in multi draw");
+        }
+
+        auto& m = mMeshes[mesh];
+        auto drawId = (GLuint) mDrawsCount;
+
+        if (IsIndexed()) {
+            mElementsCommands.push_back({m.indicesCount, instancesCount, m.firstIndex, (GLint) m.firstVertex, drawId});
+        }
+        else {
+            mArraysCommands.push_back({m.verticesCount, instancesCount, m.firstVertex, drawId});
+        }
+
+        if (mDrawDataSize > 0 && drawData) {
+            std::memcpy(mDrawData.data() + mDrawDataSize * drawId, drawData, mDrawDataSize);
+        }
+
+        mDrawsCount += 1;
+    }
+
+    void HwMultiDraw::Submit() {
+        if (mDrawsCount == 0) {
+            return;
+        }
+
+        glBindVertexArray(mVAO);
+
+        for (size_t first = 0; first < mDrawsCount; first += mDrawsPerBatch) {
+            auto count = std::min(mDrawsPerBatch, mDrawsCount - first);
+
+            if (mDrawDataSize > 0) {
+                UploadDrawData(first, count);
+            }
+
+            if (mIndirectSupported) {
+                SubmitIndirect(first, count);
+            }
+            else {
+                SubmitFallback(first, count);
+            }
+        }
+
+        glBindVertexArray(0);
+        Reset();
+    }
+
+    void HwMultiDraw::UploadDrawData(size_t first, size_t count) {
+        GLenum target = mStorageSupported ? GL_SHADER_STORAGE_BUFFER : GL_UNIFORM_BUFFER;
+        size_t size = mDrawDataSize * count;
+
+        // Orphan previous storage, so we do not wait for draws of the previous batch
+        glBindBuffer(target, mDrawDataBuffer);
+        glBufferData(target, mDrawDataSize * mDrawsPerBatch, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(target, 0, size, mDrawData.data() + mDrawDataSize * first);
+        glBindBuffer(target, 0);
+        glBindBufferRange(target, mDrawDataBinding, mDrawDataBuffer, 0, size);
+    }
+
+    void HwMultiDraw::Reset() {
+        mArraysCommands.clear();
+        mElementsCommands.clear();
+        mDrawsCount = 0;
+    }
+
+    void HwMultiDraw::SubmitIndirect(size_t first, size_t count) {
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, mCommandBuffer);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DrawElementsIndirectCommand) * mMaxDraws, nullptr, GL_STREAM_DRAW);
+
+        // Draw ids index data of the batch
+        if (IsIndexed()) {
+            for (size_t i = first; i < first + count; i++) {
+                mElementsCommands[i].baseInstance = (GLuint) (i - first);
+            }
+
+            glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(DrawElementsIndirectCommand) * count, mElementsCommands.data() + first);
+            glMultiDrawElementsIndirect(mTopology, GL_UNSIGNED_INT, nullptr, (GLsizei) count, 0);
+        }
+        else {
+            for (size_t i = first; i < first + count; i++) {
+                mArraysCommands[i].baseInstance = (GLuint) (i - first);
+            }
+
+            glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(DrawArraysIndirectCommand) * count, mArraysCommands.data() + first);
+            glMultiDrawArraysIndirect(mTopology, nullptr, (GLsizei) count, 0);
+        }
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+    void HwMultiDraw::SubmitFallback(size_t first, size_t count) {
+        // No base instance support: draw id attribute array is disabled, so pass id as constant attribute value
+        for (size_t i = first; i < first + count; i++) {
+            glVertexAttribI1ui(mDrawIdLocation, (GLuint) (i - first));
+
+            if (IsIndexed()) {
+                auto& cmd = mElementsCommands[i];
+                glDrawElementsInstancedBaseVertex(
+                    mTopology,
+                    cmd.count,
+                    GL_UNSIGNED_INT,
+                    (void *) (sizeof(GLuint) * cmd.firstIndex),
+                    cmd.instanceCount,
+                    cmd.baseVertex
+                );
+            }
+            else {
+                auto& cmd = mArraysCommands[i];
+                glDrawArraysInstanced(mTopology, cmd.first, cmd.count, cmd.instanceCount);
+            }
+        }
+    }
+
+}
@@ -0,0 +1,165 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_MULTI_DRAW_HPP
+#define X11HELLOWORLD_MULTI_DRAW_HPP
+
+#include <GL/glew.h>
+#include <x11hw/geometry.hpp>
+#include <vector>
+
+namespace x11hw {
+
+    /**
+     * Packs many meshes of the same vertex layout into shared vertex/index buffers
+     * and submits all queued draws with single glMultiDraw*Indirect call.
+     *
+     * Each draw gets its index through per-instance attribute (drawIdLocation),
+     * which may be used in the shader to fetch per-draw data from the buffer bound
+     * at drawDataBinding (SSBO if supported, UBO otherwise).
+     * UBO is limited by GL_MAX_UNIFORM_BLOCK_SIZE, so draws are submitted in batches of
+     * GetMaxDrawsPerBatch() and draw index is relative to the batch (size UBO array by it).
+     * If indirect drawing (with base instance) is not supported, draws are issued one by one.
+     */
+    class HwMultiDraw {
+    public:
+        struct DrawArraysIndirectCommand {
+            GLuint count;
+            GLuint instanceCount;
+            GLuint first;
+            GLuint baseInstance;
+        };
+
+        struct DrawElementsIndirectCommand {
+            GLuint count;
+            GLuint instanceCount;
+            GLuint firstIndex;
+            GLint baseVertex;
+            GLuint baseInstance;
+        };
+
+        struct InitParams {
+            size_t maxVertices = 0;
+            size_t maxIndices = 0;
+            size_t maxDraws = 0;
+            size_t drawDataSize = 0;
+            size_t stride = 0;
+            GLenum topology = 0;
+            GLuint drawIdLocation = 0;
+            GLuint drawDataBinding = 0;
+            /** Use shader storage buffer for per-draw data if supported (uniform buffer otherwise) */
+            bool storageBuffer = true;
+            std::vector<HwGeometry::Attribute> attributes;
+        };
+
+        explicit HwMultiDraw(const InitParams& params);
+        HwMultiDraw(const HwMultiDraw&) = delete;
+        HwMultiDraw(HwMultiDraw&&) = delete;
+        ~HwMultiDraw();
+
+        /**
+         * Append mesh data to the shared buffers
+         * @param vertexData Vertex data (verticesCount * stride bytes)
+         * @param verticesCount Number of vertices
+         * @param indices Indices relative to mesh first vertex (null for non-indexed)
+         * @param indicesCount Number of indices
+         * @return Mesh id to use in AddDraw
+         */
+        size_t AddMesh(const void *vertexData, size_t verticesCount, const GLuint *indices = nullptr, size_t indicesCount = 0);
+
+        /**
+         * Queue mesh draw for next submission
+         * @param mesh Mesh id returned by AddMesh
+         * @param instancesCount Number of instances to draw
+         * @param drawData Per-draw data (drawDataSize bytes), may be null
+         */
+        void AddDraw(size_t mesh, GLuint instancesCount = 1, const void *drawData = nullptr);
+
+        /** Issue all queued draws and clear the queue */
+        void Submit();
+
+        /** Clear queued draws without submission */
+        void Reset();
+
+        /** @return True if draws are submitted with single indirect call */
+        bool IsIndirectSupported() const { return mIndirectSupported; }
+
+        /** @return True if per-draw data is bound as shader storage buffer */
+        bool IsStorageBufferSupported() const { return mStorageSupported; }
+
+        /** @return Max draws of one submission batch (size of per-draw data array in the shader) */
+        size_t GetMaxDrawsPerBatch() const { return mDrawsPerBatch; }
+
+        /** @return Number of queued draws */
+        size_t GetDrawsCount() const { return mDrawsCount; }
+
+    private:
+        struct Mesh {
+            GLuint firstVertex;
+            GLuint verticesCount;
+            GLuint firstIndex;
+            GLuint indicesCount;
+        };
+
+        bool IsIndexed() const { return mMaxIndices > 0; }
+        void UploadDrawData(size_t first, size_t count);
+        void SubmitIndirect(size_t first, size_t count);
+        void SubmitFallback(size_t first, size_t count);
+
+        // Draw id attribute is fetched as (instance / divisor + baseInstance),
+        // so huge divisor gives the same id for every instance of the draw
+        static const GLuint DRAW_ID_DIVISOR = 1u << 30u;
+
+        std::vector<Mesh> mMeshes;
+        std::vector<DrawArraysIndirectCommand> mArraysCommands;
+        std::vector<DrawElementsIndirectCommand> mElementsCommands;
+        std::vector<unsigned char> mDrawData;
+
+        size_t mMaxVertices = 0;
+        size_t mMaxIndices = 0;
+        size_t mMaxDraws = 0;
+        size_t mDrawDataSize = 0;
+        size_t mStride = 0;
+        size_t mVerticesCount = 0;
+        size_t mIndicesCount = 0;
+        size_t mDrawsCount = 0;
+        size_t mDrawsPerBatch = 0;
+        GLenum mTopology = 0;
+        GLuint mDrawIdLocation = 0;
+        GLuint mDrawDataBinding = 0;
+
+        bool mIndirectSupported = false;
+        bool mStorageSupported = false;
+
+        GLuint mVAO = 0;
+        GLuint mVBO = 0;
+        GLuint mIBO = 0;
+        GLuint mDrawIdBuffer = 0;
+        GLuint mCommandBuffer = 0;
+        GLuint mDrawDataBuffer = 0;
+    };
+
+}
+
+#endif //X11HELLOWORLD_MULTI_DRAW_HPP
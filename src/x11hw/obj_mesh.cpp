@@ -0,0 +1,192 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/obj_mesh.hpp>
+#include <stdexcept>
+#include <unordered_map>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace x11hw {
+
+    // Resolve 1-based (or negative, relative to the end) OBJ index
+    static bool ResolveIndex(long index, size_t count, size_t &resolved) {
+        if (index > 0 && (size_t) index <= count) {
+            resolved = (size_t) index - 1;
+            return true;
+        }
+        if (index < 0 && (size_t) -index <= count) {
+            resolved = count - (size_t) -index;
+            return true;
+        }
+        return false;
+    }
+
+    // Read the whole line (no length limit, long face records are valid OBJ) as null-terminated string
+    static bool ReadLine(std::FILE *file, std::vector<char> &line) {
+        char chunk[1024];
+        line.clear();
+
+        while (std::fgets(chunk, sizeof(chunk), file)) {
+            size_t length = std::strlen(chunk);
+            line.insert(line.end(), chunk, chunk + length);
+
+            if (length > 0 && chunk[length - 1] == '\n') {
+                break;
+            }
+        }
+
+        if (line.empty()) {
+            return false;
+        }
+
+        line.push_back('\0');
+        return true;
+    }
+
+    HwObjMesh::HwObjMesh(const std::string &path) {
+        std::FILE *file = std::fopen(path.c_str(), "rb");
+
+        if (!file) {
+            throw std::runtime_error("Failed to open OBJ file " + path);
+        }
+
+        std::vector<float> positions;
+        std::vector<float> normals;
+        std::unordered_map<uint64_t, uint32_t> vertices;
+        std::vector<uint32_t> polygon;
+        std::vector<char> line;
+        size_t lineNumber = 0;
+
+        auto fail = [&](const char *message) {
+            std::fclose(file);
+            throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": " + message);
+        };
+
+        while (ReadLine(file, line)) {
+            lineNumber += 1;
+            char *cursor = line.data();
+
+            if (cursor[0] == 'v' && cursor[1] == ' ') {
+                cursor += 2;
+                for (int i = 0; i < 3; i++) {
+                    positions.push_back(std::strtof(cursor, &cursor));
+                }
+            }
+            else if (cursor[0] == 'v' && cursor[1] == 'n' && cursor[2] == ' ') {
+                cursor += 3;
+                for (int i = 0; i < 3; i++) {
+                    normals.push_back(std::strtof(cursor, &cursor));
+                }
+            }
+            else if (cursor[0] == 'f' && cursor[1] == ' ') {
+                cursor += 2;
+                polygon.clear();
+
+                // Each corner is v, v/vt, v//vn or v/vt/vn
+                while (true) {
+                    char *end;
+                    long position = std::strtol(cursor, &end, 10);
+
+                    if (end == cursor) {
+                        break;
+                    }
+
+                    long normal = 0;
+                    cursor = end;
+
+                    if (*cursor == '/') {
+                        cursor += 1;
+                        std::strtol(cursor, &end, 10);
+                        cursor = end;
+
+                        if (*cursor == '/') {
+                            cursor += 1;
+                            normal = std::strtol(cursor, &end, 10);
+                            cursor = end;
+                        }
+                    }
+
+                    size_t positionIndex = 0;
+                    size_t normalIndex = 0;
+
+                    if (!ResolveIndex(position, positions.size() / 3, positionIndex)) {
+                        fail("Position index is out of range");
+                    }
+                    if (normal != 0 && !ResolveIndex(normal, normals.size() / 3, normalIndex)) {
+                        fail("Normal index is out of range");
+                    }
+
+                    // Corners with the same position and normal share vertex
+                    uint64_t key = ((uint64_t) positionIndex << 32) | (normal != 0 ? (uint64_t) normalIndex + 1 : 0);
+                    auto found = vertices.find(key);
+
+                    if (found == vertices.end()) {
+                        auto vertex = (uint32_t) (mVertices.size() / 6);
+                        found = vertices.emplace(key, vertex).first;
+
+                        mVertices.insert(mVertices.end(), &positions[positionIndex * 3], &positions[positionIndex * 3] + 3);
+
+                        if (normal != 0) {
+                            mVertices.insert(mVertices.end(), &normals[normalIndex * 3], &normals[normalIndex * 3] + 3);
+                        }
+                        else {
+                            mVertices.insert(mVertices.end(), 3, 0.0f);
+                        }
+                    }
+
+                    polygon.push_back(found->second);
+                }
+
+                for (size_t i = 2; i < polygon.size(); i++) {
+                    mIndices.push_back(polygon[0]);
+                    mIndices.push_back(polygon[i - 1]);
+                    mIndices.push_back(polygon[i]);
+                }
+            }
+        }
+
+        std::fclose(file);
+    }
+
+    std::vector<HwGeometry::Attribute> HwObjMesh::GetAttributes() {
+        return {
+            {0, 3, GL_FLOAT, false},
+            {3 * sizeof(float), 3, GL_FLOAT, false}
+        };
+    }
+
+    HwMeshFile::Source HwObjMesh::GetSource() const {
+        HwMeshFile::Source source;
+        source.stride = STRIDE;
+        source.attributes = GetAttributes();
+        source.vertices = mVertices.data();
+        source.verticesCount = GetVerticesCount();
+        source.indices = mIndices.data();
+        source.indicesCount = mIndices.size();
+        return source;
+    }
+
+}
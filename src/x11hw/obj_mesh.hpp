@@ -0,0 +1,68 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_OBJ_MESH_HPP
+#define X11HELLOWORLD_OBJ_MESH_HPP
+
+#include <x11hw/geometry.hpp>
+#include <x11hw/mesh_file.hpp>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace x11hw {
+
+    /**
+     * Triangle mesh parsed from Wavefront OBJ text (v, vn and f records, polygons are
+     * triangulated as fans). Vertices are position (3 floats) and normal (3 floats),
+     * shared by position/normal pair. It is the parse-based source for the mesh converter.
+     */
+    class HwObjMesh {
+    public:
+        static const size_t STRIDE = 6 * sizeof(float);
+
+        /**
+         * Load and parse file
+         * @param path File path
+         */
+        explicit HwObjMesh(const std::string &path);
+
+        /** @return Vertex attributes (position at location 0, normal at location 1) */
+        static std::vector<HwGeometry::Attribute> GetAttributes();
+
+        /** @return Mesh as source of the binary mesh file */
+        HwMeshFile::Source GetSource() const;
+
+        const std::vector<float> &GetVertices() const { return mVertices; }
+        const std::vector<uint32_t> &GetIndices() const { return mIndices; }
+        size_t GetVerticesCount() const { return mVertices.size() / 6; }
+
+    private:
+        std::vector<float> mVertices;
+        std::vector<uint32_t> mIndices;
+    };
+
+}
+
+#endif //X11HELLOWORLD_OBJ_MESH_HPP
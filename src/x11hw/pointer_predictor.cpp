@@ -0,0 +1,203 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/pointer_predictor.hpp>
+#include <glm/geometric.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace x11hw {
+
+    HwPointerPredictor::HwPointerPredictor(const InitParams &params) {
+        mMinCutoff = params.minCutoff;
+        mBeta = params.beta;
+        mDerivativeCutoff = params.derivativeCutoff;
+        mAccelerationWeight = params.accelerationWeight;
+        mMaxHorizon = params.maxHorizon;
+        mIdleTimeout = params.idleTimeout;
+    }
+
+    float HwPointerPredictor::GetAlpha(float cutoff, float dt) {
+        auto tau = 1.0f / (2.0f * 3.14159265f * cutoff);
+        return 1.0f / (1.0f + tau / dt);
+    }
+
+    void HwPointerPredictor::AddSample(clock::time_point time, glm::vec2 position) {
+        // Predictions, which target time has passed, are compared with the path between samples
+        while (mPendingCount > 0) {
+            auto& prediction = mPending[mPendingFirst];
+
+            if (prediction.target > time) {
+                break;
+            }
+
+            glm::vec2 actual = position;
+
+            if (mSamplesCount > 0 && time > mLastTime && prediction.target > mLastTime) {
+                auto t = std::chrono::duration<float>(prediction.target - mLastTime).count() /
+                         std::chrono::duration<float>(time - mLastTime).count();
+                actual = mLastSample + (position - mLastSample) * t;
+            }
+            else if (mSamplesCount > 0) {
+                actual = mLastSample;
+            }
+
+            Evaluate(prediction, actual);
+            mPendingFirst = (mPendingFirst + 1) % MAX_PENDING;
+            mPendingCount -= 1;
+        }
+
+        mTotalSamples += 1;
+
+        auto dt = std::chrono::duration<float>(time - mLastTime).count();
+
+        // Several samples with the same timestamp (events coalesced by the server) keep the motion,
+        // the filter takes the latest position with the next sample
+        if (mSamplesCount > 0 && time == mLastTime) {
+            mLastSample = position;
+            return;
+        }
+
+        // Motion after a pause (or out of order sample) starts from rest
+        if (mSamplesCount == 0 || dt < 0.0f || time - mLastTime > mIdleTimeout) {
+            if (mSamplesCount == 0 || dt > 0.0f) {
+                mPosition = position;
+                mVelocity = glm::vec2(0.0f);
+                mAcceleration = glm::vec2(0.0f);
+                mLastTime = time;
+            }
+
+            mLastSample = position;
+            mSamplesCount = 1;
+            return;
+        }
+
+        // 1€ filter: velocity is filtered first, its magnitude drives position cutoff
+        auto rawVelocity = (position - mPosition) / dt;
+        auto derivativeAlpha = GetAlpha(mDerivativeCutoff, dt);
+        auto velocity = mVelocity + (rawVelocity - mVelocity) * derivativeAlpha;
+
+        auto cutoff = mMinCutoff + mBeta * glm::length(velocity);
+        mPosition = mPosition + (position - mPosition) * GetAlpha(cutoff, dt);
+
+        if (mSamplesCount > 1) {
+            auto rawAcceleration = (velocity - mVelocity) / dt;
+            mAcceleration = mAcceleration + (rawAcceleration - mAcceleration) * derivativeAlpha;
+        }
+
+        mVelocity = velocity;
+        mLastSample = position;
+        mLastTime = time;
+        mSamplesCount += 1;
+    }
+
+    void HwPointerPredictor::Reset() {
+        mSamplesCount = 0;
+        mVelocity = glm::vec2(0.0f);
+        mAcceleration = glm::vec2(0.0f);
+
+        // Path to compare pending predictions with is broken
+        mPendingCount = 0;
+    }
+
+    glm::vec2 HwPointerPredictor::Predict(clock::time_point now, clock::time_point target) {
+        if (mSamplesCount == 0) {
+            return mLastSample;
+        }
+
+        bool stopped = now - mLastTime > mIdleTimeout;
+
+        // Pending predictions, which target pointer did not reach moving, compare with rest position
+        while (stopped && mPendingCount > 0 && mPending[mPendingFirst].target <= now) {
+            Evaluate(mPending[mPendingFirst], mLastSample);
+            mPendingFirst = (mPendingFirst + 1) % MAX_PENDING;
+            mPendingCount -= 1;
+        }
+
+        glm::vec2 predicted = mLastSample;
+
+        if (mSamplesCount > 1 && !stopped) {
+            auto horizon = std::min(std::max(target - mLastTime, clock::duration::zero()), mMaxHorizon);
+            auto t = std::chrono::duration<float>(horizon).count();
+            predicted = mPosition + mVelocity * t + mAcceleration * (0.5f * mAccelerationWeight * t * t);
+        }
+
+        mPredictions += 1;
+
+        // Oldest prediction is dropped if the ring is full (pointer has not moved for a while)
+        if (mPendingCount == MAX_PENDING) {
+            mPendingFirst = (mPendingFirst + 1) % MAX_PENDING;
+            mPendingCount -= 1;
+        }
+
+        Prediction prediction;
+        prediction.target = target;
+        prediction.predicted = predicted;
+        prediction.unpredicted = mLastSample;
+
+        mPending[(mPendingFirst + mPendingCount) % MAX_PENDING] = prediction;
+        mPendingCount += 1;
+
+        return predicted;
+    }
+
+    void HwPointerPredictor::Evaluate(const Prediction &prediction, glm::vec2 actual) {
+        auto error = (double) glm::length(prediction.predicted - actual);
+
+        mEvaluated += 1;
+        mErrorSum += error;
+        mErrorSquaredSum += error * error;
+        mErrorMax = std::max(mErrorMax, error);
+        mUnpredictedErrorSum += (double) glm::length(prediction.unpredicted - actual);
+    }
+
+    HwPointerPredictor::Stats HwPointerPredictor::GetStats() const {
+        Stats stats;
+        stats.samples = mTotalSamples;
+        stats.predictions = mPredictions;
+        stats.evaluated = mEvaluated;
+
+        if (mEvaluated > 0) {
+            stats.meanErrorPx = mErrorSum / (double) mEvaluated;
+            stats.rmsErrorPx = std::sqrt(mErrorSquaredSum / (double) mEvaluated);
+            stats.maxErrorPx = mErrorMax;
+            stats.meanUnpredictedErrorPx = mUnpredictedErrorSum / (double) mEvaluated;
+        }
+
+        return stats;
+    }
+
+    void HwPointerPredictor::Report(std::ostream &stream, const char *label) const {
+        auto stats = GetStats();
+
+        stream << "Pointer prediction (" << label << "): samples " << stats.samples
+               << ", predictions " << stats.predictions
+               << ", evaluated " << stats.evaluated
+               << ", error mean " << stats.meanErrorPx << " px"
+               << ", rms " << stats.rmsErrorPx << " px"
+               << ", max " << stats.maxErrorPx << " px"
+               << " (without prediction mean " << stats.meanUnpredictedErrorPx << " px)" << std::endl;
+    }
+
+}
@@ -0,0 +1,156 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_POINTER_PREDICTOR_HPP
+#define X11HELLOWORLD_POINTER_PREDICTOR_HPP
+
+#include <glm/vec2.hpp>
+#include <chrono>
+#include <ostream>
+
+namespace x11hw {
+
+    /**
+     * Extrapolates pointer position to the time the frame reaches the screen.
+     * Samples are smoothed with 1€ filter (cutoff grows with speed: strong smoothing of jitter
+     * at rest, little lag in fast motion), velocity is its filtered derivative and acceleration
+     * is the low-passed derivative of velocity. Prediction is p + v t + a t^2 / 2 (acceleration
+     * term scaled by accelerationWeight), horizon t is limited by maxHorizon.
+     * X server sends no motion events while pointer rests, so after idleTimeout without samples
+     * pointer is considered stopped and the last position is returned.
+     *
+     * Error metric: predictions are kept until the pointer passes their target time, then compared
+     * with the actual position (interpolated between samples) and with the position the frame would
+     * show without prediction (the last sample).
+     */
+    class HwPointerPredictor {
+    public:
+        typedef std::chrono::steady_clock clock;
+
+        struct InitParams {
+            /** Cutoff frequency of position filter at rest (Hz) */
+            float minCutoff = 1.0f;
+            /** Growth of cutoff frequency with speed (Hz per pixel/s) */
+            float beta = 0.05f;
+            /** Cutoff frequency of velocity and acceleration filters (Hz) */
+            float derivativeCutoff = 20.0f;
+            /** Scale of acceleration term (0 - linear extrapolation) */
+            float accelerationWeight = 0.5f;
+            /** Max time to extrapolate past the last sample */
+            std::chrono::microseconds maxHorizon{50000};
+            /** Time without samples after which pointer is considered stopped */
+            std::chrono::microseconds idleTimeout{40000};
+
+            InitParams() {}
+        };
+
+        struct Stats {
+            size_t samples = 0;
+            size_t predictions = 0;
+            size_t evaluated = 0;
+            double meanErrorPx = 0.0;
+            double rmsErrorPx = 0.0;
+            double maxErrorPx = 0.0;
+            /** Error of the last sample position (what is shown without prediction) */
+            double meanUnpredictedErrorPx = 0.0;
+        };
+
+        explicit HwPointerPredictor(const InitParams &params = InitParams());
+        HwPointerPredictor(const HwPointerPredictor&) = delete;
+        HwPointerPredictor(HwPointerPredictor&&) = delete;
+
+        /**
+         * Add pointer sample
+         * @param time Time the sample was generated (event time)
+         * @param position Pointer position
+         */
+        void AddSample(clock::time_point time, glm::vec2 position);
+
+        /** Forget motion history (call when pointer jumps, for instance on button press) */
+        void Reset();
+
+        /**
+         * Predict pointer position and keep prediction for the error metric
+         * @param now Current time (pointer is stopped if there were no samples for idleTimeout)
+         * @param target Time the frame is expected to be presented
+         * @return Predicted position (last sample if there are no samples to extrapolate)
+         */
+        glm::vec2 Predict(clock::time_point now, clock::time_point target);
+
+        /** @return Filtered velocity in pixels per second */
+        glm::vec2 GetVelocity() const { return mVelocity; }
+
+        /** @return True if there is at least one sample */
+        bool HasSamples() const { return mSamplesCount > 0; }
+
+        /** @return Error of predictions evaluated so far */
+        Stats GetStats() const;
+
+        /** Print statistics */
+        void Report(std::ostream &stream, const char *label) const;
+
+    private:
+        struct Prediction {
+            clock::time_point target;
+            glm::vec2 predicted;
+            glm::vec2 unpredicted;
+        };
+
+        static float GetAlpha(float cutoff, float dt);
+        void Evaluate(const Prediction &prediction, glm::vec2 actual);
+
+    private:
+        static const size_t MAX_PENDING = 16;
+
+        float mMinCutoff;
+        float mBeta;
+        float mDerivativeCutoff;
+        float mAccelerationWeight;
+        clock::duration mMaxHorizon;
+        clock::duration mIdleTimeout;
+
+        clock::time_point mLastTime{};
+        glm::vec2 mLastSample{};
+        glm::vec2 mPosition{};
+        glm::vec2 mVelocity{};
+        glm::vec2 mAcceleration{};
+        size_t mSamplesCount = 0;
+
+        // Fixed ring of predictions waiting for their target time
+        Prediction mPending[MAX_PENDING] = {};
+        size_t mPendingFirst = 0;
+        size_t mPendingCount = 0;
+
+        size_t mTotalSamples = 0;
+        size_t mPredictions = 0;
+        size_t mEvaluated = 0;
+        double mErrorSum = 0.0;
+        double mErrorSquaredSum = 0.0;
+        double mErrorMax = 0.0;
+        double mUnpredictedErrorSum = 0.0;
+    };
+
+}
+
+#endif //X11HELLOWORLD_POINTER_PREDICTOR_HPP
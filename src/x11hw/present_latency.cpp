@@ -0,0 +1,216 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/present_latency.hpp>
+#include <x11hw/window.hpp>
+#include <algorithm>
+
+namespace x11hw {
+
+    HwPresentLatency::HwPresentLatency(const InitParams &params) : mWindow(params.window) {
+        mSamplesMs.reserve(MAX_SAMPLES);
+
+        HwWindow::SwapInfo info;
+        mPresentTime = mWindow && mWindow->QuerySwapInfo(info);
+    }
+
+    HwPresentLatency::~HwPresentLatency() {
+        DropPending();
+    }
+
+    void HwPresentLatency::EndFrame(clock::time_point inputTime) {
+        Poll();
+
+        if (mPendingCount == MAX_PENDING) {
+            return;
+        }
+
+        Frame frame{};
+        frame.inputTime = inputTime;
+        frame.submitTime = clock::now();
+
+        if (mPresentTime) {
+            frame.swap = mWindow->GetSwapCount();
+        }
+        else {
+            frame.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+            // Flush, so the fence is not stuck in the command buffer until the next frame
+            glFlush();
+        }
+
+        mPending[(mPendingFirst + mPendingCount) % MAX_PENDING] = frame;
+        mPendingCount += 1;
+    }
+
+    void HwPresentLatency::Poll() {
+        auto now = clock::now();
+
+        if (mPendingCount == 0) {
+            return;
+        }
+
+        if (mPresentTime && !PollPresent(now)) {
+            // Present time does not match the frames: frames in flight have no fences, so are not measured
+            DropPending();
+            mPresentTime = false;
+        }
+
+        if (!mPresentTime) {
+            PollFences(now);
+        }
+    }
+
+    bool HwPresentLatency::PollPresent(clock::time_point now) {
+        HwWindow::SwapInfo info;
+
+        if (!mWindow->QuerySwapInfo(info)) {
+            return false;
+        }
+
+        while (mPendingCount > 0) {
+            auto& frame = mPending[mPendingFirst];
+
+            if (frame.swap > info.completedSwaps) {
+                // Swaps are not counted in the same way (not all go through the window), or clocks differ
+                if (now - frame.submitTime > std::chrono::seconds(1)) {
+                    return false;
+                }
+
+                mLastPendingPoll = now;
+                return true;
+            }
+
+            // Present time is between submit and this poll, otherwise clocks differ (slack is for
+            // rounding of UST and for swaps completed before submit time is taken right after them)
+            static const auto CLOCK_SLACK = std::chrono::milliseconds(100);
+
+            if (info.presentTime + CLOCK_SLACK < frame.submitTime || info.presentTime > now + CLOCK_SLACK) {
+                return false;
+            }
+
+            if (frame.swap == info.completedSwaps) {
+                AddSample(frame, info.presentTime, info.presentTime);
+            }
+            else {
+                // Later swap completed too: this one is done between the last pending poll and that swap
+                AddSample(frame, std::max(frame.submitTime, mLastPendingPoll), info.presentTime);
+            }
+
+            mPendingFirst = (mPendingFirst + 1) % MAX_PENDING;
+            mPendingCount -= 1;
+        }
+
+        return true;
+    }
+
+    void HwPresentLatency::PollFences(clock::time_point now) {
+        while (mPendingCount > 0) {
+            auto& frame = mPending[mPendingFirst];
+
+            // Fences are signalled in order, so stop on first not signalled
+            GLenum status = glClientWaitSync(frame.fence, 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+                mLastPendingPoll = now;
+                return;
+            }
+
+            // Fence signalled after it was submitted and after the last poll, which saw it pending
+            AddSample(frame, std::max(frame.submitTime, mLastPendingPoll), now);
+
+            glDeleteSync(frame.fence);
+            mPendingFirst = (mPendingFirst + 1) % MAX_PENDING;
+            mPendingCount -= 1;
+        }
+    }
+
+    void HwPresentLatency::AddSample(const Frame &frame, clock::time_point earliest, clock::time_point latest) {
+        auto completed = earliest + (latest - earliest) / 2;
+        auto latencyMs = std::chrono::duration<double, std::milli>(completed - frame.inputTime).count();
+
+        mUncertaintySumMs += std::chrono::duration<double, std::milli>(latest - earliest).count() * 0.5;
+        mMeasuredFrames += 1;
+        mSmoothedMs = mSmoothedMs > 0.0 ? mSmoothedMs * 0.9 + latencyMs * 0.1 : latencyMs;
+
+        if (mSamplesMs.size() < MAX_SAMPLES) {
+            mSamplesMs.push_back(latencyMs);
+        }
+        else {
+            mSamplesMs[mNextSample] = latencyMs;
+            mNextSample = (mNextSample + 1) % MAX_SAMPLES;
+        }
+    }
+
+    void HwPresentLatency::DropPending() {
+        for (size_t i = 0; i < mPendingCount; i++) {
+            auto& frame = mPending[(mPendingFirst + i) % MAX_PENDING];
+
+            if (frame.fence) {
+                glDeleteSync(frame.fence);
+            }
+        }
+
+        mPendingFirst = 0;
+        mPendingCount = 0;
+    }
+
+    HwPresentLatency::Stats HwPresentLatency::GetStats() const {
+        Stats stats;
+        stats.presentTime = mPresentTime;
+
+        if (mSamplesMs.empty()) {
+            return stats;
+        }
+
+        auto sorted = mSamplesMs;
+        std::sort(sorted.begin(), sorted.end());
+
+        double sum = 0.0;
+        for (auto sample: sorted) {
+            sum += sample;
+        }
+
+        stats.frames = sorted.size();
+        stats.averageMs = sum / (double) sorted.size();
+        stats.medianMs = sorted[sorted.size() / 2];
+        stats.p99Ms = sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)];
+        stats.maxMs = sorted.back();
+        stats.uncertaintyMs = mUncertaintySumMs / (double) mMeasuredFrames;
+
+        return stats;
+    }
+
+    void HwPresentLatency::Report(std::ostream &stream, const char *label) const {
+        auto stats = GetStats();
+
+        stream << "Present latency (" << label << ", to " << (stats.presentTime ? "present" : "GPU completion") << "): "
+               << stats.frames << " frames, "
+               << "avg " << stats.averageMs << " ms, "
+               << "median " << stats.medianMs << " ms, "
+               << "p99 " << stats.p99Ms << " ms, "
+               << "max " << stats.maxMs << " ms "
+               << "(+/- " << stats.uncertaintyMs << " ms)" << std::endl;
+    }
+
+}
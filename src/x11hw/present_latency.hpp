@@ -0,0 +1,139 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_PRESENT_LATENCY_HPP
+#define X11HELLOWORLD_PRESENT_LATENCY_HPP
+
+#include <GL/glew.h>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+namespace x11hw {
+
+    /**
+     * Measures latency from input sampling to presentation of the frame.
+     * With a window and GLX_OML_sync_control present time is the UST of swap completion,
+     * reported by the presentation engine (X Present complete notify for Mesa), so it includes
+     * compositor and flip: bypassed compositor and fullscreen flips are visible in the numbers.
+     * Otherwise (or if UST is not in the steady clock domain) a fence is inserted right after swap,
+     * so it signals once the frame (and the swap blit/flip queued by the driver) is executed on
+     * GPU, and time spent by compositor after that is not visible to the app.
+     * Both are polled without blocking, so the completion is only known to lie between the poll,
+     * which still saw the frame pending, and the poll, which saw it done (or UST of a later swap,
+     * if several swaps completed between polls): the sample is the middle of that interval, its
+     * half is the uncertainty (zero for present time of exactly that swap).
+     * Call Poll more often than once per frame (for instance, before and after frame pacing wait)
+     * to make the interval shorter.
+     */
+    class HwPresentLatency {
+    public:
+        typedef std::chrono::steady_clock clock;
+
+        struct Stats {
+            size_t frames = 0;
+            double averageMs = 0.0;
+            double medianMs = 0.0;
+            double p99Ms = 0.0;
+            double maxMs = 0.0;
+            /** Average half of the interval between polls, which bracket the signal */
+            double uncertaintyMs = 0.0;
+            /** Latency is measured to present time (false - to GPU completion) */
+            bool presentTime = false;
+        };
+
+        struct InitParams {
+            /** Window to query present time of (nullptr - GPU completion only), must outlive the object */
+            class HwWindow *window = nullptr;
+
+            InitParams() {}
+        };
+
+        /** Max number of kept samples (older are discarded) */
+        static const size_t MAX_SAMPLES = 1 << 16;
+
+        /** Max number of frames with not signalled fences (newer are not measured) */
+        static const size_t MAX_PENDING = 16;
+
+        explicit HwPresentLatency(const InitParams &params = InitParams());
+        HwPresentLatency(const HwPresentLatency&) = delete;
+        HwPresentLatency(HwPresentLatency&&) = delete;
+        ~HwPresentLatency();
+
+        /**
+         * Mark presented frame (call right after swap buffers)
+         * @param inputTime Time, when input of the frame was sampled (simulation time of the rendered state)
+         */
+        void EndFrame(clock::time_point inputTime);
+
+        /** Collect completed frames (does not block, present time query is a round trip to the server) */
+        void Poll();
+
+        /** @return Exponentially smoothed latency of the recent frames (0 if nothing is measured yet) */
+        double GetSmoothedMs() const { return mSmoothedMs; }
+
+        /** @return True if latency is measured to present time */
+        bool IsPresentTime() const { return mPresentTime; }
+
+        /** @return Latency statistics of the collected frames */
+        Stats GetStats() const;
+
+        /** Print statistics */
+        void Report(std::ostream &stream, const char *label) const;
+
+    private:
+        struct Frame {
+            GLsync fence;
+            int64_t swap;
+            clock::time_point inputTime;
+            clock::time_point submitTime;
+        };
+
+        bool PollPresent(clock::time_point now);
+        void PollFences(clock::time_point now);
+        void AddSample(const Frame &frame, clock::time_point earliest, clock::time_point latest);
+        void DropPending();
+
+        // Fixed ring, so measurement does not allocate per frame
+        Frame mPending[MAX_PENDING] = {};
+        size_t mPendingFirst = 0;
+        size_t mPendingCount = 0;
+
+        std::vector<double> mSamplesMs;
+        size_t mNextSample = 0;
+
+        // Last poll, which found a pending fence (signal of the next fences is later)
+        clock::time_point mLastPendingPoll;
+        double mUncertaintySumMs = 0.0;
+        double mSmoothedMs = 0.0;
+        size_t mMeasuredFrames = 0;
+
+        class HwWindow *mWindow = nullptr;
+        bool mPresentTime = false;
+    };
+
+}
+
+#endif //X11HELLOWORLD_PRESENT_LATENCY_HPP
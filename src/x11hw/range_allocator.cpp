@@ -0,0 +1,275 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/range_allocator.hpp>
+#include <algorithm>
+#include <cassert>
+
+namespace x11hw {
+
+    static uint32_t FindLastSet(uint32_t value) {
+        assert(value);
+        return 31u - (uint32_t) __builtin_clz(value);
+    }
+
+    static uint32_t FindFirstSet(uint32_t value) {
+        assert(value);
+        return (uint32_t) __builtin_ctz(value);
+    }
+
+    HwRangeAllocator::HwRangeAllocator(uint32_t capacity) {
+        assert(capacity > 0);
+        mCapacity = capacity;
+        Reset();
+    }
+
+    void HwRangeAllocator::Reset() {
+        mNodes.clear();
+        mUnusedNodes.clear();
+        mFlBitmap = 0;
+        mUsed = 0;
+        mAllocationsCount = 0;
+
+        for (uint32_t fl = 0; fl < FL_COUNT; fl++) {
+            mSlBitmaps[fl] = 0;
+            for (uint32_t sl = 0; sl < SL_COUNT; sl++) {
+                mFreeLists[fl][sl] = INVALID;
+            }
+        }
+
+        uint32_t node = NewNode();
+        mNodes[node].offset = 0;
+        mNodes[node].size = mCapacity;
+        InsertFree(node);
+    }
+
+    void HwRangeAllocator::Mapping(uint32_t size, uint32_t &fl, uint32_t &sl) {
+        if (size < SL_COUNT) {
+            fl = 0;
+            sl = size;
+        }
+        else {
+            uint32_t log2 = FindLastSet(size);
+            fl = log2 - SL_LOG2 + 1;
+            sl = (size >> (log2 - SL_LOG2)) - SL_COUNT;
+        }
+    }
+
+    void HwRangeAllocator::MappingSearch(uint32_t size, uint32_t &fl, uint32_t &sl) {
+        // Round up to the next bin, so any block of found bin fits the request
+        if (size >= SL_COUNT) {
+            uint32_t round = (1u << (FindLastSet(size) - SL_LOG2)) - 1;
+            size = size > 0xffffffffu - round ? 0xffffffffu : size + round;
+        }
+
+        Mapping(size, fl, sl);
+    }
+
+    uint32_t HwRangeAllocator::NewNode() {
+        if (!mUnusedNodes.empty()) {
+            uint32_t node = mUnusedNodes.back();
+            mUnusedNodes.pop_back();
+            mNodes[node] = Node();
+            return node;
+        }
+
+        mNodes.emplace_back();
+        return (uint32_t) mNodes.size() - 1;
+    }
+
+    void HwRangeAllocator::DeleteNode(uint32_t node) {
+        mUnusedNodes.push_back(node);
+    }
+
+    void HwRangeAllocator::InsertFree(uint32_t node) {
+        uint32_t fl, sl;
+        Mapping(mNodes[node].size, fl, sl);
+
+        uint32_t head = mFreeLists[fl][sl];
+        mNodes[node].free = true;
+        mNodes[node].prevFree = INVALID;
+        mNodes[node].nextFree = head;
+
+        if (head != INVALID) {
+            mNodes[head].prevFree = node;
+        }
+
+        mFreeLists[fl][sl] = node;
+        mFlBitmap |= 1u << fl;
+        mSlBitmaps[fl] |= 1u << sl;
+    }
+
+    void HwRangeAllocator::RemoveFree(uint32_t node) {
+        auto& n = mNodes[node];
+
+        if (n.prevFree != INVALID) {
+            mNodes[n.prevFree].nextFree = n.nextFree;
+        }
+        else {
+            uint32_t fl, sl;
+            Mapping(n.size, fl, sl);
+            mFreeLists[fl][sl] = n.nextFree;
+
+            if (n.nextFree == INVALID) {
+                mSlBitmaps[fl] &= ~(1u << sl);
+                if (!mSlBitmaps[fl]) {
+                    mFlBitmap &= ~(1u << fl);
+                }
+            }
+        }
+
+        if (n.nextFree != INVALID) {
+            mNodes[n.nextFree].prevFree = n.prevFree;
+        }
+
+        n.free = false;
+        n.prevFree = INVALID;
+        n.nextFree = INVALID;
+    }
+
+    uint32_t HwRangeAllocator::FindFree(uint32_t size) const {
+        uint32_t fl, sl;
+        MappingSearch(size, fl, sl);
+
+        if (fl < FL_COUNT) {
+            uint32_t slMap = mSlBitmaps[fl] & (~0u << sl);
+
+            if (!slMap) {
+                uint32_t flMap = fl + 1 < 32 ? mFlBitmap & (~0u << (fl + 1)) : 0;
+                fl = flMap ? FindFirstSet(flMap) : FL_COUNT;
+                slMap = flMap ? mSlBitmaps[fl] : 0;
+            }
+
+            if (slMap) {
+                return mFreeLists[fl][FindFirstSet(slMap)];
+            }
+        }
+
+        // Bins above are empty, but block of the request own bin may still fit (exact fit included)
+        Mapping(size, fl, sl);
+
+        for (uint32_t node = mFreeLists[fl][sl]; node != INVALID; node = mNodes[node].nextFree) {
+            if (mNodes[node].size >= size) {
+                return node;
+            }
+        }
+
+        return INVALID;
+    }
+
+    uint32_t HwRangeAllocator::Allocate(uint32_t size, uint32_t &offset) {
+        assert(size > 0);
+
+        uint32_t node = FindFree(size);
+        if (node == INVALID) {
+            return INVALID;
+        }
+
+        RemoveFree(node);
+
+        // Split remainder into new free block right after allocated range
+        if (mNodes[node].size > size) {
+            uint32_t rest = NewNode();
+            auto& n = mNodes[node];
+            auto& r = mNodes[rest];
+
+            r.offset = n.offset + size;
+            r.size = n.size - size;
+            r.prevPhys = node;
+            r.nextPhys = n.nextPhys;
+
+            if (n.nextPhys != INVALID) {
+                mNodes[n.nextPhys].prevPhys = rest;
+            }
+
+            n.size = size;
+            n.nextPhys = rest;
+            InsertFree(rest);
+        }
+
+        mUsed += size;
+        mAllocationsCount += 1;
+        offset = mNodes[node].offset;
+
+        return node;
+    }
+
+    void HwRangeAllocator::Release(uint32_t allocation) {
+        assert(allocation < mNodes.size());
+        assert(!mNodes[allocation].free);
+
+        uint32_t node = allocation;
+        mUsed -= mNodes[node].size;
+        mAllocationsCount -= 1;
+
+        uint32_t prev = mNodes[node].prevPhys;
+        if (prev != INVALID && mNodes[prev].free) {
+            RemoveFree(prev);
+            mNodes[prev].size += mNodes[node].size;
+            mNodes[prev].nextPhys = mNodes[node].nextPhys;
+
+            if (mNodes[node].nextPhys != INVALID) {
+                mNodes[mNodes[node].nextPhys].prevPhys = prev;
+            }
+
+            DeleteNode(node);
+            node = prev;
+        }
+
+        uint32_t next = mNodes[node].nextPhys;
+        if (next != INVALID && mNodes[next].free) {
+            RemoveFree(next);
+            mNodes[node].size += mNodes[next].size;
+            mNodes[node].nextPhys = mNodes[next].nextPhys;
+
+            if (mNodes[next].nextPhys != INVALID) {
+                mNodes[mNodes[next].nextPhys].prevPhys = node;
+            }
+
+            DeleteNode(next);
+        }
+
+        InsertFree(node);
+    }
+
+    HwRangeAllocator::Stats HwRangeAllocator::GetStats() const {
+        Stats stats;
+        stats.capacity = mCapacity;
+        stats.used = mUsed;
+        stats.free = mCapacity - mUsed;
+        stats.allocationsCount = mAllocationsCount;
+
+        for (uint32_t fl = 0; fl < FL_COUNT; fl++) {
+            for (uint32_t sl = 0; sl < SL_COUNT; sl++) {
+                for (uint32_t node = mFreeLists[fl][sl]; node != INVALID; node = mNodes[node].nextFree) {
+                    stats.largestFree = std::max(stats.largestFree, mNodes[node].size);
+                    stats.freeBlocksCount += 1;
+                }
+            }
+        }
+
+        return stats;
+    }
+
+}
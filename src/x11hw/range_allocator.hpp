@@ -0,0 +1,113 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_RANGE_ALLOCATOR_HPP
+#define X11HELLOWORLD_RANGE_ALLOCATOR_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace x11hw {
+
+    /**
+     * Two-level segregated fit (TLSF) allocator of ranges in abstract units.
+     * Does not own any memory: it only hands out offsets inside [0, capacity),
+     * so it can be used to sub-allocate GPU buffers. Allocation and release are O(1).
+     */
+    class HwRangeAllocator {
+    public:
+        static const uint32_t INVALID = 0xffffffffu;
+
+        struct Stats {
+            uint32_t capacity = 0;
+            uint32_t used = 0;
+            uint32_t free = 0;
+            uint32_t largestFree = 0;
+            uint32_t allocationsCount = 0;
+            uint32_t freeBlocksCount = 0;
+        };
+
+        explicit HwRangeAllocator(uint32_t capacity);
+
+        /**
+         * Allocate range
+         * @param size Range size in units
+         * @param[out] offset Range offset in units
+         * @return Allocation id or INVALID if there is no free block to fit
+         */
+        uint32_t Allocate(uint32_t size, uint32_t &offset);
+
+        /**
+         * Release range and merge it with free neighbours
+         * @param allocation Allocation id returned by Allocate
+         */
+        void Release(uint32_t allocation);
+
+        /** Release all allocations */
+        void Reset();
+
+        /** @return Allocator usage statistics */
+        Stats GetStats() const;
+
+        /** @return Total range capacity in units */
+        uint32_t GetCapacity() const { return mCapacity; }
+
+    private:
+        static const uint32_t SL_LOG2 = 3;
+        static const uint32_t SL_COUNT = 1u << SL_LOG2;
+        static const uint32_t FL_COUNT = 32 - SL_LOG2 + 1;
+
+        struct Node {
+            uint32_t offset = 0;
+            uint32_t size = 0;
+            uint32_t prevPhys = INVALID;
+            uint32_t nextPhys = INVALID;
+            uint32_t prevFree = INVALID;
+            uint32_t nextFree = INVALID;
+            bool free = false;
+        };
+
+        static void Mapping(uint32_t size, uint32_t &fl, uint32_t &sl);
+        static void MappingSearch(uint32_t size, uint32_t &fl, uint32_t &sl);
+
+        uint32_t NewNode();
+        void DeleteNode(uint32_t node);
+        void InsertFree(uint32_t node);
+        void RemoveFree(uint32_t node);
+        uint32_t FindFree(uint32_t size) const;
+
+        std::vector<Node> mNodes;
+        std::vector<uint32_t> mUnusedNodes;
+        uint32_t mFreeLists[FL_COUNT][SL_COUNT];
+        uint32_t mFlBitmap = 0;
+        uint32_t mSlBitmaps[FL_COUNT];
+        uint32_t mCapacity = 0;
+        uint32_t mUsed = 0;
+        uint32_t mAllocationsCount = 0;
+    };
+
+}
+
+#endif //X11HELLOWORLD_RANGE_ALLOCATOR_HPP
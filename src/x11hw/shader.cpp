@@ -23,6 +23,8 @@
 ////////////////////////////////////////////////////////////////////////////////////
 
 #include <x11hw/shader.hpp>
+#include <x11hw/deletion_queue.hpp>
+#include <x11hw/texture.hpp>
 #include <stdexcept>
 #include <iostream>
 #include <vector>
@@ -142,6 +144,22 @@ namespace x11hw {
         glUniformMatrix4fv(location, 1, GL_FALSE, (const float*) &mat[0][0]); // GLM matrices already in col-major order
     }
 
+    void HwShader::SetTexture(const std::string &name, const HwTexture &texture, GLuint unit) const {
+        int location = GetLocation(name);
+        texture.Bind(unit);
+        glUniform1i(location, (GLint) unit);
+    }
+
+    void HwShader::SetUniformBlockBinding(const std::string &name, GLuint binding) const {
+        GLuint index = glGetUniformBlockIndex(mProgram, name.c_str());
+
+        if (index == GL_INVALID_INDEX) {
+            throw std::runtime_error("Failed to find uniform block index");
+        }
+
+        glUniformBlockBinding(mProgram, index, binding);
+    }
+
     int HwShader::GetLocation(const std::string &name) const {
         int location = glGetUniformLocation(mProgram, name.c_str());
 
@@ -153,12 +171,26 @@ namespace x11hw {
     }
 
     void HwShader::ReleaseInternal() {
+        // Program may still be used by submitted draws, so delete it once GPU is done
+        auto deletionQueue = HwDeletionQueue::GetCurrent();
+
         if (mProgram) {
-            glDeleteProgram(mProgram);
+            if (deletionQueue) {
+                deletionQueue->RetireProgram(mProgram);
+            }
+            else {
+                glDeleteProgram(mProgram);
+            }
         }
 
         for (size_t i = 0; i < mStagesCount; i++) {
-            glDeleteShader(mStages[i]);
+            if (deletionQueue && mStages[i]) {
+                deletionQueue->RetireShader(mStages[i]);
+            }
+            else {
+                glDeleteShader(mStages[i]);
+            }
+
             mStages[i] = 0;
         }
 
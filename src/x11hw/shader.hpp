@@ -64,6 +64,21 @@ namespace x11hw {
          */
         void SetMatrix4(const std::string &name, const glm::mat4 &mat) const;
 
+        /**
+         * Bind texture to texture unit and set shader sampler to use this unit
+         * @param name Sampler variable name in the shader
+         * @param texture Texture to bind
+         * @param unit Texture unit
+         */
+        void SetTexture(const std::string &name, const class HwTexture &texture, GLuint unit) const;
+
+        /**
+         * Set binding point of the shader uniform block
+         * @param name Uniform block name in the shader
+         * @param binding Uniform buffer binding point
+         */
+        void SetUniformBlockBinding(const std::string &name, GLuint binding) const;
+
     private:
         int GetLocation(const std::string &name) const;
         void ReleaseInternal();
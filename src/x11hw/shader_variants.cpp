@@ -0,0 +1,153 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/shader_variants.hpp>
+#include <x11hw/error.hpp>
+#include <algorithm>
+#include <stdexcept>
+#include <sstream>
+
+namespace x11hw {
+
+    static const char FEATURE_PRAGMA[] = "#pragma feature";
+
+    HwShaderVariants::HwShaderVariants(std::string vertexCode, std::string fragmentCode)
+        : mVertexCode(std::move(vertexCode)),
+          mFragmentCode(std::move(fragmentCode)) {
+        DeclareFeatures(mVertexCode);
+        DeclareFeatures(mFragmentCode);
+    }
+
+    HwShader &HwShaderVariants::Get(uint64_t mask) {
+        auto found = mVariants.find(mask);
+
+        if (found != mVariants.end()) {
+            return *found->second;
+        }
+
+        CHECK_MSG(mFeatures.size() == MAX_FEATURES || (mask >> mFeatures.size()) == 0, "Shader variant uses undeclared feature");
+
+        std::vector<std::string> defines;
+
+        for (size_t i = 0; i < mFeatures.size(); i++) {
+            if (mask & (uint64_t(1) << i)) {
+                defines.push_back(mFeatures[i]);
+            }
+        }
+
+        auto vertexCode = InjectDefines(mVertexCode, defines);
+        auto fragmentCode = InjectDefines(mFragmentCode, defines);
+
+        std::unique_ptr<HwShader> shader{new HwShader(vertexCode.c_str(), fragmentCode.c_str())};
+        auto& result = *shader;
+        mVariants.emplace(mask, std::move(shader));
+
+        return result;
+    }
+
+    void HwShaderVariants::ValidateFeature(size_t index, const std::string &name) const {
+        auto found = GetFeatureIndex(name);
+
+        if (found != (int) index) {
+            throw std::runtime_error("Shader feature " + name + " has index " + std::to_string(found) +
+                                     " in sources, but " + std::to_string(index) + " in enum");
+        }
+    }
+
+    int HwShaderVariants::GetFeatureIndex(const std::string &name) const {
+        for (size_t i = 0; i < mFeatures.size(); i++) {
+            if (mFeatures[i] == name) {
+                return (int) i;
+            }
+        }
+
+        return -1;
+    }
+
+    std::string HwShaderVariants::InjectDefines(const std::string &code, const std::vector<std::string> &defines) {
+        if (defines.empty()) {
+            return code;
+        }
+
+        std::string injected;
+
+        for (auto& define: defines) {
+            injected += "#define " + define + " 1\n";
+        }
+
+        // #version must stay the first directive
+        auto version = code.find("#version");
+        size_t position = 0;
+        int versionNumber = 110;
+
+        if (version != std::string::npos) {
+            auto lineEnd = code.find('\n', version);
+            position = lineEnd != std::string::npos ? lineEnd + 1 : code.size();
+
+            if (lineEnd == std::string::npos) {
+                injected = "\n" + injected;
+            }
+
+            std::istringstream(code.substr(version + sizeof("#version") - 1, position - version)) >> versionNumber;
+        }
+
+        // Compile errors must point to the lines of the original source. Line after the directive
+        // is "#line N" since GLSL 3.30 and "#line N + 1" before (GLSL ES 3.00 and 1.00 alike)
+        auto nextLine = (long) std::count(code.begin(), code.begin() + (std::ptrdiff_t) position, '\n') + 1;
+        bool lineIsNext = versionNumber >= 330 || versionNumber == 300;
+        injected += "#line " + std::to_string(lineIsNext ? nextLine : nextLine - 1) + "\n";
+
+        std::string result;
+        result.reserve(code.size() + injected.size());
+        result.append(code, 0, position);
+        result.append(injected);
+        result.append(code, position, std::string::npos);
+
+        return result;
+    }
+
+    void HwShaderVariants::DeclareFeatures(std::string &code) {
+        size_t position = 0;
+
+        while ((position = code.find(FEATURE_PRAGMA, position)) != std::string::npos) {
+            auto lineEnd = code.find('\n', position);
+            auto end = lineEnd != std::string::npos ? lineEnd : code.size();
+
+            std::istringstream line(code.substr(position + sizeof(FEATURE_PRAGMA) - 1, end - position - sizeof(FEATURE_PRAGMA) + 1));
+            std::string name;
+            line >> name;
+
+            CHECK_MSG(!name.empty(), "Shader feature declaration without name");
+
+            if (GetFeatureIndex(name) < 0) {
+                CHECK_MSG(mFeatures.size() < MAX_FEATURES, "Too many shader features");
+                mFeatures.push_back(name);
+            }
+
+            // Pragma is removed, but the line is kept, so compile errors point to the same lines
+            code.replace(position, end - position, "");
+        }
+    }
+
+}
@@ -0,0 +1,158 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_SHADER_VARIANTS_HPP
+#define X11HELLOWORLD_SHADER_VARIANTS_HPP
+
+#include <x11hw/shader.hpp>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace x11hw {
+
+    /**
+     * Set of enabled shader features.
+     * Feature is enum, which values are indices of the features in the shader declaration order.
+     * @tparam Feature Enum of the features
+     */
+    template<typename Feature>
+    class HwShaderFeatures {
+    public:
+        constexpr HwShaderFeatures() : mMask(0) {}
+        constexpr explicit HwShaderFeatures(uint64_t mask) : mMask(mask) {}
+
+        /** @return Features with feature enabled */
+        constexpr HwShaderFeatures With(Feature feature) const { return HwShaderFeatures(mMask | GetBit(feature)); }
+
+        /** @return Features with feature enabled if condition is true */
+        constexpr HwShaderFeatures With(Feature feature, bool condition) const { return condition ? With(feature) : *this; }
+
+        /** @return True if feature is enabled */
+        constexpr bool Has(Feature feature) const { return (mMask & GetBit(feature)) != 0; }
+
+        /** @return Variant bitmask */
+        constexpr uint64_t GetMask() const { return mMask; }
+
+        static constexpr uint64_t GetBit(Feature feature) { return uint64_t(1) << (uint64_t) feature; }
+
+    private:
+        uint64_t mMask;
+    };
+
+    /**
+     * Compile-time variant key: HwShaderKey<Feature, Feature::A, Feature::B>::MASK
+     * @tparam Feature Enum of the features
+     * @tparam Features Enabled features
+     */
+    template<typename Feature, Feature... Features>
+    struct HwShaderKey;
+
+    template<typename Feature>
+    struct HwShaderKey<Feature> {
+        static constexpr uint64_t MASK = 0;
+    };
+
+    template<typename Feature, Feature First, Feature... Rest>
+    struct HwShaderKey<Feature, First, Rest...> {
+        static constexpr uint64_t MASK = HwShaderFeatures<Feature>::GetBit(First) | HwShaderKey<Feature, Rest...>::MASK;
+    };
+
+    /**
+     * Family of shader programs built from single source pair.
+     *
+     * Sources declare features with "#pragma feature NAME" lines, feature index is
+     * the order of the first declaration (vertex stage first). Variant is selected by bitmask of
+     * the enabled features: "#define NAME 1" is injected after "#version" line for each of them,
+     * so shaders use #ifdef instead of runtime branches.
+     * Variants are compiled on first request and memoized by the bitmask.
+     * Not thread-safe: use from single thread with current context at a time.
+     */
+    class HwShaderVariants {
+    public:
+        static const size_t MAX_FEATURES = 64;
+
+        HwShaderVariants(std::string vertexCode, std::string fragmentCode);
+        HwShaderVariants(const HwShaderVariants&) = delete;
+        HwShaderVariants(HwShaderVariants&&) = delete;
+
+        /**
+         * Get variant, compile it if requested for the first time
+         * @param mask Bitmask of enabled features
+         * @return Shader variant
+         */
+        HwShader &Get(uint64_t mask);
+
+        /** Get variant, compile it if requested for the first time */
+        template<typename Feature>
+        HwShader &Get(HwShaderFeatures<Feature> features) { return Get(features.GetMask()); }
+
+        /**
+         * Check that enum values are indices of the features in the sources (throws otherwise)
+         * @param features Enum values with the names of the features
+         */
+        template<typename Feature>
+        void ValidateFeatures(std::initializer_list<std::pair<Feature, const char *>> features) const {
+            for (auto& feature: features) {
+                ValidateFeature((size_t) feature.first, feature.second);
+            }
+        }
+
+        /** Check that feature with name is declared with index (throws otherwise) */
+        void ValidateFeature(size_t index, const std::string &name) const;
+
+        /** @return Index of the feature or -1 if not declared */
+        int GetFeatureIndex(const std::string &name) const;
+
+        /** @return Declared features in index order */
+        const std::vector<std::string> &GetFeatures() const { return mFeatures; }
+
+        /** @return Number of compiled variants */
+        size_t GetCompiledCount() const { return mVariants.size(); }
+
+        /**
+         * Make variant source: defines are inserted right after "#version" directive,
+         * followed by "#line", so lines of compile errors match the original source
+         * @param code Shader source
+         * @param defines Names to define
+         * @return Source to compile
+         */
+        static std::string InjectDefines(const std::string &code, const std::vector<std::string> &defines);
+
+    private:
+        void DeclareFeatures(std::string &code);
+
+        std::string mVertexCode;
+        std::string mFragmentCode;
+        std::vector<std::string> mFeatures;
+        std::unordered_map<uint64_t, std::unique_ptr<HwShader>> mVariants;
+    };
+
+}
+
+#endif //X11HELLOWORLD_SHADER_VARIANTS_HPP
@@ -0,0 +1,485 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/stress_scene.hpp>
+#include <x11hw/window.hpp>
+#include <x11hw/window_manager.hpp>
+#include <x11hw/shader.hpp>
+#include <x11hw/geometry.hpp>
+#include <x11hw/buffer_pool.hpp>
+#include <x11hw/multi_draw.hpp>
+#include <x11hw/job_system.hpp>
+#include <x11hw/error.hpp>
+#include <GL/glew.h>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <cmath>
+#include <glm/vec4.hpp>
+
+namespace x11hw {
+
+    static const char *GetStressVertexCode() {
+        return R"(
+            #version 330 core
+            layout (location = 0) in vec2 position;
+
+            uniform vec2 offset;
+            uniform float scale;
+
+            void main() {
+                gl_Position = vec4(position * scale + offset, 0.0f, 1.0f);
+            }
+        )";
+    }
+
+    static const char *GetStressFragmentCode() {
+        return R"(
+            #version 330 core
+            layout (location = 0) out vec4 outColor;
+
+            uniform vec2 offset;
+
+            void main() {
+                outColor = vec4(abs(offset), 0.5f, 1.0f);
+            }
+        )";
+    }
+
+    // Per draw offsets are read by draw id (vec4 per draw, std140 array stride)
+    static std::string GetMultiDrawVertexCode(bool storageBuffer, size_t drawsPerBatch) {
+        std::string header = storageBuffer ?
+            "#version 430 core\n"
+            "layout (std430, binding = 0) readonly buffer DrawData { vec4 offsets[]; };\n" :
+            "#version 330 core\n"
+            "layout (std140) uniform DrawData { vec4 offsets[" + std::to_string(drawsPerBatch) + "]; };\n";
+
+        return header + R"(
+            layout (location = 0) in vec2 position;
+            layout (location = 1) in uint drawId;
+
+            flat out vec2 fsOffset;
+
+            uniform float scale;
+
+            void main() {
+                fsOffset = offsets[drawId].xy;
+                gl_Position = vec4(position * scale + fsOffset, 0.0f, 1.0f);
+            }
+        )";
+    }
+
+    static const char *GetMultiDrawFragmentCode() {
+        return R"(
+            #version 330 core
+            layout (location = 0) out vec4 outColor;
+
+            flat in vec2 fsOffset;
+
+            void main() {
+                outColor = vec4(abs(fsOffset), 0.5f, 1.0f);
+            }
+        )";
+    }
+
+    static const GLuint MULTI_DRAW_ID_LOCATION = 1;
+    static const GLuint MULTI_DRAW_DATA_BINDING = 0;
+
+    static double GetMs(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+        return std::chrono::duration<double, std::milli>(to - from).count();
+    }
+
+    // Small triangles spread over [-1, 1], shifted by phase (so updates really change data)
+    static void FillTriangles(float *vertices, size_t trianglesCount, size_t begin, size_t end, float phase) {
+        for (size_t t = begin; t < end; t++) {
+            auto angle = (float) t * 2.399963f + phase;
+            auto radius = std::sqrt((float) t / (float) trianglesCount);
+            float x = radius * std::cos(angle);
+            float y = radius * std::sin(angle);
+            float size = 0.05f;
+
+            float *v = &vertices[t * 6];
+            v[0] = x;        v[1] = y + size;
+            v[2] = x - size; v[3] = y - size;
+            v[4] = x + size; v[5] = y - size;
+        }
+    }
+
+    static void FillVertices(std::vector<float> &vertices, size_t count, float phase) {
+        vertices.resize(count * 2);
+        FillTriangles(vertices.data(), count / 3, 0, count / 3, phase);
+    }
+
+    HwStressScene::HwStressScene(const InitParams &params) : mParams(params) {
+        CHECK_MSG(mParams.windows > 0, "Stress scene needs at least one window");
+        CHECK_MSG(mParams.geometries > 0, "Stress scene needs at least one geometry");
+
+        mParams.verticesPerGeometry = std::max<size_t>(3, (mParams.verticesPerGeometry + 2) / 3 * 3);
+        mParams.updatesPerFrame = std::min(mParams.updatesPerFrame, mParams.geometries);
+
+        // Meshes of multi draw live in its own static buffers
+        if (mParams.multiDraw) {
+            mParams.updatesPerFrame = 0;
+            mParams.reallocationsPerFrame = 0;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        mManager = std::make_shared<HwWindowManager>(mParams.contextConfig);
+
+        for (size_t i = 0; i < mParams.windows; i++) {
+            auto window = mManager->CreateWindow("STRESS_WINDOW_" + std::to_string(i),
+                                                 "Stress " + std::to_string(i), mParams.windowSize);
+            window->MakeContextCurrent();
+            window->SetSwapInterval(0);
+            mWindows.push_back(window);
+        }
+
+        glewExperimental = GL_TRUE;
+
+        if (glewInit() != GLEW_OK) {
+            throw std::runtime_error("Failed to init GLEW");
+        }
+
+        FillVertices(mVertexData, mParams.verticesPerGeometry, 0.0f);
+        FillVertices(mLargeVertexData, mParams.verticesPerGeometry * 2, 0.0f);
+
+        // Windows share the context, so objects are created once
+        mShader.reset(new HwShader(GetStressVertexCode(), GetStressFragmentCode()));
+
+        if (mParams.pooled) {
+            mPool.reset(new HwBufferPool());
+        }
+
+        mGeometries.resize(mParams.geometries);
+
+        for (size_t i = 0; i < mParams.geometries; i++) {
+            CreateGeometry(i, false);
+        }
+
+        if (mParams.multiDraw) {
+            CreateMultiDraw();
+        }
+
+        mDrawOffsets.resize(mParams.drawsPerFrame);
+        mUpdateData.resize(mParams.updatesPerFrame * mParams.verticesPerGeometry * 2);
+
+        glFinish();
+        mSetupMs = GetMs(start, std::chrono::steady_clock::now());
+    }
+
+    HwStressScene::~HwStressScene() {
+        // GL objects go before the context of the manager, pooled geometries before the pool
+        mGeometries.clear();
+        mPool.reset();
+        mMultiDraw.reset();
+        mMultiDrawShader.reset();
+        mShader.reset();
+    }
+
+    HwStressScene::Result HwStressScene::Run() {
+        Result sums;
+
+        for (size_t i = 0; i < mParams.warmupFrames; i++) {
+            RenderFrame(sums);
+        }
+
+        sums = Result();
+        glFinish();
+
+        auto start = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < mParams.frames; i++) {
+            RenderFrame(sums);
+        }
+
+        glFinish();
+        auto seconds = GetMs(start, std::chrono::steady_clock::now()) * 1e-3;
+        auto frames = (double) std::max<size_t>(1, mParams.frames);
+
+        Result result;
+        result.setupMs = mSetupMs;
+        result.frameMs = seconds * 1e3 / frames;
+        result.pollMs = sums.pollMs / frames;
+        result.updateMs = sums.updateMs / frames;
+        result.submitMs = sums.submitMs / frames;
+        result.swapMs = sums.swapMs / frames;
+        result.drawsPerSecond = (double) mParams.drawsPerFrame * frames / seconds;
+        result.verticesPerSecond = result.drawsPerSecond * (double) mParams.verticesPerGeometry;
+        result.updateBytesPerSecond = (double) (mParams.updatesPerFrame * mParams.verticesPerGeometry * sizeof(float) * 2) * frames / seconds;
+
+        if (mPool) {
+            auto stats = mPool->GetStats();
+            result.poolPages = stats.pagesCount;
+            result.poolUtilization = stats.utilization;
+            result.poolFragmentation = stats.fragmentation;
+        }
+
+        result.indirect = mMultiDraw && mMultiDraw->IsIndirectSupported();
+
+        return result;
+    }
+
+    void HwStressScene::CreateMultiDraw() {
+        // Shader for storage buffer needs GLSL 4.30, otherwise per draw data goes through UBO batches
+        bool storageBuffer = GLEW_VERSION_4_3 != 0;
+        size_t maxDraws = std::max<size_t>(1, (mParams.drawsPerFrame + mWindows.size() - 1) / mWindows.size());
+
+        HwMultiDraw::InitParams multiDrawParams;
+        multiDrawParams.maxVertices = mParams.geometries * mParams.verticesPerGeometry;
+        multiDrawParams.maxDraws = maxDraws;
+        multiDrawParams.drawDataSize = sizeof(float) * 4;
+        multiDrawParams.stride = sizeof(float) * 2;
+        multiDrawParams.topology = GL_TRIANGLES;
+        multiDrawParams.drawIdLocation = MULTI_DRAW_ID_LOCATION;
+        multiDrawParams.drawDataBinding = MULTI_DRAW_DATA_BINDING;
+        multiDrawParams.storageBuffer = storageBuffer;
+        multiDrawParams.attributes = {{0, 2, GL_FLOAT, false}};
+
+        mMultiDraw.reset(new HwMultiDraw(multiDrawParams));
+
+        for (size_t i = 0; i < mParams.geometries; i++) {
+            mMultiDraw->AddMesh(mVertexData.data(), mParams.verticesPerGeometry);
+        }
+
+        auto vertexCode = GetMultiDrawVertexCode(mMultiDraw->IsStorageBufferSupported(), mMultiDraw->GetMaxDrawsPerBatch());
+        mMultiDrawShader.reset(new HwShader(vertexCode.c_str(), GetMultiDrawFragmentCode()));
+
+        if (!mMultiDraw->IsStorageBufferSupported()) {
+            mMultiDrawShader->SetUniformBlockBinding("DrawData", MULTI_DRAW_DATA_BINDING);
+        }
+    }
+
+    void HwStressScene::CreateGeometry(size_t index, bool large) {
+        auto& data = large ? mLargeVertexData : mVertexData;
+
+        HwGeometry::InitParams geometryParams;
+        geometryParams.topology = GL_TRIANGLES;
+        geometryParams.stride = sizeof(float) * 2;
+        geometryParams.verticesCount = data.size() / 2;
+        geometryParams.attributes = {{0, 2, GL_FLOAT, false}};
+
+        // Release first, so pooled geometry may take its own hole back
+        mGeometries[index].reset();
+        mGeometries[index].reset(mPool ? new HwGeometry(*mPool, geometryParams) : new HwGeometry(geometryParams));
+        mGeometries[index]->Update(0, data.size() * sizeof(float), data.data());
+    }
+
+    void HwStressScene::RenderFrame(Result &sums) {
+        auto t0 = std::chrono::steady_clock::now();
+        mManager->PollEvents();
+
+        // Updates rotate over geometries, data is animated on the job system and uploaded here
+        auto t1 = std::chrono::steady_clock::now();
+        PrepareUpdates();
+
+        auto updateFloats = mParams.verticesPerGeometry * 2;
+
+        for (size_t i = 0; i < mParams.updatesPerFrame; i++) {
+            mGeometries[mNextUpdate]->Update(0, updateFloats * sizeof(float), mUpdateData.data() + i * updateFloats);
+            mNextUpdate = (mNextUpdate + 1) % mGeometries.size();
+        }
+
+        // Every third reallocation is 2x sized, so released holes do not fit the next requests exactly
+        for (size_t i = 0; i < mParams.reallocationsPerFrame; i++) {
+            CreateGeometry(mNextReallocation, mReallocations % 3 == 0);
+            mNextReallocation = (mNextReallocation + 7) % mGeometries.size();
+            mReallocations += 1;
+        }
+
+        auto t2 = std::chrono::steady_clock::now();
+        size_t drawn = 0;
+        double swapMs = 0.0;
+
+        PrepareDrawList();
+
+        for (size_t w = 0; w < mWindows.size(); w++) {
+            auto window = mWindows[w];
+            auto draws = mParams.drawsPerFrame / mWindows.size() + (w < mParams.drawsPerFrame % mWindows.size() ? 1 : 0);
+            auto framebufferSize = window->GetFramebufferSize();
+
+            window->MakeContextCurrent();
+            glViewport(0, 0, framebufferSize.x, framebufferSize.y);
+            glClear(GL_COLOR_BUFFER_BIT);
+
+            if (mMultiDraw) {
+                SubmitMultiDraw(drawn, draws);
+            }
+            else {
+                SubmitDraws(drawn, draws);
+            }
+
+            drawn += draws;
+
+            auto swapStart = std::chrono::steady_clock::now();
+            window->SwapBuffers();
+            swapMs += GetMs(swapStart, std::chrono::steady_clock::now());
+        }
+
+        auto t3 = std::chrono::steady_clock::now();
+
+        sums.pollMs += GetMs(t0, t1);
+        sums.updateMs += GetMs(t1, t2);
+        sums.submitMs += GetMs(t2, t3) - swapMs;
+        sums.swapMs += swapMs;
+        mFrameIndex += 1;
+    }
+
+    void HwStressScene::SubmitDraws(size_t first, size_t count) {
+        static const std::string OFFSET = "offset";
+        static const std::string SCALE = "scale";
+
+        mShader->Bind();
+        mShader->SetFloat(SCALE, 0.1f);
+
+        for (size_t d = first; d < first + count; d++) {
+            mShader->SetVec2(OFFSET, mDrawOffsets[d]);
+            mGeometries[d % mGeometries.size()]->Draw();
+        }
+
+        mShader->Unbind();
+    }
+
+    void HwStressScene::SubmitMultiDraw(size_t first, size_t count) {
+        static const std::string SCALE = "scale";
+
+        mMultiDrawShader->Bind();
+        mMultiDrawShader->SetFloat(SCALE, 0.1f);
+
+        for (size_t d = first; d < first + count; d++) {
+            glm::vec4 drawData{mDrawOffsets[d].x, mDrawOffsets[d].y, 0.0f, 0.0f};
+            mMultiDraw->AddDraw(d % mGeometries.size(), 1, &drawData);
+        }
+
+        mMultiDraw->Submit();
+        mMultiDrawShader->Unbind();
+    }
+
+    void HwStressScene::PrepareDrawList() {
+        // Draws of each window are spread along a wave, which moves every frame
+        auto phase = (float) mFrameIndex * 0.05f;
+        auto windows = mWindows.size();
+        auto drawsPerFrame = mParams.drawsPerFrame;
+        auto offsets = mDrawOffsets.data();
+
+        auto transform = [offsets, phase, windows, drawsPerFrame](size_t begin, size_t end) {
+            // Draws are split between windows in order, first windows take the remainder (see RenderFrame)
+            size_t base = drawsPerFrame / windows;
+            size_t longDraws = (drawsPerFrame % windows) * (base + 1);
+
+            for (size_t i = begin; i < end; i++) {
+                size_t draws = i < longDraws ? base + 1 : base;
+                size_t index = i < longDraws ? i % (base + 1) : (i - longDraws) % base;
+
+                auto t = (float) index / (float) draws;
+                offsets[i] = glm::vec2(t * 1.8f - 0.9f, std::sin(t * 20.0f + phase) * 0.9f);
+            }
+        };
+
+        if (!mParams.jobSystem) {
+            transform(0, drawsPerFrame);
+            return;
+        }
+
+        // Few microseconds of work per job, well above the cost of job submission and steal
+        static const size_t GRAIN = 256;
+
+        HwJobCounter counter;
+        mParams.jobSystem->ParallelFor(counter, drawsPerFrame, GRAIN, transform);
+        mParams.jobSystem->Wait(counter);
+    }
+
+    void HwStressScene::PrepareUpdates() {
+        // Each updated geometry gets its own phase, so every upload carries new data
+        auto trianglesPerGeometry = mParams.verticesPerGeometry / 3;
+        auto trianglesCount = mParams.updatesPerFrame * trianglesPerGeometry;
+        if (trianglesCount == 0) {
+            return;
+        }
+
+        auto phase = (float) mFrameIndex * 0.05f;
+        auto geometriesCount = mGeometries.size();
+        auto firstGeometry = mNextUpdate;
+        auto vertices = mUpdateData.data();
+
+        auto fill = [vertices, trianglesPerGeometry, phase, geometriesCount, firstGeometry](size_t begin, size_t end) {
+            while (begin < end) {
+                size_t update = begin / trianglesPerGeometry;
+                size_t first = begin % trianglesPerGeometry;
+                size_t last = std::min(trianglesPerGeometry, first + (end - begin));
+                auto geometry = (firstGeometry + update) % geometriesCount;
+
+                FillTriangles(vertices + update * trianglesPerGeometry * 6, trianglesPerGeometry, first, last,
+                              phase + (float) geometry * 0.1f);
+                begin += last - first;
+            }
+        };
+
+        if (!mParams.jobSystem) {
+            fill(0, trianglesCount);
+            return;
+        }
+
+        // Three sin/cos pairs per triangle: tens of microseconds per job
+        static const size_t GRAIN = 1024;
+
+        HwJobCounter counter;
+        mParams.jobSystem->ParallelFor(counter, trianglesCount, GRAIN, fill);
+        mParams.jobSystem->Wait(counter);
+    }
+
+    void HwStressScene::WriteHeader(std::ostream &stream) {
+        stream << "windows,geometries,draws,vertices,updates,pooled,reallocations,multi_draw,"
+               << "setup_ms,frame_ms,fps,poll_ms,update_ms,submit_ms,swap_ms,"
+               << "draws_per_sec,mvertices_per_sec,update_mb_per_sec,"
+               << "pool_pages,pool_utilization,pool_fragmentation,indirect" << std::endl;
+    }
+
+    void HwStressScene::WriteRow(std::ostream &stream, const InitParams &params, const Result &result) {
+        stream << params.windows << ","
+               << params.geometries << ","
+               << params.drawsPerFrame << ","
+               << params.verticesPerGeometry << ","
+               << params.updatesPerFrame << ","
+               << (params.pooled ? 1 : 0) << ","
+               << params.reallocationsPerFrame << ","
+               << (params.multiDraw ? 1 : 0) << ","
+               << result.setupMs << ","
+               << result.frameMs << ","
+               << (result.frameMs > 0.0 ? 1e3 / result.frameMs : 0.0) << ","
+               << result.pollMs << ","
+               << result.updateMs << ","
+               << result.submitMs << ","
+               << result.swapMs << ","
+               << result.drawsPerSecond << ","
+               << result.verticesPerSecond * 1e-6 << ","
+               << result.updateBytesPerSecond * 1e-6 << ","
+               << result.poolPages << ","
+               << result.poolUtilization << ","
+               << result.poolFragmentation << ","
+               << (result.indirect ? 1 : 0) << std::endl;
+    }
+
+}
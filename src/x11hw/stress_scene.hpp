@@ -0,0 +1,149 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_STRESS_SCENE_HPP
+#define X11HELLOWORLD_STRESS_SCENE_HPP
+
+#include <x11hw/context_config.hpp>
+#include <glm/vec2.hpp>
+#include <memory>
+#include <ostream>
+#include <vector>
+#include <cstdint>
+
+namespace x11hw {
+
+    /**
+     * Synthetic load for scaling tests: windows created through HwWindowManager::CreateWindow,
+     * geometries drawn with one HwShader (uniform update per draw), part of geometries
+     * rewritten every frame through HwGeometry::Update. Swap interval is 0, so frame rate
+     * is bound only by the load. Each scene owns its window manager and context, so scenes
+     * of a sweep do not affect each other. Draw list (per draw offsets) and animated vertex
+     * data of updated geometries are prepared every frame, on the job system if one is given.
+     * Geometries either own their VBOs or share pages of HwBufferPool; reallocations release
+     * and recreate geometries with alternating sizes, so pool fragmentation shows up in the result. With multi draw, draws of each window are
+     * queued into HwMultiDraw and submitted with one indirect call per batch (one by one if
+     * indirect drawing is not supported) instead of uniform update and draw per geometry.
+     */
+    class HwStressScene {
+    public:
+        struct InitParams {
+            /** Windows to draw into (draws of the frame are split between them) */
+            size_t windows = 1;
+            /** Distinct geometries (draws cycle over them) */
+            size_t geometries = 16;
+            /** Draw calls per frame in total */
+            size_t drawsPerFrame = 1000;
+            /** Vertices per geometry (rounded up to triangles) */
+            size_t verticesPerGeometry = 3;
+            /** Geometries rewritten with HwGeometry::Update per frame */
+            size_t updatesPerFrame = 0;
+            /** Sub-allocate geometries from shared buffer pool instead of own VBO per geometry */
+            bool pooled = false;
+            /** Geometries released and recreated per frame (size alternates between 1x and 2x vertices) */
+            size_t reallocationsPerFrame = 0;
+            /** Submit draws through HwMultiDraw (geometries are static then: no updates and reallocations) */
+            bool multiDraw = false;
+            /** Measured frames (after warmup) */
+            size_t frames = 200;
+            size_t warmupFrames = 20;
+            glm::uvec2 windowSize{320, 240};
+            HwContextConfig contextConfig;
+            /** Job system to prepare draw list and updates on (nullptr - render thread only), must outlive the scene */
+            class HwJobSystem *jobSystem = nullptr;
+
+            InitParams() {}
+        };
+
+        /** Averages per frame, throughput per second of the whole run */
+        struct Result {
+            double setupMs = 0.0;
+            double frameMs = 0.0;
+            double pollMs = 0.0;
+            double updateMs = 0.0;
+            double submitMs = 0.0;
+            double swapMs = 0.0;
+            double drawsPerSecond = 0.0;
+            double verticesPerSecond = 0.0;
+            double updateBytesPerSecond = 0.0;
+            /** Buffer pool state at the end of the run (zero if not pooled) */
+            size_t poolPages = 0;
+            float poolUtilization = 0.0f;
+            float poolFragmentation = 0.0f;
+            /** Multi draw used indirect submission */
+            bool indirect = false;
+        };
+
+        /** Create windows, shader and geometries (setup time is a part of the result) */
+        explicit HwStressScene(const InitParams &params = InitParams());
+        HwStressScene(const HwStressScene&) = delete;
+        HwStressScene(HwStressScene&&) = delete;
+        ~HwStressScene();
+
+        /** Render warmup and measured frames as fast as possible */
+        Result Run();
+
+        /** @return Params in effect (vertices rounded up to triangles, updates limited by geometries) */
+        const InitParams &GetParams() const { return mParams; }
+
+        /** Print CSV header of WriteRow columns */
+        static void WriteHeader(std::ostream &stream);
+
+        /** Print scene params and result as CSV row */
+        static void WriteRow(std::ostream &stream, const InitParams &params, const Result &result);
+
+    private:
+        void RenderFrame(Result &sums);
+        void PrepareDrawList();
+        void PrepareUpdates();
+        void CreateGeometry(size_t index, bool large);
+        void CreateMultiDraw();
+        void SubmitDraws(size_t first, size_t count);
+        void SubmitMultiDraw(size_t first, size_t count);
+
+    private:
+        InitParams mParams;
+        std::shared_ptr<class HwWindowManager> mManager;
+        std::vector<class HwWindow*> mWindows;
+        std::unique_ptr<class HwShader> mShader;
+        std::unique_ptr<class HwBufferPool> mPool;
+        std::unique_ptr<class HwMultiDraw> mMultiDraw;
+        std::unique_ptr<class HwShader> mMultiDrawShader;
+        std::vector<std::unique_ptr<class HwGeometry>> mGeometries;
+
+        // Initial vertex data (and 2x sized data for reallocations), animated data of the frame updates
+        std::vector<float> mVertexData;
+        std::vector<float> mLargeVertexData;
+        std::vector<float> mUpdateData;
+        std::vector<glm::vec2> mDrawOffsets;
+        size_t mNextUpdate = 0;
+        size_t mNextReallocation = 0;
+        size_t mReallocations = 0;
+        size_t mFrameIndex = 0;
+        double mSetupMs = 0.0;
+    };
+
+}
+
+#endif //X11HELLOWORLD_STRESS_SCENE_HPP
@@ -0,0 +1,129 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/texture.hpp>
+#include <x11hw/deletion_queue.hpp>
+#include <algorithm>
+#include <cassert>
+
+namespace x11hw {
+
+    /** Pixel transfer format and type compatible with the given sized internal format */
+    static void GetTransferFormat(GLenum internalFormat, GLenum &format, GLenum &type) {
+        switch (internalFormat) {
+            case GL_R8:
+                format = GL_RED; type = GL_UNSIGNED_BYTE; return;
+            case GL_RG8:
+                format = GL_RG; type = GL_UNSIGNED_BYTE; return;
+            case GL_RGB8:
+            case GL_SRGB8:
+                format = GL_RGB; type = GL_UNSIGNED_BYTE; return;
+            case GL_R16F:
+            case GL_R32F:
+                format = GL_RED; type = GL_FLOAT; return;
+            case GL_RG16F:
+            case GL_RG32F:
+                format = GL_RG; type = GL_FLOAT; return;
+            case GL_RGB16F:
+            case GL_RGB32F:
+            case GL_R11F_G11F_B10F:
+                format = GL_RGB; type = GL_FLOAT; return;
+            case GL_RGBA16F:
+            case GL_RGBA32F:
+                format = GL_RGBA; type = GL_FLOAT; return;
+            case GL_R8UI:
+                format = GL_RED_INTEGER; type = GL_UNSIGNED_BYTE; return;
+            case GL_R32UI:
+                format = GL_RED_INTEGER; type = GL_UNSIGNED_INT; return;
+            case GL_RGBA8UI:
+                format = GL_RGBA_INTEGER; type = GL_UNSIGNED_BYTE; return;
+            case GL_DEPTH_COMPONENT16:
+            case GL_DEPTH_COMPONENT24:
+            case GL_DEPTH_COMPONENT32F:
+                format = GL_DEPTH_COMPONENT; type = GL_FLOAT; return;
+            case GL_DEPTH24_STENCIL8:
+                format = GL_DEPTH_STENCIL; type = GL_UNSIGNED_INT_24_8; return;
+            default:
+                format = GL_RGBA; type = GL_UNSIGNED_BYTE; return;
+        }
+    }
+
+    HwTexture::HwTexture(const InitParams &params) {
+        assert(params.size.x > 0 && params.size.y > 0);
+        assert(params.levels >= 1);
+
+        mSize = params.size;
+        GetTransferFormat(params.internalFormat, mFormat, mType);
+
+        glGenTextures(1, &mHandle);
+        glBindTexture(GL_TEXTURE_2D, mHandle);
+
+        if (GLEW_VERSION_4_2 || GLEW_ARB_texture_storage) {
+            glTexStorage2D(GL_TEXTURE_2D, params.levels, params.internalFormat, mSize.x, mSize.y);
+        }
+        else {
+            // Emulate immutable storage: allocate all levels once and never respecify
+            for (GLsizei level = 0; level < params.levels; level++) {
+                GLsizei width = std::max(1u, mSize.x >> (unsigned) level);
+                GLsizei height = std::max(1u, mSize.y >> (unsigned) level);
+                glTexImage2D(GL_TEXTURE_2D, level, params.internalFormat, width, height, 0, mFormat, mType, nullptr);
+            }
+
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, params.levels - 1);
+        }
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, params.minFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, params.magFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, params.wrap);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, params.wrap);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    HwTexture::~HwTexture() {
+        if (mHandle) {
+            if (auto deletionQueue = HwDeletionQueue::GetCurrent()) {
+                deletionQueue->RetireTexture(mHandle);
+            }
+            else {
+                glDeleteTextures(1, &mHandle);
+            }
+
+            mHandle = 0;
+        }
+    }
+
+    void HwTexture::Update(glm::uvec2 offset, glm::uvec2 size, GLenum format, GLenum type, const void *data, GLint level) const {
+        assert(offset.x + size.x <= mSize.x && offset.y + size.y <= mSize.y);
+
+        glBindTexture(GL_TEXTURE_2D, mHandle);
+        glTexSubImage2D(GL_TEXTURE_2D, level, offset.x, offset.y, size.x, size.y, format, type, data);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    void HwTexture::Bind(GLuint unit) const {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, mHandle);
+    }
+
+}
@@ -0,0 +1,85 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_TEXTURE_HPP
+#define X11HELLOWORLD_TEXTURE_HPP
+
+#include <GL/glew.h>
+#include <glm/vec2.hpp>
+
+namespace x11hw {
+
+    /** 2D texture with immutable storage (glTexStorage2D when supported) */
+    class HwTexture {
+    public:
+        struct InitParams {
+            glm::uvec2 size{};
+            GLsizei levels = 1;
+            GLenum internalFormat = GL_RGBA8;
+            GLenum minFilter = GL_LINEAR;
+            GLenum magFilter = GL_LINEAR;
+            GLenum wrap = GL_CLAMP_TO_EDGE;
+        };
+
+        explicit HwTexture(const InitParams &params);
+        HwTexture(const HwTexture&) = delete;
+        HwTexture(HwTexture&&) = delete;
+        ~HwTexture();
+
+        /**
+         * Update texture region from client memory or bound GL_PIXEL_UNPACK_BUFFER
+         * @param offset Region offset in pixels
+         * @param size Region size in pixels
+         * @param format Pixel data format
+         * @param type Pixel data type
+         * @param data Pixel data (or offset in bound unpack buffer)
+         * @param level Mip level
+         */
+        void Update(glm::uvec2 offset, glm::uvec2 size, GLenum format, GLenum type, const void *data, GLint level = 0) const;
+
+        /** Bind texture to texture unit */
+        void Bind(GLuint unit) const;
+
+        /** @return GL texture handle */
+        GLuint GetHandle() const { return mHandle; }
+
+        /** @return Texture size in pixels */
+        const glm::uvec2 &GetSize() const { return mSize; }
+
+        /** @return Pixel transfer format matching texture internal format */
+        GLenum GetFormat() const { return mFormat; }
+
+        /** @return Pixel transfer type matching texture internal format */
+        GLenum GetType() const { return mType; }
+
+    private:
+        glm::uvec2 mSize{};
+        GLenum mFormat = GL_RGBA;
+        GLenum mType = GL_UNSIGNED_BYTE;
+        GLuint mHandle = 0;
+    };
+
+}
+
+#endif //X11HELLOWORLD_TEXTURE_HPP
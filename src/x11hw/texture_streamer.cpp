@@ -0,0 +1,163 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/texture_streamer.hpp>
+#include <x11hw/texture.hpp>
+#include <x11hw/deletion_queue.hpp>
+#include <x11hw/error.hpp>
+#include <stdexcept>
+#include <cassert>
+#include <cstring>
+
+namespace x11hw {
+
+    HwTextureStreamer::HwTextureStreamer(const InitParams &params) {
+        assert(params.slotSize > 0);
+        assert(params.slotsCount >= 2);
+
+        mSlotSize = params.slotSize;
+        mSlots.resize(params.slotsCount);
+        mPersistent = (GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage) && glBufferStorage != nullptr;
+
+        size_t totalSize = mSlotSize * mSlots.size();
+
+        glGenBuffers(1, &mBuffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, mBuffer);
+
+        if (mPersistent) {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_PIXEL_UNPACK_BUFFER, totalSize, nullptr, flags);
+            mMapped = (uint8_t *) glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, totalSize, flags);
+            CHECK_MSG(mMapped, "Failed to persistently map texture streaming buffer");
+        }
+        else {
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+        }
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    HwTextureStreamer::~HwTextureStreamer() {
+        for (auto& slot: mSlots) {
+            if (slot.fence) {
+                glDeleteSync(slot.fence);
+            }
+        }
+
+        if (mPersistent) {
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, mBuffer);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+
+        if (auto deletionQueue = HwDeletionQueue::GetCurrent()) {
+            deletionQueue->RetireBuffer(mBuffer, 0, 0);
+        }
+        else {
+            glDeleteBuffers(1, &mBuffer);
+        }
+
+        mBuffer = 0;
+        mMapped = nullptr;
+    }
+
+    bool HwTextureStreamer::Upload(const HwTexture &texture, glm::uvec2 offset, glm::uvec2 size,
+                                   GLenum format, GLenum type, size_t bytesPerPixel, const void *pixels) {
+        auto start = std::chrono::steady_clock::now();
+
+        size_t bytes = size.x * size.y * bytesPerPixel;
+        CHECK_MSG(bytes <= mSlotSize, "Texture upload is larger than streaming slot");
+
+        if (mUploadedFrames == 0) {
+            mFirstUpload = start;
+        }
+
+        auto& slot = mSlots[mNextSlot];
+
+        if (slot.fence) {
+            // Region is still read by previous texture upload: drop instead of waiting
+            GLenum status = glClientWaitSync(slot.fence, 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+                mDroppedFrames += 1;
+                return false;
+            }
+
+            glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+        }
+
+        size_t slotOffset = mNextSlot * mSlotSize;
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, mBuffer);
+
+        if (mPersistent) {
+            std::memcpy(mMapped + slotOffset, pixels, bytes);
+        }
+        else {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT;
+            void *mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, slotOffset, bytes, flags);
+
+            if (!mapped) {
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                mDroppedFrames += 1;
+                return false;
+            }
+
+            std::memcpy(mapped, pixels, bytes);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+
+        // Rows are tightly packed
+        GLint previousAlignment = 4;
+        glGetIntegerv(GL_UNPACK_ALIGNMENT, &previousAlignment);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        texture.Update(offset, size, format, type, (const void *) slotOffset);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, previousAlignment);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        mNextSlot = (mNextSlot + 1) % mSlots.size();
+
+        mUploadedFrames += 1;
+        mUploadedBytes += bytes;
+        mCpuSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        return true;
+    }
+
+    HwTextureStreamer::Stats HwTextureStreamer::GetStats() const {
+        Stats stats;
+        stats.uploadedFrames = mUploadedFrames;
+        stats.droppedFrames = mDroppedFrames;
+        stats.uploadedBytes = mUploadedBytes;
+        stats.cpuSeconds = mCpuSeconds;
+        stats.persistent = mPersistent;
+
+        if (mUploadedFrames > 0) {
+            stats.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - mFirstUpload).count();
+        }
+
+        return stats;
+    }
+
+}
@@ -0,0 +1,107 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_TEXTURE_STREAMER_HPP
+#define X11HELLOWORLD_TEXTURE_STREAMER_HPP
+
+#include <GL/glew.h>
+#include <glm/vec2.hpp>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace x11hw {
+
+    /**
+     * Streams pixel data into textures through a ring of pixel unpack buffer regions.
+     * Buffer is persistently mapped when GL 4.4 / ARB_buffer_storage is available,
+     * otherwise each region is mapped unsynchronized. Each region is guarded by fence,
+     * if the next region is still in use by the GPU the frame is dropped (never blocks).
+     */
+    class HwTextureStreamer {
+    public:
+        struct InitParams {
+            size_t slotSize = 1920 * 1080 * 4;
+            size_t slotsCount = 3;
+        };
+
+        struct Stats {
+            size_t uploadedFrames = 0;
+            size_t droppedFrames = 0;
+            size_t uploadedBytes = 0;
+            double cpuSeconds = 0.0;
+            double wallSeconds = 0.0;
+            bool persistent = false;
+
+            /** @return Stream throughput (uploaded bytes over time since first upload) */
+            double GetThroughputMBps() const { return wallSeconds > 0.0 ? uploadedBytes / wallSeconds / 1e6 : 0.0; }
+
+            /** @return Throughput of the calling thread work (copy and upload commands) */
+            double GetCpuThroughputMBps() const { return cpuSeconds > 0.0 ? uploadedBytes / cpuSeconds / 1e6 : 0.0; }
+        };
+
+        explicit HwTextureStreamer(const InitParams &params);
+        HwTextureStreamer(const HwTextureStreamer&) = delete;
+        HwTextureStreamer(HwTextureStreamer&&) = delete;
+        ~HwTextureStreamer();
+
+        /**
+         * Upload pixels into texture region
+         * @param texture Target texture
+         * @param offset Region offset in pixels
+         * @param size Region size in pixels
+         * @param format Pixel data format
+         * @param type Pixel data type
+         * @param bytesPerPixel Size of single pixel in bytes
+         * @param pixels Tightly packed pixel data
+         * @return True if uploaded, false if frame is dropped because ring is busy
+         */
+        bool Upload(const class HwTexture &texture, glm::uvec2 offset, glm::uvec2 size,
+                    GLenum format, GLenum type, size_t bytesPerPixel, const void *pixels);
+
+        /** @return Streaming statistics */
+        Stats GetStats() const;
+
+    private:
+        struct Slot {
+            GLsync fence = nullptr;
+        };
+
+        std::vector<Slot> mSlots;
+        size_t mSlotSize = 0;
+        size_t mNextSlot = 0;
+        GLuint mBuffer = 0;
+        uint8_t *mMapped = nullptr;
+        bool mPersistent = false;
+
+        size_t mUploadedFrames = 0;
+        size_t mDroppedFrames = 0;
+        size_t mUploadedBytes = 0;
+        double mCpuSeconds = 0.0;
+        std::chrono::steady_clock::time_point mFirstUpload;
+    };
+
+}
+
+#endif //X11HELLOWORLD_TEXTURE_STREAMER_HPP
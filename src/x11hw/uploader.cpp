@@ -0,0 +1,154 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/uploader.hpp>
+#include <x11hw/context.hpp>
+#include <stdexcept>
+#include <iostream>
+#include <cassert>
+
+namespace x11hw {
+
+    HwUploader::HwUploader(HwContext *context) {
+        assert(context);
+
+        mContext = context;
+        mContext->CreateSharedContext();
+        mThread = std::thread([this]() { ThreadMain(); });
+    }
+
+    HwUploader::~HwUploader() {
+        {
+            std::lock_guard<std::mutex> guard(mMutex);
+            mStop = true;
+        }
+
+        mCondition.notify_all();
+        mThread.join();
+
+        // Finished but not polled tasks: results are dropped on this thread
+        for (auto& finished: mFinished) {
+            glDeleteSync(finished.fence);
+        }
+
+        mFinished.clear();
+        mContext->DestroySharedContext();
+        mContext = nullptr;
+    }
+
+    void HwUploader::Submit(Task task, Completion completion) {
+        assert(task);
+
+        {
+            std::lock_guard<std::mutex> guard(mMutex);
+            mPending.push_back({std::move(task), std::move(completion)});
+            mInFlight += 1;
+        }
+
+        mCondition.notify_one();
+    }
+
+    size_t HwUploader::Poll() {
+        size_t completed = 0;
+
+        while (true) {
+            Finished finished;
+
+            {
+                std::lock_guard<std::mutex> guard(mMutex);
+
+                if (mFinished.empty()) {
+                    break;
+                }
+
+                // Tasks are finished in order, so stop on first incomplete
+                GLenum status = glClientWaitSync(mFinished.front().fence, 0, 0);
+                if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+                    break;
+                }
+
+                finished = std::move(mFinished.front());
+                mFinished.pop_front();
+                mInFlight -= 1;
+            }
+
+            glDeleteSync(finished.fence);
+
+            if (finished.completion) {
+                finished.completion();
+            }
+
+            completed += 1;
+        }
+
+        return completed;
+    }
+
+    size_t HwUploader::GetPendingCount() const {
+        std::lock_guard<std::mutex> guard(mMutex);
+        return mInFlight;
+    }
+
+    void HwUploader::ThreadMain() {
+        mContext->MakeSharedContextCurrent();
+
+        while (true) {
+            Pending pending;
+
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mCondition.wait(lock, [this]() { return mStop || !mPending.empty(); });
+
+                if (mStop) {
+                    break;
+                }
+
+                pending = std::move(mPending.front());
+                mPending.pop_front();
+            }
+
+            bool success = true;
+
+            try {
+                pending.task();
+            }
+            catch (const std::exception &e) {
+                std::cerr << "Failed upload task: " << e.what() << std::endl;
+                success = false;
+            }
+
+            // Flush, so the fence becomes visible to the render context
+            GLsync fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            glFlush();
+
+            {
+                std::lock_guard<std::mutex> guard(mMutex);
+                mFinished.push_back({fence, success ? std::move(pending.completion) : Completion()});
+            }
+        }
+
+        mContext->ReleaseSharedContextCurrent();
+    }
+
+}
@@ -0,0 +1,100 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_UPLOADER_HPP
+#define X11HELLOWORLD_UPLOADER_HPP
+
+#include <GL/glew.h>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace x11hw {
+
+    /**
+     * Background thread with GL context of the same share group as the windows context.
+     * Used to compile shaders and fill buffers without blocking the render loop.
+     *
+     * Only shareable objects (buffers, programs, textures) may be created in tasks.
+     * Container objects (VAO) are per-context, so HwGeometry creates its VAO on first draw.
+     */
+    class HwUploader {
+    public:
+        /** Work to run on uploader thread (shared context is current) */
+        typedef std::function<void()> Task;
+        /** Called on render thread, once results of the task are complete on GPU */
+        typedef std::function<void()> Completion;
+
+        HwUploader(const HwUploader&) = delete;
+        HwUploader(HwUploader&&) = delete;
+        ~HwUploader();
+
+        /**
+         * Queue task for background execution
+         * @param task Task to run on uploader thread
+         * @param completion Callback to run on render thread from Poll
+         */
+        void Submit(Task task, Completion completion);
+
+        /**
+         * Run completions of finished tasks (call on render thread each frame, never blocks)
+         * @return Number of completions run
+         */
+        size_t Poll();
+
+        /** @return Number of submitted tasks, which completions are not run yet */
+        size_t GetPendingCount() const;
+
+    private:
+        friend class HwWindowManager;
+
+        struct Pending {
+            Task task;
+            Completion completion;
+        };
+
+        struct Finished {
+            GLsync fence;
+            Completion completion;
+        };
+
+        explicit HwUploader(class HwContext *context);
+
+        void ThreadMain();
+
+        class HwContext *mContext;
+        std::thread mThread;
+        mutable std::mutex mMutex;
+        std::condition_variable mCondition;
+        std::deque<Pending> mPending;
+        std::deque<Finished> mFinished;
+        size_t mInFlight = 0;
+        bool mStop = false;
+    };
+
+}
+
+#endif //X11HELLOWORLD_UPLOADER_HPP
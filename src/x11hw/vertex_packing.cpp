@@ -0,0 +1,421 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <x11hw/vertex_packing.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cassert>
+#include <cstring>
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// Without -mf16c conversion instructions are selected at runtime (GCC and Clang on x86)
+#if !defined(__F16C__) && defined(__SSE2__) && (defined(__GNUC__) || defined(__clang__))
+#define X11HW_F16C_DISPATCH
+#endif
+
+#if defined(__AVX2__) || defined(__F16C__) || defined(X11HW_F16C_DISPATCH)
+#include <immintrin.h>
+#endif
+
+namespace x11hw {
+
+    static const float SNORM10_MAX = 511.0f;
+    static const float UNORM8_MAX = 255.0f;
+
+#if defined(X11HW_F16C_DISPATCH)
+    static bool HasF16c() {
+        // F16C instructions are VEX encoded, so OS support of AVX state is required as well
+        static const bool supported = __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+        return supported;
+    }
+
+    __attribute__((target("f16c")))
+    static size_t ConvertHalfF16c(const float *source, uint16_t *target, size_t count) {
+        size_t i = 0;
+
+        for (; i + 8 <= count; i += 8) {
+            __m256 v = _mm256_loadu_ps(source + i);
+            _mm_storeu_si128((__m128i *) (target + i), _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+        }
+
+        return i;
+    }
+#endif
+
+    HwVertexPacker::HwVertexPacker(std::vector<HwVertexStream> streams)
+        : mStreams(std::move(streams)) {
+        assert(!mStreams.empty());
+
+        for (auto& stream: mStreams) {
+            assert(stream.data);
+            assert(stream.components >= 1 && stream.components <= 4);
+            assert(stream.format != HwPackedFormat::Snorm10_10_10_2 || stream.components >= 3);
+
+            mOffsets.push_back(mStride);
+            mStride += GetPackedSize(stream.format, stream.components);
+        }
+    }
+
+    HwVertexPacker::Report HwVertexPacker::Pack(size_t verticesCount, std::vector<uint8_t> &packed) const {
+        auto start = std::chrono::steady_clock::now();
+
+        Report report;
+        report.verticesCount = verticesCount;
+        report.packedStride = mStride;
+        report.isa = GetIsaName();
+
+        packed.resize(mStride * verticesCount);
+
+        std::vector<uint16_t> halfs;
+        std::vector<uint8_t> bytes;
+        std::vector<int16_t> snorms;
+
+        for (size_t s = 0; s < mStreams.size(); s++) {
+            auto& stream = mStreams[s];
+            size_t components = stream.components;
+            size_t count = components * verticesCount;
+            uint8_t *target = packed.data() + mOffsets[s];
+
+            report.sourceStride += components * sizeof(float);
+
+            switch (stream.format) {
+                case HwPackedFormat::Float: {
+                    for (size_t v = 0; v < verticesCount; v++) {
+                        std::memcpy(target + v * mStride, stream.data + v * components, components * sizeof(float));
+                    }
+                    break;
+                }
+                case HwPackedFormat::Half: {
+                    halfs.resize(count);
+                    ConvertHalf(stream.data, halfs.data(), count);
+
+                    size_t size = GetPackedSize(stream.format, components);
+                    for (size_t v = 0; v < verticesCount; v++) {
+                        uint8_t *vertex = target + v * mStride;
+                        std::memset(vertex, 0, size);
+                        std::memcpy(vertex, halfs.data() + v * components, components * sizeof(uint16_t));
+                    }
+                    break;
+                }
+                case HwPackedFormat::Snorm10_10_10_2: {
+                    snorms.resize(count);
+                    ConvertSnorm10(stream.data, snorms.data(), count);
+
+                    for (size_t v = 0; v < verticesCount; v++) {
+                        const int16_t *c = snorms.data() + v * components;
+                        // 2-bit signed w: only -1, 0 and 1 are representable
+                        int32_t w = components < 4 ? 0 : (c[3] > 255 ? 1 : (c[3] < -255 ? -1 : 0));
+                        uint32_t value =
+                            ((uint32_t) c[0] & 0x3ffu)        |
+                            ((uint32_t) c[1] & 0x3ffu) << 10u |
+                            ((uint32_t) c[2] & 0x3ffu) << 20u |
+                            ((uint32_t) w    & 0x3u)   << 30u;
+                        std::memcpy(target + v * mStride, &value, sizeof(value));
+                    }
+                    break;
+                }
+                case HwPackedFormat::Unorm8: {
+                    bytes.resize(count);
+                    ConvertUnorm8(stream.data, bytes.data(), count);
+
+                    for (size_t v = 0; v < verticesCount; v++) {
+                        uint8_t *vertex = target + v * mStride;
+                        vertex[0] = vertex[1] = vertex[2] = 0;
+                        vertex[3] = (uint8_t) UNORM8_MAX;
+                        std::memcpy(vertex, bytes.data() + v * components, components);
+                    }
+                    break;
+                }
+            }
+        }
+
+        report.sourceBytes = report.sourceStride * verticesCount;
+        report.packedBytes = mStride * verticesCount;
+        report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        return report;
+    }
+
+    HwGeometry::InitParams HwVertexPacker::GetParams(size_t verticesCount) const {
+        HwGeometry::InitParams params;
+        params.verticesCount = verticesCount;
+        params.stride = mStride;
+        params.topology = GL_TRIANGLES;
+
+        for (size_t s = 0; s < mStreams.size(); s++) {
+            params.attributes.push_back(GetAttribute(mStreams[s].format, mStreams[s].components, mOffsets[s]));
+        }
+
+        return params;
+    }
+
+    const char *HwVertexPacker::GetIsaName() {
+#if defined(__AVX2__) && defined(__F16C__)
+        return "AVX2+F16C";
+#elif defined(__AVX2__)
+        return "AVX2";
+#elif defined(__SSE2__) && defined(__F16C__)
+        return "SSE2+F16C";
+#elif defined(X11HW_F16C_DISPATCH)
+        return HasF16c() ? "SSE2+F16C (runtime)" : "SSE2";
+#elif defined(__SSE2__)
+        return "SSE2";
+#else
+        return "Scalar";
+#endif
+    }
+
+    size_t HwVertexPacker::GetPackedSize(HwPackedFormat format, size_t components) {
+        switch (format) {
+            case HwPackedFormat::Float:
+                return components * sizeof(float);
+            case HwPackedFormat::Half:
+                return (components * sizeof(uint16_t) + 3u) & ~size_t{3u};
+            case HwPackedFormat::Snorm10_10_10_2:
+            case HwPackedFormat::Unorm8:
+                return sizeof(uint32_t);
+        }
+
+        return 0;
+    }
+
+    HwGeometry::Attribute HwVertexPacker::GetAttribute(HwPackedFormat format, size_t components, size_t offset) {
+        switch (format) {
+            case HwPackedFormat::Float:
+                return {offset, components, GL_FLOAT, false};
+            case HwPackedFormat::Half:
+                return {offset, components, GL_HALF_FLOAT, false};
+            case HwPackedFormat::Snorm10_10_10_2:
+                return {offset, 4, GL_INT_2_10_10_10_REV, true};
+            case HwPackedFormat::Unorm8:
+                return {offset, 4, GL_UNSIGNED_BYTE, true};
+        }
+
+        return {offset, components, GL_FLOAT, false};
+    }
+
+    uint16_t HwVertexPacker::PackHalf(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        uint32_t sign = (bits >> 16u) & 0x8000u;
+        uint32_t mantissa = bits & 0x7fffffu;
+        int32_t exponent = (int32_t) ((bits >> 23u) & 0xffu) - 127 + 15;
+
+        // Inf and NaN
+        if ((bits & 0x7fffffffu) >= 0x7f800000u) {
+            return (uint16_t) (sign | 0x7c00u | (mantissa ? 0x200u : 0u));
+        }
+        // Overflow to Inf
+        if (exponent >= 31) {
+            return (uint16_t) (sign | 0x7c00u);
+        }
+        // Subnormal or zero
+        if (exponent <= 0) {
+            if (exponent < -10) {
+                return (uint16_t) sign;
+            }
+
+            mantissa |= 0x800000u;
+            uint32_t shift = (uint32_t) (14 - exponent);
+            uint32_t half = mantissa >> shift;
+            uint32_t rest = mantissa & ((1u << shift) - 1u);
+            uint32_t halfway = 1u << (shift - 1u);
+
+            if (rest > halfway || (rest == halfway && (half & 1u))) {
+                half += 1;
+            }
+
+            return (uint16_t) (sign | half);
+        }
+
+        // Round to nearest even, carry into exponent is correct (may produce Inf)
+        uint32_t half = sign | ((uint32_t) exponent << 10u) | (mantissa >> 13u);
+        uint32_t rest = mantissa & 0x1fffu;
+
+        if (rest > 0x1000u || (rest == 0x1000u && (half & 1u))) {
+            half += 1;
+        }
+
+        return (uint16_t) half;
+    }
+
+    void HwVertexPacker::ConvertHalf(const float *source, uint16_t *target, size_t count) {
+        size_t i = 0;
+
+#if defined(__AVX2__) && defined(__F16C__)
+        for (; i + 8 <= count; i += 8) {
+            __m256 v = _mm256_loadu_ps(source + i);
+            _mm_storeu_si128((__m128i *) (target + i), _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+        }
+#elif defined(__F16C__)
+        for (; i + 4 <= count; i += 4) {
+            __m128 v = _mm_loadu_ps(source + i);
+            _mm_storel_epi64((__m128i *) (target + i), _mm_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT));
+        }
+#elif defined(__SSE2__)
+#if defined(X11HW_F16C_DISPATCH)
+        if (HasF16c()) {
+            i = ConvertHalfF16c(source, target, count);
+        }
+#endif
+
+        // Integer conversion with the same rounding as PackHalf (to nearest even, NaN as 0x7e00)
+        const __m128i signMask = _mm_set1_epi32((int) 0x80000000u);
+        const __m128i f32Infinity = _mm_set1_epi32(255 << 23);
+        const __m128i f16Overflow = _mm_set1_epi32(((127 + 16) << 23) - 1);
+        const __m128i f16NormalMin = _mm_set1_epi32((127 - 14) << 23);
+        const __m128 denormMagic = _mm_castsi128_ps(_mm_set1_epi32(((127 - 15) + (23 - 10) + 1) << 23));
+        const __m128i rebias = _mm_set1_epi32((int) ((uint32_t) (15 - 127) << 23) + 0xfff);
+        const __m128i one = _mm_set1_epi32(1);
+        const __m128i halfInfinity = _mm_set1_epi32(0x7c00);
+        const __m128i halfNan = _mm_set1_epi32(0x7e00);
+
+        auto select = [](__m128i mask, __m128i a, __m128i b) {
+            return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+        };
+
+        for (; i + 8 <= count; i += 8) {
+            __m128i r[2];
+            __m128i signs[2];
+
+            for (int k = 0; k < 2; k++) {
+                __m128i bits = _mm_castps_si128(_mm_loadu_ps(source + i + 4 * k));
+                __m128i sign = _mm_and_si128(bits, signMask);
+                __m128i x = _mm_xor_si128(bits, sign);
+
+                // Subnormal: float addition aligns mantissa and rounds it to nearest even
+                __m128i denorm = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(x), denormMagic)),
+                                               _mm_castps_si128(denormMagic));
+
+                // Normal: rebias exponent, round to nearest even (carry into exponent may produce Inf)
+                __m128i odd = _mm_and_si128(_mm_srli_epi32(x, 13), one);
+                __m128i normal = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(x, rebias), odd), 13);
+
+                __m128i special = select(_mm_cmpgt_epi32(x, f32Infinity), halfNan, halfInfinity);
+                __m128i half = select(_mm_cmplt_epi32(x, f16NormalMin), denorm, normal);
+                r[k] = select(_mm_cmpgt_epi32(x, f16Overflow), special, half);
+
+                // Arithmetic shift makes sign 0xffff8000, so it survives signed saturation as 0x8000
+                signs[k] = _mm_srai_epi32(sign, 16);
+            }
+
+            __m128i packed = _mm_or_si128(_mm_packs_epi32(r[0], r[1]), _mm_packs_epi32(signs[0], signs[1]));
+            _mm_storeu_si128((__m128i *) (target + i), packed);
+        }
+#endif
+
+        for (; i < count; i++) {
+            target[i] = PackHalf(source[i]);
+        }
+    }
+
+    void HwVertexPacker::ConvertUnorm8(const float *source, uint8_t *target, size_t count) {
+        size_t i = 0;
+
+#if defined(__AVX2__)
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 scale = _mm256_set1_ps(UNORM8_MAX);
+        const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+
+        for (; i + 32 <= count; i += 32) {
+            __m256i r[4];
+            for (int k = 0; k < 4; k++) {
+                __m256 v = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(source + i + 8 * k), zero), one);
+                r[k] = _mm256_cvtps_epi32(_mm256_mul_ps(v, scale));
+            }
+
+            // Packs work per 128-bit lane, so restore order with cross-lane permute
+            __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(r[0], r[1]), _mm256_packs_epi32(r[2], r[3]));
+            _mm256_storeu_si256((__m256i *) (target + i), _mm256_permutevar8x32_epi32(packed, order));
+        }
+#elif defined(__SSE2__)
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 scale = _mm_set1_ps(UNORM8_MAX);
+
+        for (; i + 16 <= count; i += 16) {
+            __m128i r[4];
+            for (int k = 0; k < 4; k++) {
+                __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i + 4 * k), zero), one);
+                r[k] = _mm_cvtps_epi32(_mm_mul_ps(v, scale));
+            }
+
+            __m128i packed = _mm_packus_epi16(_mm_packs_epi32(r[0], r[1]), _mm_packs_epi32(r[2], r[3]));
+            _mm_storeu_si128((__m128i *) (target + i), packed);
+        }
+#endif
+
+        for (; i < count; i++) {
+            float v = std::min(std::max(source[i], 0.0f), 1.0f);
+            target[i] = (uint8_t) std::lrint(v * UNORM8_MAX);
+        }
+    }
+
+    void HwVertexPacker::ConvertSnorm10(const float *source, int16_t *target, size_t count) {
+        size_t i = 0;
+
+#if defined(__AVX2__)
+        const __m256 minusOne = _mm256_set1_ps(-1.0f);
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 scale = _mm256_set1_ps(SNORM10_MAX);
+
+        for (; i + 16 <= count; i += 16) {
+            __m256i r[2];
+            for (int k = 0; k < 2; k++) {
+                __m256 v = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(source + i + 8 * k), minusOne), one);
+                r[k] = _mm256_cvtps_epi32(_mm256_mul_ps(v, scale));
+            }
+
+            __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi32(r[0], r[1]), 0xd8);
+            _mm256_storeu_si256((__m256i *) (target + i), packed);
+        }
+#elif defined(__SSE2__)
+        const __m128 minusOne = _mm_set1_ps(-1.0f);
+        const __m128 one = _mm_set1_ps(1.0f);
+        const __m128 scale = _mm_set1_ps(SNORM10_MAX);
+
+        for (; i + 8 <= count; i += 8) {
+            __m128i r[2];
+            for (int k = 0; k < 2; k++) {
+                __m128 v = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(source + i + 4 * k), minusOne), one);
+                r[k] = _mm_cvtps_epi32(_mm_mul_ps(v, scale));
+            }
+
+            _mm_storeu_si128((__m128i *) (target + i), _mm_packs_epi32(r[0], r[1]));
+        }
+#endif
+
+        for (; i < count; i++) {
+            float v = std::min(std::max(source[i], -1.0f), 1.0f);
+            target[i] = (int16_t) std::lrint(v * SNORM10_MAX);
+        }
+    }
+
+}
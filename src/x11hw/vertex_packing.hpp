@@ -0,0 +1,115 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_VERTEX_PACKING_HPP
+#define X11HELLOWORLD_VERTEX_PACKING_HPP
+
+#include <GL/glew.h>
+#include <x11hw/geometry.hpp>
+#include <vector>
+#include <cstdint>
+
+namespace x11hw {
+
+    /** Storage format of packed vertex attribute */
+    enum class HwPackedFormat {
+        /** 32-bit float per component */
+        Float,
+        /** 16-bit half float per component (padded to 4 bytes) */
+        Half,
+        /** xyz as signed normalized 10 bits, w as 2 bits (GL_INT_2_10_10_10_REV) */
+        Snorm10_10_10_2,
+        /** 8-bit unsigned normalized per component, always 4 components */
+        Unorm8
+    };
+
+    /** Source attribute stream: tightly packed floats, components per vertex */
+    struct HwVertexStream {
+        const float *data;
+        size_t components;
+        HwPackedFormat format;
+    };
+
+    /**
+     * Packs float source streams into single interleaved vertex buffer of compact formats.
+     * Conversion runs in two stages: vectorized (SSE2/AVX2/F16C when enabled at compile time,
+     * F16C is detected at runtime otherwise)
+     * element-wise conversion of each stream, then interleaving into final vertex layout.
+     */
+    class HwVertexPacker {
+    public:
+        struct Report {
+            size_t verticesCount = 0;
+            size_t sourceStride = 0;
+            size_t packedStride = 0;
+            size_t sourceBytes = 0;
+            size_t packedBytes = 0;
+            double seconds = 0.0;
+            const char *isa = nullptr;
+
+            size_t GetSavedBytes() const { return sourceBytes - packedBytes; }
+        };
+
+        explicit HwVertexPacker(std::vector<HwVertexStream> streams);
+
+        /**
+         * Pack vertices
+         * @param verticesCount Number of vertices in each stream
+         * @param[out] packed Interleaved packed vertex data
+         * @return Packing report
+         */
+        Report Pack(size_t verticesCount, std::vector<uint8_t> &packed) const;
+
+        /**
+         * @param verticesCount Number of vertices
+         * @return Geometry params for the packed layout (attribute i is stream i)
+         */
+        HwGeometry::InitParams GetParams(size_t verticesCount) const;
+
+        /** @return Packed vertex stride in bytes */
+        size_t GetStride() const { return mStride; }
+
+        /** @return Name of instruction set used for conversion */
+        static const char *GetIsaName();
+
+        /** @return Packed size in bytes of attribute with given format */
+        static size_t GetPackedSize(HwPackedFormat format, size_t components);
+
+        /** @return Attribute description for packed format */
+        static HwGeometry::Attribute GetAttribute(HwPackedFormat format, size_t components, size_t offset);
+
+        static uint16_t PackHalf(float value);
+        static void ConvertHalf(const float *source, uint16_t *target, size_t count);
+        static void ConvertUnorm8(const float *source, uint8_t *target, size_t count);
+        static void ConvertSnorm10(const float *source, int16_t *target, size_t count);
+
+    private:
+        std::vector<HwVertexStream> mStreams;
+        std::vector<size_t> mOffsets;
+        size_t mStride = 0;
+    };
+
+}
+
+#endif //X11HELLOWORLD_VERTEX_PACKING_HPP
@@ -25,6 +25,7 @@
 #include <x11hw/window.hpp>
 #include <x11hw/context.hpp>
 #include <x11hw/window_manager.hpp>
+#include <x11hw/input_record.hpp>
 #include <x11hw/error.hpp>
 
 #include <stdexcept>
@@ -33,6 +34,7 @@
 #include <cstring>
 
 #include <GL/glx.h>
+#include <X11/Xatom.h>
 
 
 namespace x11hw {
@@ -54,20 +56,32 @@ namespace x11hw {
           mName(std::move(params.name)),
           mDisplay(params.display),
           mScreen(params.screen),
-          mContext(params.context) {
+          mContext(params.context),
+          mManager(params.manager) {
         assert(mDisplay);
         assert(mContext);
+        assert(mManager);
         assert(mSize.x > 0 & mSize.y > 0);
         CreateXWindow();
+
+        // Valid before the first ConfigureNotify arrives
+        QueryFboSize();
+        mSettledSize = mSize;
     }
 
     HwWindow::~HwWindow() {
+        if (mSyncCounter != None) {
+            XSyncDestroyCounter(mDisplay, mSyncCounter);
+            mSyncCounter = None;
+        }
+
         XDestroyWindow(mDisplay, mHnd);
 
         mHnd = 0;
         mScreen = 0;
         mDisplay = nullptr;
         mContext = nullptr;
+        mManager = nullptr;
     }
 
     void HwWindow::MakeContextCurrent() {
@@ -76,10 +90,81 @@ namespace x11hw {
 
     void HwWindow::SwapBuffers() {
         mContext->SwapBuffers(mHnd);
+        mSwapCount += 1;
+
+        // Frame rendered after the request is presented, window manager may continue. Request
+        // is not always followed by ConfigureNotify (size may not change), so it is acknowledged anyway
+        if (mSyncRequested) {
+            XSyncSetCounter(mDisplay, mSyncCounter, mSyncValue);
+            XFlush(mDisplay);
+
+            mSyncRequested = false;
+        }
+    }
+
+    glm::uvec2 HwWindow::QueryDrawableSize() const {
+        return mContext->QueryDrawableSize(mHnd);
+    }
+
+    bool HwWindow::QuerySwapInfo(SwapInfo &info) const {
+        int64_t ust = 0;
+        int64_t msc = 0;
+        int64_t sbc = 0;
+
+        if (!mContext->GetSyncValues(mHnd, ust, msc, sbc)) {
+            return false;
+        }
+
+        // Sync values carry UST of the last vblank, swap completion time is returned by wait for
+        // already completed swap counter (returns at once). Zero target would wait for pending swaps
+        if (sbc > 0 && !mContext->WaitForSwap(mHnd, sbc, ust, msc, sbc)) {
+            return false;
+        }
+
+        // UST is in microseconds of CLOCK_MONOTONIC (Mesa and X Present), which is the steady clock on Linux
+        info.completedSwaps = sbc;
+        info.presentTime = std::chrono::steady_clock::time_point(std::chrono::microseconds(ust));
+        return true;
     }
 
     void HwWindow::SetSwapInterval(int interval) {
-        mContext->SetSwapInterval(mHnd, interval);
+        mSwapInterval = mContext->SetSwapInterval(mHnd, interval);
+    }
+
+    void HwWindow::SetFullscreen(bool fullscreen) {
+        static const long NET_WM_STATE_REMOVE = 0;
+        static const long NET_WM_STATE_ADD = 1;
+        static const long SOURCE_APPLICATION = 1;
+
+        Atom atomWmState = XInternAtom(mDisplay, "_NET_WM_STATE", False);
+        Atom atomFullscreen = XInternAtom(mDisplay, "_NET_WM_STATE_FULLSCREEN", False);
+
+        // Window is mapped, so the state is changed by request to the window manager
+        XEvent event{};
+        event.xclient.type = ClientMessage;
+        event.xclient.window = mHnd;
+        event.xclient.message_type = atomWmState;
+        event.xclient.format = 32;
+        event.xclient.data.l[0] = fullscreen ? NET_WM_STATE_ADD : NET_WM_STATE_REMOVE;
+        event.xclient.data.l[1] = (long) atomFullscreen;
+        event.xclient.data.l[2] = 0;
+        event.xclient.data.l[3] = SOURCE_APPLICATION;
+
+        CHECK(XSendEvent(mDisplay, XRootWindow(mDisplay, mScreen), False, SubstructureRedirectMask | SubstructureNotifyMask, &event));
+        XFlush(mDisplay);
+
+        mFullscreen = fullscreen;
+    }
+
+    void HwWindow::SetBypassCompositor(bool bypass) {
+        static const long BYPASS_NO_PREFERENCE = 0;
+        static const long BYPASS_REQUESTED = 1;
+
+        Atom atomBypassCompositor = XInternAtom(mDisplay, "_NET_WM_BYPASS_COMPOSITOR", False);
+        long value = bypass ? BYPASS_REQUESTED : BYPASS_NO_PREFERENCE;
+
+        XChangeProperty(mDisplay, mHnd, atomBypassCompositor, XA_CARDINAL, 32, PropModeReplace, (unsigned char *) &value, 1);
+        XFlush(mDisplay);
     }
 
     void HwWindow::CreateXWindow() {
@@ -102,7 +187,6 @@ namespace x11hw {
         XSetWindowAttributes windowAttributes;
         windowAttributes.border_pixel = XBlackPixel(mDisplay, mScreen);
         windowAttributes.background_pixel = XWhitePixel(mDisplay, mScreen);
-        windowAttributes.override_redirect = True;
         windowAttributes.colormap = colorMap;
         windowAttributes.event_mask = mEventMask;
 
@@ -123,7 +207,11 @@ namespace x11hw {
 
         // Events & name setup
         mAtomWmDeleteWindow = XInternAtom(mDisplay, "WM_DELETE_WINDOW", False);
-        CHECK(XSetWMProtocols(mDisplay, mHnd, &mAtomWmDeleteWindow, 1));
+        CreateSyncCounter();
+
+        Atom protocols[] = { mAtomWmDeleteWindow, mAtomWmSyncRequest };
+        int protocolsCount = mSyncCounter != None ? 2 : 1;
+        CHECK(XSetWMProtocols(mDisplay, mHnd, protocols, protocolsCount));
         CHECK(XSelectInput(mDisplay, mHnd, mEventMask));
         CHECK(XStoreName(mDisplay, mHnd, mTitle.c_str()));
 
@@ -132,58 +220,181 @@ namespace x11hw {
         CHECK(XMapRaised(mDisplay, mHnd));
     }
 
+    void HwWindow::CreateSyncCounter() {
+        int eventBase, errorBase;
+        int major, minor;
+
+        // Without XSync window manager does not wait for the app during resize
+        if (!XSyncQueryExtension(mDisplay, &eventBase, &errorBase) || !XSyncInitialize(mDisplay, &major, &minor)) {
+            return;
+        }
+
+        XSyncValue initialValue;
+        XSyncIntToValue(&initialValue, 0);
+        mSyncCounter = XSyncCreateCounter(mDisplay, initialValue);
+
+        if (mSyncCounter == None) {
+            return;
+        }
+
+        mAtomWmSyncRequest = XInternAtom(mDisplay, "_NET_WM_SYNC_REQUEST", False);
+        Atom atomSyncRequestCounter = XInternAtom(mDisplay, "_NET_WM_SYNC_REQUEST_COUNTER", False);
+
+        // Format 32 properties are passed as array of long
+        long counter = (long) mSyncCounter;
+        XChangeProperty(mDisplay, mHnd, atomSyncRequestCounter, XA_CARDINAL, 32, PropModeReplace, (unsigned char *) &counter, 1);
+    }
+
     void HwWindow::QueryFboSize() {
         mFramebufferSize = mSize;
     }
 
+    void HwWindow::ApplyResize(std::chrono::steady_clock::time_point now) {
+        if (mResizePending) {
+            mResizePending = false;
+
+            if (mPendingSize != mSize) {
+                mSize = mPendingSize;
+                QueryFboSize();
+
+                mLastResizeTime = now;
+                mResizeSettling = true;
+            }
+        }
+
+        if (mResizeSettling && now - mLastResizeTime >= std::chrono::milliseconds{RESIZE_SETTLE_MS}) {
+            mResizeSettling = false;
+
+            // Size may return to the settled one within the burst
+            if (mSize != mSettledSize) {
+                mSettledSize = mSize;
+                NotifyResize();
+            }
+        }
+    }
+
+    bool HwWindow::Unsubscribe(HwEventToken token) {
+        if (token.owner != mEventOwner) {
+            return false;
+        }
+
+        switch (token.channel) {
+            case CHANNEL_INPUT:
+                return mInputEvents.Unsubscribe(token);
+            case CHANNEL_CLOSE:
+                return mCloseEvent.Unsubscribe(token);
+            case CHANNEL_RESIZE:
+                return mResizeEvent.Unsubscribe(token);
+            default:
+                return false;
+        }
+    }
+
+    bool HwWindow::IsInputObserved(EventType type) const {
+        // Live input is replaced by recorded one while replaying
+        if (mManager->IsReplaying()) {
+            return false;
+        }
+
+        return mInputEvents.HasListeners(type) || mManager->mRecorder != nullptr;
+    }
+
+    void HwWindow::HandleInput(const EventData &event) {
+        // Live input is replaced by recorded one while replaying
+        if (mManager->IsReplaying()) {
+            return;
+        }
+
+        if (auto& recorder = mManager->mRecorder) {
+            recorder->RecordInput(mManager->mFrameIndex, mName, event);
+        }
+
+        NotifyInput(event);
+    }
+
+    void HwWindow::HandleClose() {
+        // Close is still accepted while replaying, so the run may be interrupted
+        if (auto& recorder = mManager->mRecorder) {
+            recorder->RecordClose(mManager->mFrameIndex, mName);
+        }
+
+        NotifyClose();
+    }
+
     void HwWindow::NotifyInput(const EventData &event) {
-        for (auto& callback: mOnInputCallbacks) {
-            callback(event);
+        if (mInputEvents.HasListeners(event.type)) {
+            mInputEvents.Dispatch(event.type, event);
         }
     }
 
     void HwWindow::NotifyClose() {
-        for (auto& callback: mOnCloseCallbacks) {
-            callback();
-        }
+        mCloseEvent.Dispatch();
+    }
+
+    void HwWindow::NotifyResize() {
+        mResizeEvent.Dispatch(mSize, mFramebufferSize);
     }
 
     void HwWindow::ProcessEvent(const XEvent& event) {
         switch (event.type) {
             case ButtonPress: {
+                if (!IsInputObserved(EventType::MouseButtonPressed)) {
+                    break;
+                }
+
                 EventData eventData;
                 eventData.type = EventType::MouseButtonPressed;
                 eventData.mouseButton = GetMouseButtonFromId(event.xbutton.button);
                 eventData.mousePosition = {event.xbutton.x, event.xbutton.y};
-                NotifyInput(eventData);
+                eventData.time = mManager->GetEventTime(event.xbutton.time);
+                HandleInput(eventData);
                 break;
             }
             case ButtonRelease: {
+                if (!IsInputObserved(EventType::MouseButtonReleased)) {
+                    break;
+                }
+
                 EventData eventData;
                 eventData.type = EventType::MouseButtonReleased;
                 eventData.mouseButton = GetMouseButtonFromId(event.xbutton.button);
                 eventData.mousePosition = {event.xbutton.x, event.xbutton.y};
-                NotifyInput(eventData);
+                eventData.time = mManager->GetEventTime(event.xbutton.time);
+                HandleInput(eventData);
                 break;
             }
             case MotionNotify: {
+                if (!IsInputObserved(EventType::MouseMoved)) {
+                    break;
+                }
+
                 EventData eventData;
                 eventData.type = EventType::MouseMoved;
                 eventData.mouseButton = GetMouseButtonFromId(event.xbutton.button);
                 eventData.mousePosition = {event.xbutton.x, event.xbutton.y};
-                NotifyInput(eventData);
+                eventData.time = mManager->GetEventTime(event.xmotion.time);
+                HandleInput(eventData);
                 break;
             }
             case ClientMessage: {
-                if (event.xclient.data.l[0] == (long) mAtomWmDeleteWindow) {
-                    NotifyClose();
-                    break;
+                auto protocol = (Atom) event.xclient.data.l[0];
+
+                if (protocol == mAtomWmDeleteWindow) {
+                    HandleClose();
+                }
+                else if (protocol == mAtomWmSyncRequest && mSyncCounter != None) {
+                    // Value to set once the next frame is presented
+                    XSyncIntsToValue(&mSyncValue, (unsigned int) event.xclient.data.l[2], (int) event.xclient.data.l[3]);
+                    mSyncRequested = true;
                 }
+
+                break;
             }
             case ConfigureNotify: {
+                // Only the latest size of the burst is applied (in ApplyResize)
                 XConfigureEvent xce = event.xconfigure;
-                mSize = { xce.width, xce.height};
-                QueryFboSize();
+                mPendingSize = { xce.width, xce.height };
+                mResizePending = true;
                 break;
             }
             default:
@@ -27,15 +27,19 @@
 
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
+#include <X11/extensions/sync.h>
 #include <glm/vec2.hpp>
-#include <functional>
+#include <x11hw/event_dispatcher.hpp>
+#include <chrono>
 #include <string>
-#include <vector>
 
 namespace x11hw {
 
     class HwWindow {
     public:
+        /** Time the size must stay unchanged before resize listeners are notified */
+        static const int RESIZE_SETTLE_MS = 100;
+
         enum class EventType {
             MouseButtonPressed,
             MouseButtonReleased,
@@ -53,6 +57,16 @@ namespace x11hw {
             EventType type = EventType::Unknown;
             MouseButton mouseButton = MouseButton::Unknown;
             glm::ivec2 mousePosition{};
+            /** Time the event was generated (X server time mapped to steady clock) */
+            std::chrono::steady_clock::time_point time{};
+        };
+
+        /** Completion of presented frames (GLX_OML_sync_control) */
+        struct SwapInfo {
+            /** Number of swaps of the window, which are completed (frame is on the screen) */
+            int64_t completedSwaps = 0;
+            /** Time the last completed swap was presented (UST mapped to steady clock) */
+            std::chrono::steady_clock::time_point presentTime{};
         };
 
         HwWindow(const HwWindow &) = delete;
@@ -65,29 +79,100 @@ namespace x11hw {
         /** Preset back-buffer content to the screen */
         void SwapBuffers();
 
-        /** Sets swap interval */
+        /** @return Number of SwapBuffers calls (the same numbering as completed swaps of SwapInfo) */
+        int64_t GetSwapCount() const { return mSwapCount; }
+
+        /**
+         * Query the last completed swap (round trip to the server, does not wait for vblank)
+         * @param info Completed swaps and present time of the last one
+         * @return False if GLX_OML_sync_control is not supported
+         */
+        bool QuerySwapInfo(SwapInfo &info) const;
+
+        /**
+         * Sets swap interval
+         * @param interval Number of vblanks per swap (0 - no sync), negative - the same number,
+         *                 but late frames tear instead of waiting (GLX_EXT_swap_control_tear)
+         */
         void SetSwapInterval(int interval);
 
+        /** @return Swap interval in effect (after fallback, 0 if swap control is not supported) */
+        int GetSwapInterval() const { return mSwapInterval; }
+
+        /**
+         * Ask window manager to show window fullscreen (_NET_WM_STATE_FULLSCREEN)
+         * @param fullscreen True to enter fullscreen, false to leave it
+         */
+        void SetFullscreen(bool fullscreen);
+
+        /**
+         * Hint compositor to unredirect the window (_NET_WM_BYPASS_COMPOSITOR), so frames are
+         * flipped directly instead of being copied by the compositor (takes effect for fullscreen windows)
+         * @param bypass True to request bypass, false to leave it to the compositor
+         */
+        void SetBypassCompositor(bool bypass);
+
+        typedef HwEventDispatcher<EventType, (size_t) EventType::Unknown, const EventData &> InputEvents;
+        typedef HwEvent<> CloseEvent;
+        typedef HwEvent<glm::uvec2, glm::uvec2> ResizeEvent;
+
+        /**
+         * Add listener for window input events of single type (listener is not called for other types)
+         * @tparam Callback Type of a function to call (must fit into HwDelegate storage)
+         * @param type Type of events to listen
+         * @param callback The function to call
+         * @return Token to unsubscribe
+         */
+        template<typename Callback>
+        HwEventToken SubscribeOnInput(EventType type, Callback &&callback) {
+            return mInputEvents.Subscribe(type, InputEvents::Delegate(std::forward<Callback>(callback)));
+        }
+
         /**
-         * Add listener for window input events (requested when user presses red x button)
-         * @tparam Callback Type of a function to call
+         * Add listener for window input events of all types
+         * @tparam Callback Type of a function to call (must fit into HwDelegate storage)
          * @param callback The function to call
+         * @return Token to unsubscribe
          */
         template<typename Callback>
-        void SubscribeOnInput(Callback &&callback) {
-            mOnInputCallbacks.emplace_back(std::forward<Callback>(callback));
+        HwEventToken SubscribeOnInput(Callback &&callback) {
+            return mInputEvents.SubscribeAll(InputEvents::Delegate(std::forward<Callback>(callback)));
         }
 
         /**
          * Add listener for window close events (requested when user presses red x button)
-         * @tparam Callback Type of a function to call
+         * @tparam Callback Type of a function to call (must fit into HwDelegate storage)
+         * @param callback The function to call
+         * @return Token to unsubscribe
+         */
+        template<typename Callback>
+        HwEventToken SubscribeOnClose(Callback &&callback) {
+            return mCloseEvent.Subscribe(CloseEvent::Delegate(std::forward<Callback>(callback)));
+        }
+
+        /**
+         * Add listener for settled window resize: called once the size stays unchanged for RESIZE_SETTLE_MS,
+         * so size-dependent resources are reallocated once per resize, not per intermediate event.
+         * GetSize() and GetFramebufferSize() follow the latest size right away (for viewport).
+         * @tparam Callback Type of a function to call with new size and framebuffer size
          * @param callback The function to call
+         * @return Token to unsubscribe
          */
         template<typename Callback>
-        void SubscribeOnClose(Callback &&callback) {
-            mOnCloseCallbacks.emplace_back(std::forward<Callback>(callback));
+        HwEventToken SubscribeOnResize(Callback &&callback) {
+            return mResizeEvent.Subscribe(ResizeEvent::Delegate(std::forward<Callback>(callback)));
         }
 
+        /**
+         * Remove listener (may be called from the listener itself)
+         * @param token Token returned on subscription by this window
+         * @return True if listener was found (false for tokens of other windows)
+         */
+        bool Unsubscribe(HwEventToken token);
+
+        /** @return True if fullscreen was requested */
+        bool IsFullscreen() const { return mFullscreen; }
+
         /** @return Window Name (id) */
         const std::string &GetName() const { return mName; };
 
@@ -100,6 +185,9 @@ namespace x11hw {
         /** @return Framebuffer size (in pixels) */
         const glm::uvec2 &GetFramebufferSize() const { return mFramebufferSize; }
 
+        /** @return Size of the window drawable as reported by GLX (round trip to the server) */
+        glm::uvec2 QueryDrawableSize() const;
+
     private:
         friend class HwWindowManager;
 
@@ -110,12 +198,19 @@ namespace x11hw {
             Display *display;
             int screen;
             class HwContext *context;
+            class HwWindowManager *manager;
         };
 
         explicit HwWindow(InitParams &params);
 
         void CreateXWindow();
+        void CreateSyncCounter();
         void QueryFboSize();
+        void ApplyResize(std::chrono::steady_clock::time_point now);
+        void NotifyResize();
+        bool IsInputObserved(EventType type) const;
+        void HandleInput(const EventData &event);
+        void HandleClose();
         void NotifyInput(const EventData &event);
         void NotifyClose();
         void ProcessEvent(const XEvent &event);
@@ -128,16 +223,41 @@ namespace x11hw {
         glm::uvec2 mSize;
         glm::uvec2 mFramebufferSize{};
 
+        // Latest ConfigureNotify size, applied once per PollEvents (bursts are coalesced)
+        glm::uvec2 mPendingSize{};
+        glm::uvec2 mSettledSize{};
+        bool mResizePending = false;
+        bool mResizeSettling = false;
+        std::chrono::steady_clock::time_point mLastResizeTime{};
+
+        // _NET_WM_SYNC_REQUEST: window manager waits until the next frame is presented
+        XSyncCounter mSyncCounter = None;
+        XSyncValue mSyncValue{};
+        bool mSyncRequested = false;
+
+        bool mFullscreen = false;
+        int mSwapInterval = 0;
+        int64_t mSwapCount = 0;
+
         long mEventMask = 0;
         Atom mAtomWmDeleteWindow{};
+        Atom mAtomWmSyncRequest{};
         Window mHnd{};
         int mScreen = -1;
         Display *mDisplay = nullptr;
 
         class HwContext *mContext;
+        class HwWindowManager *mManager;
+
+        // Channels of subscription tokens, owner makes tokens of other windows foreign
+        static const uint32_t CHANNEL_INPUT = 1;
+        static const uint32_t CHANNEL_CLOSE = 2;
+        static const uint32_t CHANNEL_RESIZE = 3;
 
-        std::vector<std::function<void()>> mOnCloseCallbacks;
-        std::vector<std::function<void(const EventData &event)>> mOnInputCallbacks;
+        uint32_t mEventOwner = HwEventToken::NewOwner();
+        InputEvents mInputEvents{mEventOwner, CHANNEL_INPUT};
+        CloseEvent mCloseEvent{mEventOwner, CHANNEL_CLOSE};
+        ResizeEvent mResizeEvent{mEventOwner, CHANNEL_RESIZE};
     };
 
 }
@@ -25,22 +25,35 @@
 #include <x11hw/window_manager.hpp>
 #include <x11hw/window.hpp>
 #include <x11hw/context.hpp>
+#include <x11hw/uploader.hpp>
+#include <x11hw/input_record.hpp>
 #include <x11hw/error.hpp>
 #include <stdexcept>
+#include <chrono>
 
 namespace x11hw {
 
-    HwWindowManager::HwWindowManager() {
+    HwWindowManager::HwWindowManager() : HwWindowManager(HwContextConfig()) {
+
+    }
+
+    HwWindowManager::HwWindowManager(const HwContextConfig &contextConfig) {
+        // Display is also used by the uploader thread to bind its context
+        CHECK_MSG(XInitThreads(), "Failed to init X11 threads support");
+
         mDisplay = XOpenDisplay(nullptr);
         CHECK_MSG(mDisplay, "Failed to create Display");
         CHECK(XSync(mDisplay, False));
 
         mScreen = XDefaultScreen(mDisplay);
-        mContext = std::unique_ptr<HwContext>{new HwContext(mDisplay, mScreen)};
+        mContext = std::unique_ptr<HwContext>{new HwContext(mDisplay, mScreen, contextConfig)};
     }
 
     HwWindowManager::~HwWindowManager() {
-        // Release context
+        // Release input log, uploader and context
+        mRecorder = nullptr;
+        mReplay = nullptr;
+        mUploader = nullptr;
         mContext = nullptr;
 
         // Clear X11 mappings
@@ -63,7 +76,8 @@ namespace x11hw {
             size,
             mDisplay,
             mScreen,
-            mContext.get()
+            mContext.get(),
+            this
         };
 
         // Cool hack, since constructor is private - cannot do this in normal way
@@ -83,6 +97,8 @@ namespace x11hw {
     }
 
     void HwWindowManager::PollEvents() {
+        mEventQueueDepth = (uint32_t) XPending(mDisplay);
+
         while (XPending(mDisplay) > 0) {
             XEvent event;
             XNextEvent(mDisplay, &event);
@@ -91,6 +107,20 @@ namespace x11hw {
             auto found = mX11Windows.find(hnd);
             found->second->ProcessEvent(event);
         }
+
+        // Resize events are coalesced, windows get only the latest size of the burst
+        auto now = std::chrono::steady_clock::now();
+
+        for (auto& entry: mWindows) {
+            entry.second->ApplyResize(now);
+        }
+
+        if (mReplay) {
+            ReplayEvents();
+            mReplayTime = mReplay->GetFrameTime(mFrameIndex);
+        }
+
+        mFrameIndex += 1;
     }
 
     bool HwWindowManager::ContainsWindow(const std::string &name) const {
@@ -103,4 +133,98 @@ namespace x11hw {
         return found != mWindows.end()? found->second.get(): nullptr;
     }
 
+    HwUploader* HwWindowManager::GetUploader() {
+        CHECK_MSG(mContext->IsCreated(), "Uploader requires created context (create window first)");
+
+        if (!mUploader) {
+            // Constructor is private, same as for windows
+            mUploader = std::unique_ptr<HwUploader>{new HwUploader(mContext.get())};
+        }
+
+        return mUploader.get();
+    }
+
+    const HwFramebufferInfo &HwWindowManager::GetFramebufferInfo() const {
+        return mContext->GetFramebufferInfo();
+    }
+
+    bool HwWindowManager::IsFramebufferSrgb() const {
+        return mContext->IsFramebufferSrgb();
+    }
+
+    bool HwWindowManager::IsSwapTearSupported() const {
+        return mContext->IsSwapTearSupported();
+    }
+
+    HwContextMode HwWindowManager::GetContextMode() const {
+        return mContext->GetMode();
+    }
+
+    const HwDebugOutput* HwWindowManager::GetDebugOutput() const {
+        return mContext->GetDebugOutput();
+    }
+
+    void HwWindowManager::StartRecording(const std::string &path) {
+        CHECK_MSG(!mReplay, "Cannot record input while replaying");
+        mRecorder = std::unique_ptr<HwInputRecorder>{new HwInputRecorder(path)};
+    }
+
+    void HwWindowManager::StopRecording() {
+        mRecorder = nullptr;
+    }
+
+    void HwWindowManager::StartReplay(const std::string &path, bool realtime) {
+        CHECK_MSG(!mRecorder, "Cannot replay input while recording");
+        mReplay = std::unique_ptr<HwInputReplay>{new HwInputReplay(path, realtime)};
+    }
+
+    bool HwWindowManager::IsReplayFinished() const {
+        return mReplay && mReplay->IsFinished();
+    }
+
+    std::chrono::steady_clock::time_point HwWindowManager::GetEventTime(Time serverTime) {
+        using namespace std::chrono;
+
+        // Server time is 32 bit milliseconds, it wraps every ~49.7 days
+        serverTime &= 0xffffffffu;
+
+        if (mServerTimeOffsetValid && serverTime + 0x80000000u < mLastServerTime) {
+            mServerTimeEpoch += 1ull << 32;
+        }
+
+        mLastServerTime = serverTime;
+
+        auto serverUs = (int64_t) (mServerTimeEpoch + serverTime) * 1000;
+        auto nowUs = (int64_t) duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+
+        // Event is received after it is generated, so the smallest difference is the closest
+        // to the clocks offset (the rest is delivery delay)
+        if (!mServerTimeOffsetValid || nowUs - serverUs < mServerTimeOffsetUs) {
+            mServerTimeOffsetUs = nowUs - serverUs;
+            mServerTimeOffsetValid = true;
+        }
+
+        return steady_clock::time_point(duration_cast<steady_clock::duration>(microseconds(serverUs + mServerTimeOffsetUs)));
+    }
+
+    void HwWindowManager::ReplayEvents() {
+        HwInputRecord record;
+
+        while (mReplay->Next(mFrameIndex, record)) {
+            auto window = GetWindow(mReplay->GetWindowName(record));
+
+            // Window may be not created yet or already destroyed in this run
+            if (!window) {
+                continue;
+            }
+
+            if (record.kind == HwInputRecord::Kind::Input) {
+                window->NotifyInput(record.event);
+            }
+            else if (record.kind == HwInputRecord::Kind::Close) {
+                window->NotifyClose();
+            }
+        }
+    }
+
 }
@@ -27,14 +27,19 @@
 
 #include <X11/Xlib.h>
 #include <glm/vec2.hpp>
+#include <x11hw/context_config.hpp>
 #include <unordered_map>
+#include <chrono>
 #include <memory>
+#include <string>
+#include <cstdint>
 
 namespace x11hw {
 
     class HwWindowManager {
     public:
         HwWindowManager();
+        explicit HwWindowManager(const HwContextConfig &contextConfig);
         HwWindowManager(const HwWindowManager&) = delete;
         HwWindowManager(HwWindowManager&&) noexcept = delete;
         ~HwWindowManager();
@@ -67,12 +72,89 @@ namespace x11hw {
          */
         class HwWindow* GetWindow(const std::string& name);
 
+        /**
+         * Get background uploader with shared GL context (created on first call).
+         * Must be called after first window is created.
+         * @return Uploader
+         */
+        class HwUploader* GetUploader();
+
+        /** @return Mode of created context (requested mode may be not supported) */
+        HwContextMode GetContextMode() const;
+
+        /** @return Attributes of the framebuffer config selected by HwContextConfig::framebuffer policy */
+        const HwFramebufferInfo &GetFramebufferInfo() const;
+
+        /**
+         * Check if windows framebuffer is sRGB capable. If so, GL_FRAMEBUFFER_SRGB is enabled
+         * and shaders must output linear color, otherwise gamma must be applied in shaders.
+         * @return True if framebuffer does sRGB encoding
+         */
+        bool IsFramebufferSrgb() const;
+
+        /** @return True if negative swap intervals (late frames tear instead of waiting) are supported */
+        bool IsSwapTearSupported() const;
+
+        /** @return Debug messages sink if context is created in debug mode, null otherwise */
+        const class HwDebugOutput* GetDebugOutput() const;
+
+        /**
+         * Start recording input events of all windows into binary log
+         * @param path Log file path
+         */
+        void StartRecording(const std::string &path);
+
+        /** Stop recording and close log file */
+        void StopRecording();
+
+        /**
+         * Start replay of recorded input: events from the log are injected in PollEvents
+         * instead of live input events from X server.
+         * @param path Log file path
+         * @param realtime If true, events are injected at recorded time, otherwise at recorded
+         *                 frame index (deterministic, loop may run as fast as possible)
+         */
+        void StartReplay(const std::string &path, bool realtime);
+
+        /** @return True if input is replayed from log */
+        bool IsReplaying() const { return mReplay != nullptr; }
+
+        /** @return True if all recorded events are replayed */
+        bool IsReplayFinished() const;
+
+        /**
+         * @return Time of the last polled frame on the recorded timeline (clock of replayed event times,
+         *         differs from the steady clock, when replay runs as fast as possible)
+         */
+        std::chrono::steady_clock::time_point GetReplayTime() const { return mReplayTime; }
+
+        /** @return Index of the current frame (number of PollEvents calls) */
+        uint32_t GetFrameIndex() const { return mFrameIndex; }
+
+        /** @return Number of events queued by X server at the start of the last PollEvents */
+        uint32_t GetEventQueueDepth() const { return mEventQueueDepth; }
+
     private:
         friend class HwWindow;
 
+        void ReplayEvents();
+        std::chrono::steady_clock::time_point GetEventTime(Time serverTime);
+
         std::unordered_map<std::string, std::unique_ptr<class HwWindow>> mWindows;
         std::unordered_map<Window, class HwWindow*> mX11Windows;
         std::unique_ptr<class HwContext> mContext;
+        std::unique_ptr<class HwUploader> mUploader;
+        std::unique_ptr<class HwInputRecorder> mRecorder;
+        std::unique_ptr<class HwInputReplay> mReplay;
+        std::chrono::steady_clock::time_point mReplayTime{};
+        uint32_t mFrameIndex = 0;
+        uint32_t mEventQueueDepth = 0;
+
+        // Server time (ms, 32 bit) unwrapped to 64 bit and its min observed offset to steady clock
+        uint64_t mServerTimeEpoch = 0;
+        Time mLastServerTime = 0;
+        int64_t mServerTimeOffsetUs = 0;
+        bool mServerTimeOffsetValid = false;
 
         Display* mDisplay = nullptr;
         int mScreen = -1;
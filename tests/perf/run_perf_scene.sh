@@ -0,0 +1,155 @@
+#!/bin/sh
+# Runs one perf scene command on a private Xvfb server with Mesa llvmpipe and compares its
+# metrics with the baseline of this machine (<baseline dir>/<hostname>.txt).
+#
+# Usage: run_perf_scene.sh <baseline dir> <threshold %> <scene> <command> [args ...]
+#
+# Metrics are taken from the command output:
+#  - "<scene>.<metric> <value> <unit>" lines (x11hwbench scenes)
+#  - "Replayed N frames in ..." summary (x11helloworld --replay)
+#  - single row CSV (x11helloworld --stress)
+# Scene fails if it produces no metrics or no frames.
+#
+# Metric regresses if it is worse than the baseline by more than threshold percent: metrics
+# with "/s" units are expected to grow, all the others (times, memory) to shrink.
+# Metrics missing in the baseline are recorded. Set X11HW_PERF_UPDATE_BASELINE=1 to
+# overwrite the baseline of the scene with the current run.
+#
+# Exit code 77 (skipped) if Xvfb is not installed.
+
+set -u
+
+if [ $# -lt 4 ]; then
+    echo "Usage: $0 <baseline dir> <threshold %> <scene> <command> [args ...]" >&2
+    exit 2
+fi
+
+BASELINE_DIR=$1
+THRESHOLD=$2
+SCENE=$3
+shift 3
+
+if ! command -v Xvfb > /dev/null 2>&1; then
+    echo "Xvfb is not found, perf scene $SCENE skipped"
+    exit 77
+fi
+
+WORK_DIR=$(mktemp -d)
+XVFB_PID=
+
+cleanup() {
+    if [ -n "$XVFB_PID" ]; then
+        kill "$XVFB_PID" 2> /dev/null
+        wait "$XVFB_PID" 2> /dev/null
+    fi
+    rm -rf "$WORK_DIR"
+}
+
+trap cleanup EXIT
+trap 'exit 1' INT TERM
+
+# Server picks a free display and writes its number into fd 3
+Xvfb -displayfd 3 -screen 0 1280x1024x24 -nolisten tcp 3> "$WORK_DIR/display" 2> "$WORK_DIR/xvfb.log" &
+XVFB_PID=$!
+
+for i in $(seq 100); do
+    [ -s "$WORK_DIR/display" ] && break
+    sleep 0.1
+done
+
+if [ ! -s "$WORK_DIR/display" ]; then
+    echo "Failed to start Xvfb:" >&2
+    cat "$WORK_DIR/xvfb.log" >&2
+    exit 1
+fi
+
+# Software rasterizer makes numbers comparable across runs on the machine (no GPU clocks)
+DISPLAY=:$(cat "$WORK_DIR/display") LIBGL_ALWAYS_SOFTWARE=1 GALLIUM_DRIVER=llvmpipe \
+    "$@" > "$WORK_DIR/output.txt"
+STATUS=$?
+
+cat "$WORK_DIR/output.txt"
+
+if [ $STATUS -ne 0 ]; then
+    echo "Scene $SCENE failed with code $STATUS" >&2
+    exit $STATUS
+fi
+
+# Metric lines of the scene: "<scene>.<metric> <value> <unit>"
+awk -v scene="$SCENE" '
+    index($0, scene ".") == 1 { print; next }
+
+    # Replayed N frames in S s, avg frame X ms, startup Y ms, peak RSS Z MiB
+    /^Replayed / {
+        if ($2 > 0) {
+            printf "%s.frame_time_ms %s ms\n", scene, $9
+            printf "%s.startup_ms %s ms\n", scene, $12
+            printf "%s.peak_rss_mib %s MiB\n", scene, $16
+        }
+        next
+    }
+
+    # Stress CSV: header, then one row per combination (scene must be one combination)
+    /^windows,geometries,/ { columns = split($0, header, ","); next }
+    columns > 0 && /^[0-9]/ {
+        split($0, row, ",")
+        for (i = 1; i <= columns; i++) {
+            value[header[i]] = row[i]
+        }
+        if (value["frame_ms"] > 0) {
+            printf "%s.startup_ms %s ms\n", scene, value["setup_ms"]
+            printf "%s.frame_time_ms %s ms\n", scene, value["frame_ms"]
+            printf "%s.draws_per_sec %s draws/s\n", scene, value["draws_per_sec"]
+        }
+    }
+' "$WORK_DIR/output.txt" > "$WORK_DIR/current.txt"
+
+if [ ! -s "$WORK_DIR/current.txt" ]; then
+    echo "Scene $SCENE produced no metrics (or no frames)" >&2
+    exit 1
+fi
+
+mkdir -p "$BASELINE_DIR"
+BASELINE="$BASELINE_DIR/$(hostname).txt"
+touch "$BASELINE"
+
+if [ "${X11HW_PERF_UPDATE_BASELINE:-0}" = "1" ]; then
+    grep -v "^$SCENE\." "$BASELINE" > "$WORK_DIR/baseline.txt"
+    cat "$WORK_DIR/current.txt" >> "$WORK_DIR/baseline.txt"
+    cp "$WORK_DIR/baseline.txt" "$BASELINE"
+    echo "Baseline of $SCENE updated in $BASELINE"
+    exit 0
+fi
+
+awk -v threshold="$THRESHOLD" -v baseline="$BASELINE" -v missing="$WORK_DIR/missing.txt" '
+    FILENAME == baseline { base[$1] = $2; next }
+    {
+        if (!($1 in base)) {
+            print >> missing
+            printf "%-40s %12g %-9s (no baseline, recorded)\n", $1, $2, $3
+            next
+        }
+
+        higherIsBetter = ($3 ~ /\/s$/)
+        change = base[$1] != 0 ? ($2 - base[$1]) / base[$1] * 100.0 : 0.0
+        regression = higherIsBetter ? -change : change
+        status = regression > threshold ? "REGRESSED" : "ok"
+        printf "%-40s %12g %-9s baseline %12g %+7.1f%% %s\n", $1, $2, $3, base[$1], change, status
+
+        if (regression > threshold) {
+            failed = 1
+        }
+    }
+    END { exit failed }
+' "$BASELINE" "$WORK_DIR/current.txt"
+RESULT=$?
+
+if [ -s "$WORK_DIR/missing.txt" ]; then
+    cat "$WORK_DIR/missing.txt" >> "$BASELINE"
+fi
+
+if [ $RESULT -ne 0 ]; then
+    echo "Scene $SCENE regressed by more than $THRESHOLD% against $BASELINE" >&2
+fi
+
+exit $RESULT
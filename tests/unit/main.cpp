@@ -0,0 +1,80 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <test.hpp>
+#include <iostream>
+#include <cstring>
+
+struct TestEntry {
+    const char *name;
+    x11hw::test::TestFunction function;
+};
+
+static const TestEntry TESTS[] = {
+    { "range-allocator-exact-fit", x11hw::test::TestRangeAllocatorExactFit },
+    { "range-allocator-split-merge", x11hw::test::TestRangeAllocatorSplitMerge },
+    { "range-allocator-reuse", x11hw::test::TestRangeAllocatorReuse },
+    { "job-system-steal", x11hw::test::TestJobSystemSteal },
+    { "job-system-nested", x11hw::test::TestJobSystemNested },
+    { "job-system-continuations", x11hw::test::TestJobSystemContinuations },
+    { "job-system-overflow", x11hw::test::TestJobSystemOverflow },
+    { "input-replay-timeline", x11hw::test::TestInputReplayTimeline },
+    { "debug-output-dedup", x11hw::test::TestDebugOutputDedup },
+    { "event-token-owner", x11hw::test::TestEventTokenOwner },
+    { "obj-mesh-long-line", x11hw::test::TestObjMeshLongLine },
+};
+
+static bool Run(const TestEntry &entry) {
+    try {
+        entry.function();
+        std::cout << entry.name << ": ok" << std::endl;
+        return true;
+    }
+    catch (const std::exception &e) {
+        std::cerr << entry.name << ": FAILED " << e.what() << std::endl;
+        return false;
+    }
+}
+
+int main(int argc, const char *const *argv) {
+    // No argument runs all the tests, CTest runs them one by one
+    bool passed = true;
+
+    for (auto& entry: TESTS) {
+        if (argc < 2 || std::strcmp(entry.name, argv[1]) == 0) {
+            passed = Run(entry) && passed;
+
+            if (argc >= 2) {
+                return passed ? 0 : 1;
+            }
+        }
+    }
+
+    if (argc >= 2) {
+        std::cerr << "Unknown test " << argv[1] << std::endl;
+        return 1;
+    }
+
+    return passed ? 0 : 1;
+}
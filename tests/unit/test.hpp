@@ -0,0 +1,65 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef X11HELLOWORLD_TEST_HPP
+#define X11HELLOWORLD_TEST_HPP
+
+#include <stdexcept>
+#include <string>
+
+/** Fail the test with the location and the failed condition */
+#define TEST_CHECK(condition)                                                                   \
+    do {                                                                                        \
+        if (!(condition)) {                                                                     \
+            throw std::runtime_error(std::string(__FILE__) + ":" + std::to_string(__LINE__) +   \
+                                     ": " #condition);                                          \
+        }                                                                                       \
+    } while (false)
+
+namespace x11hw {
+    namespace test {
+
+        using TestFunction = void (*)();
+
+        void TestRangeAllocatorExactFit();
+        void TestRangeAllocatorSplitMerge();
+        void TestRangeAllocatorReuse();
+
+        void TestJobSystemSteal();
+        void TestJobSystemNested();
+        void TestJobSystemContinuations();
+        void TestJobSystemOverflow();
+
+        void TestInputReplayTimeline();
+
+        void TestDebugOutputDedup();
+
+        void TestEventTokenOwner();
+
+        void TestObjMeshLongLine();
+
+    }
+}
+
+#endif //X11HELLOWORLD_TEST_HPP
@@ -0,0 +1,64 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <test.hpp>
+#include <x11hw/event_dispatcher.hpp>
+
+namespace x11hw {
+    namespace test {
+
+        void TestEventTokenOwner() {
+            // Two owners (e.g. windows) with the same channel: listener ids are the same
+            HwEvent<int> first(HwEventToken::NewOwner(), 1);
+            HwEvent<int> second(HwEventToken::NewOwner(), 1);
+
+            int firstCalls = 0;
+            int secondCalls = 0;
+            auto firstToken = first.Subscribe([&firstCalls](int) { firstCalls += 1; });
+            auto secondToken = second.Subscribe([&secondCalls](int) { secondCalls += 1; });
+            TEST_CHECK(firstToken.id == secondToken.id);
+            TEST_CHECK(firstToken.owner != secondToken.owner);
+
+            // Foreign token is rejected and does not remove the listener with the same id
+            TEST_CHECK(!second.Unsubscribe(firstToken));
+            second.Dispatch(0);
+            TEST_CHECK(secondCalls == 1);
+
+            TEST_CHECK(first.Unsubscribe(firstToken));
+            TEST_CHECK(!first.Unsubscribe(firstToken));
+            first.Dispatch(0);
+            TEST_CHECK(firstCalls == 0);
+
+            // Same for the dispatcher of several event types
+            enum class Type { A, B, Count };
+            HwEventDispatcher<Type, (size_t) Type::Count, int> events(HwEventToken::NewOwner(), 1);
+            auto token = events.Subscribe(Type::A, [](int) {});
+            TEST_CHECK(!events.Unsubscribe(secondToken));
+            TEST_CHECK(events.HasListeners(Type::A));
+            TEST_CHECK(events.Unsubscribe(token));
+            TEST_CHECK(!events.HasListeners(Type::A));
+        }
+
+    }
+}
@@ -0,0 +1,96 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+#include <test.hpp>
+#include <x11hw/input_record.hpp>
+#include <cstdio>
+#include <string>
+
+namespace x11hw {
+    namespace test {
+
+        template<typename T>
+        static void WriteValue(std::FILE *file, T value) {
+            std::fwrite(&value, sizeof(T), 1, file);
+        }
+
+        static void WriteHeader(std::FILE *file, HwInputRecord::Kind kind, uint32_t frame, uint64_t timestamp) {
+            WriteValue<uint8_t>(file, (uint8_t) kind);
+            WriteValue<uint32_t>(file, frame);
+            WriteValue<uint64_t>(file, timestamp);
+            WriteValue<uint16_t>(file, 0);
+        }
+
+        static void WriteMotion(std::FILE *file, uint32_t frame, uint64_t timestamp) {
+            WriteHeader(file, HwInputRecord::Kind::Input, frame, timestamp);
+            WriteValue<uint8_t>(file, (uint8_t) HwWindow::EventType::MouseMoved);
+            WriteValue<uint8_t>(file, (uint8_t) HwWindow::MouseButton::Unknown);
+            WriteValue<int32_t>(file, 0);
+            WriteValue<int32_t>(file, 0);
+        }
+
+        static int64_t GetUs(std::chrono::steady_clock::duration duration) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        }
+
+        void TestInputReplayTimeline() {
+            std::string path = "x11hw_test_input_replay.bin";
+            std::FILE *file = std::fopen(path.c_str(), "wb");
+            TEST_CHECK(file);
+
+            std::fwrite("X11HWINP", 8, 1, file);
+            WriteValue<uint32_t>(file, 1);
+
+            std::string name = "window";
+            WriteHeader(file, HwInputRecord::Kind::Window, 10, 100000);
+            WriteValue<uint16_t>(file, (uint16_t) name.size());
+            std::fwrite(name.data(), name.size(), 1, file);
+
+            WriteMotion(file, 10, 100000);
+            WriteMotion(file, 20, 300000);
+            std::fclose(file);
+
+            // Frame indices drive fast replay, event times stay on the recorded timeline
+            HwInputReplay replay(path, false);
+            std::remove(path.c_str());
+
+            HwInputRecord record;
+            TEST_CHECK(!replay.Next(0, record));
+
+            auto start = replay.GetFrameTime(0);
+            TEST_CHECK(GetUs(replay.GetFrameTime(5) - start) == 50000);
+            TEST_CHECK(GetUs(replay.GetFrameTime(10) - start) == 100000);
+            TEST_CHECK(GetUs(replay.GetFrameTime(15) - start) == 200000);
+            TEST_CHECK(GetUs(replay.GetFrameTime(20) - start) == 300000);
+            // After the last record: average recorded frame time (15 ms)
+            TEST_CHECK(GetUs(replay.GetFrameTime(30) - start) == 450000);
+
+            TEST_CHECK(replay.Next(10, record));
+            TEST_CHECK(record.event.time == replay.GetFrameTime(10));
+            TEST_CHECK(replay.Next(20, record));
+            TEST_CHECK(record.event.time == replay.GetFrameTime(20));
+            TEST_CHECK(replay.IsFinished());
+        }
+
+    }
+}
@@ -0,0 +1,252 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+#include <test.hpp>
+#include <x11hw/job_system.hpp>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace x11hw {
+    namespace test {
+
+        // Every slot counts runs of its job, each must run exactly once
+        static bool AllOnce(const std::vector<std::atomic<int>> &runs) {
+            for (auto& run: runs) {
+                if (run.load() != 1) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        void TestJobSystemSteal() {
+            HwJobSystem::InitParams params;
+            params.workersCount = 3;
+            HwJobSystem jobSystem(params);
+
+            static const size_t JOBS = 2000;
+            std::vector<std::atomic<int>> runs(JOBS);
+
+            for (size_t round = 0; round < 4; round++) {
+                for (auto& run: runs) {
+                    run.store(0);
+                }
+
+                HwJobCounter counter;
+                for (size_t i = 0; i < JOBS; i++) {
+                    jobSystem.Submit(counter, [&runs, i]() { runs[i].fetch_add(1); });
+                }
+
+                // Owner stays away from its deque for a while, so workers have to steal
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                jobSystem.Wait(counter);
+
+                TEST_CHECK(counter.IsDone());
+                TEST_CHECK(AllOnce(runs));
+            }
+
+            // Single job raced by owner pop and thieves steal
+            std::atomic<int> single{0};
+            for (size_t round = 0; round < 10000; round++) {
+                HwJobCounter counter;
+                jobSystem.Submit(counter, [&single]() { single.fetch_add(1); });
+                jobSystem.Wait(counter);
+            }
+            TEST_CHECK(single.load() == 10000);
+
+            auto stats = jobSystem.GetStats();
+            TEST_CHECK(stats.stolen > 0);
+            TEST_CHECK(stats.executed == 4 * JOBS + 10000);
+        }
+
+        void TestJobSystemNested() {
+            HwJobSystem::InitParams params;
+            params.workersCount = 3;
+            HwJobSystem jobSystem(params);
+
+            static const size_t PARENTS = 64;
+            static const size_t CHILDREN = 64;
+            std::vector<std::atomic<int>> runs(PARENTS * CHILDREN);
+            std::atomic<size_t> incomplete{0};
+
+            // Jobs submit children to their own thread deque and wait for them inside the job
+            HwJobCounter counter;
+            for (size_t p = 0; p < PARENTS; p++) {
+                jobSystem.Submit(counter, [&jobSystem, &runs, &incomplete, p]() {
+                    HwJobCounter children;
+                    jobSystem.ParallelFor(children, CHILDREN, 4, [&runs, p](size_t begin, size_t end) {
+                        for (size_t c = begin; c < end; c++) {
+                            runs[p * CHILDREN + c].fetch_add(1);
+                        }
+                    });
+                    jobSystem.Wait(children);
+
+                    for (size_t c = 0; c < CHILDREN; c++) {
+                        if (runs[p * CHILDREN + c].load() != 1) {
+                            incomplete.fetch_add(1);
+                        }
+                    }
+                });
+            }
+
+            jobSystem.Wait(counter);
+
+            TEST_CHECK(incomplete.load() == 0);
+            TEST_CHECK(AllOnce(runs));
+        }
+
+        void TestJobSystemContinuations() {
+            HwJobSystem::InitParams params;
+            params.workersCount = 3;
+            HwJobSystem jobSystem(params);
+
+            // Results of the dependency group are visible in the continuation
+            {
+                static const size_t JOBS = 256;
+                std::vector<int> values(JOBS, 0);
+                std::atomic<int> sum{-1};
+
+                HwJobCounter first;
+                HwJobCounter second;
+                for (size_t i = 0; i < JOBS; i++) {
+                    jobSystem.Submit(first, [&values, i]() { values[i] = (int) i; });
+                }
+                jobSystem.SubmitAfter(first, second, [&values, &sum]() {
+                    int s = 0;
+                    for (auto v: values) {
+                        s += v;
+                    }
+                    sum.store(s);
+                });
+
+                jobSystem.Wait(second);
+                TEST_CHECK(first.IsDone());
+                TEST_CHECK(sum.load() == (int) (JOBS * (JOBS - 1) / 2));
+            }
+
+            // Continuation added while the dependency finishes on a worker: it runs exactly once, after it
+            {
+                static const size_t ROUNDS = 5000;
+                std::atomic<size_t> ran{0};
+                std::atomic<size_t> early{0};
+
+                for (size_t round = 0; round < ROUNDS; round++) {
+                    std::atomic<bool> done{false};
+                    HwJobCounter first;
+                    HwJobCounter second;
+
+                    jobSystem.Submit(first, [&done]() { done.store(true); });
+                    jobSystem.SubmitAfter(first, second, [&done, &ran, &early]() {
+                        if (!done.load()) {
+                            early.fetch_add(1);
+                        }
+                        ran.fetch_add(1);
+                    });
+
+                    jobSystem.Wait(second);
+                    jobSystem.Wait(first);
+                }
+
+                TEST_CHECK(early.load() == 0);
+                TEST_CHECK(ran.load() == ROUNDS);
+            }
+
+            // Dependency with no jobs is already done: continuation is queued at once
+            {
+                std::atomic<int> ran{0};
+                HwJobCounter first;
+                HwJobCounter second;
+
+                jobSystem.SubmitAfter(first, second, [&ran]() { ran.fetch_add(1); });
+                jobSystem.Wait(second);
+                TEST_CHECK(ran.load() == 1);
+            }
+
+            // Chain of groups, each one waits for the previous
+            {
+                static const size_t LINKS = 32;
+                std::vector<std::unique_ptr<HwJobCounter>> counters;
+                std::atomic<size_t> order{0};
+                std::atomic<size_t> misordered{0};
+
+                counters.emplace_back(new HwJobCounter());
+                jobSystem.Submit(*counters.back(), [&order]() { order.fetch_add(1); });
+
+                for (size_t i = 1; i < LINKS; i++) {
+                    counters.emplace_back(new HwJobCounter());
+                    jobSystem.SubmitAfter(*counters[i - 1], *counters[i], [&order, &misordered, i]() {
+                        if (order.fetch_add(1) != i) {
+                            misordered.fetch_add(1);
+                        }
+                    });
+                }
+
+                jobSystem.Wait(*counters.back());
+                TEST_CHECK(order.load() == LINKS);
+                TEST_CHECK(misordered.load() == 0);
+
+                for (auto& counter: counters) {
+                    jobSystem.Wait(*counter);
+                }
+            }
+        }
+
+        void TestJobSystemOverflow() {
+            static const size_t JOBS = 1000;
+
+            // Small queue and job ring: full queue runs the job inline, wrapped ring allocates it
+            for (size_t workers: {0u, 2u}) {
+                HwJobSystem::InitParams params;
+                params.workersCount = workers;
+                params.queueCapacity = 16;
+                HwJobSystem jobSystem(params);
+
+                std::vector<std::atomic<int>> runs(JOBS);
+                for (auto& run: runs) {
+                    run.store(0);
+                }
+
+                HwJobCounter counter;
+                for (size_t i = 0; i < JOBS; i++) {
+                    jobSystem.Submit(counter, [&runs, i]() { runs[i].fetch_add(1); });
+                }
+                jobSystem.Wait(counter);
+
+                TEST_CHECK(AllOnce(runs));
+
+                auto stats = jobSystem.GetStats();
+                TEST_CHECK(stats.executed == JOBS);
+
+                if (workers == 0) {
+                    TEST_CHECK(stats.inlined > 0);
+                    TEST_CHECK(stats.allocated > 0);
+                }
+            }
+        }
+
+    }
+}
@@ -0,0 +1,62 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <test.hpp>
+#include <x11hw/obj_mesh.hpp>
+#include <cstdio>
+#include <string>
+
+namespace x11hw {
+    namespace test {
+
+        void TestObjMeshLongLine() {
+            // Polygon of 400 corners: its face record is longer than 1 KB
+            const size_t corners = 400;
+            std::string path = "x11hw_test_long_line.obj";
+            std::FILE *file = std::fopen(path.c_str(), "wb");
+            TEST_CHECK(file);
+
+            for (size_t i = 0; i < corners; i++) {
+                std::fprintf(file, "v %zu.0 0.0 0.0\n", i);
+            }
+
+            std::string face = "f";
+            for (size_t i = 1; i <= corners; i++) {
+                face += " " + std::to_string(i);
+            }
+
+            std::fprintf(file, "%s\n", face.c_str());
+            std::fclose(file);
+            TEST_CHECK(face.size() > 1024);
+
+            HwObjMesh mesh(path);
+            std::remove(path.c_str());
+
+            TEST_CHECK(mesh.GetVerticesCount() == corners);
+            TEST_CHECK(mesh.GetIndices().size() == (corners - 2) * 3);
+            TEST_CHECK(mesh.GetIndices().back() == corners - 1);
+        }
+
+    }
+}
@@ -0,0 +1,129 @@
+////////////////////////////////////////////////////////////////////////////////////
+// MIT License                                                                    //
+//                                                                                //
+// Copyright (c) 2021 Egor Orachyov                                               //
+//                                                                                //
+// Permission is hereby granted, free of charge, to any person obtaining a copy   //
+// of this software and associated documentation files (the "Software"), to deal  //
+// in the Software without restriction, including without limitation the rights   //
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell      //
+// copies of the Software, and to permit persons to whom the Software is          //
+// furnished to do so, subject to the following conditions:                       //
+//                                                                                //
+// The above copyright notice and this permission notice shall be included in all //
+// copies or substantial portions of the Software.                                //
+//                                                                                //
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR     //
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,       //
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE    //
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER         //
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,  //
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE  //
+// SOFTWARE.                                                                      //
+////////////////////////////////////////////////////////////////////////////////////
+
+#include <test.hpp>
+#include <x11hw/range_allocator.hpp>
+#include <vector>
+
+namespace x11hw {
+    namespace test {
+
+        void TestRangeAllocatorExactFit() {
+            // Sizes not on a bin boundary are rounded up on search, exact fit must still be found
+            for (uint32_t capacity: {1u, 7u, 8u, 9u, 100u, 1000u, 4097u, 65535u}) {
+                HwRangeAllocator allocator(capacity);
+                uint32_t offset = HwRangeAllocator::INVALID;
+
+                auto allocation = allocator.Allocate(capacity, offset);
+                TEST_CHECK(allocation != HwRangeAllocator::INVALID);
+                TEST_CHECK(offset == 0);
+                TEST_CHECK(allocator.GetStats().free == 0);
+
+                uint32_t extra;
+                TEST_CHECK(allocator.Allocate(1, extra) == HwRangeAllocator::INVALID);
+
+                allocator.Release(allocation);
+                TEST_CHECK(allocator.GetStats().largestFree == capacity);
+            }
+
+            // Page filled to capacity with equal ranges
+            HwRangeAllocator allocator(300);
+            uint32_t offset;
+            for (uint32_t i = 0; i < 3; i++) {
+                TEST_CHECK(allocator.Allocate(100, offset) != HwRangeAllocator::INVALID);
+                TEST_CHECK(offset == i * 100);
+            }
+            TEST_CHECK(allocator.GetStats().used == 300);
+        }
+
+        void TestRangeAllocatorSplitMerge() {
+            HwRangeAllocator allocator(1024);
+            uint32_t offsets[4];
+            uint32_t allocations[4];
+
+            for (uint32_t i = 0; i < 4; i++) {
+                allocations[i] = allocator.Allocate(100, offsets[i]);
+                TEST_CHECK(allocations[i] != HwRangeAllocator::INVALID);
+                TEST_CHECK(offsets[i] == i * 100);
+            }
+
+            // Tail remainder is the only free block
+            auto stats = allocator.GetStats();
+            TEST_CHECK(stats.used == 400);
+            TEST_CHECK(stats.freeBlocksCount == 1);
+            TEST_CHECK(stats.largestFree == 624);
+
+            // Holes are not adjacent: no merge
+            allocator.Release(allocations[0]);
+            allocator.Release(allocations[2]);
+            stats = allocator.GetStats();
+            TEST_CHECK(stats.freeBlocksCount == 3);
+            TEST_CHECK(stats.allocationsCount == 2);
+
+            // Merge with previous and next free neighbours
+            allocator.Release(allocations[1]);
+            stats = allocator.GetStats();
+            TEST_CHECK(stats.freeBlocksCount == 2);
+            TEST_CHECK(stats.largestFree == 624);
+
+            allocator.Release(allocations[3]);
+            stats = allocator.GetStats();
+            TEST_CHECK(stats.freeBlocksCount == 1);
+            TEST_CHECK(stats.largestFree == 1024);
+            TEST_CHECK(stats.used == 0);
+        }
+
+        void TestRangeAllocatorReuse() {
+            HwRangeAllocator allocator(1000);
+            std::vector<uint32_t> allocations;
+            uint32_t offset;
+
+            for (uint32_t i = 0; i < 10; i++) {
+                allocations.push_back(allocator.Allocate(100, offset));
+                TEST_CHECK(allocations.back() != HwRangeAllocator::INVALID);
+            }
+
+            TEST_CHECK(allocator.Allocate(1, offset) == HwRangeAllocator::INVALID);
+
+            // Released hole of exact size is reused from the free list
+            allocator.Release(allocations[4]);
+            uint32_t reused = allocator.Allocate(100, offset);
+            TEST_CHECK(reused != HwRangeAllocator::INVALID);
+            TEST_CHECK(offset == 400);
+
+            // Smaller request splits the hole, rest stays free and is found later
+            allocator.Release(reused);
+            TEST_CHECK(allocator.Allocate(60, offset) != HwRangeAllocator::INVALID);
+            TEST_CHECK(offset == 400);
+            TEST_CHECK(allocator.Allocate(40, offset) != HwRangeAllocator::INVALID);
+            TEST_CHECK(offset == 460);
+            TEST_CHECK(allocator.GetStats().free == 0);
+
+            // Reset returns the whole range
+            allocator.Reset();
+            TEST_CHECK(allocator.Allocate(1000, offset) != HwRangeAllocator::INVALID);
+        }
+
+    }
+}